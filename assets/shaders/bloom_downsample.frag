@@ -0,0 +1,69 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D sourceTexture;
+uniform vec2 texelSize;     // 1 / source size
+uniform bool prefilter;     // first level: keep only the bright parts and tame fireflies
+uniform float threshold;
+
+float luma(vec3 c)
+{
+    return dot(c, vec3(0.2126, 0.7152, 0.0722));
+}
+
+// Weights each 2x2 block by 1 / (1 + luma) so a single very bright pixel cannot flicker
+vec3 karisAverage(vec3 a, vec3 b, vec3 c, vec3 d)
+{
+    float wa = 1.0 / (1.0 + luma(a));
+    float wb = 1.0 / (1.0 + luma(b));
+    float wc = 1.0 / (1.0 + luma(c));
+    float wd = 1.0 / (1.0 + luma(d));
+    return (a * wa + b * wb + c * wc + d * wd) / (wa + wb + wc + wd);
+}
+
+void main()
+{
+    // 13 bilinear taps laid out as five overlapping 2x2 boxes
+    vec2 t = texelSize;
+    vec3 a = texture(sourceTexture, TexCoords + t * vec2(-2.0,  2.0)).rgb;
+    vec3 b = texture(sourceTexture, TexCoords + t * vec2( 0.0,  2.0)).rgb;
+    vec3 c = texture(sourceTexture, TexCoords + t * vec2( 2.0,  2.0)).rgb;
+    vec3 d = texture(sourceTexture, TexCoords + t * vec2(-2.0,  0.0)).rgb;
+    vec3 e = texture(sourceTexture, TexCoords).rgb;
+    vec3 f = texture(sourceTexture, TexCoords + t * vec2( 2.0,  0.0)).rgb;
+    vec3 g = texture(sourceTexture, TexCoords + t * vec2(-2.0, -2.0)).rgb;
+    vec3 h = texture(sourceTexture, TexCoords + t * vec2( 0.0, -2.0)).rgb;
+    vec3 i = texture(sourceTexture, TexCoords + t * vec2( 2.0, -2.0)).rgb;
+    vec3 j = texture(sourceTexture, TexCoords + t * vec2(-1.0,  1.0)).rgb;
+    vec3 k = texture(sourceTexture, TexCoords + t * vec2( 1.0,  1.0)).rgb;
+    vec3 l = texture(sourceTexture, TexCoords + t * vec2(-1.0, -1.0)).rgb;
+    vec3 m = texture(sourceTexture, TexCoords + t * vec2( 1.0, -1.0)).rgb;
+
+    vec3 color;
+    if (prefilter)
+    {
+        color  = karisAverage(j, k, l, m) * 0.5;
+        color += karisAverage(a, b, d, e) * 0.125;
+        color += karisAverage(b, c, e, f) * 0.125;
+        color += karisAverage(d, e, g, h) * 0.125;
+        color += karisAverage(e, f, h, i) * 0.125;
+
+        // soft knee so the threshold does not cut a hard edge into the glow
+        float brightness = max(color.r, max(color.g, color.b));
+        float knee = threshold * 0.5;
+        float soft = clamp(brightness - threshold + knee, 0.0, 2.0 * knee);
+        soft = soft * soft / (4.0 * knee + 0.0001);
+        color *= max(soft, brightness - threshold) / max(brightness, 0.0001);
+    }
+    else
+    {
+        color  = (j + k + l + m) * 0.125;
+        color += (a + c + g + i) * 0.03125;
+        color += (b + d + f + h) * 0.0625;
+        color += e * 0.125;
+    }
+
+    FragColor = vec4(color, 1.0);
+}
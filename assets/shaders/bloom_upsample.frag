@@ -0,0 +1,24 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D sourceTexture;
+uniform vec2 texelSize;     // 1 / source size, the smaller level
+
+void main()
+{
+    // 3x3 tent, blended additively onto the larger level
+    vec2 t = texelSize;
+    vec3 color = texture(sourceTexture, TexCoords).rgb * 4.0;
+    color += texture(sourceTexture, TexCoords + t * vec2(-1.0,  0.0)).rgb * 2.0;
+    color += texture(sourceTexture, TexCoords + t * vec2( 1.0,  0.0)).rgb * 2.0;
+    color += texture(sourceTexture, TexCoords + t * vec2( 0.0,  1.0)).rgb * 2.0;
+    color += texture(sourceTexture, TexCoords + t * vec2( 0.0, -1.0)).rgb * 2.0;
+    color += texture(sourceTexture, TexCoords + t * vec2(-1.0,  1.0)).rgb;
+    color += texture(sourceTexture, TexCoords + t * vec2( 1.0,  1.0)).rgb;
+    color += texture(sourceTexture, TexCoords + t * vec2(-1.0, -1.0)).rgb;
+    color += texture(sourceTexture, TexCoords + t * vec2( 1.0, -1.0)).rgb;
+
+    FragColor = vec4(color / 16.0, 1.0);
+}
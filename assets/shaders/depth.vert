@@ -0,0 +1,17 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+// Per-instance attributes, see InstanceData
+layout (location = 3) in mat4 aModel;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+// pbr.vert draws with GL_EQUAL against this depth, both must compute gl_Position identically
+invariant gl_Position;
+
+void main()
+{
+    vec3 worldPos = vec3(aModel * vec4(aPos, 1.0));
+    gl_Position = projection * view * vec4(worldPos, 1.0);
+}
@@ -0,0 +1,41 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D sourceTexture;    // tonemapped, luma in alpha
+uniform vec2 inverseSize;           // 1 / source size
+
+const float FXAA_SPAN_MAX = 8.0;
+const float FXAA_REDUCE_MUL = 1.0 / 8.0;
+const float FXAA_REDUCE_MIN = 1.0 / 128.0;
+
+// The low quality FXAA variant: one blur along the local edge direction, no end-of-edge search
+void main()
+{
+    float lumaNW = texture(sourceTexture, TexCoords + vec2(-1.0, -1.0) * inverseSize).a;
+    float lumaNE = texture(sourceTexture, TexCoords + vec2( 1.0, -1.0) * inverseSize).a;
+    float lumaSW = texture(sourceTexture, TexCoords + vec2(-1.0,  1.0) * inverseSize).a;
+    float lumaSE = texture(sourceTexture, TexCoords + vec2( 1.0,  1.0) * inverseSize).a;
+    float lumaM  = texture(sourceTexture, TexCoords).a;
+
+    float lumaMin = min(lumaM, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));
+    float lumaMax = max(lumaM, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));
+
+    vec2 dir;
+    dir.x = -((lumaNW + lumaNE) - (lumaSW + lumaSE));
+    dir.y =  ((lumaNW + lumaSW) - (lumaNE + lumaSE));
+
+    float dirReduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * (0.25 * FXAA_REDUCE_MUL), FXAA_REDUCE_MIN);
+    float rcpDirMin = 1.0 / (min(abs(dir.x), abs(dir.y)) + dirReduce);
+    dir = clamp(dir * rcpDirMin, vec2(-FXAA_SPAN_MAX), vec2(FXAA_SPAN_MAX)) * inverseSize;
+
+    vec3 rgbA = 0.5 * (texture(sourceTexture, TexCoords + dir * (1.0 / 3.0 - 0.5)).rgb +
+                       texture(sourceTexture, TexCoords + dir * (2.0 / 3.0 - 0.5)).rgb);
+    vec3 rgbB = rgbA * 0.5 + 0.25 * (texture(sourceTexture, TexCoords + dir * -0.5).rgb +
+                                     texture(sourceTexture, TexCoords + dir * 0.5).rgb);
+
+    // the wider blur crossed an edge when its luma leaves the local range
+    float lumaB = dot(rgbB, vec3(0.299, 0.587, 0.114));
+    FragColor = vec4((lumaB < lumaMin || lumaB > lumaMax) ? rgbA : rgbB, 1.0);
+}
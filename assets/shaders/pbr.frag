@@ -5,19 +5,47 @@ in vec3 Normal;
 in vec3 FragPos;  
 in vec2 TexCoords;
 
-// Material properties
+// Material properties, one std140 entry per material bound by range (see GpuMaterial)
 uniform sampler2D albedoMap;
-uniform vec4  albedoFactor;
-uniform float metallicFactor;
-uniform float roughnessFactor;
-uniform vec3  emissiveFactor;
-uniform bool  doubleSided;
-
-// Lights & Camera
-uniform vec3 lightPos;
-uniform vec3 lightColor;
+
+layout (std140) uniform MaterialBlock {
+    vec4  albedoFactor;
+    vec4  emissiveFactor;
+    float metallicFactor;
+    float roughnessFactor;
+    bool  doubleSided;
+};
+
+// Camera
+uniform mat4 view;
 uniform vec3 viewPos;
 
+// Clustered point lights, the grid must match LightClusterGrid
+const uint CLUSTER_TILES_X = 16u;
+const uint CLUSTER_TILES_Y = 9u;
+const uint CLUSTER_SLICES  = 24u;
+
+uniform samplerBuffer  lightData;     // two texels per light: position and range, color and shadow slot
+uniform usamplerBuffer lightClusters; // offset and count into lightIndices per cluster
+uniform usamplerBuffer lightIndices;
+
+// xy: tiles per pixel, slice = log(view depth) * z - w
+uniform vec4 clusterParams;
+
+// Directional light, shining along sunDirection
+uniform vec3 sunDirection;
+uniform vec3 sunColor;
+
+// Shadows, the layout must match ShadowMaps
+const int SHADOW_TILE_COUNT = 64;
+const int CASCADE_COUNT     = 4;
+
+uniform bool shadowsEnabled;
+uniform sampler2DArrayShadow cascadeShadowMap;
+uniform sampler2DShadow      pointShadowAtlas;
+uniform samplerBuffer        shadowMatrices; // world to shadow texture space, one per atlas tile then one per cascade
+uniform vec4 cascadeEnds;                    // view depth each cascade reaches, all zero when the sun casts none
+
 const float PI = 3.14159265359;
 
 // PBR helper functions
@@ -53,13 +81,66 @@ float GeometrySmith(vec3 N, vec3 V, vec3 L, float roughness)
     return ggx1 * ggx2;
 }
 
+// Cook-Torrance BRDF for one light direction, times NdotL
+vec3 BRDF(vec3 N, vec3 V, vec3 L, vec3 albedo, vec3 F0, float metallic, float roughness)
+{
+    vec3 H = normalize(V + L);
+
+    float NDF = DistributionGGX(N, H, roughness);
+    float G   = GeometrySmith(N, V, L, roughness);
+    vec3 F    = fresnelSchlick(max(dot(H, V), 0.0), F0);
+
+    vec3 kS = F;
+    vec3 kD = vec3(1.0) - kS;
+    kD *= 1.0 - metallic;
+
+    vec3 numerator    = NDF * G * F;
+    float denominator = 4.0 * max(dot(N, V), 0.0) * max(dot(N, L), 0.0) + 0.0001;
+    vec3 specular     = numerator / denominator;
+
+    float NdotL = max(dot(N, L), 0.0);
+    return (kD * albedo / PI + specular) * NdotL;
+}
+
+mat4 shadowMatrix(int index)
+{
+    return mat4(texelFetch(shadowMatrices, index * 4),
+                texelFetch(shadowMatrices, index * 4 + 1),
+                texelFetch(shadowMatrices, index * 4 + 2),
+                texelFetch(shadowMatrices, index * 4 + 3));
+}
+
+// 1 lit, 0 shadowed. The comparison samplers filter 2x2 texels in hardware
+float cascadeShadow(vec3 position, float viewDepth)
+{
+    int cascade = int(dot(vec4(greaterThanEqual(vec4(viewDepth), cascadeEnds)), vec4(1.0)));
+    if (cascade >= CASCADE_COUNT) return 1.0;
+
+    vec4 p = shadowMatrix(SHADOW_TILE_COUNT + cascade) * vec4(position, 1.0);
+    return texture(cascadeShadowMap, vec4(p.xy, float(cascade), p.z));
+}
+
+float pointShadow(vec3 position, vec3 lightPosition, float slot)
+{
+    // same face order as ShadowLayout::cubeFace
+    vec3 d = position - lightPosition;
+    vec3 a = abs(d);
+    int face;
+    if (a.x >= a.y && a.x >= a.z) face = d.x >= 0.0 ? 0 : 1;
+    else if (a.y >= a.z)          face = d.y >= 0.0 ? 2 : 3;
+    else                          face = d.z >= 0.0 ? 4 : 5;
+
+    vec4 p = shadowMatrix(int(slot) * 6 + face) * vec4(position, 1.0);
+    return texture(pointShadowAtlas, p.xyz / p.w);
+}
+
 
 void main()
 {		
     vec3 albedo     = pow(texture(albedoMap, TexCoords).rgb, vec3(2.2)) * albedoFactor.rgb;
     float metallic  = metallicFactor;
     float roughness = roughnessFactor;
-    vec3 emissive   = emissiveFactor;
+    vec3 emissive   = emissiveFactor.rgb;
 
     vec3 N = Normal;
     // If this is a back-face on a double-sided material, flip the normal
@@ -76,36 +157,43 @@ void main()
     // Reflectance equation
     vec3 Lo = vec3(0.0);
     
-    // For now, a single point light
-    vec3 L = normalize(lightPos - FragPos);
-    vec3 H = normalize(V + L);
-    float distance    = length(lightPos - FragPos);
-    float attenuation = 1.0 / (distance * distance);
-    vec3 radiance     = lightColor * attenuation;
-        
-    // Cook-Torrance BRDF
-    float NDF = DistributionGGX(N, H, roughness);        
-    float G   = GeometrySmith(N, V, L, roughness);      
-    vec3 F    = fresnelSchlick(max(dot(H, V), 0.0), F0);       
-    
-    vec3 kS = F;
-    vec3 kD = vec3(1.0) - kS;
-    kD *= 1.0 - metallic;	  
-        
-    vec3 numerator    = NDF * G * F;
-    float denominator = 4.0 * max(dot(N, V), 0.0) * max(dot(N, L), 0.0) + 0.0001; 
-    vec3 specular     = numerator / denominator;
-        
-    float NdotL = max(dot(N, L), 0.0);        
-    Lo += (kD * albedo / PI + specular) * radiance * NdotL;
+    // Only the lights listed for this fragment's cluster
+    float viewDepth = -(view * vec4(FragPos, 1.0)).z;
+    uint slice = uint(clamp(log(viewDepth) * clusterParams.z - clusterParams.w, 0.0, float(CLUSTER_SLICES - 1u)));
+    uvec2 tile = min(uvec2(gl_FragCoord.xy * clusterParams.xy), uvec2(CLUSTER_TILES_X - 1u, CLUSTER_TILES_Y - 1u));
+    uvec2 cluster = texelFetch(lightClusters, int(tile.x + CLUSTER_TILES_X * (tile.y + CLUSTER_TILES_Y * slice))).xy;
+
+    // pushed off the surface along the normal, which hides acne at grazing angles
+    vec3 shadowPos = FragPos + N * 0.02;
+
+    vec3 sunL = -normalize(sunDirection);
+    float sunShadow = shadowsEnabled ? cascadeShadow(shadowPos, viewDepth) : 1.0;
+    Lo += BRDF(N, V, sunL, albedo, F0, metallic, roughness) * sunColor * sunShadow;
+
+    for (uint i = 0u; i < cluster.y; i++) {
+        int light = int(texelFetch(lightIndices, int(cluster.x + i)).r);
+        vec4 positionRange = texelFetch(lightData, light * 2);
+        vec4 colorSlot     = texelFetch(lightData, light * 2 + 1);
+
+        vec3 L = normalize(positionRange.xyz - FragPos);
+        float distance    = length(positionRange.xyz - FragPos);
+
+        // inverse square, windowed to reach zero at the light's range so clustering cuts nothing visible
+        float falloff     = clamp(1.0 - pow(distance / positionRange.w, 4.0), 0.0, 1.0);
+        float attenuation = falloff * falloff / max(distance * distance, 0.0001);
+        vec3 radiance     = colorSlot.rgb * attenuation;
+
+        if (shadowsEnabled && colorSlot.w >= 0.0) {
+            radiance *= pointShadow(shadowPos, positionRange.xyz, colorSlot.w);
+        }
+
+        Lo += BRDF(N, V, L, albedo, F0, metallic, roughness) * radiance;
+    }
 
     // Add emissive and ambient light
     vec3 ambient = vec3(0.03) * albedo;
     vec3 color = ambient + Lo + emissive;
-	
-    // HDR tone mapping
-    color = color / (color + vec3(1.0));
-    color = pow(color, vec3(1.0/2.2));  
-   
+
+    // Linear HDR out, exposure, tonemapping and gamma happen once in the post-process graph
     FragColor = vec4(color, 1.0);
 }
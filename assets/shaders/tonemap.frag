@@ -0,0 +1,32 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D sceneTexture;
+uniform sampler2D bloomTexture;
+uniform float exposure;
+uniform float bloomStrength;    // 0 when bloom is off, the bloom texture is not bound then
+
+void main()
+{
+    const float gamma = 2.2;
+    // 1. Sample the linear HDR color, the scene pass no longer tonemaps
+    vec3 hdrColor = texture(sceneTexture, TexCoords).rgb;
+
+    // 2. Mix in the bloom chain
+    if (bloomStrength > 0.0)
+    {
+        vec3 bloom = texture(bloomTexture, TexCoords).rgb;
+        hdrColor = mix(hdrColor, bloom, bloomStrength);
+    }
+
+    // 3. Apply exposure control
+    vec3 mapped = vec3(1.0) - exp(-hdrColor * exposure);
+
+    // 4. Apply gamma correction
+    mapped = pow(mapped, vec3(1.0 / gamma));
+
+    // luma in alpha so FXAA does not have to compute it per tap
+    FragColor = vec4(mapped, dot(mapped, vec3(0.299, 0.587, 0.114)));
+}
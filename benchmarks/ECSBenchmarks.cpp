@@ -0,0 +1,180 @@
+#include <benchmark/benchmark.h>
+#include "Coordinator.hpp"
+#include "ComponentManager.hpp"
+#include "Types.hpp"
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <utility>
+#include <vector>
+
+// Small components so the benchmarks measure the ECS bookkeeping, not the payload copies
+template<int N>
+struct BenchComponent {
+    float value = 1.0f;
+};
+
+class BenchSystem : public System {
+public:
+    void onEntityAdded(Entity entity) override {}
+    void onEntityRemoved(Entity entity) override {}
+};
+
+namespace {
+
+    // Entity counts stay below MAX_ENTITIES
+    constexpr int MIN_ENTITIES = 64;
+    constexpr int MAX_BENCH_ENTITIES = 4096;
+
+    std::vector<Entity> shuffledEntities(std::vector<Entity> entities) {
+        std::mt19937 rng(1234);
+        std::shuffle(entities.begin(), entities.end(), rng);
+        return entities;
+    }
+
+    template<std::size_t... I>
+    void registerBenchComponents(Coordinator& coordinator, std::index_sequence<I...>) {
+        (coordinator.registerComponent<BenchComponent<I>>(), ...);
+    }
+
+    template<std::size_t... I>
+    void addBenchComponents(Coordinator& coordinator, Entity entity, std::index_sequence<I...>) {
+        (coordinator.addComponent(entity, BenchComponent<I>{}), ...);
+    }
+
+    template<std::size_t... I>
+    Signature benchSignature(Coordinator& coordinator, std::index_sequence<I...>) {
+        Signature signature;
+        (signature.set(coordinator.getComponentTypeID<BenchComponent<I>>()), ...);
+        return signature;
+    }
+
+    template<std::size_t... I>
+    float sumBenchComponents(Coordinator& coordinator, Entity entity, std::index_sequence<I...>) {
+        return (coordinator.getComponent<BenchComponent<I>>(entity).value + ...);
+    }
+}
+
+static void BM_EntityCreateDestroyChurn(benchmark::State& state) {
+    Coordinator coordinator;
+    const int count = static_cast<int>(state.range(0));
+    std::vector<Entity> entities(count);
+
+    for (auto _ : state) {
+        for (int i = 0; i < count; ++i) {
+            entities[i] = coordinator.createEntity();
+        }
+        for (int i = 0; i < count; ++i) {
+            coordinator.removeEntity(entities[i]);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_EntityCreateDestroyChurn)->RangeMultiplier(4)->Range(MIN_ENTITIES, MAX_BENCH_ENTITIES);
+
+// Adding the second component moves the entity into the system, removing it moves it back out
+static void BM_AddRemoveComponentWithSystem(benchmark::State& state) {
+    Coordinator coordinator;
+    coordinator.registerComponent<BenchComponent<0>>();
+    coordinator.registerComponent<BenchComponent<1>>();
+    coordinator.registerSystem<BenchSystem>(benchSignature(coordinator, std::index_sequence<0, 1>{}));
+
+    const int count = static_cast<int>(state.range(0));
+    std::vector<Entity> entities(count);
+    for (int i = 0; i < count; ++i) {
+        entities[i] = coordinator.createEntity();
+    }
+
+    for (auto _ : state) {
+        for (Entity entity : entities) {
+            coordinator.addComponent(entity, BenchComponent<0>{});
+            coordinator.addComponent(entity, BenchComponent<1>{});
+        }
+        for (Entity entity : entities) {
+            coordinator.removeComponent<BenchComponent<1>>(entity);
+            coordinator.removeComponent<BenchComponent<0>>(entity);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count * 4);
+}
+BENCHMARK(BM_AddRemoveComponentWithSystem)->RangeMultiplier(4)->Range(MIN_ENTITIES, MAX_BENCH_ENTITIES);
+
+static void BM_GetComponentRandomAccess(benchmark::State& state) {
+    Coordinator coordinator;
+    coordinator.registerComponent<BenchComponent<0>>();
+
+    const int count = static_cast<int>(state.range(0));
+    std::vector<Entity> entities(count);
+    for (int i = 0; i < count; ++i) {
+        entities[i] = coordinator.createEntity();
+        coordinator.addComponent(entities[i], BenchComponent<0>{static_cast<float>(i)});
+    }
+    std::vector<Entity> order = shuffledEntities(entities);
+
+    for (auto _ : state) {
+        float sum = 0.0f;
+        for (Entity entity : order) {
+            sum += coordinator.getComponent<BenchComponent<0>>(entity).value;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_GetComponentRandomAccess)->RangeMultiplier(4)->Range(MIN_ENTITIES, MAX_BENCH_ENTITIES);
+
+// Every entity owns all six components, the system signature selects the first K of them
+template<std::size_t K>
+static void BM_SystemIteration(benchmark::State& state) {
+    Coordinator coordinator;
+    registerBenchComponents(coordinator, std::make_index_sequence<6>{});
+    coordinator.registerSystem<BenchSystem>(benchSignature(coordinator, std::make_index_sequence<K>{}));
+    auto system = coordinator.getSystem<BenchSystem>();
+
+    const int count = static_cast<int>(state.range(0));
+    for (int i = 0; i < count; ++i) {
+        Entity entity = coordinator.createEntity();
+        addBenchComponents(coordinator, entity, std::make_index_sequence<6>{});
+    }
+
+    for (auto _ : state) {
+        float sum = 0.0f;
+        for (Entity entity : system->entitySet) {
+            sum += sumBenchComponents(coordinator, entity, std::make_index_sequence<K>{});
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+    state.counters["components"] = static_cast<double>(K);
+}
+BENCHMARK_TEMPLATE(BM_SystemIteration, 1)->RangeMultiplier(4)->Range(MIN_ENTITIES, MAX_BENCH_ENTITIES);
+BENCHMARK_TEMPLATE(BM_SystemIteration, 2)->RangeMultiplier(4)->Range(MIN_ENTITIES, MAX_BENCH_ENTITIES);
+BENCHMARK_TEMPLATE(BM_SystemIteration, 3)->RangeMultiplier(4)->Range(MIN_ENTITIES, MAX_BENCH_ENTITIES);
+BENCHMARK_TEMPLATE(BM_SystemIteration, 4)->RangeMultiplier(4)->Range(MIN_ENTITIES, MAX_BENCH_ENTITIES);
+BENCHMARK_TEMPLATE(BM_SystemIteration, 5)->RangeMultiplier(4)->Range(MIN_ENTITIES, MAX_BENCH_ENTITIES);
+BENCHMARK_TEMPLATE(BM_SystemIteration, 6)->RangeMultiplier(4)->Range(MIN_ENTITIES, MAX_BENCH_ENTITIES);
+
+// Removes every element in random order, each removal swaps the last element into the hole
+static void BM_ComponentArraySwapRemove(benchmark::State& state) {
+    const int count = static_cast<int>(state.range(0));
+    std::vector<Entity> entities(count);
+    std::iota(entities.begin(), entities.end(), 0);
+    std::vector<Entity> order = shuffledEntities(entities);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        ComponentArray<BenchComponent<0>> componentArray;
+        for (Entity entity : entities) {
+            componentArray.insertData(entity, BenchComponent<0>{});
+        }
+        state.ResumeTiming();
+
+        for (Entity entity : order) {
+            componentArray.removeData(entity);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_ComponentArraySwapRemove)->RangeMultiplier(4)->Range(MIN_ENTITIES, MAX_BENCH_ENTITIES);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,192 @@
+#include <benchmark/benchmark.h>
+#include "Bounds.hpp"
+#include "DynamicBVH.hpp"
+#include "LightClusters.hpp"
+#include "TransformHierarchy.hpp"
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace {
+
+    constexpr int MIN_OBJECTS = 1024;
+    constexpr int MAX_OBJECTS = 100000;
+
+    // Objects scattered through a 1km cube, the camera sees roughly a tenth of them
+    std::vector<AABB> sceneBoxes(std::size_t count) {
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+        std::uniform_real_distribution<float> size(0.5f, 4.0f);
+
+        std::vector<AABB> boxes(count);
+        for (auto& box : boxes) {
+            glm::vec3 center(position(rng), position(rng), position(rng));
+            box.min = center - glm::vec3(size(rng));
+            box.max = center + glm::vec3(size(rng));
+        }
+        return boxes;
+    }
+
+    Frustum sceneFrustum() {
+        glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+        glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        return Frustum::fromMatrix(projection * view);
+    }
+}
+
+// One scalar frustum test per object, what culling without a hierarchy costs
+static void BM_FrustumCullScalar(benchmark::State& state) {
+    std::vector<AABB> boxes = sceneBoxes(state.range(0));
+    Frustum frustum = sceneFrustum();
+
+    for (auto _ : state) {
+        std::size_t visible = 0;
+        for (auto const& box : boxes) {
+            visible += frustum.intersects(box) ? 1 : 0;
+        }
+        benchmark::DoNotOptimize(visible);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FrustumCullScalar)->RangeMultiplier(10)->Range(MIN_OBJECTS, MAX_OBJECTS)->Unit(benchmark::kMicrosecond);
+
+static void BM_FrustumCullBatch(benchmark::State& state) {
+    std::vector<AABB> boxes = sceneBoxes(state.range(0));
+    std::vector<std::uint8_t> visible(boxes.size());
+    Frustum frustum = sceneFrustum();
+
+    for (auto _ : state) {
+        frustum.testBatch(boxes.data(), boxes.size(), visible.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FrustumCullBatch)->RangeMultiplier(10)->Range(MIN_OBJECTS, MAX_OBJECTS)->Unit(benchmark::kMicrosecond);
+
+static void BM_BVHFrustumQuery(benchmark::State& state) {
+    std::vector<AABB> boxes = sceneBoxes(state.range(0));
+    Frustum frustum = sceneFrustum();
+
+    DynamicBVH bvh;
+    for (std::size_t i = 0; i < boxes.size(); ++i) {
+        bvh.createProxy(boxes[i], static_cast<std::uint32_t>(i));
+    }
+
+    std::vector<std::uint32_t> results;
+    for (auto _ : state) {
+        results.clear();
+        bvh.query(frustum, results);
+        benchmark::DoNotOptimize(results.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["visible"] = static_cast<double>(results.size());
+    state.counters["height"] = static_cast<double>(bvh.getHeight());
+}
+BENCHMARK(BM_BVHFrustumQuery)->RangeMultiplier(10)->Range(MIN_OBJECTS, MAX_OBJECTS)->Unit(benchmark::kMicrosecond);
+
+// A tenth of the scene moves every frame, half of those far enough to leave their fat boxes
+static void BM_BVHMoveProxies(benchmark::State& state) {
+    std::vector<AABB> boxes = sceneBoxes(state.range(0));
+
+    DynamicBVH bvh;
+    std::vector<std::int32_t> proxies;
+    for (std::size_t i = 0; i < boxes.size(); ++i) {
+        proxies.push_back(bvh.createProxy(boxes[i], static_cast<std::uint32_t>(i)));
+    }
+
+    float direction = 1.0f;
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < boxes.size(); i += 10) {
+            glm::vec3 offset(direction * ((i % 20 == 0) ? 0.5f : 0.01f));
+            boxes[i].min += offset;
+            boxes[i].max += offset;
+            bvh.moveProxy(proxies[i], boxes[i]);
+        }
+        direction = -direction;
+    }
+    state.SetItemsProcessed(state.iterations() * (state.range(0) / 10));
+}
+BENCHMARK(BM_BVHMoveProxies)->RangeMultiplier(10)->Range(MIN_OBJECTS, MAX_OBJECTS)->Unit(benchmark::kMicrosecond);
+
+// 100k nodes shaped like imported glTF scenes: 1000 roots, each a tree with a branching factor of 4
+TransformHierarchy sceneHierarchy(Entity nodeCount) {
+    TransformHierarchy hierarchy;
+    const Entity roots = 1000;
+    for (Entity entity = 0; entity < nodeCount; ++entity) {
+        Entity parent = entity < roots ? NULL_ENTITY : (entity - roots) / 4;
+        hierarchy.add(entity, parent);
+        hierarchy.setLocal(entity, glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+    }
+    hierarchy.update();
+    return hierarchy;
+}
+
+constexpr Entity HIERARCHY_NODES = 100000;
+
+// Every root moves, so all nodes are recomputed in one linear pass
+static void BM_HierarchyFullUpdate(benchmark::State& state) {
+    TransformHierarchy hierarchy = sceneHierarchy(HIERARCHY_NODES);
+    for (auto _ : state) {
+        for (Entity root = 0; root < 1000; ++root) hierarchy.markDirty(root);
+        hierarchy.update();
+        benchmark::DoNotOptimize(hierarchy.getUpdatedEntities().data());
+    }
+    state.SetItemsProcessed(state.iterations() * HIERARCHY_NODES);
+}
+BENCHMARK(BM_HierarchyFullUpdate)->Unit(benchmark::kMicrosecond);
+
+// One root in a hundred moves, only those subtrees are recomputed
+static void BM_HierarchyDirtySubtrees(benchmark::State& state) {
+    TransformHierarchy hierarchy = sceneHierarchy(HIERARCHY_NODES);
+    for (auto _ : state) {
+        for (Entity root = 0; root < 1000; root += 100) hierarchy.markDirty(root);
+        hierarchy.update();
+        benchmark::DoNotOptimize(hierarchy.getUpdatedEntities().data());
+    }
+    state.SetItemsProcessed(state.iterations() * HIERARCHY_NODES);
+}
+BENCHMARK(BM_HierarchyDirtySubtrees)->Unit(benchmark::kMicrosecond);
+
+// Nothing moved, update returns without touching the nodes
+static void BM_HierarchyStatic(benchmark::State& state) {
+    TransformHierarchy hierarchy = sceneHierarchy(HIERARCHY_NODES);
+    for (auto _ : state) {
+        hierarchy.update();
+        benchmark::DoNotOptimize(hierarchy.getUpdatedEntities().data());
+    }
+    state.SetItemsProcessed(state.iterations() * HIERARCHY_NODES);
+}
+BENCHMARK(BM_HierarchyStatic)->Unit(benchmark::kMicrosecond);
+
+// Lights spread over a 200m level around the camera with 2-10m ranges, roughly half in view
+static void BM_LightClusterAssign(benchmark::State& state) {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> height(0.0f, 10.0f);
+    std::uniform_real_distribution<float> range(2.0f, 10.0f);
+
+    std::vector<PointLight> lights(state.range(0));
+    for (auto& light : lights) {
+        light.position = glm::vec3(position(rng), height(rng), position(rng));
+        light.range = range(rng);
+        light.color = glm::vec3(1.0f);
+    }
+
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 200.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(1.0f, 2.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    LightClusterGrid grid;
+    grid.setProjection(projection);
+    for (auto _ : state) {
+        grid.assign(lights.data(), lights.size(), view);
+        benchmark::DoNotOptimize(grid.getLightIndices().data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["assigned"] = static_cast<double>(grid.getStats().assignedLights);
+    state.counters["indices"] = static_cast<double>(grid.getStats().indices);
+    state.counters["overflow"] = static_cast<double>(grid.getStats().overflow);
+}
+BENCHMARK(BM_LightClusterAssign)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -31,6 +31,12 @@ test() {
     ctest --test-dir build --output-on-failure
 }
 
+# Runs the benchmark suites and stores the JSON results in build/bench_output.json.
+bench() {
+    echo "--- Building and Running Benchmarks ---"
+    cmake --build build --target run_benchmarks
+}
+
 # Deletes the build directory for a clean start.
 clean() {
     echo "--- Cleaning Build Directory ---"
@@ -39,11 +45,12 @@ clean() {
 
 # Prints the help message.
 usage() {
-    echo "Usage: $0 {configure|build|run|test|clean}"
+    echo "Usage: $0 {configure|build|run|test|bench|clean}"
     echo "  configure: Sets up the build directory for the first time."
     echo "  build: Compiles the project."
     echo "  run: Builds and runs the main executable."
     echo "  test: Builds and runs the unit tests."
+    echo "  bench: Builds and runs the benchmarks, writing JSON results."
     echo "  clean: Deletes the build directory."
 }
 
@@ -70,6 +77,9 @@ case "$1" in
     test)
         test
         ;;
+    bench)
+        bench
+        ;;
     clean)
         clean
         ;;
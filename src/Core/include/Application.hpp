@@ -7,7 +7,11 @@
 #include "PhysicsSystem.hpp"
 #include "InputSystem.hpp"
 #include "PlayerControlSystem.hpp"
+#include "TransformSystem.hpp"
+#include "LightSystem.hpp"
+#include <functional>
 #include <memory>
+#include <string>
 #include <glm/glm.hpp>
 
 struct GLFWwindow;
@@ -20,6 +24,12 @@ public:
 
 private:
     void init();
+    //framebuffer size changes arrive through GLFW and are applied at the start of the next frame
+    static void onFramebufferResize(GLFWwindow* window, int width, int height);
+    glm::mat4 cameraProjection() const;
+    //a baked pack in assets/baked/<name>.pack loads right away, otherwise the glTF is loaded in the
+    //background and the returned handle tracks it. onLoaded runs once the entities exist either way
+    std::shared_ptr<SceneLoad> loadScene(const std::string& name, const std::string& gltfPath, std::function<void(Scene&)> onLoaded);
 
     GLFWwindow* window;
     std::unique_ptr<Coordinator> coordinator;
@@ -30,14 +40,26 @@ private:
     std::shared_ptr<PhysicsSystem> physicsSystem;
     std::shared_ptr<InputSystem> inputSystem;
     std::shared_ptr<PlayerControlSystem> playerControlSystem;
+    std::shared_ptr<TransformSystem> transformSystem;
+    std::shared_ptr<LightSystem> lightSystem;
     
+    //the scene with the ground, physics waits for it. Null when it came from a baked pack
+    std::shared_ptr<SceneLoad> levelLoad;
+
     Entity cameraEntity;
     Entity cubeEntity;
     Entity groundEntity;
 
-    glm::vec3 lightPos;
-    glm::vec3 lightColor;
+    //per frame, on the render thread, for the GL side of background loads
+    static constexpr double UPLOAD_BUDGET_MS = 2.0;
+    //video memory every streamed texture shares, the smallest mips stay resident regardless
+    static constexpr std::size_t TEXTURE_BUDGET_MB = 256;
 
     float deltaTime = 0.0f;
     float lastFrame = 0.0f;
+
+    //in framebuffer pixels, which differ from window coordinates on high DPI screens
+    int windowWidth = 1280;
+    int windowHeight = 720;
+    bool framebufferResized = false;
 };
\ No newline at end of file
@@ -3,7 +3,15 @@
 #include "Shader.hpp"
 #include "Mesh.hpp"
 #include "Texture.hpp"
+#include "TextureStreamer.hpp"
+#include "MaterialBuffer.hpp"
+#include "GeometryArena.hpp"
 #include "Types.hpp" 
+#include "JobSystem.hpp"
+#include "UploadQueue.hpp"
+#include <atomic>
+#include <functional>
+#include <future>
 #include <map>
 #include <string>
 #include <memory>
@@ -13,7 +21,50 @@ using Scene = std::map<std::string, Entity>;
 
 class Coordinator;
 
+enum class LoadStatus { LOADING, READY, FAILED };
+
+// Handle to a scene loading in the background. Parsing, image decoding and mesh processing run on
+// the AssetManager's workers, GL uploads and entity spawning through AssetManager::update, so the
+// scene only exists, and onLoaded only runs, on the render thread
+class SceneLoad {
+
+    public:
+
+        LoadStatus getStatus() const { return status; }
+        bool isDone() const { return status != LoadStatus::LOADING; }
+        //nullptr until the status is READY
+        Scene* getScene() const { return scene; }
+        //set once the status is FAILED
+        const std::string& getError() const { return error; }
+
+    private:
+
+        friend class AssetManager;
+
+        enum class Stage { PARSING, MATERIALS, PROCESSING, UPLOADING };
+
+        std::string sceneName;
+        Coordinator* coordinator = nullptr;
+        std::function<void(Scene&)> onLoaded;
+
+        Stage stage = Stage::PARSING;
+        std::atomic<LoadStatus> status{LoadStatus::LOADING};
+        std::string error;
+        Scene* scene = nullptr;
+
+        //shared with the jobs reading it, released once the scene is spawned
+        std::shared_ptr<tinygltf::Model> model;
+        //every texture's mip chain, built by the parse job, indexed like the model's textures
+        std::shared_ptr<std::vector<std::vector<TextureLevel>>> textureLevels;
+        std::future<std::string> parseJob;
+        MaterialID firstMaterial = 0;
+        std::vector<std::future<MeshData>> meshJobs;
+        //the jobs' results, taken on the render thread so a failed job fails the load
+        std::vector<MeshData> meshData;
+};
+
 struct Material {
+    std::string name;
     std::shared_ptr<Texture> albedoMap;
     glm::vec4 albedoFactor = glm::vec4(1.0f);
     float metallicFactor = 1.0f;
@@ -29,19 +80,73 @@ class AssetManager {
         std::map<std::string, std::shared_ptr<Shader>> shaders;
         std::map<std::string, std::shared_ptr<Mesh>> meshes;
         std::map<std::string, std::shared_ptr<Texture>> textures;
-        std::map<std::string, std::shared_ptr<Material>> materials;
+        std::map<std::string, MaterialID> materialIDs;
+
+        //index 0 is always the default material
+        std::vector<std::shared_ptr<Material>> materials;
+        std::unique_ptr<MaterialBuffer> materialBuffer;
+
+        //every mesh is suballocated from here, meshes keep it alive while they exist
+        std::shared_ptr<GeometryArena> geometryArena;
+
+        MeshImportOptions meshOptions;
+
+        //every texture streams, only its smallest mips are resident until something draws it
+        TextureStreamer textureStreamer;
+
+        //returns the MaterialID given to the model's first material
+        MaterialID processMaterials(const tinygltf::Model& model);
+        //the texture streams from levels, built from its image beforehand
+        void createTexture(const tinygltf::Model& model, const tinygltf::Texture& texture, std::vector<TextureLevel> levels);
+        MaterialID createMaterials(const tinygltf::Model& model);
+        void spawnScene(const tinygltf::Model& model, Scene& scene, Coordinator& coordinator);
 
-        void processMaterials(const tinygltf::Model& model);
+        //moves a background load on as far as its jobs allow, queueing whatever needs the GL context
+        void advanceLoad(const std::shared_ptr<SceneLoad>& load);
+
+        //spawns the node and its children, every node gets an entity so the hierarchy stays intact
+        void spawnNode(const tinygltf::Model& model, int nodeIndex, Entity parent, Scene& scene, Coordinator& coordinator);
+        void uploadMaterials();
+
+        std::vector<std::shared_ptr<SceneLoad>> pendingLoads;
+        UploadQueue uploads;
+        //last, so the workers are joined before anything their jobs could still reach is destroyed
+        std::unique_ptr<JobSystem> jobs;
 
     public:
 
+        //PACKED halves vertex size, FULL keeps float vertices for debugging precision issues
+        AssetManager(VertexFormat vertexFormat = VertexFormat::PACKED, const MeshImportOptions& meshOptions = {});
+
+        //loads on the calling thread, blocking until the scene's entities exist
         Scene& loadScene(const std::string& sceneName, const std::string& path, Coordinator& coordinator);
+        //returns at once, the scene appears during later update calls and onLoaded runs right after
+        std::shared_ptr<SceneLoad> loadSceneAsync(const std::string& sceneName, const std::string& path, Coordinator& coordinator,
+                                                  std::function<void(Scene&)> onLoaded = {});
+        //a pack written by AssetBaker: memory mapped and uploaded straight from the mapping, which stays
+        //mapped while its textures stream. Throws if the pack was baked for another vertex format
+        Scene& loadPack(const std::string& sceneName, const std::string& path, Coordinator& coordinator);
+        //call once per frame on the render thread, spends at most about budgetMilliseconds on uploads
+        void update(double budgetMilliseconds);
+        bool isLoading() const { return !pendingLoads.empty() || !uploads.empty(); }
+
+        //materialScreenSizes holds, by MaterialID, how many pixels across the largest draw using that
+        //material covered this frame, 0 when nothing drew it. Their textures stream towards that
+        void requestTextures(const std::vector<float>& materialScreenSizes);
+        TextureStreamer& getTextureStreamer() { return textureStreamer; }
+        const TextureStreamer& getTextureStreamer() const { return textureStreamer; }
+
         std::shared_ptr<Shader> loadShader(const std::string& name, const std::string& vertPath, const std::string& fragPath);
 
         std::shared_ptr<Shader> getShader(const std::string& name);
         std::shared_ptr<Mesh> getMesh(const std::string& name);
         std::shared_ptr<Texture> getTexture(const std::string& name);
         std::shared_ptr<Material> getMaterial(const std::string& name);
+        const Material& getMaterial(MaterialID id) const { return *materials[id < materials.size() ? id : 0]; }
+        std::size_t getMaterialCount() const { return materials.size(); }
+        MaterialID getMaterialID(const std::string& name) const;
+        const MaterialBuffer& getMaterialBuffer() const { return *materialBuffer; }
+        const GeometryArena& getGeometryArena() const { return *geometryArena; }
         Scene* getScene(const std::string& sceneName);
         Entity getEntityFromScene(const std::string& sceneName, const std::string& entityName);
 
@@ -0,0 +1,234 @@
+#pragma once
+
+#include "Vertex.hpp"
+#include "MeshLOD.hpp"
+#include "GeometryArena.hpp"
+#include "TextureCompression.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Baked scene pack, written offline by AssetBaker and memory mapped at runtime. Every record is
+// plain data at a fixed offset, vertices are already in the arena's format and indices in the
+// width the arena will store, so loading is a few pointer casts and GL uploads straight from the
+// mapping. Offsets are from the start of the file and every block is 16-byte aligned.
+namespace AssetPack {
+
+    constexpr char MAGIC[4] = {'S', 'P', 'A', 'K'};
+    //bump on any layout change, old packs are rejected and must be baked again
+    constexpr std::uint32_t VERSION = 2;
+    constexpr std::uint32_t NONE = 0xFFFFFFFFu;
+
+    //a run of bytes in the string block, not null terminated
+    struct String {
+        std::uint32_t offset = 0;
+        std::uint32_t length = 0;
+    };
+
+    struct Header {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t vertexFormat;
+        std::uint32_t meshCount;
+        std::uint32_t textureCount;
+        std::uint32_t materialCount;
+        std::uint32_t nodeCount;
+        std::uint32_t padding;
+        std::uint64_t meshes;
+        std::uint64_t textures;
+        std::uint64_t materials;
+        std::uint64_t nodes;
+        std::uint64_t strings;
+        std::uint64_t fileSize;
+    };
+
+    struct MeshRecord {
+        String name;
+        std::uint32_t vertexCount;
+        std::uint32_t indexCount;
+        std::uint32_t indexType;
+        std::uint32_t quantized;
+        std::uint32_t subMeshCount;
+        std::uint32_t lodCount;
+        float boundsMin[3];
+        float boundsMax[3];
+        float positionTransform[16];
+        std::uint64_t vertices;
+        std::uint64_t indices;
+        std::uint64_t subMeshes;
+        std::uint64_t lods;
+    };
+
+    //material is the pack's own material index or NONE for the default material
+    struct SubMeshRecord {
+        std::uint32_t material;
+        std::uint32_t indexCount;
+        std::uint32_t indexOffset;
+        std::int32_t baseVertex;
+    };
+
+    //a baked mip chain, levels points at levelCount LevelRecords, largest first. components is
+    //what the source image had, format what the levels are stored and uploaded as
+    //TextureRecord::flags, the texture stores grey in red and is swizzled back to RGB
+    constexpr std::uint32_t TEXTURE_GREY = 1u << 0;
+
+    struct TextureRecord {
+        String name;
+        std::uint32_t width;
+        std::uint32_t height;
+        //channels stored, after the ones no texel uses were left out
+        std::uint32_t components;
+        std::uint32_t format;
+        std::uint32_t levelCount;
+        std::uint32_t flags;
+        std::uint64_t levels;
+    };
+
+    struct LevelRecord {
+        std::uint64_t data;
+        std::uint64_t size;
+        std::uint32_t width;
+        std::uint32_t height;
+    };
+
+    struct MaterialRecord {
+        String name;
+        //the pack's texture index or NONE
+        std::uint32_t albedoTexture = NONE;
+        std::uint32_t doubleSided = 0;
+        float albedoFactor[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+        float emissiveFactor[3] = {0.0f, 0.0f, 0.0f};
+        float metallicFactor = 1.0f;
+        float roughnessFactor = 1.0f;
+    };
+
+    //nodes are stored parents first, so spawning them in order keeps the hierarchy valid
+    struct NodeRecord {
+        String name;
+        std::uint32_t parent = NONE;
+        std::uint32_t mesh = NONE;
+        float position[3] = {0.0f, 0.0f, 0.0f};
+        float rotation[4] = {0.0f, 0.0f, 0.0f, 1.0f}; //x, y, z, w
+        float scale[3] = {1.0f, 1.0f, 1.0f};
+    };
+
+    static_assert(sizeof(Header) == 80, "AssetPack::Header layout changed, bump VERSION");
+    static_assert(sizeof(MeshRecord) == 152, "AssetPack::MeshRecord layout changed, bump VERSION");
+    static_assert(sizeof(SubMeshRecord) == 16, "AssetPack::SubMeshRecord layout changed, bump VERSION");
+    static_assert(sizeof(TextureRecord) == 40, "AssetPack::TextureRecord layout changed, bump VERSION");
+    static_assert(sizeof(LevelRecord) == 24, "AssetPack::LevelRecord layout changed, bump VERSION");
+    static_assert(sizeof(MeshLOD) == 8, "MeshLOD is stored as is, bump VERSION if it changes");
+}
+
+// Read only view of a whole file, unmapped when destroyed
+class MappedFile {
+
+    public:
+
+        //throws std::runtime_error when the file cannot be opened or mapped
+        explicit MappedFile(const std::string& path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const std::uint8_t* data() const { return bytes; }
+        std::size_t size() const { return length; }
+
+    private:
+
+        const std::uint8_t* bytes = nullptr;
+        std::size_t length = 0;
+#if defined(_WIN32)
+        void* file = nullptr;
+        void* mapping = nullptr;
+#endif
+};
+
+// Validates a pack once on open, after that every accessor points straight into the mapping
+class AssetPackReader {
+
+    public:
+
+        //throws std::runtime_error on a wrong magic, version, any record reaching past the file or
+        //submesh and LOD ranges that do not fit their mesh
+        explicit AssetPackReader(const std::string& path);
+
+        const AssetPack::Header& getHeader() const { return *header; }
+        VertexFormat getVertexFormat() const { return static_cast<VertexFormat>(header->vertexFormat); }
+
+        const AssetPack::MeshRecord& getMesh(std::uint32_t i) const { return record<AssetPack::MeshRecord>(header->meshes)[i]; }
+        const AssetPack::TextureRecord& getTexture(std::uint32_t i) const { return record<AssetPack::TextureRecord>(header->textures)[i]; }
+        const AssetPack::MaterialRecord& getMaterial(std::uint32_t i) const { return record<AssetPack::MaterialRecord>(header->materials)[i]; }
+        const AssetPack::NodeRecord& getNode(std::uint32_t i) const { return record<AssetPack::NodeRecord>(header->nodes)[i]; }
+
+        const void* getVertices(const AssetPack::MeshRecord& mesh) const { return file.data() + mesh.vertices; }
+        const void* getIndices(const AssetPack::MeshRecord& mesh) const { return file.data() + mesh.indices; }
+        const AssetPack::SubMeshRecord* getSubMeshes(const AssetPack::MeshRecord& mesh) const { return record<AssetPack::SubMeshRecord>(mesh.subMeshes); }
+        const MeshLOD* getLODs(const AssetPack::MeshRecord& mesh) const { return record<MeshLOD>(mesh.lods); }
+        const AssetPack::LevelRecord* getLevels(const AssetPack::TextureRecord& texture) const { return record<AssetPack::LevelRecord>(texture.levels); }
+        const std::uint8_t* getLevelData(const AssetPack::LevelRecord& level) const { return file.data() + level.data; }
+        std::string_view getString(const AssetPack::String& string) const;
+
+    private:
+
+        template <typename T>
+        const T* record(std::uint64_t offset) const { return reinterpret_cast<const T*>(file.data() + offset); }
+
+        //throws unless [offset, offset + bytes) lies inside the file
+        void expect(std::uint64_t offset, std::uint64_t bytes, const char* what) const;
+        [[noreturn]] void corrupt(const char* what) const;
+        void validate() const;
+
+        MappedFile file;
+        const AssetPack::Header* header = nullptr;
+};
+
+// Collects a scene and writes it in one go, laid out the way AssetPackReader maps it
+class AssetPackWriter {
+
+    public:
+
+        explicit AssetPackWriter(VertexFormat vertexFormat);
+
+        //vertices are encoded for the pack's vertex format here, indices are relative to the mesh's
+        //vertices as SubMesh offsets are before the arena adds its range
+        std::uint32_t addMesh(const std::string& name, const std::vector<Vertex>& vertices, const std::vector<std::uint32_t>& indices,
+                              const std::vector<AssetPack::SubMeshRecord>& subMeshes, const std::vector<MeshLOD>& lods);
+        //builds the whole mip chain, drops the channels TextureCompression::findChannels finds unused
+        //and compresses it with the format chooseFormat picks, compress false keeps raw levels. srgb
+        //filters the mips in linear space, for color data
+        std::uint32_t addTexture(const std::string& name, const std::uint8_t* pixels, std::uint32_t width, std::uint32_t height,
+                                 std::uint32_t components, bool srgb, bool compress);
+        //the name argument replaces whatever material.name holds
+        std::uint32_t addMaterial(const std::string& name, AssetPack::MaterialRecord material);
+        std::uint32_t addNode(const std::string& name, AssetPack::NodeRecord node);
+
+        //returns false when the file cannot be written
+        bool write(const std::string& path) const;
+
+    private:
+
+        AssetPack::String addString(const std::string& string);
+
+        struct PendingMesh {
+            AssetPack::MeshRecord record;
+            std::vector<std::uint8_t> vertices;
+            std::vector<std::uint8_t> indices;
+            std::vector<AssetPack::SubMeshRecord> subMeshes;
+            std::vector<MeshLOD> lods;
+        };
+        struct PendingTexture {
+            AssetPack::TextureRecord record;
+            std::vector<TextureLevel> levels;
+        };
+
+        VertexFormat vertexFormat;
+        std::vector<PendingMesh> meshes;
+        std::vector<PendingTexture> textures;
+        std::vector<AssetPack::MaterialRecord> materials;
+        std::vector<AssetPack::NodeRecord> nodes;
+        std::string strings;
+};
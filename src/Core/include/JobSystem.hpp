@@ -0,0 +1,51 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// A fixed pool of worker threads running jobs in submission order. Jobs must not touch GL or
+// the ECS, anything that does goes through the render thread's UploadQueue instead
+class JobSystem {
+
+    public:
+
+        //0 uses every hardware thread but the one left to the main thread
+        explicit JobSystem(std::size_t threadCount = 0);
+        //jobs already running finish, queued ones are dropped and their futures report broken_promise
+        ~JobSystem();
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        //the future holds the job's result, or rethrows what it threw
+        template <typename F>
+        std::future<std::invoke_result_t<std::decay_t<F>>> submit(F&& job) {
+            using Result = std::invoke_result_t<std::decay_t<F>>;
+            //std::function needs something copyable, a packaged_task is move only
+            auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(job));
+            std::future<Result> result = task->get_future();
+            enqueue([task]() { (*task)(); });
+            return result;
+        }
+
+        std::size_t getThreadCount() const { return workers.size(); }
+
+    private:
+
+        void enqueue(std::function<void()> job);
+        void workerLoop();
+
+        std::vector<std::thread> workers;
+        std::deque<std::function<void()>> queue;
+        std::mutex mutex;
+        std::condition_variable wake;
+        bool stopping = false;
+};
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Zone names are stored by pointer, so they must outlive the profiler (string literals, or
+// names built at runtime and passed through Profiler::intern).
+struct ProfileEvent {
+    const char* name = nullptr;
+    std::uint64_t startNs = 0;
+    std::uint64_t endNs = 0;
+    std::uint32_t threadID = 0;
+    std::uint32_t depth = 0;
+};
+
+struct ZoneSummary {
+    std::string name;
+    std::size_t sampleCount = 0;
+    double p50Ms = 0.0;
+    double p95Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+};
+
+class Profiler {
+
+    public:
+
+        static constexpr std::size_t RING_CAPACITY = 1 << 16;
+        static constexpr std::size_t SUMMARY_WINDOW = 512;
+
+        static Profiler& get();
+
+        //monotonic timestamp in nanoseconds, shared by every zone so traces line up across threads
+        static std::uint64_t now();
+
+        //called by ProfileScope, only touches the calling thread's ring buffer
+        void record(const char* name, std::uint64_t startNs, std::uint64_t endNs, std::uint32_t depth);
+
+        //GPU zones resolved by GpuProfiler go to their own track, timestamps already converted to now() time
+        void recordGpu(const char* name, std::uint64_t startNs, std::uint64_t endNs, std::uint32_t depth);
+
+        //drains every ring into the rolling per-zone windows, call once per frame from the main thread
+        void endFrame();
+
+        std::vector<ZoneSummary> getSummary() const;
+        void printSummary(std::ostream& out) const;
+        bool exportChromeTrace(const std::string& path) const;
+
+        //drops all recorded events and statistics, mostly useful for tests
+        void reset();
+
+        //a copy of name that lives as long as the profiler, the same pointer for equal names
+        const char* intern(const std::string& name);
+
+        std::uint64_t getFrameIndex() const { return frameIndex; }
+
+    private:
+
+        struct ThreadBuffer {
+            std::uint32_t threadID = 0;
+            std::string trackName;
+            std::vector<ProfileEvent> ring;
+            std::atomic<std::uint64_t> writeIndex{0};
+            std::uint64_t drainIndex = 0;
+        };
+
+        struct ZoneWindow {
+            std::vector<std::uint64_t> durationsNs;
+            std::size_t next = 0;
+        };
+
+        Profiler() = default;
+        ThreadBuffer& getThreadBuffer();
+        ThreadBuffer& registerBuffer(const std::string& trackName);
+        void writeEvent(ThreadBuffer& buffer, const char* name, std::uint64_t startNs, std::uint64_t endNs, std::uint32_t depth);
+
+        mutable std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> threadBuffers;
+        ThreadBuffer* gpuBuffer = nullptr;
+        std::unordered_map<std::string, ZoneWindow> zoneWindows;
+        std::unordered_map<const char*, ZoneWindow*> windowLookup;
+        //never cleared, not even by reset, events may still point into it
+        std::unordered_set<std::string> internedNames;
+        std::uint64_t frameIndex = 0;
+        std::uint64_t lastFrameNs = 0;
+};
+
+class ProfileScope {
+
+    public:
+
+        explicit ProfileScope(const char* name);
+        ~ProfileScope();
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+
+    private:
+
+        const char* name;
+        std::uint64_t startNs;
+        std::uint32_t depth;
+};
+
+//SUPERPOSITION_PROFILING is set from CMake; when it is off the macros compile to nothing
+#if defined(SUPERPOSITION_PROFILING) && SUPERPOSITION_PROFILING
+    #define PROFILE_CONCAT_INNER(a, b) a##b
+    #define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+    #define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+    #define PROFILE_FRAME() Profiler::get().endFrame()
+#else
+    #define PROFILE_SCOPE(name) ((void)0)
+    #define PROFILE_FRAME() ((void)0)
+#endif
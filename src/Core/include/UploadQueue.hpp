@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+
+// Work that has to run on the thread owning the GL context, spread over frames. Each frame runs
+// tasks in order until its time budget is spent, so no single frame pays for a whole asset
+class UploadQueue {
+
+    public:
+
+        void push(std::function<void()> task);
+
+        //always runs at least one task so a task longer than the budget cannot stall the queue.
+        //Tasks pushed while processing wait for the next call. Returns how many ran
+        std::size_t process(double budgetMilliseconds);
+
+        std::size_t size() const { return tasks.size(); }
+        bool empty() const { return tasks.empty(); }
+
+    private:
+
+        std::deque<std::function<void()>> tasks;
+};
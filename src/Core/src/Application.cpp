@@ -1,11 +1,14 @@
 
 #include "Application.hpp"
+#include "GLExtensions.hpp"
 #include "Mesh.hpp"
+#include "Profiler.hpp"
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/quaternion.hpp>
+#include <filesystem>
 #include <iostream>
 #include <stdexcept>
 
@@ -25,39 +28,66 @@ Application::~Application() {
 
 void Application::init() {
 
+    PROFILE_SCOPE("Application::init");
+
     if (!glfwInit()) { throw std::runtime_error("Failed to initialize GLFW"); }
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-    window = glfwCreateWindow(1280, 720, "Superposition Engine", nullptr, nullptr);
+    window = glfwCreateWindow(windowWidth, windowHeight, "Superposition Engine", nullptr, nullptr);
     if (!window) { glfwTerminate(); throw std::runtime_error("Failed to create GLFW window"); }
     glfwMakeContextCurrent(window);
+    glfwGetFramebufferSize(window, &windowWidth, &windowHeight);
+    glfwSetWindowUserPointer(window, this);
+    glfwSetFramebufferSizeCallback(window, onFramebufferResize);
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) { throw std::runtime_error("Failed to initialize GLAD"); }
+    GLExtensions::load((GLExtensions::LoadProc)glfwGetProcAddress);
     
     glEnable(GL_DEPTH_TEST);
 
     coordinator = std::make_unique<Coordinator>();
     assetManager = std::make_unique<AssetManager>();
+    assetManager->getTextureStreamer().setBudget(TEXTURE_BUDGET_MB * 1024 * 1024);
     spaceManager = std::make_unique<SpaceManager>();
 
     coordinator->registerComponent<TransformComponent>();
+    coordinator->registerComponent<WorldTransformComponent>();
     coordinator->registerComponent<MeshComponent>();
     coordinator->registerComponent<CameraComponent>();
+    coordinator->registerComponent<LightComponent>();
     coordinator->registerComponent<RigidBodyComponent>();
     coordinator->registerComponent<CollisionShapeComponent>();
     coordinator->registerComponent<PlayerControlledComponent>();
+    coordinator->registerComponent<SpatialStateComponent>();
+    coordinator->registerComponent<SpatialManifoldComponent>();
 
     {
         Signature signature;
         signature.set(coordinator->getComponentTypeID<TransformComponent>());
+        signature.set(coordinator->getComponentTypeID<WorldTransformComponent>());
+        coordinator->registerSystem<TransformSystem>(signature);
+    }
+    transformSystem = coordinator->getSystem<TransformSystem>();
+
+    {
+        Signature signature;
+        signature.set(coordinator->getComponentTypeID<WorldTransformComponent>());
         signature.set(coordinator->getComponentTypeID<MeshComponent>());
         coordinator->registerSystem<RenderSystem>(signature);
     }
     renderSystem = coordinator->getSystem<RenderSystem>();
 
+    {
+        Signature signature;
+        signature.set(coordinator->getComponentTypeID<WorldTransformComponent>());
+        signature.set(coordinator->getComponentTypeID<LightComponent>());
+        coordinator->registerSystem<LightSystem>(signature);
+    }
+    lightSystem = coordinator->getSystem<LightSystem>();
+
     {
         Signature signature;
         signature.set(coordinator->getComponentTypeID<TransformComponent>());
@@ -83,28 +113,43 @@ void Application::init() {
     playerControlSystem = coordinator->getSystem<PlayerControlSystem>();
 
     // Initialize systems
-    physicsSystem->init(coordinator.get(), spaceManager.get());
+    transformSystem->init(coordinator.get());
+    lightSystem->init(coordinator.get());
+    physicsSystem->init(coordinator.get(), spaceManager.get(), transformSystem.get());
     inputSystem->init(coordinator.get(), window);
-    playerControlSystem->init(coordinator.get(), inputSystem.get());
+    playerControlSystem->init(coordinator.get(), inputSystem.get(), transformSystem.get());
 
     // Load the new PBR shader
     assetManager->loadShader("pbr", "assets/shaders/pbr.vert", "assets/shaders/pbr.frag");
-    assetManager->loadShader("post_process", "assets/shaders/post_process.vert" ,"assets/shaders/post_process.frag");
-    assetManager->loadScene("platform", "assets/models/Platform_2x2_Empty.gltf", *coordinator);
-    assetManager->loadScene("squere", "assets/models/Light_Square.gltf", *coordinator);
-    renderSystem->init(coordinator.get(), assetManager.get());
+    assetManager->loadShader("depth", "assets/shaders/depth.vert", "assets/shaders/depth.frag");
+    assetManager->loadShader("bloom_downsample", "assets/shaders/post_process.vert", "assets/shaders/bloom_downsample.frag");
+    assetManager->loadShader("bloom_upsample", "assets/shaders/post_process.vert", "assets/shaders/bloom_upsample.frag");
+    assetManager->loadShader("tonemap", "assets/shaders/post_process.vert", "assets/shaders/tonemap.frag");
+    assetManager->loadShader("fxaa", "assets/shaders/post_process.vert", "assets/shaders/fxaa.frag");
+    renderSystem->init(coordinator.get(), assetManager.get(), transformSystem.get(), windowWidth, windowHeight);
+    renderSystem->setDynamicResolution(true);
 
     // Set up the physics world
     spaceManager->createSpace(btVector3(0, -9.81, 0));
 
     // Set up a light source
-    lightPos = glm::vec3(0.0f, 5.0f, 5.0f);
-    lightColor = glm::vec3(150.0f, 150.0f, 150.0f);
+    Entity lightEntity = coordinator->createEntity();
+    coordinator->addComponent(lightEntity, TransformComponent{.position = {0.0f, 5.0f, 5.0f}});
+    coordinator->addComponent(lightEntity, WorldTransformComponent{});
+    coordinator->addComponent(lightEntity, LightComponent{.color = {1.0f, 1.0f, 1.0f}, .intensity = 150.0f, .range = 40.0f,
+                                                          .castShadows = true});
+
+    // And a sun, tilted down so its -Z points at the ground
+    Entity sunEntity = coordinator->createEntity();
+    coordinator->addComponent(sunEntity, TransformComponent{.rotation = glm::quat(glm::vec3(glm::radians(-55.0f), glm::radians(30.0f), 0.0f))});
+    coordinator->addComponent(sunEntity, WorldTransformComponent{});
+    coordinator->addComponent(sunEntity, LightComponent{.color = {1.0f, 0.95f, 0.85f}, .intensity = 3.0f,
+                                                        .type = LightType::DIRECTIONAL, .castShadows = true});
 
     cameraEntity = coordinator->createEntity();
     coordinator->addComponent(cameraEntity, TransformComponent{.position = {0.0f, 2.0f, 10.0f}});
     coordinator->addComponent(cameraEntity, CameraComponent{
-        .projectionMatrix = glm::perspective(glm::radians(45.0f), 1280.0f / 720.0f, 0.1f, 100.0f),
+        .projectionMatrix = cameraProjection(),
         .primary = true
     });
     
@@ -127,28 +172,54 @@ void Application::init() {
     coordinator->addComponent(cameraEntity, CollisionShapeComponent{.type = ShapeType::CAPSULE, .dimensions = {0.5f, 1.0f, 0.0f}});
 
 
-    // Get the light square entity and add physics components
-    Entity lightSquare = assetManager->getEntityFromScene("squere", "Light_Square");
-    if (lightSquare != -1) {
-        auto& lightTransform = coordinator->getComponent<TransformComponent>(lightSquare);
-        lightTransform.position = {0.0f, 10.0f, 0.0f}; // Start it above the platform
-        
-        coordinator->addComponent(lightSquare, RigidBodyComponent{.mass = 5.0f, .friction = 0.5f, .restitution = 0.5f});
-        coordinator->addComponent(lightSquare, CollisionShapeComponent{.type = ShapeType::BOX, .dimensions = {0.5f, 0.5f, 0.5f}});
-    }
-        
-   // Get the platform entity and add physics components
-    Entity groundEntity = assetManager->getEntityFromScene("platform", "Platform_2x2_Empty");
-    if (groundEntity != -1) {
-        auto& platformTransform = coordinator->getComponent<TransformComponent>(groundEntity);
-        platformTransform.scale = {10.0f, 0.5f, 10.0f};
-
-        coordinator->addComponent(groundEntity, RigidBodyComponent{.mass = 0.0f, .friction = 0.8f});
-        coordinator->addComponent(groundEntity, CollisionShapeComponent{
-            .type = ShapeType::BOX, 
-            .dimensions = {10.0f, 0.5f, 10.0f}
-        });
+    // The scenes stream in over the first frames, their physics is added once their entities exist
+    loadScene("squere", "assets/models/Light_Square.gltf", [this](Scene&) {
+        Entity lightSquare = assetManager->getEntityFromScene("squere", "Light_Square");
+        if (lightSquare != -1) {
+            auto& lightTransform = coordinator->getComponent<TransformComponent>(lightSquare);
+            lightTransform.position = {0.0f, 10.0f, 0.0f}; // Start it above the platform
+            transformSystem->markDirty(lightSquare);
+
+            coordinator->addComponent(lightSquare, RigidBodyComponent{.mass = 5.0f, .friction = 0.5f, .restitution = 0.5f});
+            coordinator->addComponent(lightSquare, CollisionShapeComponent{.type = ShapeType::BOX, .dimensions = {0.5f, 0.5f, 0.5f}});
+        }
+    });
+
+    levelLoad = loadScene("platform", "assets/models/Platform_2x2_Empty.gltf", [this](Scene&) {
+        Entity groundEntity = assetManager->getEntityFromScene("platform", "Platform_2x2_Empty");
+        if (groundEntity != -1) {
+            auto& platformTransform = coordinator->getComponent<TransformComponent>(groundEntity);
+            platformTransform.scale = {10.0f, 0.5f, 10.0f};
+            transformSystem->markDirty(groundEntity);
+
+            coordinator->addComponent(groundEntity, RigidBodyComponent{.mass = 0.0f, .friction = 0.8f});
+            coordinator->addComponent(groundEntity, CollisionShapeComponent{
+                .type = ShapeType::BOX,
+                .dimensions = {10.0f, 0.5f, 10.0f}
+            });
+        }
+    });
+}
+
+std::shared_ptr<SceneLoad> Application::loadScene(const std::string& name, const std::string& gltfPath,
+                                                  std::function<void(Scene&)> onLoaded) {
+    std::string packPath = "assets/baked/" + name + ".pack";
+    if (std::filesystem::exists(packPath)) {
+        onLoaded(assetManager->loadPack(name, packPath, *coordinator));
+        return nullptr;
     }
+    return assetManager->loadSceneAsync(name, gltfPath, *coordinator, std::move(onLoaded));
+}
+
+void Application::onFramebufferResize(GLFWwindow* window, int width, int height) {
+    auto* application = static_cast<Application*>(glfwGetWindowUserPointer(window));
+    application->windowWidth = width;
+    application->windowHeight = height;
+    application->framebufferResized = true;
+}
+
+glm::mat4 Application::cameraProjection() const {
+    return glm::perspective(glm::radians(45.0f), static_cast<float>(windowWidth) / static_cast<float>(windowHeight), 0.1f, 100.0f);
 }
 
 void Application::run() {
@@ -157,17 +228,87 @@ void Application::run() {
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
 
+        //a minimized window reports a zero size, keep the old targets until it comes back
+        if (framebufferResized && windowWidth > 0 && windowHeight > 0) {
+            framebufferResized = false;
+            renderSystem->resize(windowWidth, windowHeight);
+            coordinator->getComponent<CameraComponent>(cameraEntity).projectionMatrix = cameraProjection();
+        }
+
+        //finishes background loads a few uploads at a time
+        assetManager->update(UPLOAD_BUDGET_MS);
+
         // Update systems in the correct order
-        inputSystem->update(deltaTime);
-        playerControlSystem->update(deltaTime);
-        physicsSystem->update(deltaTime);
+        {
+            PROFILE_SCOPE("InputSystem::update");
+            inputSystem->update(deltaTime);
+        }
+        {
+            PROFILE_SCOPE("PlayerControlSystem::update");
+            playerControlSystem->update(deltaTime);
+        }
+        //nothing would hold the camera up before the ground arrives
+        if (!levelLoad || levelLoad->isDone()) {
+            PROFILE_SCOPE("PhysicsSystem::update");
+            physicsSystem->update(deltaTime);
+        }
+        transformSystem->update();
+        lightSystem->update();
         
-        auto const& cameraComponent = coordinator->getComponent<CameraComponent>(cameraEntity);
-        auto const& cameraTransform = coordinator->getComponent<TransformComponent>(cameraEntity);
-        renderSystem->draw(cameraComponent, cameraTransform, lightPos, lightColor);
+        {
+            PROFILE_SCOPE("RenderSystem::draw");
+            auto const& cameraComponent = coordinator->getComponent<CameraComponent>(cameraEntity);
+            auto const& cameraTransform = coordinator->getComponent<TransformComponent>(cameraEntity);
+            renderSystem->setViewSpace(physicsSystem->getCurrentSpace());
+            renderSystem->draw(cameraComponent, cameraTransform, *lightSystem);
+        }
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        {
+            PROFILE_SCOPE("Application::swapBuffers");
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        PROFILE_FRAME();
     }
 
+#if SUPERPOSITION_PROFILING
+    Profiler::get().printSummary(std::cout);
+
+    auto const& renderStats = renderSystem->getStats();
+    std::cout << "Instances last frame: " << renderStats.instances << " (" << renderStats.triangles << " triangles)"
+              << " in " << renderStats.drawCommands << " draw commands, " << renderStats.drawCalls
+              << " draw calls, " << renderStats.stateBinds
+              << " state binds (" << renderStats.redundantBinds << " redundant skipped)" << std::endl;
+    std::cout << "Culling last frame: " << renderStats.visible << " visible, "
+              << renderStats.culled << " culled" << std::endl;
+    std::cout << "Portals last frame: " << renderStats.portalViews << " views rendered, "
+              << renderStats.portalsSkipped << " drawn as plain meshes" << std::endl;
+    std::cout << "Overdraw: " << renderStats.shadedSamples << " shaded samples (" << renderStats.overdraw
+              << " per pixel), " << renderStats.depthSamples << " in the depth pre-pass" << std::endl;
+    std::cout << "Lights last frame: " << renderStats.lights << " in " << renderStats.lightIndices
+              << " cluster entries (" << renderStats.lightOverflow << " dropped from full clusters)" << std::endl;
+    std::cout << "Shadows last frame: " << renderStats.shadowPasses << " passes over " << renderStats.shadowCasters
+              << " casters, " << renderStats.shadowTilesCached << " maps reused from cache" << std::endl;
+    std::cout << "Resolution last frame: " << renderStats.renderScale << " of " << windowWidth << "x" << windowHeight
+              << " at " << renderStats.gpuMilliseconds << " ms GPU, render targets hold "
+              << renderStats.renderTargetBytes / (1024 * 1024) << " MB" << std::endl;
+    std::cout << "Uniform uploads last frame: " << renderStats.uniformCallsIssued
+              << " issued, " << renderStats.uniformCallsSaved << " skipped as redundant" << std::endl;
+
+    auto const& geometryArena = assetManager->getGeometryArena();
+    std::cout << "Geometry arena: " << geometryArena.getVerticesUsed() << "/" << geometryArena.getVertexCapacity()
+              << " vertices of " << geometryArena.getVertexStride() << " bytes, " << geometryArena.getIndexBytesUsed()
+              << "/" << geometryArena.getIndexBytes() << " index bytes" << std::endl;
+
+    auto const& textureStreamer = assetManager->getTextureStreamer();
+    std::cout << "Texture streaming: " << textureStreamer.getResidentBytes() / (1024 * 1024) << "/"
+              << textureStreamer.getBudget() / (1024 * 1024) << " MB resident over " << textureStreamer.getTextureCount()
+              << " textures, " << textureStreamer.getUploadsLastFrame() << " levels uploaded and "
+              << textureStreamer.getEvictionsLastFrame() << " evicted last frame" << std::endl;
+
+    if (Profiler::get().exportChromeTrace("superposition_trace.json")) {
+        std::cout << "Profiler trace written to superposition_trace.json" << std::endl;
+    }
+#endif
 }
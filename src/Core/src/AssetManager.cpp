@@ -1,78 +1,407 @@
 #include "AssetManager.hpp"
+#include "AssetPack.hpp"
 #include "Coordinator.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtx/matrix_decompose.hpp>
 
 #define TINYGLTF_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include <tiny_gltf.h>
 
-Scene& AssetManager::loadScene(const std::string& sceneName, const std::string& path, Coordinator& coordinator) {
+namespace {
 
-    tinygltf::Model model;
-    tinygltf::TinyGLTF loader;
-    std::string err;
-    std::string warn;
+    //file I/O, JSON and image decoding, returns the error or an empty string
+    std::string parseGLTF(const std::string& path, tinygltf::Model& model) {
+
+        PROFILE_SCOPE("AssetManager::parseGLTF");
+
+        tinygltf::TinyGLTF loader;
+        std::string err;
+        std::string warn;
 
-    bool ret;
-    if (path.substr(path.find_last_of(".") + 1) == "glb") {
-        ret = loader.LoadBinaryFromFile(&model, &err, &warn, path);
-    } else {
-        ret = loader.LoadASCIIFromFile(&model, &err, &warn, path);
+        bool ret;
+        if (path.substr(path.find_last_of(".") + 1) == "glb") {
+            ret = loader.LoadBinaryFromFile(&model, &err, &warn, path);
+        } else {
+            ret = loader.LoadASCIIFromFile(&model, &err, &warn, path);
+        }
+
+        if (!warn.empty()) { std::cout << "glTF WARN: " << warn << std::endl; }
+        if (!ret) { return err.empty() ? "Failed to load glTF file " + path : err; }
+        return std::string();
     }
 
-    if (!warn.empty()) { std::cout << "glTF WARN: " << warn << std::endl; }
-    if (!err.empty()) { std::cerr << "glTF ERR: " << err << std::endl; }
-    if (!ret) { throw std::runtime_error("Failed to load glTF file."); }
+    //every texture's full mip chain, raw. Base color and emissive are gamma encoded, their mips
+    //are averaged in linear space
+    std::vector<std::vector<TextureLevel>> buildMipChains(const tinygltf::Model& model) {
+
+        PROFILE_SCOPE("AssetManager::buildMipChains");
+
+        std::vector<bool> color(model.textures.size(), false);
+        for (const auto& material : model.materials) {
+            int indices[2] = {material.pbrMetallicRoughness.baseColorTexture.index, material.emissiveTexture.index};
+            for (int index : indices) {
+                if (index >= 0 && index < static_cast<int>(color.size())) color[index] = true;
+            }
+        }
+
+        std::vector<std::vector<TextureLevel>> chains;
+        for (std::size_t t = 0; t < model.textures.size(); t++) {
+            const auto& image = model.images[model.textures[t].source];
+            chains.push_back(TextureCompression::buildMipChain(image.image.data(), image.width, image.height, image.component, color[t]));
+        }
+        return chains;
+    }
+}
+
+AssetManager::AssetManager(VertexFormat vertexFormat, const MeshImportOptions& meshOptions) {
+    this->meshOptions = meshOptions;
+
+    materials.push_back(std::make_shared<Material>());
+    materials.back()->name = "default";
+    materialIDs["default"] = 0;
+    materialBuffer = std::make_unique<MaterialBuffer>();
+    geometryArena = std::make_shared<GeometryArena>(vertexFormat);
+    uploadMaterials();
+}
+
+Scene& AssetManager::loadScene(const std::string& sceneName, const std::string& path, Coordinator& coordinator) {
+
+    PROFILE_SCOPE("AssetManager::loadScene");
+
+    tinygltf::Model model;
+    std::string err = parseGLTF(path, model);
+    if (!err.empty()) {
+        std::cerr << "glTF ERR: " << err << std::endl;
+        throw std::runtime_error("Failed to load glTF file.");
+    }
 
     scenes[sceneName] = Scene();
     Scene& currentScene = scenes[sceneName];
 
-    processMaterials(model);
+    MaterialID firstMaterial = processMaterials(model);
 
-    for (const auto& mesh : model.meshes)
-        meshes[mesh.name] = Mesh::CreateFromGLTF(model, mesh);
-    
+    {
+        PROFILE_SCOPE("AssetManager::buildMeshes");
+        for (const auto& mesh : model.meshes)
+            meshes[mesh.name] = Mesh::CreateFromGLTF(model, mesh, firstMaterial, geometryArena, meshOptions);
+    }
 
-    int sceneIndex = model.defaultScene > -1 ? model.defaultScene : 0;
-    const tinygltf::Scene& scene = model.scenes[sceneIndex];
+    spawnScene(model, currentScene, coordinator);
+    return currentScene;
+}
 
-    for (int nodeIndex : scene.nodes) {
-        const tinygltf::Node& node = model.nodes[nodeIndex];
-        if (node.mesh < 0) continue;
+std::shared_ptr<SceneLoad> AssetManager::loadSceneAsync(const std::string& sceneName, const std::string& path,
+                                                        Coordinator& coordinator, std::function<void(Scene&)> onLoaded) {
 
-        Entity entity = coordinator.createEntity();
-        currentScene[node.name] = entity;
-        
-        TransformComponent transform;
-        if (!node.translation.empty()) {
-            transform.position = glm::vec3(node.translation[0], node.translation[1], node.translation[2]);
+    //started on first use, programs that only load synchronously never spawn the threads
+    if (!jobs) jobs = std::make_unique<JobSystem>();
+
+    auto load = std::make_shared<SceneLoad>();
+    load->sceneName = sceneName;
+    load->coordinator = &coordinator;
+    load->onLoaded = std::move(onLoaded);
+    load->model = std::make_shared<tinygltf::Model>();
+    load->textureLevels = std::make_shared<std::vector<std::vector<TextureLevel>>>();
+
+    std::shared_ptr<tinygltf::Model> model = load->model;
+    std::shared_ptr<std::vector<std::vector<TextureLevel>>> textureLevels = load->textureLevels;
+    load->parseJob = jobs->submit([model, textureLevels, path]() {
+        std::string err = parseGLTF(path, *model);
+        if (err.empty()) *textureLevels = buildMipChains(*model);
+        return err;
+    });
+
+    pendingLoads.push_back(load);
+    return load;
+}
+
+void AssetManager::update(double budgetMilliseconds) {
+
+    PROFILE_SCOPE("AssetManager::update");
+
+    for (const auto& load : pendingLoads) advanceLoad(load);
+    uploads.process(budgetMilliseconds);
+    textureStreamer.update();
+
+    pendingLoads.erase(std::remove_if(pendingLoads.begin(), pendingLoads.end(),
+                                      [](const std::shared_ptr<SceneLoad>& load) { return load->isDone(); }),
+                       pendingLoads.end());
+}
+
+void AssetManager::advanceLoad(const std::shared_ptr<SceneLoad>& load) {
+
+    auto finished = [](const auto& future) {
+        return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    };
+
+    // --- 1. Parsed: textures one upload each, then the materials, which fix the model's MaterialIDs ---
+    if (load->stage == SceneLoad::Stage::PARSING) {
+        if (!finished(load->parseJob)) return;
+
+        load->error = load->parseJob.get();
+        if (!load->error.empty()) {
+            std::cerr << "glTF ERR: " << load->error << std::endl;
+            load->model.reset();
+            load->textureLevels.reset();
+            load->status = LoadStatus::FAILED;
+            return;
+        }
+
+        for (std::size_t t = 0; t < load->model->textures.size(); t++) {
+            uploads.push([this, load, t]() {
+                createTexture(*load->model, load->model->textures[t], std::move((*load->textureLevels)[t]));
+            });
+        }
+
+        //the mesh jobs start from here, they need the MaterialIDs the materials got
+        uploads.push([this, load]() {
+            load->firstMaterial = createMaterials(*load->model);
+            for (const auto& mesh : load->model->meshes) {
+                std::shared_ptr<tinygltf::Model> model = load->model;
+                MaterialID firstMaterial = load->firstMaterial;
+                MeshImportOptions options = meshOptions;
+                load->meshJobs.push_back(jobs->submit([model, &mesh, firstMaterial, options]() {
+                    return Mesh::ProcessGLTF(*model, mesh, firstMaterial, options);
+                }));
+            }
+            load->stage = SceneLoad::Stage::PROCESSING;
+        });
+        load->stage = SceneLoad::Stage::MATERIALS;
+        return;
+    }
+
+    // --- 2. Processed: one upload per mesh, the entities once every mesh they name exists ---
+    if (load->stage == SceneLoad::Stage::PROCESSING) {
+        for (const auto& job : load->meshJobs) {
+            if (!finished(job)) return;
+        }
+
+        //a job that threw rethrows here, on the render thread, and fails the load like a parse error
+        try {
+            for (auto& job : load->meshJobs) load->meshData.push_back(job.get());
+        } catch (const std::exception& e) {
+            load->error = e.what();
+            std::cerr << "glTF ERR: " << load->error << std::endl;
+            load->model.reset();
+            load->textureLevels.reset();
+            load->meshJobs.clear();
+            load->meshData.clear();
+            load->status = LoadStatus::FAILED;
+            return;
+        }
+
+        for (std::size_t m = 0; m < load->meshData.size(); m++) {
+            uploads.push([this, load, m]() {
+                meshes[load->model->meshes[m].name] = Mesh::Create(std::move(load->meshData[m]), geometryArena, meshOptions.keepCPUData);
+            });
         }
-        if (!node.rotation.empty()) {
-            transform.rotation = glm::quat(node.rotation[3], node.rotation[0], node.rotation[1], node.rotation[2]);
+
+        uploads.push([this, load]() {
+            scenes[load->sceneName] = Scene();
+            Scene& scene = scenes[load->sceneName];
+            spawnScene(*load->model, scene, *load->coordinator);
+
+            load->model.reset();
+            load->textureLevels.reset();
+            load->meshJobs.clear();
+            load->meshData.clear();
+            load->scene = &scene;
+            load->status = LoadStatus::READY;
+            if (load->onLoaded) load->onLoaded(scene);
+        });
+        load->stage = SceneLoad::Stage::UPLOADING;
+    }
+}
+
+Scene& AssetManager::loadPack(const std::string& sceneName, const std::string& path, Coordinator& coordinator) {
+
+    PROFILE_SCOPE("AssetManager::loadPack");
+
+    //shared with the textures streaming from it
+    auto packFile = std::make_shared<AssetPackReader>(path);
+    const AssetPackReader& pack = *packFile;
+    const AssetPack::Header& header = pack.getHeader();
+    if (pack.getVertexFormat() != geometryArena->getFormat()) {
+        throw std::runtime_error(path + " was baked for a different vertex format than the geometry arena uses");
+    }
+
+    // --- 1. Textures and materials, pack material i becomes firstMaterial + i ---
+    std::vector<std::shared_ptr<Texture>> packTextures;
+    for (std::uint32_t i = 0; i < header.textureCount; i++) {
+        const AssetPack::TextureRecord& record = pack.getTexture(i);
+        std::vector<TextureUpload> levels;
+        for (std::uint32_t l = 0; l < record.levelCount; l++) {
+            const AssetPack::LevelRecord& level = pack.getLevels(record)[l];
+            levels.push_back(TextureUpload{static_cast<int>(level.width), static_cast<int>(level.height),
+                                           pack.getLevelData(level), static_cast<std::size_t>(level.size)});
         }
-        if (!node.scale.empty()) {
-            transform.scale = glm::vec3(node.scale[0], node.scale[1], node.scale[2]);
+        auto texture = textureStreamer.add(static_cast<TextureFormat>(record.format), std::move(levels), packFile,
+                                           (record.flags & AssetPack::TEXTURE_GREY) != 0);
+        textures[std::string(pack.getString(record.name))] = texture;
+        packTextures.push_back(texture);
+    }
+
+    MaterialID firstMaterial = static_cast<MaterialID>(materials.size());
+    for (std::uint32_t i = 0; i < header.materialCount; i++) {
+        const AssetPack::MaterialRecord& record = pack.getMaterial(i);
+        auto mat = std::make_shared<Material>();
+        mat->name = std::string(pack.getString(record.name));
+        if (record.albedoTexture < packTextures.size()) mat->albedoMap = packTextures[record.albedoTexture];
+        mat->albedoFactor = glm::make_vec4(record.albedoFactor);
+        mat->emissiveFactor = glm::make_vec3(record.emissiveFactor);
+        mat->metallicFactor = record.metallicFactor;
+        mat->roughnessFactor = record.roughnessFactor;
+        mat->doubleSided = record.doubleSided != 0;
+
+        materialIDs[mat->name] = static_cast<MaterialID>(materials.size());
+        materials.push_back(mat);
+    }
+    uploadMaterials();
+
+    // --- 2. Meshes, vertices and indices go from the mapping to the arena without a copy ---
+    std::vector<std::string> meshNames;
+    for (std::uint32_t i = 0; i < header.meshCount; i++) {
+        const AssetPack::MeshRecord& record = pack.getMesh(i);
+
+        std::vector<SubMesh> subMeshes(record.subMeshCount);
+        const AssetPack::SubMeshRecord* packSubMeshes = pack.getSubMeshes(record);
+        for (std::uint32_t s = 0; s < record.subMeshCount; s++) {
+            const AssetPack::SubMeshRecord& packSubMesh = packSubMeshes[s];
+            subMeshes[s].materialID = packSubMesh.material < header.materialCount ? firstMaterial + packSubMesh.material : 0;
+            subMeshes[s].indexCount = packSubMesh.indexCount;
+            subMeshes[s].indexOffset = packSubMesh.indexOffset;
+            subMeshes[s].baseVertex = packSubMesh.baseVertex;
         }
+        const MeshLOD* packLODs = pack.getLODs(record);
+        std::vector<MeshLOD> lods(packLODs, packLODs + record.lodCount);
+
+        AABB bounds{glm::make_vec3(record.boundsMin), glm::make_vec3(record.boundsMax)};
+        meshNames.emplace_back(pack.getString(record.name));
+        meshes[meshNames.back()] = std::make_shared<Mesh>(pack.getVertices(record), record.vertexCount,
+                                                          pack.getIndices(record), record.indexCount,
+                                                          static_cast<IndexType>(record.indexType),
+                                                          std::move(subMeshes), std::move(lods), bounds,
+                                                          glm::make_mat4(record.positionTransform), record.quantized != 0,
+                                                          geometryArena);
+    }
+
+    // --- 3. Entities, parents are stored before their children ---
+    scenes[sceneName] = Scene();
+    Scene& scene = scenes[sceneName];
+    std::vector<Entity> nodeEntities(header.nodeCount, NULL_ENTITY);
+    for (std::uint32_t i = 0; i < header.nodeCount; i++) {
+        const AssetPack::NodeRecord& node = pack.getNode(i);
+
+        Entity entity = coordinator.createEntity();
+        nodeEntities[i] = entity;
+        std::string name(pack.getString(node.name));
+        if (!name.empty()) scene[name] = entity;
+
+        TransformComponent transform;
+        transform.parent = node.parent < i ? nodeEntities[node.parent] : NULL_ENTITY;
+        transform.position = glm::make_vec3(node.position);
+        transform.rotation = glm::quat(node.rotation[3], node.rotation[0], node.rotation[1], node.rotation[2]);
+        transform.scale = glm::make_vec3(node.scale);
         coordinator.addComponent(entity, transform);
+        coordinator.addComponent(entity, WorldTransformComponent{});
+
+        if (node.mesh < meshNames.size()) {
+            coordinator.addComponent(entity, MeshComponent{.meshName = meshNames[node.mesh]});
+        }
+    }
+
+    return scene;
+}
+
+void AssetManager::spawnScene(const tinygltf::Model& model, Scene& scene, Coordinator& coordinator) {
+
+    PROFILE_SCOPE("AssetManager::spawnScene");
+
+    if (model.scenes.empty()) return;
+    int sceneIndex = model.defaultScene > -1 ? model.defaultScene : 0;
+    for (int nodeIndex : model.scenes[sceneIndex].nodes)
+        spawnNode(model, nodeIndex, NULL_ENTITY, scene, coordinator);
+}
+
+void AssetManager::spawnNode(const tinygltf::Model& model, int nodeIndex, Entity parent, Scene& scene, Coordinator& coordinator) {
+
+    const tinygltf::Node& node = model.nodes[nodeIndex];
+
+    Entity entity = coordinator.createEntity();
+    if (!node.name.empty()) scene[node.name] = entity;
+
+    TransformComponent transform;
+    transform.parent = parent;
+    if (node.matrix.size() == 16) {
+        glm::mat4 matrix = glm::make_mat4(node.matrix.data());
+        glm::vec3 skew;
+        glm::vec4 perspective;
+        glm::decompose(matrix, transform.scale, transform.rotation, transform.position, skew, perspective);
+    }
+    if (!node.translation.empty()) {
+        transform.position = glm::vec3(node.translation[0], node.translation[1], node.translation[2]);
+    }
+    if (!node.rotation.empty()) {
+        transform.rotation = glm::quat(node.rotation[3], node.rotation[0], node.rotation[1], node.rotation[2]);
+    }
+    if (!node.scale.empty()) {
+        transform.scale = glm::vec3(node.scale[0], node.scale[1], node.scale[2]);
+    }
+    coordinator.addComponent(entity, transform);
+    coordinator.addComponent(entity, WorldTransformComponent{});
 
+    if (node.mesh >= 0) {
         const auto& mesh = model.meshes[node.mesh];
         coordinator.addComponent(entity, MeshComponent{.meshName = mesh.name});
     }
-    
-    return currentScene;
+
+    //children are spawned after the parent, so the parent is already in the hierarchy when they join
+    for (int childIndex : node.children)
+        spawnNode(model, childIndex, entity, scene, coordinator);
 }
 
-void AssetManager::processMaterials(const tinygltf::Model& model) {
+MaterialID AssetManager::processMaterials(const tinygltf::Model& model) {
 
-    for (const auto& texture : model.textures) {
-        const auto& image = model.images[texture.source];
-        auto tex = std::make_shared<Texture>(image.image.data(), image.width, image.height, image.component);
-        textures[image.name] = tex;
+    PROFILE_SCOPE("AssetManager::processMaterials");
+
+    std::vector<std::vector<TextureLevel>> chains = buildMipChains(model);
+    for (std::size_t t = 0; t < model.textures.size(); t++) createTexture(model, model.textures[t], std::move(chains[t]));
+    return createMaterials(model);
+}
+
+void AssetManager::createTexture(const tinygltf::Model& model, const tinygltf::Texture& texture, std::vector<TextureLevel> levels) {
+    const auto& image = model.images[texture.source];
+    auto owner = std::make_shared<std::vector<TextureLevel>>(std::move(levels));
+
+    std::vector<TextureUpload> levelUploads;
+    for (const TextureLevel& level : *owner) {
+        levelUploads.push_back(TextureUpload{level.width, level.height, level.data.data(), level.data.size()});
     }
+    textures[image.name] = textureStreamer.add(TextureCompression::rawFormat(image.component), std::move(levelUploads), owner);
+}
+
+void AssetManager::requestTextures(const std::vector<float>& materialScreenSizes) {
+    std::size_t count = std::min(materialScreenSizes.size(), materials.size());
+    for (std::size_t id = 0; id < count; id++) {
+        if (materialScreenSizes[id] > 0.0f && materials[id]->albedoMap) {
+            textureStreamer.request(*materials[id]->albedoMap, materialScreenSizes[id]);
+        }
+    }
+}
+
+MaterialID AssetManager::createMaterials(const tinygltf::Model& model) {
+
+    MaterialID firstMaterial = static_cast<MaterialID>(materials.size());
 
     for (const auto& material : model.materials) {
         auto mat = std::make_shared<Material>();
+        mat->name = material.name;
         
         const auto& pbr = material.pbrMetallicRoughness;
         if (pbr.baseColorTexture.index >= 0) {
@@ -90,8 +419,31 @@ void AssetManager::processMaterials(const tinygltf::Model& model) {
         
         mat->doubleSided = material.doubleSided;
 
-        materials[material.name] = mat;
+        //glTF material i becomes firstMaterial + i, so meshes can resolve their index without names
+        materialIDs[material.name] = static_cast<MaterialID>(materials.size());
+        materials.push_back(mat);
     }
+
+    uploadMaterials();
+    return firstMaterial;
+}
+
+void AssetManager::uploadMaterials() {
+
+    std::vector<GpuMaterial> gpuMaterials;
+    gpuMaterials.reserve(materials.size());
+
+    for (auto const& material : materials) {
+        GpuMaterial gpuMaterial;
+        gpuMaterial.albedoFactor = material->albedoFactor;
+        gpuMaterial.emissiveFactor = glm::vec4(material->emissiveFactor, 0.0f);
+        gpuMaterial.metallicFactor = material->metallicFactor;
+        gpuMaterial.roughnessFactor = material->roughnessFactor;
+        gpuMaterial.doubleSided = material->doubleSided ? 1 : 0;
+        gpuMaterials.push_back(gpuMaterial);
+    }
+
+    materialBuffer->upload(gpuMaterials);
 }
 
 std::shared_ptr<Shader> AssetManager::loadShader(const std::string& name, const std::string& vertPath, const std::string& fragPath) {
@@ -107,19 +459,12 @@ std::shared_ptr<Mesh> AssetManager::getMesh(const std::string& name) { return me
 std::shared_ptr<Texture> AssetManager::getTexture(const std::string& name) { return textures.at(name); }
 
 std::shared_ptr<Material> AssetManager::getMaterial(const std::string& name) {
+    return materials[getMaterialID(name)];
+}
 
-    if (materials.find(name) == materials.end()) {
-
-        if (materials.find("default") == materials.end()) {
-            
-            auto defaultMat = std::make_shared<Material>();
-            materials["default"] = defaultMat;
-        }
-
-        return materials["default"];
-    }
-
-    return materials.at(name);
+MaterialID AssetManager::getMaterialID(const std::string& name) const {
+    auto it = materialIDs.find(name);
+    return it == materialIDs.end() ? 0 : it->second;
 }
 
 Scene* AssetManager::getScene(const std::string& sceneName) {
@@ -0,0 +1,378 @@
+#include "AssetPack.hpp"
+#include "Profiler.hpp"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+
+    constexpr std::uint64_t ALIGNMENT = 16;
+
+    std::uint64_t align(std::uint64_t offset) {
+        return (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+    template <typename T>
+    void appendBytes(std::vector<std::uint8_t>& bytes, const T* data, std::size_t count) {
+        const std::uint8_t* begin = reinterpret_cast<const std::uint8_t*>(data);
+        bytes.insert(bytes.end(), begin, begin + count * sizeof(T));
+    }
+}
+
+// --- MappedFile ---
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(const std::string& path) {
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) { file = nullptr; throw std::runtime_error("Failed to open " + path); }
+
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+    length = static_cast<std::size_t>(fileSize.QuadPart);
+    if (length == 0) return;
+
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping) bytes = static_cast<const std::uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!bytes) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        throw std::runtime_error("Failed to map " + path);
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (bytes) UnmapViewOfFile(bytes);
+    if (mapping) CloseHandle(mapping);
+    if (file) CloseHandle(file);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) {
+    int descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) throw std::runtime_error("Failed to open " + path);
+
+    struct stat status;
+    if (fstat(descriptor, &status) != 0) {
+        close(descriptor);
+        throw std::runtime_error("Failed to stat " + path);
+    }
+    length = static_cast<std::size_t>(status.st_size);
+    if (length == 0) { close(descriptor); return; }
+
+    void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    //the mapping keeps its own reference to the file
+    close(descriptor);
+    if (address == MAP_FAILED) throw std::runtime_error("Failed to map " + path);
+
+    //meshes are read right away, texture levels whenever they stream in, so no sequential hint
+    madvise(address, length, MADV_WILLNEED);
+    bytes = static_cast<const std::uint8_t*>(address);
+}
+
+MappedFile::~MappedFile() {
+    if (bytes) munmap(const_cast<std::uint8_t*>(bytes), length);
+}
+
+#endif
+
+// --- AssetPackReader ---
+
+AssetPackReader::AssetPackReader(const std::string& path) : file(path) {
+    expect(0, sizeof(AssetPack::Header), "header");
+    header = record<AssetPack::Header>(0);
+    if (std::memcmp(header->magic, AssetPack::MAGIC, sizeof(AssetPack::MAGIC)) != 0) {
+        throw std::runtime_error(path + " is not an asset pack");
+    }
+    if (header->version != AssetPack::VERSION) {
+        throw std::runtime_error(path + " was baked for pack version " + std::to_string(header->version) +
+                                 ", this build reads version " + std::to_string(AssetPack::VERSION) + ". Bake it again");
+    }
+    validate();
+}
+
+void AssetPackReader::expect(std::uint64_t offset, std::uint64_t bytes, const char* what) const {
+    if (offset > file.size() || bytes > file.size() - offset) {
+        throw std::runtime_error(std::string("Asset pack is truncated, ") + what + " reaches past the end of the file");
+    }
+}
+
+void AssetPackReader::corrupt(const char* what) const {
+    throw std::runtime_error(std::string("Asset pack is corrupt, ") + what + ". Bake it again");
+}
+
+// Everything the accessors hand out is checked here once, so loading never reads past the mapping
+void AssetPackReader::validate() const {
+
+    const AssetPack::Header& h = *header;
+    if (h.fileSize != file.size()) throw std::runtime_error("Asset pack size does not match its header");
+
+    expect(h.meshes, std::uint64_t(h.meshCount) * sizeof(AssetPack::MeshRecord), "mesh table");
+    expect(h.textures, std::uint64_t(h.textureCount) * sizeof(AssetPack::TextureRecord), "texture table");
+    expect(h.materials, std::uint64_t(h.materialCount) * sizeof(AssetPack::MaterialRecord), "material table");
+    expect(h.nodes, std::uint64_t(h.nodeCount) * sizeof(AssetPack::NodeRecord), "node table");
+    expect(h.strings, 0, "string block");
+
+    std::size_t vertexStride = getVertexFormat() == VertexFormat::PACKED ? sizeof(PackedVertex) : sizeof(Vertex);
+    for (std::uint32_t i = 0; i < h.meshCount; i++) {
+        const AssetPack::MeshRecord& mesh = getMesh(i);
+        std::size_t indexSize = mesh.indexType == static_cast<std::uint32_t>(IndexType::UINT16) ? 2 : 4;
+        expect(mesh.vertices, std::uint64_t(mesh.vertexCount) * vertexStride, "mesh vertices");
+        expect(mesh.indices, std::uint64_t(mesh.indexCount) * indexSize, "mesh indices");
+        expect(mesh.subMeshes, std::uint64_t(mesh.subMeshCount) * sizeof(AssetPack::SubMeshRecord), "submeshes");
+        expect(mesh.lods, std::uint64_t(mesh.lodCount) * sizeof(MeshLOD), "mesh LODs");
+        expect(h.strings + mesh.name.offset, mesh.name.length, "mesh name");
+
+        //the renderer indexes submeshes through the LODs and draws their index ranges unchecked
+        if (mesh.indexType > static_cast<std::uint32_t>(IndexType::UINT32)) corrupt("a mesh has an unknown index type");
+        if (mesh.lodCount == 0 || mesh.subMeshCount % mesh.lodCount != 0) corrupt("a mesh's submeshes do not split evenly into its LODs");
+        const AssetPack::SubMeshRecord* subMeshes = getSubMeshes(mesh);
+        for (std::uint32_t s = 0; s < mesh.subMeshCount; s++) {
+            if (std::uint64_t(subMeshes[s].indexOffset) + subMeshes[s].indexCount > mesh.indexCount) {
+                corrupt("a submesh reaches past its mesh's indices");
+            }
+            if (subMeshes[s].baseVertex < 0 || std::uint32_t(subMeshes[s].baseVertex) > mesh.vertexCount) {
+                corrupt("a submesh's base vertex lies outside its mesh");
+            }
+        }
+        std::uint32_t primitives = mesh.subMeshCount / mesh.lodCount;
+        const MeshLOD* lods = getLODs(mesh);
+        for (std::uint32_t l = 0; l < mesh.lodCount; l++) {
+            if (std::uint64_t(lods[l].firstSubMesh) + primitives > mesh.subMeshCount) corrupt("a LOD reaches past its mesh's submeshes");
+        }
+    }
+    for (std::uint32_t i = 0; i < h.textureCount; i++) {
+        const AssetPack::TextureRecord& texture = getTexture(i);
+        if (texture.format > static_cast<std::uint32_t>(TextureFormat::BC5)) throw std::runtime_error("Asset pack has an unknown texture format");
+        TextureFormat format = static_cast<TextureFormat>(texture.format);
+        if (texture.levelCount == 0) corrupt("a texture has no levels");
+        expect(texture.levels, std::uint64_t(texture.levelCount) * sizeof(AssetPack::LevelRecord), "texture levels");
+        for (std::uint32_t l = 0; l < texture.levelCount; l++) {
+            const AssetPack::LevelRecord& level = getLevels(texture)[l];
+            if (level.size != TextureCompression::levelBytes(format, static_cast<int>(level.width), static_cast<int>(level.height))) {
+                throw std::runtime_error("Asset pack texture level size does not match its format");
+            }
+            expect(level.data, level.size, "texture level");
+        }
+        expect(h.strings + texture.name.offset, texture.name.length, "texture name");
+    }
+    for (std::uint32_t i = 0; i < h.materialCount; i++) {
+        expect(h.strings + getMaterial(i).name.offset, getMaterial(i).name.length, "material name");
+    }
+    for (std::uint32_t i = 0; i < h.nodeCount; i++) {
+        expect(h.strings + getNode(i).name.offset, getNode(i).name.length, "node name");
+    }
+}
+
+std::string_view AssetPackReader::getString(const AssetPack::String& string) const {
+    return std::string_view(reinterpret_cast<const char*>(file.data() + header->strings + string.offset), string.length);
+}
+
+// --- AssetPackWriter ---
+
+AssetPackWriter::AssetPackWriter(VertexFormat vertexFormat) {
+    this->vertexFormat = vertexFormat;
+}
+
+AssetPack::String AssetPackWriter::addString(const std::string& string) {
+    AssetPack::String result;
+    result.offset = static_cast<std::uint32_t>(strings.size());
+    result.length = static_cast<std::uint32_t>(string.size());
+    strings += string;
+    return result;
+}
+
+std::uint32_t AssetPackWriter::addMesh(const std::string& name, const std::vector<Vertex>& vertices, const std::vector<std::uint32_t>& indices,
+                                       const std::vector<AssetPack::SubMeshRecord>& subMeshes, const std::vector<MeshLOD>& lods) {
+
+    PendingMesh& mesh = meshes.emplace_back();
+    AssetPack::MeshRecord& record = mesh.record;
+    std::memset(&record, 0, sizeof(record));
+    record.name = addString(name);
+    record.vertexCount = static_cast<std::uint32_t>(vertices.size());
+    record.indexCount = static_cast<std::uint32_t>(indices.size());
+    record.subMeshCount = static_cast<std::uint32_t>(subMeshes.size());
+    record.lodCount = static_cast<std::uint32_t>(lods.size());
+
+    AABB bounds;
+    for (const auto& vertex : vertices) bounds.expand(vertex.Position);
+    std::memcpy(record.boundsMin, &bounds.min, sizeof(record.boundsMin));
+    std::memcpy(record.boundsMax, &bounds.max, sizeof(record.boundsMax));
+
+    // --- 1. Vertices encoded the way Mesh::upload would before handing them to the arena ---
+    glm::mat4 positionTransform(1.0f);
+    if (vertexFormat == VertexFormat::PACKED) {
+        PositionQuantization quantization = PositionQuantization::fromBounds(bounds);
+        positionTransform = quantization.toMatrix();
+        record.quantized = 1;
+
+        mesh.vertices.reserve(vertices.size() * sizeof(PackedVertex));
+        for (const auto& vertex : vertices) {
+            PackedVertex packed = VertexPacking::pack(vertex, quantization);
+            appendBytes(mesh.vertices, &packed, 1);
+        }
+    } else {
+        appendBytes(mesh.vertices, vertices.data(), vertices.size());
+    }
+    std::memcpy(record.positionTransform, &positionTransform[0][0], sizeof(record.positionTransform));
+
+    // --- 2. Indices, 16-bit whenever every index fits, as Mesh::upload decides ---
+    if (vertices.size() <= 0x10000) {
+        record.indexType = static_cast<std::uint32_t>(IndexType::UINT16);
+        std::vector<std::uint16_t> shortIndices(indices.begin(), indices.end());
+        appendBytes(mesh.indices, shortIndices.data(), shortIndices.size());
+    } else {
+        record.indexType = static_cast<std::uint32_t>(IndexType::UINT32);
+        appendBytes(mesh.indices, indices.data(), indices.size());
+    }
+
+    mesh.subMeshes = subMeshes;
+    mesh.lods = lods;
+    if (mesh.lods.empty()) {
+        mesh.lods.push_back(MeshLOD{});
+        record.lodCount = 1;
+    }
+
+    return static_cast<std::uint32_t>(meshes.size() - 1);
+}
+
+std::uint32_t AssetPackWriter::addTexture(const std::string& name, const std::uint8_t* pixels, std::uint32_t width, std::uint32_t height,
+                                          std::uint32_t components, bool srgb, bool compress) {
+
+    int w = static_cast<int>(width);
+    int h = static_cast<int>(height);
+    int c = static_cast<int>(components);
+    //mips of a channel every texel agrees on agree too, so the base level decides for the chain
+    TextureChannels channels = TextureCompression::findChannels(pixels, w, h, c);
+    std::vector<TextureLevel> chain = TextureCompression::buildMipChain(pixels, w, h, c, srgb);
+    for (TextureLevel& level : chain) level = TextureCompression::packChannels(level, c, channels);
+
+    const std::uint8_t* base = chain[0].data.data();
+    TextureFormat format = compress ? TextureCompression::chooseFormat(base, w, h, channels.components)
+                                    : TextureCompression::rawFormat(channels.components);
+
+    PendingTexture& texture = textures.emplace_back();
+    std::memset(&texture.record, 0, sizeof(texture.record));
+    texture.record.name = addString(name);
+    texture.record.width = width;
+    texture.record.height = height;
+    texture.record.components = static_cast<std::uint32_t>(channels.components);
+    texture.record.format = static_cast<std::uint32_t>(format);
+    texture.record.flags = channels.grey ? AssetPack::TEXTURE_GREY : 0;
+
+    for (const TextureLevel& level : chain) {
+        texture.levels.push_back(TextureCompression::encode(level, channels.components, format));
+    }
+    texture.record.levelCount = static_cast<std::uint32_t>(texture.levels.size());
+    return static_cast<std::uint32_t>(textures.size() - 1);
+}
+
+std::uint32_t AssetPackWriter::addMaterial(const std::string& name, AssetPack::MaterialRecord material) {
+    material.name = addString(name);
+    materials.push_back(material);
+    return static_cast<std::uint32_t>(materials.size() - 1);
+}
+
+std::uint32_t AssetPackWriter::addNode(const std::string& name, AssetPack::NodeRecord node) {
+    node.name = addString(name);
+    nodes.push_back(node);
+    return static_cast<std::uint32_t>(nodes.size() - 1);
+}
+
+bool AssetPackWriter::write(const std::string& path) const {
+
+    PROFILE_SCOPE("AssetPackWriter::write");
+
+    // --- 1. Lay out: header, record tables, then the bulk data each record points at ---
+    AssetPack::Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, AssetPack::MAGIC, sizeof(header.magic));
+    header.version = AssetPack::VERSION;
+    header.vertexFormat = static_cast<std::uint32_t>(vertexFormat);
+    header.meshCount = static_cast<std::uint32_t>(meshes.size());
+    header.textureCount = static_cast<std::uint32_t>(textures.size());
+    header.materialCount = static_cast<std::uint32_t>(materials.size());
+    header.nodeCount = static_cast<std::uint32_t>(nodes.size());
+
+    std::uint64_t offset = align(sizeof(header));
+    auto reserve = [&offset](std::uint64_t bytes) {
+        std::uint64_t start = offset;
+        offset = align(offset + bytes);
+        return start;
+    };
+
+    header.meshes = reserve(meshes.size() * sizeof(AssetPack::MeshRecord));
+    header.textures = reserve(textures.size() * sizeof(AssetPack::TextureRecord));
+    header.materials = reserve(materials.size() * sizeof(AssetPack::MaterialRecord));
+    header.nodes = reserve(nodes.size() * sizeof(AssetPack::NodeRecord));
+
+    std::vector<AssetPack::MeshRecord> meshRecords;
+    for (const auto& mesh : meshes) {
+        AssetPack::MeshRecord record = mesh.record;
+        record.vertices = reserve(mesh.vertices.size());
+        record.indices = reserve(mesh.indices.size());
+        record.subMeshes = reserve(mesh.subMeshes.size() * sizeof(AssetPack::SubMeshRecord));
+        record.lods = reserve(mesh.lods.size() * sizeof(MeshLOD));
+        meshRecords.push_back(record);
+    }
+    std::vector<AssetPack::TextureRecord> textureRecords;
+    std::vector<std::vector<AssetPack::LevelRecord>> levelRecords;
+    for (const auto& texture : textures) {
+        AssetPack::TextureRecord record = texture.record;
+        record.levels = reserve(texture.levels.size() * sizeof(AssetPack::LevelRecord));
+        std::vector<AssetPack::LevelRecord>& levels = levelRecords.emplace_back();
+        for (const TextureLevel& level : texture.levels) {
+            AssetPack::LevelRecord levelRecord;
+            levelRecord.data = reserve(level.data.size());
+            levelRecord.size = level.data.size();
+            levelRecord.width = static_cast<std::uint32_t>(level.width);
+            levelRecord.height = static_cast<std::uint32_t>(level.height);
+            levels.push_back(levelRecord);
+        }
+        textureRecords.push_back(record);
+    }
+    header.strings = reserve(strings.size());
+    header.fileSize = offset;
+
+    // --- 2. Fill one buffer and write it out ---
+    std::vector<std::uint8_t> bytes(header.fileSize, 0);
+    auto place = [&bytes](std::uint64_t at, const void* data, std::size_t size) {
+        if (size > 0) std::memcpy(bytes.data() + at, data, size);
+    };
+
+    place(0, &header, sizeof(header));
+    place(header.meshes, meshRecords.data(), meshRecords.size() * sizeof(AssetPack::MeshRecord));
+    place(header.textures, textureRecords.data(), textureRecords.size() * sizeof(AssetPack::TextureRecord));
+    place(header.materials, materials.data(), materials.size() * sizeof(AssetPack::MaterialRecord));
+    place(header.nodes, nodes.data(), nodes.size() * sizeof(AssetPack::NodeRecord));
+    for (std::size_t i = 0; i < meshes.size(); i++) {
+        place(meshRecords[i].vertices, meshes[i].vertices.data(), meshes[i].vertices.size());
+        place(meshRecords[i].indices, meshes[i].indices.data(), meshes[i].indices.size());
+        place(meshRecords[i].subMeshes, meshes[i].subMeshes.data(), meshes[i].subMeshes.size() * sizeof(AssetPack::SubMeshRecord));
+        place(meshRecords[i].lods, meshes[i].lods.data(), meshes[i].lods.size() * sizeof(MeshLOD));
+    }
+    for (std::size_t i = 0; i < textures.size(); i++) {
+        place(textureRecords[i].levels, levelRecords[i].data(), levelRecords[i].size() * sizeof(AssetPack::LevelRecord));
+        for (std::size_t l = 0; l < textures[i].levels.size(); l++) {
+            place(levelRecords[i][l].data, textures[i].levels[l].data.data(), textures[i].levels[l].data.size());
+        }
+    }
+    place(header.strings, strings.data(), strings.size());
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(out);
+}
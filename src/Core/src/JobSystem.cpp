@@ -0,0 +1,48 @@
+#include "JobSystem.hpp"
+#include <algorithm>
+
+JobSystem::JobSystem(std::size_t threadCount) {
+    if (threadCount == 0) {
+        //hardware_concurrency may report 0 when it cannot tell
+        threadCount = std::max<std::size_t>(1, std::thread::hardware_concurrency()) - 1;
+        threadCount = std::max<std::size_t>(1, threadCount);
+    }
+
+    workers.reserve(threadCount);
+    for (std::size_t i = 0; i < threadCount; i++) {
+        workers.emplace_back(&JobSystem::workerLoop, this);
+    }
+}
+
+JobSystem::~JobSystem() {
+    std::deque<std::function<void()>> dropped;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        dropped.swap(queue);
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) worker.join();
+}
+
+void JobSystem::enqueue(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(job));
+    }
+    wake.notify_one();
+}
+
+void JobSystem::workerLoop() {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return stopping || !queue.empty(); });
+            if (stopping) return;
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+        job();
+    }
+}
@@ -0,0 +1,255 @@
+#include "Profiler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+
+namespace {
+
+    thread_local std::uint32_t scopeDepth = 0;
+
+    double toMs(std::uint64_t ns) {
+        return static_cast<double>(ns) / 1.0e6;
+    }
+
+    //nearest-rank percentile over an already sorted sample set
+    std::uint64_t percentile(const std::vector<std::uint64_t>& sorted, double p) {
+        if (sorted.empty()) return 0;
+        size_t rank = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+        return sorted[std::min(rank, sorted.size() - 1)];
+    }
+
+    void writeEscaped(std::ostream& out, const char* text) {
+        for (const char* c = text; *c; ++c) {
+            if (*c == '"' || *c == '\\') out << '\\';
+            out << *c;
+        }
+    }
+}
+
+Profiler& Profiler::get() {
+    static Profiler instance;
+    return instance;
+}
+
+std::uint64_t Profiler::now() {
+    using namespace std::chrono;
+    return static_cast<std::uint64_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+Profiler::ThreadBuffer& Profiler::registerBuffer(const std::string& trackName) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto newBuffer = std::make_unique<ThreadBuffer>();
+    newBuffer->threadID = static_cast<std::uint32_t>(threadBuffers.size());
+    newBuffer->trackName = trackName.empty() ? "CPU " + std::to_string(newBuffer->threadID) : trackName;
+    newBuffer->ring.resize(RING_CAPACITY);
+    ThreadBuffer* buffer = newBuffer.get();
+    threadBuffers.push_back(std::move(newBuffer));
+    return *buffer;
+}
+
+Profiler::ThreadBuffer& Profiler::getThreadBuffer() {
+
+    //each thread registers its ring once, after that recording never takes the lock
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (!buffer) {
+        buffer = &registerBuffer("");
+    }
+    return *buffer;
+}
+
+void Profiler::record(const char* name, std::uint64_t startNs, std::uint64_t endNs, std::uint32_t depth) {
+    writeEvent(getThreadBuffer(), name, startNs, endNs, depth);
+}
+
+void Profiler::recordGpu(const char* name, std::uint64_t startNs, std::uint64_t endNs, std::uint32_t depth) {
+    if (!gpuBuffer) {
+        gpuBuffer = &registerBuffer("GPU");
+    }
+    writeEvent(*gpuBuffer, name, startNs, endNs, depth);
+}
+
+void Profiler::writeEvent(ThreadBuffer& buffer, const char* name, std::uint64_t startNs, std::uint64_t endNs, std::uint32_t depth) {
+
+    std::uint64_t index = buffer.writeIndex.load(std::memory_order_relaxed);
+
+    ProfileEvent& event = buffer.ring[index % RING_CAPACITY];
+    event.name = name;
+    event.startNs = startNs;
+    event.endNs = endNs;
+    event.threadID = buffer.threadID;
+    event.depth = depth;
+
+    //publish the slot only after it is fully written
+    buffer.writeIndex.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::endFrame() {
+
+    std::uint64_t frameNs = now();
+    if (lastFrameNs != 0) {
+        record("Frame", lastFrameNs, frameNs, 0);
+    }
+    lastFrameNs = frameNs;
+    frameIndex++;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (auto const& buffer : threadBuffers) {
+        std::uint64_t written = buffer->writeIndex.load(std::memory_order_acquire);
+        std::uint64_t first = buffer->drainIndex;
+
+        //the writer lapped us, the oldest events are already overwritten
+        if (written - first > RING_CAPACITY) {
+            first = written - RING_CAPACITY;
+        }
+
+        for (std::uint64_t i = first; i < written; i++) {
+            const ProfileEvent& event = buffer->ring[i % RING_CAPACITY];
+
+            //lookups go by literal address first so the drain does not build a string per event
+            ZoneWindow*& window = windowLookup[event.name];
+            if (!window) {
+                window = &zoneWindows[event.name];
+                window->durationsNs.reserve(SUMMARY_WINDOW);
+            }
+
+            std::uint64_t duration = event.endNs - event.startNs;
+            if (window->durationsNs.size() < SUMMARY_WINDOW) {
+                window->durationsNs.push_back(duration);
+            } else {
+                window->durationsNs[window->next] = duration;
+            }
+            window->next = (window->next + 1) % SUMMARY_WINDOW;
+        }
+
+        buffer->drainIndex = written;
+    }
+}
+
+std::vector<ZoneSummary> Profiler::getSummary() const {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::vector<ZoneSummary> summary;
+    summary.reserve(zoneWindows.size());
+
+    for (auto const& pair : zoneWindows) {
+        std::vector<std::uint64_t> sorted = pair.second.durationsNs;
+        if (sorted.empty()) continue;
+        std::sort(sorted.begin(), sorted.end());
+
+        ZoneSummary zone;
+        zone.name = pair.first;
+        zone.sampleCount = sorted.size();
+        zone.p50Ms = toMs(percentile(sorted, 0.50));
+        zone.p95Ms = toMs(percentile(sorted, 0.95));
+        zone.p99Ms = toMs(percentile(sorted, 0.99));
+        zone.maxMs = toMs(sorted.back());
+        summary.push_back(zone);
+    }
+
+    std::sort(summary.begin(), summary.end(), [](const ZoneSummary& a, const ZoneSummary& b) {
+        return a.p50Ms > b.p50Ms;
+    });
+
+    return summary;
+}
+
+void Profiler::printSummary(std::ostream& out) const {
+
+    out << std::left << std::setw(40) << "zone"
+        << std::right << std::setw(10) << "p50 ms"
+        << std::setw(10) << "p95 ms"
+        << std::setw(10) << "p99 ms"
+        << std::setw(10) << "max ms"
+        << std::setw(10) << "samples" << "\n";
+
+    out << std::fixed << std::setprecision(3);
+    for (auto const& zone : getSummary()) {
+        out << std::left << std::setw(40) << zone.name
+            << std::right << std::setw(10) << zone.p50Ms
+            << std::setw(10) << zone.p95Ms
+            << std::setw(10) << zone.p99Ms
+            << std::setw(10) << zone.maxMs
+            << std::setw(10) << zone.sampleCount << "\n";
+    }
+}
+
+bool Profiler::exportChromeTrace(const std::string& path) const {
+
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    //chrome://tracing and Perfetto expect microseconds for ts and dur
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    file << std::fixed << std::setprecision(3);
+
+    bool first = true;
+    for (auto const& buffer : threadBuffers) {
+
+        //metadata event so the viewer labels the track
+        if (!first) file << ",";
+        first = false;
+        file << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadID
+             << ",\"args\":{\"name\":\"";
+        writeEscaped(file, buffer->trackName.c_str());
+        file << "\"}}";
+
+        std::uint64_t written = buffer->writeIndex.load(std::memory_order_acquire);
+        std::uint64_t begin = written > RING_CAPACITY ? written - RING_CAPACITY : 0;
+
+        for (std::uint64_t i = begin; i < written; i++) {
+            const ProfileEvent& event = buffer->ring[i % RING_CAPACITY];
+
+            if (!first) file << ",";
+            first = false;
+
+            file << "\n{\"name\":\"";
+            writeEscaped(file, event.name);
+            file << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.threadID
+                 << ",\"ts\":" << static_cast<double>(event.startNs) / 1000.0
+                 << ",\"dur\":" << static_cast<double>(event.endNs - event.startNs) / 1000.0
+                 << ",\"args\":{\"depth\":" << event.depth << "}}";
+        }
+    }
+
+    file << "\n]}\n";
+    return file.good();
+}
+
+void Profiler::reset() {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (auto const& buffer : threadBuffers) {
+        buffer->drainIndex = 0;
+        buffer->writeIndex.store(0, std::memory_order_release);
+    }
+    zoneWindows.clear();
+    windowLookup.clear();
+    frameIndex = 0;
+    lastFrameNs = 0;
+}
+
+const char* Profiler::intern(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    //set nodes never move, so the pointer stays valid as more names are added
+    return internedNames.insert(name).first->c_str();
+}
+
+ProfileScope::ProfileScope(const char* name) : name(name), depth(scopeDepth++) {
+    startNs = Profiler::now();
+}
+
+ProfileScope::~ProfileScope() {
+    std::uint64_t endNs = Profiler::now();
+    scopeDepth--;
+    Profiler::get().record(name, startNs, endNs, depth);
+}
@@ -0,0 +1,27 @@
+#include "UploadQueue.hpp"
+#include "Profiler.hpp"
+
+void UploadQueue::push(std::function<void()> task) {
+    tasks.push_back(std::move(task));
+}
+
+std::size_t UploadQueue::process(double budgetMilliseconds) {
+
+    PROFILE_SCOPE("UploadQueue::process");
+
+    std::uint64_t start = Profiler::now();
+    std::uint64_t budgetNs = static_cast<std::uint64_t>(budgetMilliseconds * 1e6);
+
+    //only what was queued when the frame started, a task that queues another cannot loop here forever
+    std::size_t available = tasks.size();
+    std::size_t ran = 0;
+    while (ran < available) {
+        std::function<void()> task = std::move(tasks.front());
+        tasks.pop_front();
+        task();
+        ran++;
+
+        if (Profiler::now() - start >= budgetNs) break;
+    }
+    return ran;
+}
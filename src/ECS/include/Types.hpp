@@ -9,16 +9,25 @@
 #include <glm/gtc/quaternion.hpp>
 
 const std::uint8_t MAX_COMPONENTS = 32;
-const uint32_t MAX_ENTITIES = 5000;
+const uint32_t MAX_ENTITIES = 32768;
 
 using Entity = std::uint32_t;
 using AssetID = std::uint32_t;
+using MaterialID = std::uint32_t;
 using SpaceID = std::uint32_t;
+using SpaceMask = std::uint32_t;
 using ComponentTypeID = std::uint8_t;
 using ComponentTypeName = const char*;
 using Signature = std::bitset<MAX_COMPONENTS>;
 using ComponentOverrides = std::map<ComponentTypeID, std::any>;
 
+const Entity NULL_ENTITY = static_cast<Entity>(-1);
+
+//entities without a SpatialStateComponent live in the first space only
+const SpaceID DEFAULT_SPACE = 0;
+//renderable spaces, one bit each in a SpaceMask
+const SpaceID MAX_SPACES = 32;
+
 enum class PlayerAction {
     MOVE_FORWARD,
     MOVE_BACK,
@@ -36,12 +45,37 @@ struct TransformComponent {
     glm::vec3 front = {0.0f, 0.0f, -1.0f};
     glm::vec3 up = {0.0f, 1.0f, 0.0f};
     glm::vec3 right = {1.0f, 0.0f, 0.0f};
+
+    //position, rotation and scale are relative to this entity. Read when the entity joins the
+    //TransformSystem, change it afterwards with TransformSystem::setParent. Rigid bodies write
+    //world space values back, so entities with physics are expected to be roots
+    Entity parent = NULL_ENTITY;
+};
+
+// Cached world matrices, written by TransformSystem only when the TransformComponent is marked dirty
+struct WorldTransformComponent {
+    glm::mat4 model = glm::mat4(1.0f);
+    glm::mat3 normalMatrix = glm::mat3(1.0f);
 };
 
 struct MeshComponent {
     std::string meshName;
 };
 
+enum class LightType { POINT, DIRECTIONAL };
+
+// Light at the entity's world position, gathered by LightSystem. Directional lights shine along
+// the entity's front (local -Z) and ignore range
+struct LightComponent {
+    glm::vec3 color = {1.0f, 1.0f, 1.0f};
+    float intensity = 1.0f;
+    //distance at which the light fades out completely, smaller ranges touch fewer clusters
+    float range = 10.0f;
+    LightType type = LightType::POINT;
+    //point shadows take six atlas tiles each and only a few lights get them, nearest first
+    bool castShadows = false;
+};
+
 
 struct CameraComponent {
     glm::mat4 projectionMatrix;
@@ -80,8 +114,19 @@ struct InterspaceLinkProperties {
 struct SpatialStateComponent {
     InterspaceLinkProperties linkProperties;
     std::map<SpaceID, ComponentOverrides> instances;
+
+    //spaces the entity has an instance in, ids past MAX_SPACES are not rendered
+    SpaceMask spaceMask() const {
+        SpaceMask mask = 0;
+        for (auto const& [space, overrides] : instances) {
+            if (space < MAX_SPACES) mask |= SpaceMask(1) << space;
+        }
+        return mask;
+    }
 };
 
+// A portal into targetSpace. Rendered entities with this component draw the target space through
+// their mesh instead of the mesh itself, as seen from targetManifold's side
 struct SpatialManifoldComponent {
     enum class Type {STATIC_PORTAL, VIEW_DEPENDENT};
     Type type;
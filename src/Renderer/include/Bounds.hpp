@@ -0,0 +1,73 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+struct AABB {
+    glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+    glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+
+    bool isValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+    glm::vec3 center() const { return (min + max) * 0.5f; }
+    glm::vec3 extents() const { return (max - min) * 0.5f; }
+
+    void expand(const glm::vec3& point) {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    void expand(const AABB& other) {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+
+    bool contains(const AABB& other) const {
+        return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z &&
+               max.x >= other.max.x && max.y >= other.max.y && max.z >= other.max.z;
+    }
+
+    bool overlaps(const AABB& other) const {
+        return min.x <= other.max.x && max.x >= other.min.x &&
+               min.y <= other.max.y && max.y >= other.min.y &&
+               min.z <= other.max.z && max.z >= other.min.z;
+    }
+
+    float surfaceArea() const {
+        glm::vec3 size = max - min;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    static AABB merge(const AABB& a, const AABB& b) {
+        AABB result = a;
+        result.expand(b);
+        return result;
+    }
+
+    //bounds of the box after an affine transform, without transforming all eight corners
+    AABB transformed(const glm::mat4& transform) const;
+};
+
+enum class FrustumTest { OUTSIDE, INTERSECTS, INSIDE };
+
+struct Frustum {
+    // left, right, bottom, top, near, far; normals point inwards, xyz normalized
+    glm::vec4 planes[6];
+
+    //Gribb-Hartmann extraction from an OpenGL projection * view matrix
+    static Frustum fromMatrix(const glm::mat4& viewProjection);
+
+    static constexpr std::uint8_t ALL_PLANES = 0x3F;
+
+    FrustumTest test(const AABB& box) const { std::uint8_t planeMask = ALL_PLANES; return test(box, planeMask); }
+
+    //only tests the planes set in planeMask and clears the ones the box is fully inside of,
+    //so children of a box can skip planes their parent already passed
+    FrustumTest test(const AABB& box, std::uint8_t& planeMask) const;
+    bool intersects(const AABB& box) const { return test(box) != FrustumTest::OUTSIDE; }
+
+    //tests count boxes, writing 1 to visible[i] when box i is at least partially inside.
+    //Uses SSE on four boxes at a time when available.
+    void testBatch(const AABB* boxes, std::size_t count, std::uint8_t* visible) const;
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "GeometryArena.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class InstanceBuffer;
+class GLStateCache;
+
+// Layout fixed by GL for glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand {
+    std::uint32_t count;
+    std::uint32_t instanceCount;
+    std::uint32_t firstIndex;
+    std::int32_t baseVertex;
+    std::uint32_t baseInstance;
+};
+static_assert(sizeof(DrawElementsIndirectCommand) == 20, "DrawElementsIndirectCommand must match the GL layout");
+
+// Draw records for a whole frame, written once and uploaded in one call. With multi-draw
+// indirect a range of commands is one API call and baseInstance selects the instance data.
+// On 3.3 contexts the same commands are replayed one by one, moving the instance attribute
+// pointers instead, since base instance is not available there.
+class DrawCommandBuffer {
+
+    public:
+
+        DrawCommandBuffer();
+        ~DrawCommandBuffer();
+
+        DrawCommandBuffer(const DrawCommandBuffer&) = delete;
+        DrawCommandBuffer& operator=(const DrawCommandBuffer&) = delete;
+
+        void clear() { commands.clear(); }
+        void push(const DrawElementsIndirectCommand& command) { commands.push_back(command); }
+        std::size_t size() const { return commands.size(); }
+
+        //sends every pushed command to the GPU, call once after the last push of the frame
+        void upload();
+
+        //draws commands [first, first + count) from the bound VAO, all with the same index type.
+        //instances holds the frame's instance data with baseInstance counted from its start
+        void draw(std::size_t first, std::size_t count, IndexType indexType,
+                  const InstanceBuffer& instances, GLStateCache& stateCache) const;
+
+        bool isIndirect() const { return indirect; }
+
+    private:
+
+        std::vector<DrawElementsIndirectCommand> commands;
+        unsigned int buffer = 0;
+        std::size_t capacity = 0;
+        bool indirect = false;
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Bounds.hpp"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Incrementally updated AABB tree (after Box2D's b2DynamicTree, in 3D). Leaves store a fattened
+// box so small movements do not touch the tree; only proxies that leave their fat box are
+// reinserted. Internal nodes are kept balanced with AVL-style rotations.
+class DynamicBVH {
+
+    public:
+
+        static constexpr std::int32_t NULL_NODE = -1;
+
+        explicit DynamicBVH(float fatMargin = 0.1f);
+
+        std::int32_t createProxy(const AABB& aabb, std::uint32_t userData);
+        void destroyProxy(std::int32_t proxyID);
+
+        //returns true when the proxy had to be reinserted
+        bool moveProxy(std::int32_t proxyID, const AABB& aabb);
+
+        std::uint32_t getUserData(std::int32_t proxyID) const { return nodes[proxyID].userData; }
+        const AABB& getFatAABB(std::int32_t proxyID) const { return nodes[proxyID].aabb; }
+        std::size_t getProxyCount() const { return proxyCount; }
+        int getHeight() const { return root == NULL_NODE ? 0 : nodes[root].height; }
+
+        //appends the user data of every proxy whose fat box touches the frustum.
+        //Subtrees fully inside are accepted without further tests, leaves of partially
+        //visible subtrees are tested in SIMD batches.
+        void query(const Frustum& frustum, std::vector<std::uint32_t>& results);
+
+        //appends the user data of every proxy whose fat box overlaps the box
+        void query(const AABB& box, std::vector<std::uint32_t>& results);
+
+        void clear();
+
+    private:
+
+        struct Node {
+            AABB aabb;
+            std::int32_t parent = NULL_NODE;   // doubles as the free list link
+            std::int32_t child1 = NULL_NODE;
+            std::int32_t child2 = NULL_NODE;
+            std::int32_t height = -1;          // leaf = 0, free = -1
+            std::uint32_t userData = 0;
+
+            bool isLeaf() const { return child1 == NULL_NODE; }
+        };
+
+        std::int32_t allocateNode();
+        void freeNode(std::int32_t nodeID);
+        void insertLeaf(std::int32_t leaf);
+        void removeLeaf(std::int32_t leaf);
+        std::int32_t balance(std::int32_t nodeID);
+        void collectLeaves(std::int32_t nodeID, std::vector<std::uint32_t>& results);
+
+        std::vector<Node> nodes;
+        std::int32_t root = NULL_NODE;
+        std::int32_t freeList = NULL_NODE;
+        std::size_t proxyCount = 0;
+        float fatMargin;
+
+        // query scratch, kept between calls so steady-state queries do not allocate
+        std::vector<std::int32_t> stack;
+        std::vector<std::pair<std::int32_t, std::uint8_t>> frustumStack;
+        std::vector<AABB> candidateBoxes;
+        std::vector<std::uint32_t> candidateData;
+        std::vector<std::uint8_t> candidateVisible;
+};
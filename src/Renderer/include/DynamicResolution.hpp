@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+// Picks the fraction of the native resolution to render at from measured GPU frame times. The
+// scale drops as soon as a smoothed frame time goes over budget, straight to the step whose pixel
+// count should fit, and only climbs back one step at a time after a run of frames with headroom.
+// Scales are quantized to SCALE_STEP so the render target pool only ever sees a few sizes.
+class DynamicResolution {
+
+    public:
+
+        static constexpr float SCALE_STEP = 0.125f;
+        //frames to wait after a change, the new scale's timings are a few frames late
+        static constexpr std::uint32_t SETTLE_FRAMES = 8;
+        //consecutive frames under the headroom needed before going up a step
+        static constexpr std::uint32_t RAISE_FRAMES = 60;
+
+        DynamicResolution(float budgetMilliseconds = 14.0f, float minScale = 0.5f, float maxScale = 1.0f);
+
+        void setBudget(float milliseconds) { this->budgetMilliseconds = milliseconds; }
+        void setScaleRange(float minScale, float maxScale);
+
+        //feeds one frame's GPU time, returns true when the scale changed
+        bool update(float gpuMilliseconds);
+
+        float getScale() const { return scale; }
+        float getSmoothedMilliseconds() const { return smoothedMilliseconds; }
+
+    private:
+
+        float quantize(float value) const;
+
+        float budgetMilliseconds;
+        float minScale;
+        float maxScale;
+        float scale;
+        float smoothedMilliseconds = 0.0f;
+        std::uint32_t settleFrames = 0;
+        std::uint32_t headroomFrames = 0;
+};
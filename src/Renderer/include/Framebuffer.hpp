@@ -1,17 +1,38 @@
 #pragma once
 
+#include "RenderTargetPool.hpp"
+
+// HDR color plus depth-stencil, both taken from a RenderTargetPool so resizing to a size used
+// recently reattaches existing targets instead of allocating new ones
 class Framebuffer {
 public:
 
     unsigned int FBO;
     unsigned int textureColorBuffer;
 
-    Framebuffer(int width, int height);
+    //the pool must outlive the framebuffer
+    Framebuffer(RenderTargetPool& pool, int width, int height);
     ~Framebuffer();
 
+    Framebuffer(const Framebuffer&) = delete;
+    Framebuffer& operator=(const Framebuffer&) = delete;
+
+    //swaps in attachments of the new size, does nothing when the size is unchanged
+    void resize(int width, int height);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    //also sets the viewport to the framebuffer's size
     void bind();
     void unbind();
 
 private:
-    unsigned int RBO;
-};
\ No newline at end of file
+    void attach();
+
+    RenderTargetPool& pool;
+    RenderTarget color;
+    RenderTarget depthStencil;
+    int width = 0;
+    int height = 0;
+};
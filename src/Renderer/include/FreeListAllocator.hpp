@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+
+// Hands out ranges of a linear resource (buffer elements, not bytes). Free blocks are kept by
+// offset for coalescing and by size for best-fit lookup, so both allocate and release are
+// O(log n) in the number of free blocks. No GL calls, the owner maps offsets onto its buffers.
+class FreeListAllocator {
+
+    public:
+
+        static constexpr std::uint32_t INVALID_OFFSET = ~0u;
+
+        explicit FreeListAllocator(std::uint32_t capacity = 0);
+
+        //returns the offset of a block of exactly size elements, or INVALID_OFFSET if none fits
+        std::uint32_t allocate(std::uint32_t size);
+
+        //offset must come from allocate, neighbouring free blocks are merged
+        void release(std::uint32_t offset);
+
+        //extends the range at the end, existing offsets stay valid
+        void grow(std::uint32_t newCapacity);
+
+        std::uint32_t getCapacity() const { return capacity; }
+        std::uint32_t getUsed() const { return used; }
+        std::uint32_t getLargestFreeBlock() const;
+        std::size_t getFreeBlockCount() const { return freeByOffset.size(); }
+        std::size_t getAllocationCount() const { return allocations.size(); }
+
+    private:
+
+        using SizeIndex = std::multimap<std::uint32_t, std::uint32_t>;
+
+        void insertFree(std::uint32_t offset, std::uint32_t size);
+        void eraseFree(std::map<std::uint32_t, std::uint32_t>::iterator block);
+
+        std::uint32_t capacity = 0;
+        std::uint32_t used = 0;
+
+        //offset -> size
+        std::map<std::uint32_t, std::uint32_t> freeByOffset;
+        //size -> offset
+        SizeIndex freeBySize;
+        std::unordered_map<std::uint32_t, std::uint32_t> allocations;
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+// Entry points newer than the 3.3 core profile glad was generated for. They are looked up after
+// the context exists and only used when the driver reports support, callers keep a 3.3 path.
+namespace GLExtensions {
+
+    using LoadProc = void* (*)(const char* name);
+
+    //call once after gladLoadGLLoader with the same loader
+    void load(LoadProc loadProc);
+
+    //GL 4.3 or ARB_multi_draw_indirect
+    bool hasMultiDrawIndirect();
+
+    //EXT_texture_compression_s3tc, BC1 and BC3 uploads. BC4 and BC5 are RGTC, core since 3.0
+    bool hasS3TC();
+
+    //glMultiDrawElementsIndirect, commands are read from the bound GL_DRAW_INDIRECT_BUFFER
+    void multiDrawElementsIndirect(unsigned int mode, unsigned int type, const void* indirect, int drawCount, int stride);
+}
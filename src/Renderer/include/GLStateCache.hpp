@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Per-frame counters for state changes that reached the driver and ones the cache filtered out
+struct GLStateStats {
+    std::uint64_t programBinds = 0;
+    std::uint64_t vertexArrayBinds = 0;
+    std::uint64_t textureBinds = 0;
+    std::uint64_t bufferRangeBinds = 0;
+    std::uint64_t redundantBinds = 0;
+    std::uint64_t draws = 0;
+
+    std::uint64_t binds() const { return programBinds + vertexArrayBinds + textureBinds + bufferRangeBinds; }
+};
+
+// Shadow copy of the GL binding state the renderer touches per draw. Binds that match the
+// shadow are dropped before reaching the driver. Code that changes these bindings behind the
+// cache's back (framebuffers, post processing) must call invalidate() afterwards.
+class GLStateCache {
+
+    public:
+
+        static constexpr unsigned int MAX_TEXTURE_UNITS = 16;
+        static constexpr unsigned int MAX_UNIFORM_BUFFERS = 8;
+
+        GLStateCache() { invalidate(); }
+
+        void useProgram(unsigned int program);
+        void bindVertexArray(unsigned int vertexArray);
+        void bindTexture2D(unsigned int unit, unsigned int texture);
+        void bindUniformBufferRange(unsigned int bindingPoint, unsigned int buffer, std::size_t offset, std::size_t size);
+
+        void countDraw() { stats.draws++; }
+
+        //forgets every cached binding, the next bind of each kind always reaches GL
+        void invalidate();
+
+        const GLStateStats& getStats() const { return stats; }
+        void resetStats() { stats = GLStateStats{}; }
+
+    private:
+
+        static constexpr unsigned int UNKNOWN = ~0u;
+
+        struct BufferRange {
+            unsigned int buffer = UNKNOWN;
+            std::size_t offset = 0;
+            std::size_t size = 0;
+        };
+
+        unsigned int program = UNKNOWN;
+        unsigned int vertexArray = UNKNOWN;
+        unsigned int activeTextureUnit = UNKNOWN;
+        std::array<unsigned int, MAX_TEXTURE_UNITS> textures;
+        std::array<BufferRange, MAX_UNIFORM_BUFFERS> uniformBuffers;
+
+        GLStateStats stats;
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "FreeListAllocator.hpp"
+#include <cstddef>
+#include <cstdint>
+
+enum class VertexFormat {
+    FULL,   //Vertex, 32 bytes
+    PACKED  //PackedVertex, 16 bytes with quantized positions
+};
+
+enum class IndexType {
+    UINT16,
+    UINT32
+};
+
+// Where a mesh lives inside the arena, in vertices and indices rather than bytes
+struct GeometryRange {
+    std::uint32_t baseVertex = 0;
+    std::uint32_t vertexCount = 0;
+    //in units of indexType, ready for the draw's firstIndex
+    std::uint32_t firstIndex = 0;
+    std::uint32_t indexCount = 0;
+    IndexType indexType = IndexType::UINT32;
+
+    //allocator offset in 16-bit slots, only the arena reads it
+    std::uint32_t indexSlot = 0;
+};
+
+// All static geometry in one VAO backed by one vertex and one index buffer. Meshes get
+// suballocated ranges and draw with a base vertex, so switching meshes is no longer a VAO bind
+// and small meshes do not each cost three GL objects. Full buffers are grown by copying into a
+// larger one on the GPU, which keeps every existing range valid.
+//
+// Every vertex in an arena has the same format. The index buffer is managed in 16-bit slots and
+// every allocation is an even number of slots, so 16 and 32-bit meshes share it and 32-bit ranges
+// stay aligned. Draws must still use the range's index type.
+class GeometryArena {
+
+    public:
+
+        GeometryArena(VertexFormat format = VertexFormat::PACKED,
+                      std::uint32_t initialVertices = 1 << 16,
+                      std::uint32_t initialIndices = 1 << 18);
+        ~GeometryArena();
+
+        GeometryArena(const GeometryArena&) = delete;
+        GeometryArena& operator=(const GeometryArena&) = delete;
+
+        //vertices are in the arena's format, indices in indexType and relative to the first vertex
+        GeometryRange allocate(const void* vertices, std::uint32_t vertexCount,
+                               const void* indices, std::uint32_t indexCount, IndexType indexType);
+        void release(const GeometryRange& range);
+
+        unsigned int getVAO() const { return VAO; }
+        //same buffers with only positions and instance matrices enabled, for depth-only passes
+        unsigned int getDepthVAO() const { return depthVAO; }
+        VertexFormat getFormat() const { return format; }
+        std::size_t getVertexStride() const;
+
+        std::uint32_t getVertexCapacity() const { return vertexAllocator.getCapacity(); }
+        std::uint32_t getVerticesUsed() const { return vertexAllocator.getUsed(); }
+        std::size_t getIndexBytes() const { return indexAllocator.getCapacity() * sizeof(std::uint16_t); }
+        std::size_t getIndexBytesUsed() const { return indexAllocator.getUsed() * sizeof(std::uint16_t); }
+
+    private:
+
+        //reserves count elements, growing the buffer when no free block is large enough
+        std::uint32_t reserve(FreeListAllocator& allocator, unsigned int& buffer,
+                              std::size_t elementSize, std::uint32_t count);
+        //(re)points a VAO at the current buffers, the depth VAO only fetches positions
+        void setupVertexArray(unsigned int vertexArray, bool positionOnly);
+
+        VertexFormat format;
+        FreeListAllocator vertexAllocator;
+        FreeListAllocator indexAllocator;
+
+        unsigned int VAO = 0;
+        unsigned int depthVAO = 0;
+        unsigned int VBO = 0;
+        unsigned int EBO = 0;
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Times GPU work with GL_TIMESTAMP query pairs. Results are read back FRAME_LATENCY frames
+// later so the CPU never waits on the GPU, then forwarded to Profiler::recordGpu.
+class GpuProfiler {
+
+    public:
+
+        static constexpr std::size_t FRAME_LATENCY = 4;
+        static constexpr std::size_t MAX_ZONES_PER_FRAME = 128;
+
+        GpuProfiler();
+        ~GpuProfiler();
+
+        GpuProfiler(const GpuProfiler&) = delete;
+        GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+        //collects the oldest frame in the ring and starts recording into its slot
+        void beginFrame();
+
+        void beginZone(const char* name);
+        void endZone();
+
+        //zones that can still be recorded this frame, nested inside the ones open now
+        std::size_t getFreeZones() const;
+
+        bool isSupported() const { return supported; }
+        std::uint64_t getDroppedFrames() const { return droppedFrames; }
+
+    private:
+
+        struct Zone {
+            const char* name;
+            std::uint32_t depth;
+            std::uint32_t startQuery;
+            std::uint32_t endQuery;
+        };
+
+        struct Frame {
+            std::vector<unsigned int> queries;
+            std::vector<Zone> zones;
+            std::uint32_t usedQueries = 0;
+            bool pending = false;
+        };
+
+        void collect(Frame& frame);
+
+        std::array<Frame, FRAME_LATENCY> frames;
+        std::vector<std::size_t> openZones;
+        //end queries the open, recorded zones still need, kept free so every one of them can close
+        std::uint32_t reservedQueries = 0;
+        std::size_t currentFrame = 0;
+        std::uint64_t frameCount = 0;
+        std::uint64_t droppedFrames = 0;
+
+        //GPU timestamps live in their own clock domain, this maps them onto Profiler::now()
+        std::int64_t gpuToCpuOffsetNs = 0;
+        bool supported = false;
+};
+
+class GpuProfileScope {
+
+    public:
+
+        GpuProfileScope(GpuProfiler* profiler, const char* name) : profiler(profiler) {
+            if (profiler) profiler->beginZone(name);
+        }
+        ~GpuProfileScope() {
+            if (profiler) profiler->endZone();
+        }
+
+        GpuProfileScope(const GpuProfileScope&) = delete;
+        GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+
+    private:
+
+        GpuProfiler* profiler;
+};
+
+#if defined(SUPERPOSITION_PROFILING) && SUPERPOSITION_PROFILING
+    #define GPU_PROFILE_CONCAT_INNER(a, b) a##b
+    #define GPU_PROFILE_CONCAT(a, b) GPU_PROFILE_CONCAT_INNER(a, b)
+    #define GPU_PROFILE_SCOPE(profiler, name) GpuProfileScope GPU_PROFILE_CONCAT(gpuProfileScope_, __LINE__)(profiler, name)
+#else
+    #define GPU_PROFILE_SCOPE(profiler, name) ((void)0)
+#endif
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <array>
+#include <cstddef>
+
+// Per-instance vertex attributes, read by pbr.vert at locations 3-6 (model) and 7-9 (normal matrix)
+struct InstanceData {
+    glm::mat4 model;
+    glm::mat3 normalMatrix;
+};
+
+// Streams per-instance data through one vertex buffer split into FRAMES_IN_FLIGHT segments.
+// Each frame maps its own segment unsynchronized and fences it afterwards, so the CPU only
+// waits if it gets more than FRAMES_IN_FLIGHT frames ahead of the GPU. Persistent mapping
+// needs GL 4.4, which the 3.3 core context does not guarantee.
+class InstanceBuffer {
+
+    public:
+
+        static constexpr std::size_t FRAMES_IN_FLIGHT = 3;
+        static constexpr unsigned int FIRST_ATTRIBUTE = 3;
+
+        InstanceBuffer(std::size_t initialCapacity = 1024);
+        ~InstanceBuffer();
+
+        InstanceBuffer(const InstanceBuffer&) = delete;
+        InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+
+        //returns a write-only pointer to room for instanceCount instances, valid until unmap()
+        InstanceData* map(std::size_t instanceCount);
+        void unmap();
+
+        //fences the current segment, call after the last draw that reads from it
+        void endFrame();
+
+        //enables the instanced attributes on the bound VAO, done once per VAO
+        static void enableAttributes();
+
+        //points the bound VAO's instanced attributes at firstInstance of the current segment
+        void bindAttributes(std::size_t firstInstance) const;
+
+    private:
+
+        void allocate(std::size_t capacity);
+        void waitForSegment(std::size_t segment);
+
+        unsigned int VBO = 0;
+        std::size_t capacity = 0;
+        std::size_t currentSegment = 0;
+        std::size_t frameCount = 0;
+        std::array<void*, FRAMES_IN_FLIGHT> fences{};
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "LightClusters.hpp"
+#include <cstddef>
+#include <vector>
+
+// The lights and their cluster lists as three buffer textures, re-specified every frame.
+// pbr.frag reads them with texelFetch since GL 3.3 has no shader storage buffers.
+class LightBuffer {
+
+    public:
+
+        //units FIRST_TEXTURE_UNIT to FIRST_TEXTURE_UNIT + 2: lights, cluster ranges, light indices
+        static constexpr unsigned int FIRST_TEXTURE_UNIT = 1;
+
+        LightBuffer();
+        ~LightBuffer();
+
+        LightBuffer(const LightBuffer&) = delete;
+        LightBuffer& operator=(const LightBuffer&) = delete;
+
+        void upload(const std::vector<PointLight>& lights, const LightClusterGrid& grid);
+
+        //binds outside the GLStateCache, invalidate the cache afterwards
+        void bind() const;
+
+    private:
+
+        struct TextureBuffer {
+            unsigned int buffer = 0;
+            unsigned int texture = 0;
+        };
+
+        static void write(const TextureBuffer& target, const void* data, std::size_t bytes);
+
+        TextureBuffer lightData;
+        TextureBuffer clusterData;
+        TextureBuffer indexData;
+};
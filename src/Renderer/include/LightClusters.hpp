@@ -0,0 +1,100 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One point light as pbr.frag reads it, two RGBA32F texels of the light buffer
+struct PointLight {
+    glm::vec3 position;
+    //the light has no effect past this distance, which is what lets it be clustered
+    float range;
+    //already multiplied by the intensity
+    glm::vec3 color;
+    //slot in the point shadow atlas, its cube faces are tiles slot * 6 to slot * 6 + 5. Negative without shadows
+    float shadowSlot = -1.0f;
+};
+static_assert(sizeof(PointLight) == 32, "PointLight must match the two texels pbr.frag reads per light");
+
+// Lights of one cluster, a run of lightIndices
+struct ClusterRange {
+    std::uint32_t offset;
+    std::uint32_t count;
+};
+
+struct LightClusterStats {
+    std::uint64_t lights = 0;
+    std::uint64_t assignedLights = 0;
+    std::uint64_t indices = 0;
+    std::uint64_t maxPerCluster = 0;
+    //light references dropped because their cluster was full
+    std::uint64_t overflow = 0;
+};
+
+// Splits the view frustum into TILES_X * TILES_Y screen tiles and SLICES exponential depth slices,
+// and lists the lights whose range touches each of these froxels. Per slice, a light is tested
+// against the view space bounds of the froxels its section projects onto, four at a time with SSE.
+class LightClusterGrid {
+
+    public:
+
+        //pbr.frag declares the same grid, keep both in sync
+        static constexpr std::uint32_t TILES_X = 16;
+        static constexpr std::uint32_t TILES_Y = 9;
+        static constexpr std::uint32_t SLICES = 24;
+        static constexpr std::uint32_t CLUSTER_COUNT = TILES_X * TILES_Y * SLICES;
+        static constexpr std::uint32_t MAX_LIGHTS_PER_CLUSTER = 128;
+
+        //indices are uploaded as 16 bits
+        static constexpr std::size_t MAX_LIGHTS = 65535;
+
+        LightClusterGrid();
+
+        //rebuilds the froxel bounds, only when the perspective projection actually changed
+        void setProjection(const glm::mat4& projection);
+
+        //lights beyond MAX_LIGHTS are ignored
+        void assign(const PointLight* lights, std::size_t count, const glm::mat4& view);
+
+        const std::vector<ClusterRange>& getClusters() const { return clusters; }
+        const std::vector<std::uint16_t>& getLightIndices() const { return lightIndices; }
+        const LightClusterStats& getStats() const { return stats; }
+
+        static std::uint32_t clusterIndex(std::uint32_t x, std::uint32_t y, std::uint32_t slice) {
+            return x + TILES_X * (y + TILES_Y * slice);
+        }
+
+        //slice = log(viewDepth) * depthScale - depthBias, what pbr.frag evaluates per fragment
+        float getDepthScale() const { return depthScale; }
+        float getDepthBias() const { return depthBias; }
+        std::int32_t sliceForDepth(float viewDepth) const;
+
+        float getNearPlane() const { return nearPlane; }
+        float getFarPlane() const { return farPlane; }
+
+    private:
+
+        void buildClusterBounds();
+
+        glm::mat4 projection = glm::mat4(0.0f);
+        float nearPlane = 0.1f;
+        float farPlane = 100.0f;
+        float depthScale = 0.0f;
+        float depthBias = 0.0f;
+
+        //view depth where each slice starts, SLICES + 1 entries ending at the far plane
+        std::vector<float> sliceDepths;
+
+        //view space froxel bounds in SoA, padded by three entries so four-wide loads never run off the end
+        std::vector<float> minX, minY, minZ;
+        std::vector<float> maxX, maxY, maxZ;
+
+        //(cluster, light) pairs found this frame, bucketed into lightIndices by a counting sort
+        std::vector<std::uint32_t> pairClusters;
+        std::vector<std::uint16_t> pairLights;
+
+        std::vector<ClusterRange> clusters;
+        std::vector<std::uint16_t> lightIndices;
+        LightClusterStats stats;
+};
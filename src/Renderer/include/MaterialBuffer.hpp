@@ -0,0 +1,45 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class GLStateCache;
+
+// Mirrors the std140 MaterialBlock in pbr.frag, keep both in sync
+struct GpuMaterial {
+    glm::vec4 albedoFactor = glm::vec4(1.0f);
+    glm::vec4 emissiveFactor = glm::vec4(0.0f);
+    float metallicFactor = 1.0f;
+    float roughnessFactor = 1.0f;
+    std::int32_t doubleSided = 0;
+    float padding = 0.0f;
+};
+static_assert(sizeof(GpuMaterial) == 48, "GpuMaterial must match the std140 MaterialBlock layout");
+
+// Every loaded material packed into one uniform buffer, a draw selects its material with a range bind
+class MaterialBuffer {
+
+    public:
+
+        static constexpr unsigned int BINDING_POINT = 0;
+
+        MaterialBuffer();
+        ~MaterialBuffer();
+
+        MaterialBuffer(const MaterialBuffer&) = delete;
+        MaterialBuffer& operator=(const MaterialBuffer&) = delete;
+
+        //replaces the whole buffer, entries are padded to the driver's uniform offset alignment
+        void upload(const std::vector<GpuMaterial>& materials);
+        void bind(std::uint32_t materialIndex, GLStateCache& stateCache) const;
+
+        std::size_t getStride() const { return stride; }
+
+    private:
+
+        unsigned int UBO;
+        std::size_t stride;
+        std::size_t count = 0;
+};
@@ -4,54 +4,106 @@
 #include <string>
 #include <vector>
 #include <memory>
-#include <glm/gtx/hash.hpp>
 #include <tiny_gltf.h> 
+#include "Types.hpp"
+#include "Bounds.hpp"
+#include "GeometryArena.hpp"
+#include "MeshLOD.hpp"
+#include "Vertex.hpp"
 
-class Shader;
-class AssetManager;
-
-struct Vertex {
-    glm::vec3 Position;
-    glm::vec3 Normal;
-    glm::vec2 TexCoords;
-
-    bool operator==(const Vertex& other) const {
-        return Position == other.Position && Normal == other.Normal && TexCoords == other.TexCoords;
-    }
-};
 
 struct SubMesh {
-    std::string materialName;
+    MaterialID materialID = 0;
     unsigned int indexCount;
-    unsigned int indexOffset; 
+    //first index and the vertex its indices are relative to, both absolute in the geometry arena
+    //once the mesh is constructed
+    unsigned int indexOffset;
+    int baseVertex = 0;
 };
 
 
-namespace std {
-    template<> struct hash<Vertex> {
-        size_t operator()(Vertex const& vertex) const {
-            return ((hash<glm::vec3>()(vertex.Position) ^
-                   (hash<glm::vec3>()(vertex.Normal) << 1)) >> 1) ^
-                   (hash<glm::vec2>()(vertex.TexCoords) << 1);
-        }
-    };
-}
+// Import time processing for CreateFromGLTF
+struct MeshImportOptions {
+    //keeps Mesh::vertices and indices after upload, off unless something reads them on the CPU
+    bool keepCPUData = false;
+    bool generateLODs = true;
+    //including LOD 0, each level aims for half the triangles of the one before
+    std::uint32_t maxLODs = 4;
+    //simplification stops once the error would pass this fraction of the primitive's bounds diagonal
+    float maxLODError = 0.05f;
+};
+
+// What importing a glTF mesh produces before anything touches GL, so it can be built on a worker
+// thread and handed to the Mesh constructor on the render thread
+struct MeshData {
+    std::vector<Vertex>       vertices;
+    std::vector<unsigned int> indices;
+    std::vector<SubMesh>      subMeshes;
+    std::vector<MeshLOD>      lods;
+};
 
 class Mesh {
     public:
-        // Mesh Data
+        // Mesh Data, vertices and indices are empty after upload unless the mesh keeps its CPU copy
         std::vector<Vertex>       vertices;
         std::vector<unsigned int> indices;
         std::vector<SubMesh>      subMeshes; 
-        unsigned int VAO;
 
-        Mesh(std::vector<Vertex>&& vertices, std::vector<unsigned int>&& indices, std::vector<SubMesh>&& subMeshes);
-        void draw(Shader& shader, AssetManager& assetManager);
+        //at least one entry, LOD l draws subMeshes [lods[l].firstSubMesh, firstSubMesh + getPrimitiveCount())
+        std::vector<MeshLOD>      lods;
+
+        //stable small integer used to group draws, unlike the name it is cheap to sort on
+        std::uint32_t id;
+
+        //object space bounds of every vertex, used for culling
+        AABB bounds;
+
+        //maps the arena's stored positions to object space, identity unless the arena is packed.
+        //Renderers multiply it onto the model matrix, normals are unaffected
+        glm::mat4 positionTransform = glm::mat4(1.0f);
+        bool quantized = false;
+
+        //submesh offsets are relative to these vertices and indices, the arena range is added here.
+        //Meshes under 65536 vertices upload 16-bit indices. Without lods every submesh is LOD 0
+        Mesh(std::vector<Vertex>&& vertices, std::vector<unsigned int>&& indices, std::vector<SubMesh>&& subMeshes,
+             std::shared_ptr<GeometryArena> arena, bool keepCPUData = false, std::vector<MeshLOD>&& lods = {});
+        //baked geometry already in the arena's vertex format and final index width, uploaded straight
+        //from wherever it points. Nothing is kept on the CPU
+        Mesh(const void* vertices, std::uint32_t vertexCount, const void* indices, std::uint32_t indexCount, IndexType indexType,
+             std::vector<SubMesh>&& subMeshes, std::vector<MeshLOD>&& lods, const AABB& bounds,
+             const glm::mat4& positionTransform, bool quantized, std::shared_ptr<GeometryArena> arena);
+        ~Mesh();
+
+        Mesh(const Mesh&) = delete;
+        Mesh& operator=(const Mesh&) = delete;
+
+        //the VAO shared by every mesh in the same arena
+        unsigned int getVAO() const { return arena->getVAO(); }
+        unsigned int getDepthVAO() const { return arena->getDepthVAO(); }
+        const GeometryRange& getRange() const { return range; }
+        IndexType getIndexType() const { return range.indexType; }
+        std::size_t getPrimitiveCount() const { return subMeshes.size() / lods.size(); }
         
-        static std::shared_ptr<Mesh> CreateFromGLTF(const tinygltf::Model& model, const tinygltf::Mesh& gltfMesh);
+        //reads, optimizes and simplifies the mesh's primitives without any GL calls, safe on any thread
+        //as long as the model is not modified meanwhile
+        static MeshData ProcessGLTF(const tinygltf::Model& model, const tinygltf::Mesh& gltfMesh, MaterialID firstMaterial,
+                                   const MeshImportOptions& options = {});
+        static std::shared_ptr<Mesh> Create(MeshData&& data, std::shared_ptr<GeometryArena> arena, bool keepCPUData = false);
+
+        //firstMaterial is the MaterialID the asset manager gave to the model's material 0
+        static std::shared_ptr<Mesh> CreateFromGLTF(const tinygltf::Model& model, const tinygltf::Mesh& gltfMesh,
+                                                    MaterialID firstMaterial, std::shared_ptr<GeometryArena> arena,
+                                                    const MeshImportOptions& options = {});
 
     private:
-        unsigned int VBO, EBO;
-        void setupMesh();
-        
+        //primitives this small are drawn at full detail at every distance
+        static constexpr std::size_t MIN_LOD_TRIANGLES = 64;
+
+        void upload();
+        //makes the submeshes absolute in the arena once the range is known
+        void offsetSubMeshes();
+
+        //shared so the arena outlives every mesh still referenced by a system
+        std::shared_ptr<GeometryArena> arena;
+        GeometryRange range;
 };
\ No newline at end of file
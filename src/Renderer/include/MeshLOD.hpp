@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// One level of detail: a run of submeshes, one per glTF primitive, sharing the mesh's vertices
+struct MeshLOD {
+    std::uint32_t firstSubMesh = 0;
+    //largest object space deviation from LOD 0, zero for LOD 0 itself
+    float error = 0.0f;
+};
+
+namespace LODSelection {
+
+    //coarsest LOD whose error projects to at most thresholdPixels. pixelsPerUnit is the
+    //projected size of one object space unit at the instance's distance. Moving to a coarser
+    //LOD needs the error to fit (1 - hysteresis) of the threshold, moving back to a finer one
+    //happens as soon as the threshold is crossed, so instances near a boundary do not flicker
+    std::uint32_t select(const MeshLOD* lods, std::size_t lodCount, std::uint32_t currentLOD,
+                         float pixelsPerUnit, float thresholdPixels, float hysteresis);
+}
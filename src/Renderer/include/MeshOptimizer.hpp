@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Vertex.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Vertex counts and average cache miss ratio (transformed vertices per triangle) before and after
+struct MeshOptimizationReport {
+    std::size_t verticesBefore = 0;
+    std::size_t verticesAfter = 0;
+    std::size_t triangles = 0;
+    float acmrBefore = 0.0f;
+    float acmrAfter = 0.0f;
+};
+
+// Import time reordering of indexed triangle lists. Every pass keeps the set of triangles and
+// their winding, only the order of triangles and vertices changes. Indices are local to the
+// vertex array they are given, the way CreateFromGLTF keeps them per primitive.
+namespace MeshOptimizer {
+
+    //size of the simulated post-transform cache, close to what current GPUs reuse in practice
+    constexpr unsigned int CACHE_SIZE = 16;
+
+    //merges bitwise identical vertices, returns how many were removed
+    std::size_t weldVertices(std::vector<Vertex>& vertices, std::vector<std::uint32_t>& indices);
+
+    //Forsyth's linear-speed vertex cache optimisation
+    void optimizeVertexCache(std::vector<std::uint32_t>& indices, std::size_t vertexCount);
+
+    //splits a cache-ordered list where the cache goes cold and sorts the pieces so outward facing
+    //ones come first, which lets early depth reject more of the rest. Run after optimizeVertexCache
+    void optimizeOverdraw(std::vector<std::uint32_t>& indices, const std::vector<Vertex>& vertices);
+
+    //renumbers vertices in first-use order and drops unreferenced ones
+    void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<std::uint32_t>& indices);
+
+    //FIFO cache simulation, 3.0 is the worst and about 0.5 the best a regular grid can reach
+    float computeACMR(const std::vector<std::uint32_t>& indices, std::size_t vertexCount, unsigned int cacheSize = CACHE_SIZE);
+
+    //all passes in order
+    MeshOptimizationReport optimize(std::vector<Vertex>& vertices, std::vector<std::uint32_t>& indices);
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Vertex.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Quadric error edge collapse (Garland and Heckbert) that only ever collapses a vertex onto one
+// of its neighbours. The result is a new index list over the same vertices, so every LOD of a
+// mesh can share one vertex range. Vertices on open borders, attribute seams and non-manifold
+// edges never move, which keeps silhouettes closed and UV seams intact.
+namespace MeshSimplifier {
+
+    //stops at targetIndexCount indices or before the first collapse whose error would exceed
+    //maxError. Errors are object space distances, resultError receives the largest one applied
+    std::vector<std::uint32_t> simplify(const std::vector<Vertex>& vertices,
+                                        const std::vector<std::uint32_t>& indices,
+                                        std::size_t targetIndexCount,
+                                        float maxError,
+                                        float* resultError = nullptr);
+}
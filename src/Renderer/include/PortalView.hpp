@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Bounds.hpp"
+#include <glm/glm.hpp>
+
+// Screen region in NDC, used to bound what a portal can show
+struct ScreenRect {
+    glm::vec2 min = glm::vec2(-1.0f);
+    glm::vec2 max = glm::vec2(1.0f);
+
+    bool isEmpty() const { return min.x >= max.x || min.y >= max.y; }
+    //fraction of the whole screen covered, the NDC square has an area of 4
+    float area() const { return isEmpty() ? 0.0f : (max.x - min.x) * (max.y - min.y) * 0.25f; }
+
+    static ScreenRect intersect(const ScreenRect& a, const ScreenRect& b) {
+        return ScreenRect{glm::max(a.min, b.min), glm::min(a.max, b.max)};
+    }
+};
+
+// Camera math for looking through a SpatialManifoldComponent. A manifold's surface faces its
+// local +Z, and a pair of manifolds is glued frame to frame: whatever lies behind the target
+// manifold shows up behind the source one, so a doorway pair has its target turned 180 degrees.
+namespace PortalView {
+
+    //view of the target space as seen through the source manifold
+    glm::mat4 throughPortal(const glm::mat4& view, const glm::mat4& sourceModel, const glm::mat4& targetModel);
+
+    //true when the camera is on the side the manifold's surface faces
+    bool facesCamera(const glm::mat4& model, const glm::vec3& cameraPosition);
+
+    //view space plane of the target manifold's surface, oriented so what lies behind it is on the positive side
+    glm::vec4 clipPlane(const glm::mat4& view, const glm::mat4& targetModel);
+
+    //replaces the near plane of an OpenGL perspective projection by a view space plane (Lengyel's
+    //oblique frustum), so geometry between the virtual camera and the target manifold is clipped.
+    //Depth precision is only lost away from the plane. Returns the projection unchanged when the
+    //camera is not on the plane's negative side
+    glm::mat4 obliqueProjection(const glm::mat4& projection, const glm::vec4& clipPlane);
+
+    //NDC rectangle covered by a world space box, clamped to the screen. A box reaching behind the
+    //camera conservatively covers the whole screen, false when it is entirely behind or off screen
+    bool screenRect(const glm::mat4& viewProjection, const AABB& bounds, ScreenRect& rect);
+
+    //projection whose frustum sides pass through rect, for culling to what a portal can show
+    glm::mat4 restrictToRect(const glm::mat4& projection, const ScreenRect& rect);
+}
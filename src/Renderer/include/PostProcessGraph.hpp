@@ -0,0 +1,113 @@
+#pragma once
+
+#include "RenderGraph.hpp"
+#include "RenderTargetPool.hpp"
+#include "Shader.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+
+class GpuProfiler;
+
+enum class PostProcessQuality { LOW, MEDIUM, HIGH };
+
+struct PostProcessSettings {
+    float exposure = 1.0f;
+
+    bool bloom = true;
+    //mip levels in the downsample chain, the first one is half resolution
+    std::uint32_t bloomLevels = 5;
+    //HDR brightness where pixels start to bloom
+    float bloomThreshold = 1.0f;
+    //blend between the scene and the bloom chain
+    float bloomStrength = 0.04f;
+
+    bool fxaa = true;
+
+    static PostProcessSettings forQuality(PostProcessQuality quality);
+};
+
+// The shaders each kind of pass runs, all drawn with post_process.vert over a screen quad
+struct PostProcessShaders {
+    std::shared_ptr<Shader> bloomDownsample;
+    std::shared_ptr<Shader> bloomUpsample;
+    std::shared_ptr<Shader> tonemap;
+    std::shared_ptr<Shader> fxaa;
+};
+
+// Post effects as a RenderGraph from the HDR scene to the default framebuffer: a bloom downsample
+// and upsample chain, tonemapping and FXAA. Disabled effects are culled or left out of the graph,
+// so turning one off never leaves a full screen copy behind, and intermediate targets come from
+// the RenderTargetPool for as long as the graph needs them.
+class PostProcessGraph {
+
+    public:
+
+        PostProcessGraph(const PostProcessShaders& shaders, unsigned int quadVAO);
+        ~PostProcessGraph();
+
+        PostProcessGraph(const PostProcessGraph&) = delete;
+        PostProcessGraph& operator=(const PostProcessGraph&) = delete;
+
+        //only recompiles the graph when the set of effects changes
+        void setSettings(const PostProcessSettings& settings);
+        const PostProcessSettings& getSettings() const { return settings; }
+
+        //sceneColor is sceneWidth x sceneHeight, the result covers the default framebuffer at windowWidth x windowHeight
+        void execute(RenderTargetPool& pool, unsigned int sceneColor, int sceneWidth, int sceneHeight,
+                     int windowWidth, int windowHeight, GpuProfiler* profiler = nullptr);
+
+        std::size_t getLivePassCount() const { return graph.getLivePasses().size(); }
+
+    private:
+
+        enum class PassKind { BLOOM_DOWNSAMPLE, BLOOM_UPSAMPLE, TONEMAP, FXAA };
+
+        void build();
+        void runPass(RenderGraph::PassID pass);
+        //texture holding a resource this frame, and its size
+        unsigned int textureOf(RenderGraph::ResourceID resource) const;
+        glm::vec2 sizeOf(RenderGraph::ResourceID resource) const;
+
+        PostProcessSettings settings;
+        PostProcessShaders shaders;
+        unsigned int quadVAO;
+        unsigned int FBO = 0;
+
+        RenderGraph graph;
+        RenderGraph::ResourceID sceneResource = 0;
+        RenderGraph::ResourceID backbufferResource = 0;
+        //what to run for each pass, indexed by PassID
+        std::vector<PassKind> passKinds;
+        std::vector<std::uint32_t> passLevels;
+
+        //per execute()
+        std::vector<RenderTarget> slotTargets;
+        unsigned int sceneTexture = 0;
+        glm::vec2 sceneSize = glm::vec2(1.0f);
+
+        struct DownsampleUniforms {
+            UniformHandle<int> sourceTexture;
+            UniformHandle<glm::vec2> texelSize;
+            UniformHandle<bool> prefilter;
+            UniformHandle<float> threshold;
+        } downsampleUniforms;
+
+        struct UpsampleUniforms {
+            UniformHandle<int> sourceTexture;
+            UniformHandle<glm::vec2> texelSize;
+        } upsampleUniforms;
+
+        struct TonemapUniforms {
+            UniformHandle<int> sceneTexture;
+            UniformHandle<int> bloomTexture;
+            UniformHandle<float> exposure;
+            UniformHandle<float> bloomStrength;
+        } tonemapUniforms;
+
+        struct FxaaUniforms {
+            UniformHandle<int> sourceTexture;
+            UniformHandle<glm::vec2> inverseSize;
+        } fxaaUniforms;
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "RenderTargetPool.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Size and format of a graph-owned target, relative to the size of the graph's input
+struct GraphResourceDesc {
+    float scale = 1.0f;
+    RenderTargetFormat format = RenderTargetFormat::RGBA8;
+
+    bool operator==(const GraphResourceDesc& other) const { return scale == other.scale && format == other.format; }
+};
+
+// Passes declare the resources they read and the one they write, in execution order. compile()
+// keeps only the passes that contribute to an output, and gives every transient resource a
+// physical slot; resources whose lifetimes do not overlap share a slot when their descs match.
+// Writing a resource that already holds data is a read-modify-write and depends on that data.
+// The graph only does the bookkeeping, executing passes and owning targets is up to the caller.
+class RenderGraph {
+
+    public:
+
+        using ResourceID = std::uint32_t;
+        using PassID = std::uint32_t;
+        static constexpr std::uint32_t NO_SLOT = 0xFFFFFFFFu;
+
+        void clear();
+
+        //lives outside the graph (the scene color, the default framebuffer), never aliased
+        ResourceID importResource(const std::string& name);
+        ResourceID createResource(const std::string& name, const GraphResourceDesc& desc);
+        PassID addPass(const std::string& name, const std::vector<ResourceID>& reads, ResourceID write);
+
+        //passes writing an output are never culled
+        void markOutput(ResourceID resource);
+
+        //throws std::runtime_error when a transient resource is read before anything writes it
+        void compile();
+
+        const std::vector<PassID>& getLivePasses() const { return livePasses; }
+        bool isLive(PassID pass) const { return passes[pass].live; }
+        const std::string& getPassName(PassID pass) const { return passes[pass].name; }
+        const std::vector<ResourceID>& getReads(PassID pass) const { return passes[pass].reads; }
+        ResourceID getWrite(PassID pass) const { return passes[pass].write; }
+
+        bool isImported(ResourceID resource) const { return resources[resource].imported; }
+        const GraphResourceDesc& getDesc(ResourceID resource) const { return resources[resource].desc; }
+        std::uint32_t getSlot(ResourceID resource) const { return resources[resource].slot; }
+
+        std::size_t getSlotCount() const { return slots.size(); }
+        const GraphResourceDesc& getSlotDesc(std::uint32_t slot) const { return slots[slot].desc; }
+        //slots to acquire before the i-th live pass runs and to release after it
+        const std::vector<std::uint32_t>& getAcquires(std::size_t liveIndex) const { return acquires[liveIndex]; }
+        const std::vector<std::uint32_t>& getReleases(std::size_t liveIndex) const { return releases[liveIndex]; }
+
+    private:
+
+        struct Resource {
+            std::string name;
+            GraphResourceDesc desc;
+            bool imported = false;
+            bool output = false;
+            std::uint32_t slot = NO_SLOT;
+            //first and last live pass touching it, as indices into livePasses
+            std::size_t firstUse = 0;
+            std::size_t lastUse = 0;
+            bool used = false;
+        };
+
+        struct Pass {
+            std::string name;
+            std::vector<ResourceID> reads;
+            ResourceID write;
+            std::vector<PassID> dependencies;
+            bool live = false;
+        };
+
+        struct Slot {
+            GraphResourceDesc desc;
+            std::size_t firstUse;
+            std::size_t lastUse;
+        };
+
+        std::vector<Resource> resources;
+        std::vector<Pass> passes;
+        std::vector<PassID> livePasses;
+        std::vector<Slot> slots;
+        std::vector<std::vector<std::uint32_t>> acquires;
+        std::vector<std::vector<std::uint32_t>> releases;
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 64-bit draw sort key, most significant field first so sorting groups the most expensive
+// state changes together:
+//   pass(3) | shader(7) | material(14) | mesh(16) | submesh(8) | depth(16)
+// Packets that only differ in depth can share one instanced draw.
+namespace RenderKey {
+
+    constexpr unsigned int DEPTH_BITS = 16;
+    constexpr unsigned int SUBMESH_BITS = 8;
+    constexpr unsigned int MESH_BITS = 16;
+    constexpr unsigned int MATERIAL_BITS = 14;
+    constexpr unsigned int SHADER_BITS = 7;
+    constexpr unsigned int PASS_BITS = 3;
+
+    constexpr unsigned int DEPTH_SHIFT = 0;
+    constexpr unsigned int SUBMESH_SHIFT = DEPTH_SHIFT + DEPTH_BITS;
+    constexpr unsigned int MESH_SHIFT = SUBMESH_SHIFT + SUBMESH_BITS;
+    constexpr unsigned int MATERIAL_SHIFT = MESH_SHIFT + MESH_BITS;
+    constexpr unsigned int SHADER_SHIFT = MATERIAL_SHIFT + MATERIAL_BITS;
+    constexpr unsigned int PASS_SHIFT = SHADER_SHIFT + SHADER_BITS;
+    static_assert(PASS_SHIFT + PASS_BITS == 64, "render key fields must fill 64 bits");
+
+    constexpr std::uint64_t DEPTH_MASK = (std::uint64_t(1) << DEPTH_BITS) - 1;
+
+    //every field except depth, keys equal under this mask draw the same submesh with the same state
+    constexpr std::uint64_t BATCH_MASK = ~DEPTH_MASK;
+
+    enum Pass : std::uint32_t {
+        PASS_OPAQUE = 0
+    };
+
+    inline std::uint64_t field(std::uint32_t value, unsigned int bits, unsigned int shift) {
+        return (std::uint64_t(value) & ((std::uint64_t(1) << bits) - 1)) << shift;
+    }
+
+    inline std::uint64_t make(std::uint32_t pass, std::uint32_t shader, std::uint32_t material,
+                              std::uint32_t mesh, std::uint32_t subMesh, std::uint32_t depth) {
+        return field(pass, PASS_BITS, PASS_SHIFT) |
+               field(shader, SHADER_BITS, SHADER_SHIFT) |
+               field(material, MATERIAL_BITS, MATERIAL_SHIFT) |
+               field(mesh, MESH_BITS, MESH_SHIFT) |
+               field(subMesh, SUBMESH_BITS, SUBMESH_SHIFT) |
+               field(depth, DEPTH_BITS, DEPTH_SHIFT);
+    }
+
+    //depth pre-pass order: index type, then depth front to back, then mesh and submesh so
+    //neighbouring packets of the same submesh can still merge. Only the pre-pass sorts on this
+    inline std::uint64_t makeDepthFirst(std::uint32_t indexType, std::uint32_t depth,
+                                        std::uint32_t mesh, std::uint32_t subMesh) {
+        return field(indexType, 1, 48) |
+               field(depth, DEPTH_BITS, 32) |
+               field(mesh, MESH_BITS, 16) |
+               field(subMesh, SUBMESH_BITS, 0);
+    }
+
+    //quantizes a non-negative view depth, nearer is smaller. Uses the top bits of the float
+    //so precision is logarithmic and no near/far range is needed
+    std::uint32_t depthBucket(float viewDepth);
+}
+
+// Key fields are truncated to their bit widths, so the packet keeps the full values it draws with
+struct DrawPacket {
+    std::uint64_t key;
+    std::uint32_t instance;   // index into the caller's per-frame instance data
+    std::uint32_t subMesh;
+};
+
+// Per-frame list of draw packets. sort() is a stable LSD radix sort over the key bytes that
+// reuses its scratch buffer, so once capacity has grown to the scene size a frame allocates nothing.
+class RenderQueue {
+
+    public:
+
+        void clear() { packets.clear(); }
+        void reserve(std::size_t count);
+        void push(std::uint64_t key, std::uint32_t instance, std::uint32_t subMesh) { packets.push_back({key, instance, subMesh}); }
+        void sort();
+
+        std::size_t size() const { return packets.size(); }
+        bool empty() const { return packets.empty(); }
+        const DrawPacket& operator[](std::size_t index) const { return packets[index]; }
+        const std::vector<DrawPacket>& getPackets() const { return packets; }
+
+    private:
+
+        std::vector<DrawPacket> packets;
+        std::vector<DrawPacket> scratch;
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class RenderTargetFormat {
+    RGB16F,            //HDR color
+    RGBA8,
+    DEPTH24_STENCIL8   //renderbuffer, never sampled
+};
+
+struct RenderTargetDesc {
+    int width = 0;
+    int height = 0;
+    RenderTargetFormat format = RenderTargetFormat::RGBA8;
+
+    bool operator==(const RenderTargetDesc& other) const {
+        return width == other.width && height == other.height && format == other.format;
+    }
+};
+
+// A texture, or a renderbuffer for formats that are only ever attached
+struct RenderTarget {
+    unsigned int id = 0;
+    bool renderbuffer = false;
+    RenderTargetDesc desc;
+};
+
+// Owns every render target texture and renderbuffer, handing them out by size and format.
+// Released targets stay allocated for MAX_IDLE_FRAMES so a resize or resolution change that comes
+// back to a recent size reuses them instead of reallocating, and the bytes held are tracked.
+class RenderTargetPool {
+
+    public:
+
+        static constexpr std::uint64_t MAX_IDLE_FRAMES = 240;
+
+        RenderTargetPool() = default;
+        ~RenderTargetPool();
+
+        RenderTargetPool(const RenderTargetPool&) = delete;
+        RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+        //a free target matching desc, or a new one
+        RenderTarget acquire(const RenderTargetDesc& desc);
+        void release(const RenderTarget& target);
+
+        //deletes targets released more than MAX_IDLE_FRAMES frames ago, call once per frame
+        void endFrame();
+
+        std::size_t getBytesAllocated() const { return bytesAllocated; }
+        std::size_t getBytesInUse() const { return bytesInUse; }
+        std::size_t getTargetCount() const { return entries.size(); }
+
+        static std::size_t bytesPerPixel(RenderTargetFormat format);
+        static std::size_t bytesFor(const RenderTargetDesc& desc) {
+            return static_cast<std::size_t>(desc.width) * static_cast<std::size_t>(desc.height) * bytesPerPixel(desc.format);
+        }
+
+    private:
+
+        struct Entry {
+            RenderTarget target;
+            bool inUse = false;
+            std::uint64_t releasedFrame = 0;
+        };
+
+        static RenderTarget create(const RenderTargetDesc& desc);
+        static void destroy(const RenderTarget& target);
+
+        std::vector<Entry> entries;
+        std::uint64_t frame = 0;
+        std::size_t bytesAllocated = 0;
+        std::size_t bytesInUse = 0;
+};
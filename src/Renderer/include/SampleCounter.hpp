@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Counts the samples that pass the depth test between begin() and end() with a GL_SAMPLES_PASSED
+// query, or the GPU nanoseconds spent between them with GL_TIME_ELAPSED. Like GpuProfiler, results
+// are read FRAME_LATENCY frames later so the CPU never waits on the GPU. Only one counter of each
+// type may be open at a time.
+class SampleCounter {
+
+    public:
+
+        static constexpr std::size_t FRAME_LATENCY = 4;
+
+        enum class Type { SAMPLES_PASSED, TIME_ELAPSED };
+
+        SampleCounter(Type type = Type::SAMPLES_PASSED);
+        ~SampleCounter();
+
+        SampleCounter(const SampleCounter&) = delete;
+        SampleCounter& operator=(const SampleCounter&) = delete;
+
+        //collects the oldest query in the ring and starts counting into its slot
+        void begin();
+        void end();
+
+        //newest collected result, samples or nanoseconds, zero until the first frame comes back
+        std::uint64_t getSamples() const { return samples; }
+
+    private:
+
+        unsigned int target = 0;
+
+        std::array<unsigned int, FRAME_LATENCY> queries{};
+        std::array<bool, FRAME_LATENCY> pending{};
+        std::size_t current = 0;
+        std::uint64_t frameCount = 0;
+        std::uint64_t samples = 0;
+};
@@ -1,18 +1,100 @@
 #pragma once
+#include <array>
+#include <cstdint>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include <glm/glm.hpp>
 
+// Index into a shader's reflected uniform table, typed so a handle can only be set with the
+// value type it was resolved for. An invalid handle (uniform optimized out) is silently ignored,
+// resolving one for a uniform GLSL declares with another type is an error.
+template<typename T>
+struct UniformHandle {
+    int slot = -1;
+    bool isValid() const { return slot >= 0; }
+};
+
+struct UniformStats {
+    std::uint64_t callsIssued = 0;
+    std::uint64_t callsSaved = 0;
+};
+
 class Shader {
     public:
         unsigned int m_ID;
+
+        //small sequential id for render sort keys, program names are not guaranteed to be small
+        std::uint32_t sortID;
+
         Shader(const std::string& vertexPath, const std::string& fragmentPath);
         void use();
-        
+
+        template<typename T>
+        UniformHandle<T> getUniform(const std::string& name) const {
+            auto it = slotByName.find(name);
+            if (it == slotByName.end()) return UniformHandle<T>{};
+            //the setter would call the wrong glUniform*, so the handle comes back invalid
+            if (!accepts(static_cast<const T*>(nullptr), uniforms[it->second].type)) {
+                reportTypeMismatch(name, uniforms[it->second].type);
+                return UniformHandle<T>{};
+            }
+            return UniformHandle<T>{it->second};
+        }
+
+        void set(UniformHandle<glm::mat4> handle, const glm::mat4& mat) const;
+        void set(UniformHandle<glm::mat3> handle, const glm::mat3& mat) const;
+        void set(UniformHandle<glm::vec2> handle, const glm::vec2& value) const;
+        void set(UniformHandle<glm::vec3> handle, const glm::vec3& value) const;
+        void set(UniformHandle<glm::vec4> handle, const glm::vec4& value) const;
+        void set(UniformHandle<float> handle, float value) const;
+        void set(UniformHandle<int> handle, int value) const;
+        void set(UniformHandle<bool> handle, bool value) const;
+
+        // name based setters go through the same reflected table, without a driver lookup
         void setMat4(const std::string& name, const glm::mat4& mat) const;
         void setVec3(const std::string& name, const glm::vec3& value) const;
         void setVec4(const std::string& name, const glm::vec4& value) const;
         void setFloat(const std::string& name, float value) const;
         void setBool(const std::string& name, bool value) const;
+        void setInt(const std::string& name, int value) const;
+
+        // attaches a std140 block to a buffer binding point, GLSL 330 has no layout(binding)
+        void bindUniformBlock(const std::string& blockName, unsigned int bindingPoint) const;
+
+        // counters are shared by all shaders and reset by the renderer once per frame
+        static UniformStats getUniformStats() { return uniformStats; }
+        static void resetUniformStats() { uniformStats = UniformStats{}; }
+
     private:
+        struct UniformInfo {
+            int location = -1;
+            unsigned int type = 0;
+            bool hasValue = false;
+            std::array<std::uint32_t, 16> value{};
+        };
+
+        // mutable because caching the last uploaded value does not change the shader's meaning
+        mutable std::vector<UniformInfo> uniforms;
+        std::unordered_map<std::string, int> slotByName;
+
+        static UniformStats uniformStats;
+
         void checkCompileErrors(unsigned int shader, std::string type);
-};
\ No newline at end of file
+        void reflectUniforms();
+
+        // whether the setter for the pointed to type can upload a uniform of the reflected GL type
+        static bool accepts(const glm::mat4*, unsigned int type);
+        static bool accepts(const glm::mat3*, unsigned int type);
+        static bool accepts(const glm::vec2*, unsigned int type);
+        static bool accepts(const glm::vec3*, unsigned int type);
+        static bool accepts(const glm::vec4*, unsigned int type);
+        static bool accepts(const float*, unsigned int type);
+        static bool accepts(const int*, unsigned int type);
+        static bool accepts(const bool*, unsigned int type);
+        // asserts in debug builds, only logs in release
+        static void reportTypeMismatch(const std::string& name, unsigned int type);
+
+        // returns false when the cached value already matches and the GL call can be skipped
+        bool updateCache(int slot, const void* data, std::size_t size) const;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Bounds.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// One cascade of a directional light's shadow map. The region it covers is kept larger than the
+// camera slice it serves, so the cascade only moves, and its static casters only need rendering
+// again, once the slice has drifted out of that margin
+struct ShadowCascade {
+    glm::mat4 view = glm::mat4(1.0f);
+    glm::mat4 projection = glm::mat4(1.0f);
+    glm::vec3 center = glm::vec3(0.0f);
+    glm::vec3 lightDirection = glm::vec3(0.0f);
+    float radius = 0.0f;
+    bool valid = false;
+};
+
+// Sphere around one depth slice of the camera frustum
+struct BoundingSphere {
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+};
+
+// Projection math shared by the shadow passes and pbr.frag. Everything maps into [0, 1] texture
+// space directly, so the shader only multiplies, divides and samples.
+namespace ShadowLayout {
+
+    //practical split scheme: lambda 0 splits linearly, 1 logarithmically. splits holds count + 1 depths
+    void cascadeSplits(float nearPlane, float farPlane, std::size_t count, float lambda, float* splits);
+
+    //smallest sphere around the frustum slice between two view depths. Its radius does not depend on
+    //where the camera looks, which keeps cascade sizes fixed as it turns
+    BoundingSphere sliceBounds(const glm::mat4& projection, const glm::mat4& inverseView, float nearDepth, float farDepth);
+
+    //keeps the cascade when it still covers the slice, otherwise re-centers it on the slice snapped to
+    //whole texels with margin extra room, and returns true. Casters up to casterDistance beyond the
+    //region towards the light are kept in the depth range
+    bool fitCascade(ShadowCascade& cascade, const BoundingSphere& slice, const glm::vec3& lightDirection,
+                    int resolution, float margin, float casterDistance);
+
+    //+X, -X, +Y, -Y, +Z, -Z, the face a direction from the light falls into, as pbr.frag picks it
+    std::uint32_t cubeFace(const glm::vec3& direction);
+    glm::mat4 cubeFaceView(const glm::vec3& position, std::uint32_t face);
+    //90 degrees so the six faces exactly cover the sphere, reaching to the light's range
+    glm::mat4 cubeFaceProjection(float range);
+
+    //maps clip space onto one square tile of an atlas tilesPerRow tiles wide, depth onto [0, 1]
+    glm::mat4 tileTransform(std::uint32_t tile, std::uint32_t tilesPerRow);
+    //clip space onto the whole texture
+    glm::mat4 textureTransform();
+}
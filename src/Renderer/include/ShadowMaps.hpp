@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Where a shadow pass renders: a directional cascade layer or a point light cube face tile
+struct ShadowTarget {
+    enum class Type { CASCADE, ATLAS_TILE };
+    Type type = Type::CASCADE;
+    std::uint32_t index = 0;
+};
+
+// Depth textures for the shadow passes: a 2D array with one layer per directional cascade and an
+// atlas of square tiles for the cube faces of point lights. Both have a twin that only holds the
+// static casters. A pass over the static casters refreshes the twin, a pass over the moving ones
+// starts from a copy of it, so static geometry is only rasterized again when its tile changes.
+class ShadowMaps {
+
+    public:
+
+        static constexpr std::uint32_t CASCADE_COUNT = 4;
+        static constexpr int CASCADE_RESOLUTION = 2048;
+
+        static constexpr int ATLAS_RESOLUTION = 2048;
+        static constexpr int TILE_RESOLUTION = 256;
+        static constexpr std::uint32_t TILES_PER_ROW = ATLAS_RESOLUTION / TILE_RESOLUTION;
+        static constexpr std::uint32_t TILE_COUNT = TILES_PER_ROW * TILES_PER_ROW;
+        //six faces per light
+        static constexpr std::uint32_t MAX_POINT_SHADOWS = TILE_COUNT / 6;
+        //one per tile, then one per cascade
+        static constexpr std::uint32_t MATRIX_COUNT = TILE_COUNT + CASCADE_COUNT;
+
+        //after the light buffers: cascades, point atlas, point face matrices
+        static constexpr unsigned int FIRST_TEXTURE_UNIT = 4;
+
+        ShadowMaps();
+        ~ShadowMaps();
+
+        ShadowMaps(const ShadowMaps&) = delete;
+        ShadowMaps& operator=(const ShadowMaps&) = delete;
+
+        //clears the target's static twin and renders into it
+        void beginStatic(const ShadowTarget& target);
+        //copies the static twin into the sampled map and renders on top of it
+        void beginDynamic(const ShadowTarget& target);
+        //back to the default framebuffer, bindings are left behind the GLStateCache's back
+        void end();
+
+        //world to shadow texture space for every tile and cascade, MATRIX_COUNT of them
+        void uploadMatrices(const std::vector<glm::mat4>& matrices);
+
+        //binds outside the GLStateCache, invalidate the cache afterwards
+        void bind() const;
+
+        std::size_t getBytesAllocated() const;
+
+    private:
+
+        void attach(unsigned int framebuffer, const ShadowTarget& target, bool staticTwin) const;
+        void region(const ShadowTarget& target, int& x, int& y, int& size) const;
+        void setRegion(const ShadowTarget& target) const;
+
+        static unsigned int createDepthTexture(unsigned int target, int size, int layers, bool sampled);
+
+        unsigned int cascades = 0;
+        unsigned int staticCascades = 0;
+        unsigned int atlas = 0;
+        unsigned int staticAtlas = 0;
+
+        //the copy reads one framebuffer and draws into the other
+        unsigned int drawFBO = 0;
+        unsigned int readFBO = 0;
+
+        unsigned int matrixBuffer = 0;
+        unsigned int matrixTexture = 0;
+};
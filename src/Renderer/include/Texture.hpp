@@ -1,16 +1,45 @@
 #pragma once
 #include <glad/glad.h>
 #include <iostream>
+#include <vector>
+#include "TextureCompression.hpp"
+
+// One level of a baked mip chain, data stays owned by the caller until the upload returns
+struct TextureUpload {
+    int width = 0;
+    int height = 0;
+    const void* data = nullptr;
+    std::size_t size = 0;
+};
 
 class Texture {
 
     public:
 
         unsigned int ID;
-        Texture(const unsigned char* data, int width, int height, int nrComponents);
+        //levelCount levels with nothing uploaded yet, for TextureStreamer to fill from the smallest up.
+        //BC1 and BC3 levels are decoded on the CPU when the driver lacks S3TC. grey samples red as RGB,
+        //and the second channel as alpha when there is one
+        Texture(TextureFormat format, int levelCount, bool grey = false);
         virtual ~Texture();
 
         //pure method, does not change state in any form
         void bind() const;
-};
 
+        //levels below the base level are never sampled, so they can be released and uploaded again
+        //while the texture is in use
+        void uploadLevel(int level, const TextureUpload& upload);
+        void releaseLevel(int level);
+        void setBaseLevel(int level);
+
+        //video memory the levels take, for budgeting
+        std::size_t getBytes() const { return bytes; }
+
+    private:
+
+        void setSampling() const;
+
+        TextureFormat format = TextureFormat::RGBA8;
+        std::vector<std::size_t> levelBytes;
+        std::size_t bytes = 0;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// How a texture's texels are stored, on disk and on the GPU. The BC formats are 4x4 blocks:
+// BC1 and BC4 take 8 bytes per block, BC3 and BC5 16
+enum class TextureFormat : std::uint32_t {
+    R8, RG8, RGB8, RGBA8,
+    BC1, //RGB, 0.5 bytes per texel
+    BC3, //RGB with a separate alpha block, 1 byte per texel
+    BC4, //one channel, 0.5 bytes per texel
+    BC5  //two channels, 1 byte per texel
+};
+
+// One level of a mip chain, tightly packed rows for the uncompressed formats, blocks in row order
+// for the compressed ones
+struct TextureLevel {
+    int width = 0;
+    int height = 0;
+    std::vector<std::uint8_t> data;
+};
+
+// The channels a texture's texels actually use. A channel is left out when every texel holds what
+// GL fills in for a missing one, 0 for green and blue or 255 for alpha, and red, green and blue
+// that are always equal are stored once and swizzled back to grey
+struct TextureChannels {
+    int components = 4;
+    //the first stored channel is grey RGB, the second alpha when there are two
+    bool grey = false;
+};
+
+// CPU side of the texture pipeline: mip chain generation and block compression for AssetBaker,
+// decompression for drivers without S3TC. Nothing here touches GL
+namespace TextureCompression {
+
+    bool isCompressed(TextureFormat format);
+    //channels the format stores, what a decompressed texel holds
+    int channelCount(TextureFormat format);
+    std::size_t levelBytes(TextureFormat format, int width, int height);
+
+    //scans RGB and RGBA texels for the channels they use, one and two channel data is kept as is
+    TextureChannels findChannels(const std::uint8_t* pixels, int width, int height, int components);
+    //level with components channels per texel, down to the ones channels keeps
+    TextureLevel packChannels(const TextureLevel& level, int components, const TextureChannels& channels);
+
+    //picks by channel count, so pack with findChannels first: BC4 and BC5 for one and two channel
+    //data, BC1 for color, BC3 only when some texel is not fully opaque
+    TextureFormat chooseFormat(const std::uint8_t* pixels, int width, int height, int components);
+    //the uncompressed format holding components channels
+    TextureFormat rawFormat(int components);
+
+    //every level down to 1x1 with a 2x2 box filter. srgb averages the first three channels after
+    //the same 2.2 gamma pbr.frag decodes albedo with, so mips do not darken
+    std::vector<TextureLevel> buildMipChain(const std::uint8_t* pixels, int width, int height, int components, bool srgb);
+
+    //level holds components channels per texel, the result is in format, which must be raw for
+    //the same channel count or a BC format
+    TextureLevel encode(const TextureLevel& level, int components, TextureFormat format);
+
+    //back to channelCount(format) channels per texel
+    TextureLevel decode(const TextureLevel& level, TextureFormat format);
+
+    //single 4x4 blocks, rgba is 16 texels of 4 bytes and values 16 bytes, row by row
+    void encodeBC1Block(const std::uint8_t* rgba, std::uint8_t* block);
+    void encodeBC4Block(const std::uint8_t* values, std::uint8_t* block);
+    void decodeBC1Block(const std::uint8_t* block, std::uint8_t* rgba);
+    void decodeBC4Block(const std::uint8_t* block, std::uint8_t* values);
+}
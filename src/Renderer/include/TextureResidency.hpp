@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// A level to upload or drop, in the order they have to happen
+struct TextureStreamAction {
+    enum class Type { UPLOAD, EVICT };
+    Type type = Type::UPLOAD;
+    std::uint32_t texture = 0;
+    std::uint32_t level = 0;
+};
+
+// Decides which mips of the streamed textures are resident, without touching GL. Every texture
+// keeps a contiguous run of levels from its resident level down to the smallest. The tail, every
+// level up to TAIL_SIZE texels across, is resident from the start and never evicted, so a texture
+// always has something to sample. Levels above it are uploaded one at a time, the cheapest first
+// across all textures so everything sharpens together, and dropped least recently used first once
+// the budget is reached. Textures drawn since the last plan only lose levels finer than they want.
+class TextureResidency {
+
+    public:
+
+        static constexpr int TAIL_SIZE = 64;
+
+        //the level whose larger side still covers screenPixels, pixels <= 0 want the tail only
+        static std::uint32_t levelFor(int width, int height, std::uint32_t levelCount, float screenPixels);
+        //first level no more than TAIL_SIZE across
+        static std::uint32_t tailLevel(int width, int height, std::uint32_t levelCount);
+
+        //levelBytes largest first. The tail counts as resident at once, the caller uploads it
+        std::uint32_t add(std::vector<std::size_t> levelBytes, std::uint32_t tailLevel);
+
+        //the texture is drawn this frame and wants level, or finer when another draw asks for more
+        void request(std::uint32_t texture, std::uint32_t level);
+
+        //what to change to move towards the requested levels. At least one upload is planned whenever
+        //one fits the budget, then more until uploadBytes is used. The state already reflects the
+        //actions when this returns, and a new frame of requests begins. actions is cleared first
+        void plan(std::size_t budgetBytes, std::size_t uploadBytes, std::vector<TextureStreamAction>& actions);
+
+        std::uint32_t getResidentLevel(std::uint32_t texture) const { return textures[texture].resident; }
+        std::uint32_t getWantedLevel(std::uint32_t texture) const { return textures[texture].wanted; }
+        std::size_t getResidentBytes() const { return residentBytes; }
+        std::size_t getTextureCount() const { return textures.size(); }
+
+    private:
+
+        struct Entry {
+            std::vector<std::size_t> levelBytes;
+            std::uint32_t tail = 0;
+            std::uint32_t resident = 0;
+            std::uint32_t wanted = 0;
+            std::uint64_t lastUsed = 0;
+        };
+
+        //drops the finest resident level of the least recently used texture that can spare one
+        bool evictFor(std::uint32_t texture, std::vector<TextureStreamAction>& actions);
+
+        //next level bytes and texture, a min heap kept between plans so it never reallocates
+        using Candidate = std::pair<std::size_t, std::uint32_t>;
+
+        std::vector<Entry> textures;
+        std::vector<Candidate> candidates;
+        std::size_t residentBytes = 0;
+        //requests are stamped with this, plan moves it on
+        std::uint64_t frame = 1;
+};
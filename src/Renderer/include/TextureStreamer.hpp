@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Texture.hpp"
+#include "TextureResidency.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Keeps the textures it owns within a video memory budget. Each starts with only its smallest
+// levels resident, the renderer reports how many pixels across each is drawn at, and update
+// uploads the levels that size calls for a few per frame, dropping least recently used levels
+// when the budget runs out. TextureResidency makes the decisions, this applies them to GL.
+class TextureStreamer {
+
+    public:
+
+        static constexpr std::size_t DEFAULT_BUDGET_BYTES = 256u * 1024 * 1024;
+        static constexpr std::size_t DEFAULT_UPLOAD_BYTES = 4u * 1024 * 1024;
+
+        TextureStreamer(std::size_t budgetBytes = DEFAULT_BUDGET_BYTES, std::size_t uploadBytesPerFrame = DEFAULT_UPLOAD_BYTES);
+
+        void setBudget(std::size_t bytes) { this->budgetBytes = bytes; }
+        void setUploadRate(std::size_t bytesPerFrame) { this->uploadBytesPerFrame = bytesPerFrame; }
+
+        //levels largest first, pointing into data owner keeps alive for as long as the texture streams.
+        //The smallest levels are uploaded before this returns. grey is passed on to the Texture
+        std::shared_ptr<Texture> add(TextureFormat format, std::vector<TextureUpload> levels, std::shared_ptr<const void> owner,
+                                     bool grey = false);
+
+        //the texture was drawn this frame covering about screenPixels across
+        void request(const Texture& texture, float screenPixels);
+
+        //call once per frame on the render thread, after the frame's requests
+        void update();
+
+        std::size_t getBudget() const { return budgetBytes; }
+        std::size_t getResidentBytes() const { return residency.getResidentBytes(); }
+        std::size_t getTextureCount() const { return streamed.size(); }
+        std::uint32_t getUploadsLastFrame() const { return uploadsLastFrame; }
+        std::uint32_t getEvictionsLastFrame() const { return evictionsLastFrame; }
+
+    private:
+
+        struct Streamed {
+            std::shared_ptr<Texture> texture;
+            std::vector<TextureUpload> levels;
+            std::shared_ptr<const void> owner;
+        };
+
+        TextureResidency residency;
+        std::vector<Streamed> streamed;
+        std::unordered_map<const Texture*, std::uint32_t> slots;
+
+        //per frame scratch, cleared by update rather than reallocated
+        std::vector<TextureStreamAction> actions;
+        std::vector<std::uint32_t> changed;
+
+        std::size_t budgetBytes;
+        std::size_t uploadBytesPerFrame;
+        std::uint32_t uploadsLastFrame = 0;
+        std::uint32_t evictionsLastFrame = 0;
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtx/hash.hpp>
+#include <cstddef>
+#include <cstdint>
+#include "Bounds.hpp"
+
+// Full precision vertex, what loaders produce and mesh processing works on
+struct Vertex {
+    glm::vec3 Position;
+    glm::vec3 Normal;
+    glm::vec2 TexCoords;
+
+    bool operator==(const Vertex& other) const {
+        return Position == other.Position && Normal == other.Normal && TexCoords == other.TexCoords;
+    }
+};
+
+namespace std {
+    template<> struct hash<Vertex> {
+        size_t operator()(Vertex const& vertex) const {
+            return ((hash<glm::vec3>()(vertex.Position) ^
+                   (hash<glm::vec3>()(vertex.Normal) << 1)) >> 1) ^
+                   (hash<glm::vec2>()(vertex.TexCoords) << 1);
+        }
+    };
+}
+
+// Half the size of Vertex. Positions are 16-bit unorm inside the mesh bounds, normals are
+// snorm 10:10:10:2 and texture coordinates are half floats. All three decode in the vertex
+// fetch, the bounds are undone by folding PositionQuantization into the instance matrix
+struct PackedVertex {
+    std::uint16_t position[3];
+    std::uint16_t padding;
+    std::uint32_t normal;
+    std::uint16_t texCoords[2];
+};
+static_assert(sizeof(PackedVertex) == 16, "PackedVertex must stay 16 bytes");
+
+// Maps unorm positions back into object space: position = offset + stored * scale
+struct PositionQuantization {
+    glm::vec3 offset = glm::vec3(0.0f);
+    glm::vec3 scale = glm::vec3(1.0f);
+
+    static PositionQuantization fromBounds(const AABB& bounds);
+
+    //stored positions to object space, multiplied onto the model matrix per instance
+    glm::mat4 toMatrix() const;
+};
+
+namespace VertexPacking {
+
+    std::uint16_t floatToHalf(float value);
+    float halfToFloat(std::uint16_t half);
+
+    //GL_INT_2_10_10_10_REV, w is left at zero
+    std::uint32_t packNormal(const glm::vec3& normal);
+    glm::vec3 unpackNormal(std::uint32_t packed);
+
+    std::uint16_t quantizeUnorm16(float value);
+
+    PackedVertex pack(const Vertex& vertex, const PositionQuantization& quantization);
+    Vertex unpack(const PackedVertex& packed, const PositionQuantization& quantization);
+}
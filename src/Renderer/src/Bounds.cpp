@@ -0,0 +1,132 @@
+#include "Bounds.hpp"
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define BOUNDS_USE_SSE 1
+#else
+    #define BOUNDS_USE_SSE 0
+#endif
+
+AABB AABB::transformed(const glm::mat4& transform) const {
+
+    if (!isValid()) return *this;
+
+    glm::vec3 c = center();
+    glm::vec3 e = extents();
+
+    //Arvo: the new half extents are the old ones run through the absolute rotation-scale part
+    glm::vec3 newCenter = glm::vec3(transform * glm::vec4(c, 1.0f));
+    glm::vec3 newExtents(0.0f);
+    for (int row = 0; row < 3; row++) {
+        newExtents[row] = std::fabs(transform[0][row]) * e.x +
+                          std::fabs(transform[1][row]) * e.y +
+                          std::fabs(transform[2][row]) * e.z;
+    }
+
+    AABB result;
+    result.min = newCenter - newExtents;
+    result.max = newCenter + newExtents;
+    return result;
+}
+
+Frustum Frustum::fromMatrix(const glm::mat4& m) {
+
+    Frustum frustum;
+
+    //rows of the matrix, glm is column-major
+    glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    frustum.planes[0] = row3 + row0;
+    frustum.planes[1] = row3 - row0;
+    frustum.planes[2] = row3 + row1;
+    frustum.planes[3] = row3 - row1;
+    frustum.planes[4] = row3 + row2;
+    frustum.planes[5] = row3 - row2;
+
+    for (auto& plane : frustum.planes) {
+        float length = glm::length(glm::vec3(plane));
+        if (length > 0.0f) plane /= length;
+    }
+
+    return frustum;
+}
+
+FrustumTest Frustum::test(const AABB& box, std::uint8_t& planeMask) const {
+
+    glm::vec3 c = box.center();
+    glm::vec3 e = box.extents();
+
+    for (int i = 0; i < 6; i++) {
+        if (!(planeMask & (1 << i))) continue;
+
+        const glm::vec4& plane = planes[i];
+        float distance = plane.x * c.x + plane.y * c.y + plane.z * c.z + plane.w;
+        float radius = std::fabs(plane.x) * e.x + std::fabs(plane.y) * e.y + std::fabs(plane.z) * e.z;
+
+        if (distance + radius < 0.0f) return FrustumTest::OUTSIDE;
+        if (distance - radius >= 0.0f) planeMask &= ~(1 << i);
+    }
+
+    return planeMask == 0 ? FrustumTest::INSIDE : FrustumTest::INTERSECTS;
+}
+
+void Frustum::testBatch(const AABB* boxes, std::size_t count, std::uint8_t* visible) const {
+
+    std::size_t i = 0;
+
+#if BOUNDS_USE_SSE
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 zero = _mm_setzero_ps();
+
+    for (; i + 4 <= count; i += 4) {
+        const AABB& a = boxes[i];
+        const AABB& b = boxes[i + 1];
+        const AABB& c = boxes[i + 2];
+        const AABB& d = boxes[i + 3];
+
+        //transpose four boxes into SoA center / extent lanes
+        __m128 minX = _mm_setr_ps(a.min.x, b.min.x, c.min.x, d.min.x);
+        __m128 minY = _mm_setr_ps(a.min.y, b.min.y, c.min.y, d.min.y);
+        __m128 minZ = _mm_setr_ps(a.min.z, b.min.z, c.min.z, d.min.z);
+        __m128 maxX = _mm_setr_ps(a.max.x, b.max.x, c.max.x, d.max.x);
+        __m128 maxY = _mm_setr_ps(a.max.y, b.max.y, c.max.y, d.max.y);
+        __m128 maxZ = _mm_setr_ps(a.max.z, b.max.z, c.max.z, d.max.z);
+
+        __m128 centerX = _mm_mul_ps(_mm_add_ps(minX, maxX), half);
+        __m128 centerY = _mm_mul_ps(_mm_add_ps(minY, maxY), half);
+        __m128 centerZ = _mm_mul_ps(_mm_add_ps(minZ, maxZ), half);
+        __m128 extentX = _mm_mul_ps(_mm_sub_ps(maxX, minX), half);
+        __m128 extentY = _mm_mul_ps(_mm_sub_ps(maxY, minY), half);
+        __m128 extentZ = _mm_mul_ps(_mm_sub_ps(maxZ, minZ), half);
+
+        __m128 outside = _mm_setzero_ps();
+        for (auto const& plane : planes) {
+            __m128 nx = _mm_set1_ps(plane.x);
+            __m128 ny = _mm_set1_ps(plane.y);
+            __m128 nz = _mm_set1_ps(plane.z);
+
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, centerX), _mm_mul_ps(ny, centerY)),
+                                         _mm_add_ps(_mm_mul_ps(nz, centerZ), _mm_set1_ps(plane.w)));
+            __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(std::fabs(plane.x)), extentX),
+                                                  _mm_mul_ps(_mm_set1_ps(std::fabs(plane.y)), extentY)),
+                                       _mm_mul_ps(_mm_set1_ps(std::fabs(plane.z)), extentZ));
+
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), zero));
+        }
+
+        int mask = _mm_movemask_ps(outside);
+        visible[i]     = (mask & 1) ? 0 : 1;
+        visible[i + 1] = (mask & 2) ? 0 : 1;
+        visible[i + 2] = (mask & 4) ? 0 : 1;
+        visible[i + 3] = (mask & 8) ? 0 : 1;
+    }
+#endif
+
+    for (; i < count; i++) {
+        visible[i] = intersects(boxes[i]) ? 1 : 0;
+    }
+}
@@ -0,0 +1,65 @@
+#include "DrawCommandBuffer.hpp"
+#include "GLExtensions.hpp"
+#include "GLStateCache.hpp"
+#include "InstanceBuffer.hpp"
+#include <glad/glad.h>
+#include <cstdint>
+
+//core since 4.0, absent from the 3.3 headers
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+DrawCommandBuffer::DrawCommandBuffer() {
+    indirect = GLExtensions::hasMultiDrawIndirect();
+    if (indirect) glGenBuffers(1, &buffer);
+}
+
+DrawCommandBuffer::~DrawCommandBuffer() {
+    if (buffer) glDeleteBuffers(1, &buffer);
+}
+
+void DrawCommandBuffer::upload() {
+
+    if (!indirect || commands.empty()) return;
+
+    std::size_t bytes = commands.size() * sizeof(DrawElementsIndirectCommand);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, buffer);
+
+    //orphaning lets the driver hand out fresh storage while last frame's commands are still read
+    if (commands.size() > capacity) capacity = commands.size() * 2;
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, capacity * sizeof(DrawElementsIndirectCommand), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, bytes, commands.data());
+}
+
+void DrawCommandBuffer::draw(std::size_t first, std::size_t count, IndexType indexType,
+                             const InstanceBuffer& instances, GLStateCache& stateCache) const {
+
+    if (count == 0) return;
+
+    GLenum type = indexType == IndexType::UINT16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    std::size_t indexSize = indexType == IndexType::UINT16 ? sizeof(std::uint16_t) : sizeof(std::uint32_t);
+
+    if (indirect) {
+        //the indirect binding is not VAO state and several buffers take turns during a frame
+        std::uintptr_t offset = first * sizeof(DrawElementsIndirectCommand);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, buffer);
+        instances.bindAttributes(0);
+        GLExtensions::multiDrawElementsIndirect(GL_TRIANGLES, type, reinterpret_cast<const void*>(offset),
+                                                static_cast<int>(count), 0);
+        stateCache.countDraw();
+        return;
+    }
+
+    for (std::size_t i = first; i < first + count; i++) {
+        const DrawElementsIndirectCommand& command = commands[i];
+        instances.bindAttributes(command.baseInstance);
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES,
+                                          command.count,
+                                          type,
+                                          reinterpret_cast<void*>(static_cast<std::uintptr_t>(command.firstIndex) * indexSize),
+                                          command.instanceCount,
+                                          command.baseVertex);
+        stateCache.countDraw();
+    }
+}
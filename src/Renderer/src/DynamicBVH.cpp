@@ -0,0 +1,361 @@
+#include "DynamicBVH.hpp"
+#include <algorithm>
+#include <cassert>
+
+DynamicBVH::DynamicBVH(float fatMargin) : fatMargin(fatMargin) {
+}
+
+void DynamicBVH::clear() {
+    nodes.clear();
+    root = NULL_NODE;
+    freeList = NULL_NODE;
+    proxyCount = 0;
+}
+
+std::int32_t DynamicBVH::allocateNode() {
+
+    if (freeList == NULL_NODE) {
+        nodes.emplace_back();
+        nodes.back().height = 0;
+        return static_cast<std::int32_t>(nodes.size() - 1);
+    }
+
+    std::int32_t nodeID = freeList;
+    freeList = nodes[nodeID].parent;
+
+    nodes[nodeID] = Node{};
+    nodes[nodeID].height = 0;
+    return nodeID;
+}
+
+void DynamicBVH::freeNode(std::int32_t nodeID) {
+    nodes[nodeID].parent = freeList;
+    nodes[nodeID].height = -1;
+    freeList = nodeID;
+}
+
+std::int32_t DynamicBVH::createProxy(const AABB& aabb, std::uint32_t userData) {
+
+    std::int32_t proxyID = allocateNode();
+
+    glm::vec3 margin(fatMargin);
+    nodes[proxyID].aabb.min = aabb.min - margin;
+    nodes[proxyID].aabb.max = aabb.max + margin;
+    nodes[proxyID].userData = userData;
+    nodes[proxyID].height = 0;
+
+    insertLeaf(proxyID);
+    proxyCount++;
+    return proxyID;
+}
+
+void DynamicBVH::destroyProxy(std::int32_t proxyID) {
+
+    assert(proxyID >= 0 && proxyID < static_cast<std::int32_t>(nodes.size()) && nodes[proxyID].isLeaf());
+
+    removeLeaf(proxyID);
+    freeNode(proxyID);
+    proxyCount--;
+}
+
+bool DynamicBVH::moveProxy(std::int32_t proxyID, const AABB& aabb) {
+
+    assert(proxyID >= 0 && proxyID < static_cast<std::int32_t>(nodes.size()) && nodes[proxyID].isLeaf());
+
+    //still inside the fattened box, the tree does not need to change
+    if (nodes[proxyID].aabb.contains(aabb)) {
+        return false;
+    }
+
+    removeLeaf(proxyID);
+
+    glm::vec3 margin(fatMargin);
+    nodes[proxyID].aabb.min = aabb.min - margin;
+    nodes[proxyID].aabb.max = aabb.max + margin;
+
+    insertLeaf(proxyID);
+    return true;
+}
+
+void DynamicBVH::insertLeaf(std::int32_t leaf) {
+
+    if (root == NULL_NODE) {
+        root = leaf;
+        nodes[root].parent = NULL_NODE;
+        return;
+    }
+
+    // --- 1. Find the best sibling by surface area cost ---
+    AABB leafAABB = nodes[leaf].aabb;
+    std::int32_t index = root;
+
+    while (!nodes[index].isLeaf()) {
+        std::int32_t child1 = nodes[index].child1;
+        std::int32_t child2 = nodes[index].child2;
+
+        float area = nodes[index].aabb.surfaceArea();
+        float combinedArea = AABB::merge(nodes[index].aabb, leafAABB).surfaceArea();
+
+        //cost of creating a new parent for this node and the new leaf
+        float cost = 2.0f * combinedArea;
+
+        //minimum cost of pushing the leaf further down the tree
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        auto descendCost = [&](std::int32_t child) {
+            float merged = AABB::merge(leafAABB, nodes[child].aabb).surfaceArea();
+            if (nodes[child].isLeaf()) return merged + inheritanceCost;
+            return (merged - nodes[child].aabb.surfaceArea()) + inheritanceCost;
+        };
+
+        float cost1 = descendCost(child1);
+        float cost2 = descendCost(child2);
+
+        if (cost < cost1 && cost < cost2) break;
+        index = cost1 < cost2 ? child1 : child2;
+    }
+
+    std::int32_t sibling = index;
+
+    // --- 2. Create a new parent for the sibling and the leaf ---
+    std::int32_t oldParent = nodes[sibling].parent;
+    std::int32_t newParent = allocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].aabb = AABB::merge(leafAABB, nodes[sibling].aabb);
+    nodes[newParent].height = nodes[sibling].height + 1;
+
+    if (oldParent != NULL_NODE) {
+        if (nodes[oldParent].child1 == sibling) {
+            nodes[oldParent].child1 = newParent;
+        } else {
+            nodes[oldParent].child2 = newParent;
+        }
+    } else {
+        root = newParent;
+    }
+
+    nodes[newParent].child1 = sibling;
+    nodes[newParent].child2 = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    // --- 3. Walk back up, refitting and rebalancing ---
+    index = nodes[leaf].parent;
+    while (index != NULL_NODE) {
+        index = balance(index);
+
+        std::int32_t child1 = nodes[index].child1;
+        std::int32_t child2 = nodes[index].child2;
+        nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+        nodes[index].aabb = AABB::merge(nodes[child1].aabb, nodes[child2].aabb);
+
+        index = nodes[index].parent;
+    }
+}
+
+void DynamicBVH::removeLeaf(std::int32_t leaf) {
+
+    if (leaf == root) {
+        root = NULL_NODE;
+        return;
+    }
+
+    std::int32_t parent = nodes[leaf].parent;
+    std::int32_t grandParent = nodes[parent].parent;
+    std::int32_t sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+    if (grandParent == NULL_NODE) {
+        root = sibling;
+        nodes[sibling].parent = NULL_NODE;
+        freeNode(parent);
+        return;
+    }
+
+    //the sibling takes the parent's place
+    if (nodes[grandParent].child1 == parent) {
+        nodes[grandParent].child1 = sibling;
+    } else {
+        nodes[grandParent].child2 = sibling;
+    }
+    nodes[sibling].parent = grandParent;
+    freeNode(parent);
+
+    std::int32_t index = grandParent;
+    while (index != NULL_NODE) {
+        index = balance(index);
+
+        std::int32_t child1 = nodes[index].child1;
+        std::int32_t child2 = nodes[index].child2;
+        nodes[index].aabb = AABB::merge(nodes[child1].aabb, nodes[child2].aabb);
+        nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+
+        index = nodes[index].parent;
+    }
+}
+
+// Rotates the taller child up when the subtree under iA is out of balance, returns the new subtree root
+std::int32_t DynamicBVH::balance(std::int32_t iA) {
+
+    Node& A = nodes[iA];
+    if (A.isLeaf() || A.height < 2) {
+        return iA;
+    }
+
+    std::int32_t iB = A.child1;
+    std::int32_t iC = A.child2;
+    Node& B = nodes[iB];
+    Node& C = nodes[iC];
+
+    int difference = C.height - B.height;
+
+    auto replaceInParent = [&](std::int32_t oldChild, std::int32_t newChild, std::int32_t parent) {
+        if (parent == NULL_NODE) {
+            root = newChild;
+        } else if (nodes[parent].child1 == oldChild) {
+            nodes[parent].child1 = newChild;
+        } else {
+            nodes[parent].child2 = newChild;
+        }
+    };
+
+    // Rotate C up
+    if (difference > 1) {
+        std::int32_t iF = C.child1;
+        std::int32_t iG = C.child2;
+        Node& F = nodes[iF];
+        Node& G = nodes[iG];
+
+        C.child1 = iA;
+        C.parent = A.parent;
+        A.parent = iC;
+        replaceInParent(iA, iC, C.parent);
+
+        if (F.height > G.height) {
+            C.child2 = iF;
+            A.child2 = iG;
+            G.parent = iA;
+            A.aabb = AABB::merge(B.aabb, G.aabb);
+            C.aabb = AABB::merge(A.aabb, F.aabb);
+            A.height = 1 + std::max(B.height, G.height);
+            C.height = 1 + std::max(A.height, F.height);
+        } else {
+            C.child2 = iG;
+            A.child2 = iF;
+            F.parent = iA;
+            A.aabb = AABB::merge(B.aabb, F.aabb);
+            C.aabb = AABB::merge(A.aabb, G.aabb);
+            A.height = 1 + std::max(B.height, F.height);
+            C.height = 1 + std::max(A.height, G.height);
+        }
+        return iC;
+    }
+
+    // Rotate B up
+    if (difference < -1) {
+        std::int32_t iD = B.child1;
+        std::int32_t iE = B.child2;
+        Node& D = nodes[iD];
+        Node& E = nodes[iE];
+
+        B.child1 = iA;
+        B.parent = A.parent;
+        A.parent = iB;
+        replaceInParent(iA, iB, B.parent);
+
+        if (D.height > E.height) {
+            B.child2 = iD;
+            A.child1 = iE;
+            E.parent = iA;
+            A.aabb = AABB::merge(C.aabb, E.aabb);
+            B.aabb = AABB::merge(A.aabb, D.aabb);
+            A.height = 1 + std::max(C.height, E.height);
+            B.height = 1 + std::max(A.height, D.height);
+        } else {
+            B.child2 = iE;
+            A.child1 = iD;
+            D.parent = iA;
+            A.aabb = AABB::merge(C.aabb, D.aabb);
+            B.aabb = AABB::merge(A.aabb, E.aabb);
+            A.height = 1 + std::max(C.height, D.height);
+            B.height = 1 + std::max(A.height, E.height);
+        }
+        return iB;
+    }
+
+    return iA;
+}
+
+void DynamicBVH::collectLeaves(std::int32_t nodeID, std::vector<std::uint32_t>& results) {
+
+    const Node& node = nodes[nodeID];
+    if (node.isLeaf()) {
+        results.push_back(node.userData);
+        return;
+    }
+    collectLeaves(node.child1, results);
+    collectLeaves(node.child2, results);
+}
+
+void DynamicBVH::query(const Frustum& frustum, std::vector<std::uint32_t>& results) {
+
+    if (root == NULL_NODE) return;
+
+    frustumStack.clear();
+    candidateBoxes.clear();
+    candidateData.clear();
+    frustumStack.push_back({root, Frustum::ALL_PLANES});
+
+    while (!frustumStack.empty()) {
+        auto [nodeID, planeMask] = frustumStack.back();
+        frustumStack.pop_back();
+        const Node& node = nodes[nodeID];
+
+        //leaves under a partially visible parent are deferred to the batched test
+        if (node.isLeaf()) {
+            candidateBoxes.push_back(node.aabb);
+            candidateData.push_back(node.userData);
+            continue;
+        }
+
+        FrustumTest result = frustum.test(node.aabb, planeMask);
+        if (result == FrustumTest::OUTSIDE) continue;
+
+        if (result == FrustumTest::INSIDE) {
+            collectLeaves(nodeID, results);
+            continue;
+        }
+
+        frustumStack.push_back({node.child1, planeMask});
+        frustumStack.push_back({node.child2, planeMask});
+    }
+
+    candidateVisible.resize(candidateBoxes.size());
+    frustum.testBatch(candidateBoxes.data(), candidateBoxes.size(), candidateVisible.data());
+
+    for (std::size_t i = 0; i < candidateBoxes.size(); i++) {
+        if (candidateVisible[i]) results.push_back(candidateData[i]);
+    }
+}
+
+void DynamicBVH::query(const AABB& box, std::vector<std::uint32_t>& results) {
+
+    if (root == NULL_NODE) return;
+
+    stack.clear();
+    stack.push_back(root);
+
+    while (!stack.empty()) {
+        std::int32_t nodeID = stack.back();
+        stack.pop_back();
+        const Node& node = nodes[nodeID];
+
+        if (!node.aabb.overlaps(box)) continue;
+
+        if (node.isLeaf()) {
+            results.push_back(node.userData);
+        } else {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+}
@@ -0,0 +1,65 @@
+#include "DynamicResolution.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+    //weight of the newest frame in the running average
+    constexpr float SMOOTHING = 0.2f;
+    //a drop aims this far under budget so the next spike does not immediately trigger another one
+    constexpr float TARGET_FRACTION = 0.9f;
+    //going up a step costs about (1 + step / scale)^2 in time, only climb with this much headroom
+    constexpr float RAISE_FRACTION = 0.7f;
+}
+
+DynamicResolution::DynamicResolution(float budgetMilliseconds, float minScale, float maxScale)
+    : budgetMilliseconds(budgetMilliseconds), minScale(minScale), maxScale(maxScale), scale(maxScale) {}
+
+void DynamicResolution::setScaleRange(float minScale, float maxScale) {
+    this->minScale = minScale;
+    this->maxScale = std::max(minScale, maxScale);
+    scale = std::clamp(scale, this->minScale, this->maxScale);
+}
+
+float DynamicResolution::quantize(float value) const {
+    float stepped = std::floor(value / SCALE_STEP + 1e-4f) * SCALE_STEP;
+    return std::clamp(stepped, minScale, maxScale);
+}
+
+bool DynamicResolution::update(float gpuMilliseconds) {
+
+    //zero means no measurement came back yet
+    if (gpuMilliseconds <= 0.0f) return false;
+
+    smoothedMilliseconds = smoothedMilliseconds == 0.0f
+                               ? gpuMilliseconds
+                               : smoothedMilliseconds + (gpuMilliseconds - smoothedMilliseconds) * SMOOTHING;
+
+    if (settleFrames > 0) {
+        settleFrames--;
+        return false;
+    }
+
+    float previous = scale;
+
+    if (smoothedMilliseconds > budgetMilliseconds) {
+        //frame time follows the pixel count, which goes with the square of the scale
+        float fit = scale * std::sqrt(budgetMilliseconds * TARGET_FRACTION / smoothedMilliseconds);
+        scale = std::min(quantize(fit), std::max(scale - SCALE_STEP, minScale));
+        headroomFrames = 0;
+    } else if (smoothedMilliseconds < budgetMilliseconds * RAISE_FRACTION && scale < maxScale) {
+        if (++headroomFrames >= RAISE_FRAMES) {
+            scale = std::min(quantize(scale + SCALE_STEP), maxScale);
+            headroomFrames = 0;
+        }
+    } else {
+        headroomFrames = 0;
+    }
+
+    if (scale == previous) return false;
+
+    //the average still holds the old scale's cost, let the new one show up first
+    smoothedMilliseconds *= (scale * scale) / (previous * previous);
+    settleFrames = SETTLE_FRAMES;
+    return true;
+}
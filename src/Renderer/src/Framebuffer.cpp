@@ -2,26 +2,39 @@
 #include <glad/glad.h>
 #include <iostream>
 
-Framebuffer::Framebuffer(int width, int height) {
-
+Framebuffer::Framebuffer(RenderTargetPool& pool, int width, int height) : pool(pool) {
     glGenFramebuffers(1, &FBO);
-    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    resize(width, height);
+}
+
+Framebuffer::~Framebuffer() {
+    glDeleteFramebuffers(1, &FBO);
+    pool.release(color);
+    pool.release(depthStencil);
+}
 
-    glGenTextures(1, &textureColorBuffer);
-    glBindTexture(GL_TEXTURE_2D, textureColorBuffer);
+void Framebuffer::resize(int width, int height) {
 
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_FLOAT, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    if (width == this->width && height == this->height) return;
 
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textureColorBuffer, 0);
+    //released before acquiring, so shrinking and growing back can hand out the same targets
+    if (color.id) pool.release(color);
+    if (depthStencil.id) pool.release(depthStencil);
 
-    glGenRenderbuffers(1, &RBO);
-    glBindRenderbuffer(GL_RENDERBUFFER, RBO);
+    this->width = width;
+    this->height = height;
+    color = pool.acquire(RenderTargetDesc{width, height, RenderTargetFormat::RGB16F});
+    depthStencil = pool.acquire(RenderTargetDesc{width, height, RenderTargetFormat::DEPTH24_STENCIL8});
+    textureColorBuffer = color.id;
 
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    attach();
+}
+
+void Framebuffer::attach() {
 
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, RBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color.id, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthStencil.id);
 
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
         std::cerr << "ERROR::FRAMEBUFFER:: Framebuffer is not complete!" << std::endl;
@@ -30,14 +43,9 @@ Framebuffer::Framebuffer(int width, int height) {
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-Framebuffer::~Framebuffer() {
-    glDeleteFramebuffers(1, &FBO);
-    glDeleteTextures(1, &textureColorBuffer);
-    glDeleteRenderbuffers(1, &RBO);
-}
-
 void Framebuffer::bind() {
     glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glViewport(0, 0, width, height);
 }
 
 void Framebuffer::unbind() {
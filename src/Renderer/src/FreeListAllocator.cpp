@@ -0,0 +1,99 @@
+#include "FreeListAllocator.hpp"
+#include <cassert>
+#include <iterator>
+
+FreeListAllocator::FreeListAllocator(std::uint32_t capacity) {
+    grow(capacity);
+}
+
+void FreeListAllocator::insertFree(std::uint32_t offset, std::uint32_t size) {
+    freeByOffset.emplace(offset, size);
+    freeBySize.emplace(size, offset);
+}
+
+void FreeListAllocator::eraseFree(std::map<std::uint32_t, std::uint32_t>::iterator block) {
+
+    auto range = freeBySize.equal_range(block->second);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == block->first) {
+            freeBySize.erase(it);
+            break;
+        }
+    }
+    freeByOffset.erase(block);
+}
+
+std::uint32_t FreeListAllocator::allocate(std::uint32_t size) {
+
+    if (size == 0) return INVALID_OFFSET;
+
+    //best fit keeps the large blocks intact for large meshes
+    auto fit = freeBySize.lower_bound(size);
+    if (fit == freeBySize.end()) return INVALID_OFFSET;
+
+    std::uint32_t offset = fit->second;
+    std::uint32_t blockSize = fit->first;
+    eraseFree(freeByOffset.find(offset));
+
+    if (blockSize > size) insertFree(offset + size, blockSize - size);
+
+    allocations.emplace(offset, size);
+    used += size;
+    return offset;
+}
+
+void FreeListAllocator::release(std::uint32_t offset) {
+
+    auto allocation = allocations.find(offset);
+    assert(allocation != allocations.end() && "Offset was not returned by allocate.");
+    if (allocation == allocations.end()) return;
+
+    std::uint32_t size = allocation->second;
+    allocations.erase(allocation);
+    used -= size;
+
+    // --- 1. Merge with the free block that ends where this one starts ---
+    auto next = freeByOffset.lower_bound(offset);
+    if (next != freeByOffset.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset) {
+            offset = previous->first;
+            size += previous->second;
+            eraseFree(previous);
+        }
+    }
+
+    // --- 2. Merge with the free block that starts where this one ends ---
+    next = freeByOffset.lower_bound(offset);
+    if (next != freeByOffset.end() && offset + size == next->first) {
+        size += next->second;
+        eraseFree(next);
+    }
+
+    insertFree(offset, size);
+}
+
+void FreeListAllocator::grow(std::uint32_t newCapacity) {
+
+    if (newCapacity <= capacity) return;
+
+    std::uint32_t offset = capacity;
+    std::uint32_t size = newCapacity - capacity;
+    capacity = newCapacity;
+
+    //a free block at the old end simply gets longer
+    if (!freeByOffset.empty()) {
+        auto last = std::prev(freeByOffset.end());
+        if (last->first + last->second == offset) {
+            offset = last->first;
+            size += last->second;
+            eraseFree(last);
+        }
+    }
+
+    insertFree(offset, size);
+}
+
+std::uint32_t FreeListAllocator::getLargestFreeBlock() const {
+    return freeBySize.empty() ? 0 : std::prev(freeBySize.end())->first;
+}
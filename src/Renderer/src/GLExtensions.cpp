@@ -0,0 +1,51 @@
+#include "GLExtensions.hpp"
+#include <glad/glad.h>
+#include <cstring>
+
+namespace {
+
+    using MultiDrawElementsIndirectProc = void (APIENTRY *)(GLenum mode, GLenum type, const void* indirect,
+                                                           GLsizei drawCount, GLsizei stride);
+
+    MultiDrawElementsIndirectProc multiDrawElementsIndirectProc = nullptr;
+    bool s3tc = false;
+
+    bool hasExtension(const char* name) {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++) {
+            const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+            if (extension && std::strcmp(extension, name) == 0) return true;
+        }
+        return false;
+    }
+}
+
+void GLExtensions::load(LoadProc loadProc) {
+
+    GLint major = 0;
+    GLint minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+
+    //a 3.3 core request usually gets the newest core version the driver has, macOS stops at 4.1.
+    //baseInstance in the commands is only honoured with ARB_base_instance
+    bool gl43 = major > 4 || (major == 4 && minor >= 3);
+    if (gl43 || (hasExtension("GL_ARB_multi_draw_indirect") && hasExtension("GL_ARB_base_instance"))) {
+        multiDrawElementsIndirectProc = reinterpret_cast<MultiDrawElementsIndirectProc>(loadProc("glMultiDrawElementsIndirect"));
+    }
+
+    s3tc = hasExtension("GL_EXT_texture_compression_s3tc");
+}
+
+bool GLExtensions::hasMultiDrawIndirect() {
+    return multiDrawElementsIndirectProc != nullptr;
+}
+
+bool GLExtensions::hasS3TC() {
+    return s3tc;
+}
+
+void GLExtensions::multiDrawElementsIndirect(unsigned int mode, unsigned int type, const void* indirect, int drawCount, int stride) {
+    multiDrawElementsIndirectProc(mode, type, indirect, drawCount, stride);
+}
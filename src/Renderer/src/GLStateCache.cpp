@@ -0,0 +1,64 @@
+#include "GLStateCache.hpp"
+#include <glad/glad.h>
+
+void GLStateCache::useProgram(unsigned int program) {
+
+    if (this->program == program) {
+        stats.redundantBinds++;
+        return;
+    }
+    this->program = program;
+    glUseProgram(program);
+    stats.programBinds++;
+}
+
+void GLStateCache::bindVertexArray(unsigned int vertexArray) {
+
+    if (this->vertexArray == vertexArray) {
+        stats.redundantBinds++;
+        return;
+    }
+    this->vertexArray = vertexArray;
+    glBindVertexArray(vertexArray);
+    stats.vertexArrayBinds++;
+}
+
+void GLStateCache::bindTexture2D(unsigned int unit, unsigned int texture) {
+
+    //units past the shadowed range are passed straight through
+    if (unit < MAX_TEXTURE_UNITS && textures[unit] == texture) {
+        stats.redundantBinds++;
+        return;
+    }
+
+    if (activeTextureUnit != unit) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        activeTextureUnit = unit;
+    }
+    glBindTexture(GL_TEXTURE_2D, texture);
+    if (unit < MAX_TEXTURE_UNITS) textures[unit] = texture;
+    stats.textureBinds++;
+}
+
+void GLStateCache::bindUniformBufferRange(unsigned int bindingPoint, unsigned int buffer, std::size_t offset, std::size_t size) {
+
+    if (bindingPoint < MAX_UNIFORM_BUFFERS) {
+        BufferRange& bound = uniformBuffers[bindingPoint];
+        if (bound.buffer == buffer && bound.offset == offset && bound.size == size) {
+            stats.redundantBinds++;
+            return;
+        }
+        bound = BufferRange{buffer, offset, size};
+    }
+
+    glBindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, buffer, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size));
+    stats.bufferRangeBinds++;
+}
+
+void GLStateCache::invalidate() {
+    program = UNKNOWN;
+    vertexArray = UNKNOWN;
+    activeTextureUnit = UNKNOWN;
+    textures.fill(UNKNOWN);
+    uniformBuffers.fill(BufferRange{});
+}
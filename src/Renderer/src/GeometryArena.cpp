@@ -0,0 +1,143 @@
+#include "GeometryArena.hpp"
+#include "InstanceBuffer.hpp"
+#include "Vertex.hpp"
+#include "Profiler.hpp"
+#include <glad/glad.h>
+#include <algorithm>
+#include <stdexcept>
+
+GeometryArena::GeometryArena(VertexFormat format, std::uint32_t initialVertices, std::uint32_t initialIndices)
+    : format(format), vertexAllocator(initialVertices), indexAllocator(initialIndices * 2) {
+
+    glGenVertexArrays(1, &VAO);
+    glGenVertexArrays(1, &depthVAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(initialVertices) * getVertexStride(), nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(initialIndices) * 2 * sizeof(std::uint16_t), nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    setupVertexArray(VAO, false);
+    setupVertexArray(depthVAO, true);
+}
+
+GeometryArena::~GeometryArena() {
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteVertexArrays(1, &depthVAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
+}
+
+std::size_t GeometryArena::getVertexStride() const {
+    return format == VertexFormat::PACKED ? sizeof(PackedVertex) : sizeof(Vertex);
+}
+
+void GeometryArena::setupVertexArray(unsigned int vertexArray, bool positionOnly) {
+    glBindVertexArray(vertexArray);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+    //attribute pointers capture whatever VBO is bound to GL_ARRAY_BUFFER
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+
+    //pbr.vert reads the same vec3/vec3/vec2 inputs either way, the fetch does the decoding
+    if (format == VertexFormat::PACKED) {
+        GLsizei stride = sizeof(PackedVertex);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, (void*)offsetof(PackedVertex, position));
+        if (!positionOnly) {
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)offsetof(PackedVertex, normal));
+            glEnableVertexAttribArray(2);
+            glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(PackedVertex, texCoords));
+        }
+    } else {
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+        if (!positionOnly) {
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+            glEnableVertexAttribArray(2);
+            glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+        }
+    }
+
+    InstanceBuffer::enableAttributes();
+    glBindVertexArray(0);
+}
+
+std::uint32_t GeometryArena::reserve(FreeListAllocator& allocator, unsigned int& buffer,
+                                     std::size_t elementSize, std::uint32_t count) {
+
+    std::uint32_t offset = allocator.allocate(count);
+    if (offset != FreeListAllocator::INVALID_OFFSET) return offset;
+
+    PROFILE_SCOPE("GeometryArena::grow");
+
+    //doubling keeps the number of copies logarithmic in the total geometry loaded
+    std::uint32_t oldCapacity = allocator.getCapacity();
+    std::uint32_t newCapacity = std::max(oldCapacity * 2, oldCapacity + count);
+
+    unsigned int grown = 0;
+    glGenBuffers(1, &grown);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(newCapacity) * elementSize, nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(oldCapacity) * elementSize);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glDeleteBuffers(1, &buffer);
+    buffer = grown;
+
+    //both VAOs still point at the deleted buffer
+    setupVertexArray(VAO, false);
+    setupVertexArray(depthVAO, true);
+
+    allocator.grow(newCapacity);
+    offset = allocator.allocate(count);
+    if (offset == FreeListAllocator::INVALID_OFFSET) {
+        throw std::runtime_error("GeometryArena failed to allocate after growing.");
+    }
+    return offset;
+}
+
+GeometryRange GeometryArena::allocate(const void* vertices, std::uint32_t vertexCount,
+                                      const void* indices, std::uint32_t indexCount, IndexType indexType) {
+
+    GeometryRange range;
+    range.vertexCount = vertexCount;
+    range.indexCount = indexCount;
+    range.indexType = indexType;
+    if (vertexCount == 0 || indexCount == 0) return range;
+
+    std::size_t stride = getVertexStride();
+    std::size_t indexSize = indexType == IndexType::UINT16 ? sizeof(std::uint16_t) : sizeof(std::uint32_t);
+
+    //even slot counts keep every free block, and so every 32-bit range, 4 byte aligned
+    std::uint32_t slots = static_cast<std::uint32_t>(indexCount * indexSize / sizeof(std::uint16_t));
+    slots += slots & 1u;
+
+    range.baseVertex = reserve(vertexAllocator, VBO, stride, vertexCount);
+    range.indexSlot = reserve(indexAllocator, EBO, sizeof(std::uint16_t), slots);
+    range.firstIndex = indexType == IndexType::UINT16 ? range.indexSlot : range.indexSlot / 2;
+
+    //uploads go through the copy targets so the VAO's element buffer binding is left alone
+    glBindBuffer(GL_COPY_WRITE_BUFFER, VBO);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(range.baseVertex) * stride,
+                    static_cast<GLsizeiptr>(vertexCount) * stride, vertices);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(range.indexSlot) * sizeof(std::uint16_t),
+                    static_cast<GLsizeiptr>(indexCount) * indexSize, indices);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    return range;
+}
+
+void GeometryArena::release(const GeometryRange& range) {
+    if (range.vertexCount == 0 || range.indexCount == 0) return;
+    vertexAllocator.release(range.baseVertex);
+    indexAllocator.release(range.indexSlot);
+}
@@ -0,0 +1,144 @@
+#include "GpuProfiler.hpp"
+#include "Profiler.hpp"
+#include <glad/glad.h>
+#include <cassert>
+#include <iostream>
+#include <limits>
+
+namespace {
+    constexpr std::size_t SKIPPED_ZONE = std::numeric_limits<std::size_t>::max();
+    constexpr std::uint32_t OPEN_QUERY = std::numeric_limits<std::uint32_t>::max();
+}
+
+GpuProfiler::GpuProfiler() {
+
+    //timer queries are core since 3.3, but some drivers report a zero-bit counter
+    GLint counterBits = 0;
+    glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &counterBits);
+    supported = counterBits > 0;
+
+    if (!supported) {
+        std::cerr << "GpuProfiler: GL_TIMESTAMP queries are not supported, GPU zones disabled" << std::endl;
+        return;
+    }
+
+    for (auto& frame : frames) {
+        frame.queries.resize(MAX_ZONES_PER_FRAME * 2);
+        frame.zones.reserve(MAX_ZONES_PER_FRAME);
+        glGenQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+    }
+
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    gpuToCpuOffsetNs = static_cast<std::int64_t>(Profiler::now()) - static_cast<std::int64_t>(gpuNow);
+}
+
+GpuProfiler::~GpuProfiler() {
+
+    if (!supported) return;
+
+    for (auto& frame : frames) {
+        glDeleteQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+    }
+}
+
+void GpuProfiler::beginFrame() {
+
+    if (!supported) return;
+
+    openZones.clear();
+    reservedQueries = 0;
+
+    //the slot we are about to reuse was recorded FRAME_LATENCY frames ago
+    currentFrame = frameCount % FRAME_LATENCY;
+    frameCount++;
+
+    Frame& frame = frames[currentFrame];
+    collect(frame);
+
+    frame.zones.clear();
+    frame.usedQueries = 0;
+    frame.pending = true;
+}
+
+void GpuProfiler::beginZone(const char* name) {
+
+    if (!supported) return;
+
+    //the zone's own pair plus the end of every zone still open around it
+    Frame& frame = frames[currentFrame];
+    if (frame.usedQueries + 2 + reservedQueries > frame.queries.size()) {
+        openZones.push_back(SKIPPED_ZONE);
+        return;
+    }
+
+    Zone zone;
+    zone.name = name;
+    zone.depth = static_cast<std::uint32_t>(openZones.size());
+    zone.startQuery = frame.usedQueries++;
+    zone.endQuery = OPEN_QUERY;
+
+    glQueryCounter(frame.queries[zone.startQuery], GL_TIMESTAMP);
+
+    reservedQueries++;
+    openZones.push_back(frame.zones.size());
+    frame.zones.push_back(zone);
+}
+
+void GpuProfiler::endZone() {
+
+    if (!supported || openZones.empty()) return;
+
+    std::size_t zoneIndex = openZones.back();
+    openZones.pop_back();
+    if (zoneIndex == SKIPPED_ZONE) return;
+
+    Frame& frame = frames[currentFrame];
+    Zone& zone = frame.zones[zoneIndex];
+    reservedQueries--;
+    zone.endQuery = frame.usedQueries++;
+    assert(zone.endQuery < frame.queries.size() && "GPU zone closed without a reserved end query");
+
+    glQueryCounter(frame.queries[zone.endQuery], GL_TIMESTAMP);
+}
+
+std::size_t GpuProfiler::getFreeZones() const {
+
+    if (!supported) return 0;
+
+    const Frame& frame = frames[currentFrame];
+    std::size_t used = frame.usedQueries + reservedQueries;
+    return used < frame.queries.size() ? (frame.queries.size() - used) / 2 : 0;
+}
+
+void GpuProfiler::collect(Frame& frame) {
+
+    if (!frame.pending || frame.usedQueries == 0) {
+        frame.pending = false;
+        return;
+    }
+    frame.pending = false;
+
+    //queries complete in submission order, so the last one tells us if the whole frame is ready
+    GLint available = 0;
+    glGetQueryObjectiv(frame.queries[frame.usedQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        //never block on readback, losing a frame of GPU timings is cheaper than a pipeline stall
+        droppedFrames++;
+        return;
+    }
+
+    for (auto const& zone : frame.zones) {
+        if (zone.endQuery == OPEN_QUERY) continue;
+
+        GLuint64 start = 0;
+        GLuint64 end = 0;
+        glGetQueryObjectui64v(frame.queries[zone.startQuery], GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(frame.queries[zone.endQuery], GL_QUERY_RESULT, &end);
+
+        Profiler::get().recordGpu(zone.name,
+                                  static_cast<std::uint64_t>(static_cast<std::int64_t>(start) + gpuToCpuOffsetNs),
+                                  static_cast<std::uint64_t>(static_cast<std::int64_t>(end) + gpuToCpuOffsetNs),
+                                  zone.depth);
+    }
+}
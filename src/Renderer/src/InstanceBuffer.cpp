@@ -0,0 +1,99 @@
+#include "InstanceBuffer.hpp"
+#include <glad/glad.h>
+#include <cstdint>
+
+InstanceBuffer::InstanceBuffer(std::size_t initialCapacity) {
+    glGenBuffers(1, &VBO);
+    allocate(initialCapacity);
+}
+
+InstanceBuffer::~InstanceBuffer() {
+    for (auto& fence : fences) {
+        if (fence) glDeleteSync(static_cast<GLsync>(fence));
+    }
+    glDeleteBuffers(1, &VBO);
+}
+
+void InstanceBuffer::allocate(std::size_t newCapacity) {
+
+    //the old storage is orphaned, the driver keeps it alive until in-flight draws finish
+    for (auto& fence : fences) {
+        if (fence) glDeleteSync(static_cast<GLsync>(fence));
+        fence = nullptr;
+    }
+
+    capacity = newCapacity;
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, capacity * FRAMES_IN_FLIGHT * sizeof(InstanceData), nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void InstanceBuffer::waitForSegment(std::size_t segment) {
+
+    GLsync fence = static_cast<GLsync>(fences[segment]);
+    if (!fence) return;
+
+    //usually signalled long ago, only blocks when the GPU is FRAMES_IN_FLIGHT frames behind
+    while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {}
+
+    glDeleteSync(fence);
+    fences[segment] = nullptr;
+}
+
+InstanceData* InstanceBuffer::map(std::size_t instanceCount) {
+
+    if (instanceCount > capacity) {
+        std::size_t newCapacity = capacity;
+        while (newCapacity < instanceCount) newCapacity *= 2;
+        allocate(newCapacity);
+    }
+
+    currentSegment = frameCount % FRAMES_IN_FLIGHT;
+    frameCount++;
+    waitForSegment(currentSegment);
+
+    if (instanceCount == 0) return nullptr;
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    void* data = glMapBufferRange(GL_ARRAY_BUFFER,
+                                  currentSegment * capacity * sizeof(InstanceData),
+                                  instanceCount * sizeof(InstanceData),
+                                  GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+    return static_cast<InstanceData*>(data);
+}
+
+void InstanceBuffer::unmap() {
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void InstanceBuffer::endFrame() {
+    if (fences[currentSegment]) glDeleteSync(static_cast<GLsync>(fences[currentSegment]));
+    fences[currentSegment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void InstanceBuffer::enableAttributes() {
+    //a mat4 takes four consecutive locations and a mat3 three
+    for (unsigned int i = 0; i < 7; i++) {
+        glEnableVertexAttribArray(FIRST_ATTRIBUTE + i);
+        glVertexAttribDivisor(FIRST_ATTRIBUTE + i, 1);
+    }
+}
+
+void InstanceBuffer::bindAttributes(std::size_t firstInstance) const {
+
+    //GL 3.3 has no base instance, so the attribute pointers move to the bucket instead
+    std::uintptr_t base = (currentSegment * capacity + firstInstance) * sizeof(InstanceData);
+    GLsizei stride = sizeof(InstanceData);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    for (unsigned int column = 0; column < 4; column++) {
+        std::uintptr_t offset = base + offsetof(InstanceData, model) + column * sizeof(glm::vec4);
+        glVertexAttribPointer(FIRST_ATTRIBUTE + column, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offset));
+    }
+    for (unsigned int column = 0; column < 3; column++) {
+        std::uintptr_t offset = base + offsetof(InstanceData, normalMatrix) + column * sizeof(glm::vec3);
+        glVertexAttribPointer(FIRST_ATTRIBUTE + 4 + column, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offset));
+    }
+}
@@ -0,0 +1,62 @@
+#include "LightBuffer.hpp"
+#include <glad/glad.h>
+#include <algorithm>
+#include <utility>
+
+LightBuffer::LightBuffer() {
+
+    //the format is fixed per texture, only the buffer storage changes each frame
+    const std::pair<TextureBuffer*, GLenum> targets[] = {
+        {&lightData, GL_RGBA32F},
+        {&clusterData, GL_RG32UI},
+        {&indexData, GL_R16UI}
+    };
+
+    for (const auto& [target, format] : targets) {
+        glGenBuffers(1, &target->buffer);
+        glGenTextures(1, &target->texture);
+
+        //a texture buffer needs storage before it can be attached
+        write(*target, nullptr, 32);
+        glBindTexture(GL_TEXTURE_BUFFER, target->texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, format, target->buffer);
+    }
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+LightBuffer::~LightBuffer() {
+    for (TextureBuffer* target : {&lightData, &clusterData, &indexData}) {
+        glDeleteTextures(1, &target->texture);
+        glDeleteBuffers(1, &target->buffer);
+    }
+}
+
+void LightBuffer::write(const TextureBuffer& target, const void* data, std::size_t bytes) {
+
+    //orphans last frame's storage, texture buffers follow the buffer object so no re-attach is needed
+    glBindBuffer(GL_TEXTURE_BUFFER, target.buffer);
+    glBufferData(GL_TEXTURE_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+    if (data && bytes > 0) glBufferSubData(GL_TEXTURE_BUFFER, 0, bytes, data);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void LightBuffer::upload(const std::vector<PointLight>& lights, const LightClusterGrid& grid) {
+
+    //never zero sized, an empty cluster list simply has every count at zero
+    const auto& clusters = grid.getClusters();
+    const auto& indices = grid.getLightIndices();
+
+    write(lightData, lights.empty() ? nullptr : lights.data(), std::max<std::size_t>(lights.size() * sizeof(PointLight), sizeof(PointLight)));
+    write(clusterData, clusters.data(), clusters.size() * sizeof(ClusterRange));
+    write(indexData, indices.empty() ? nullptr : indices.data(), std::max<std::size_t>(indices.size() * sizeof(std::uint16_t), sizeof(std::uint16_t)));
+}
+
+void LightBuffer::bind() const {
+
+    const TextureBuffer* targets[] = {&lightData, &clusterData, &indexData};
+    for (unsigned int i = 0; i < 3; i++) {
+        glActiveTexture(GL_TEXTURE0 + FIRST_TEXTURE_UNIT + i);
+        glBindTexture(GL_TEXTURE_BUFFER, targets[i]->texture);
+    }
+    glActiveTexture(GL_TEXTURE0);
+}
@@ -0,0 +1,224 @@
+#include "LightClusters.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define CLUSTERS_USE_SSE 1
+#else
+    #define CLUSTERS_USE_SSE 0
+#endif
+
+namespace {
+
+    //tiles covered by view space [minimum, maximum] along one axis, between two view depths
+    bool tileRange(float minimum, float maximum, float nearDepth, float farDepth, float scale, float shift,
+                   std::uint32_t tiles, std::int32_t& first, std::int32_t& last) {
+
+        float ndcMin = std::min(scale * minimum / nearDepth, scale * minimum / farDepth) - shift;
+        float ndcMax = std::max(scale * maximum / nearDepth, scale * maximum / farDepth) - shift;
+        if (ndcMax < -1.0f || ndcMin > 1.0f) return false;
+
+        std::int32_t lastTile = static_cast<std::int32_t>(tiles) - 1;
+        first = std::clamp(static_cast<std::int32_t>(std::floor((ndcMin * 0.5f + 0.5f) * tiles)), 0, lastTile);
+        last = std::clamp(static_cast<std::int32_t>(std::floor((ndcMax * 0.5f + 0.5f) * tiles)), 0, lastTile);
+        return true;
+    }
+}
+
+LightClusterGrid::LightClusterGrid() {
+    clusters.resize(CLUSTER_COUNT, ClusterRange{0, 0});
+    sliceDepths.resize(SLICES + 1, 0.0f);
+    for (auto* bounds : {&minX, &minY, &minZ, &maxX, &maxY, &maxZ}) {
+        bounds->resize(CLUSTER_COUNT + 3, 0.0f);
+    }
+}
+
+void LightClusterGrid::setProjection(const glm::mat4& projection) {
+
+    if (projection == this->projection) return;
+    this->projection = projection;
+
+    //near and far of an OpenGL perspective matrix
+    nearPlane = projection[3][2] / (projection[2][2] - 1.0f);
+    farPlane = projection[3][2] / (projection[2][2] + 1.0f);
+
+    float logRatio = std::log(farPlane / nearPlane);
+    depthScale = static_cast<float>(SLICES) / logRatio;
+    depthBias = static_cast<float>(SLICES) * std::log(nearPlane) / logRatio;
+
+    for (std::uint32_t slice = 0; slice <= SLICES; slice++) {
+        sliceDepths[slice] = nearPlane * std::pow(farPlane / nearPlane, static_cast<float>(slice) / SLICES);
+    }
+
+    buildClusterBounds();
+}
+
+std::int32_t LightClusterGrid::sliceForDepth(float viewDepth) const {
+    float slice = std::log(std::max(viewDepth, nearPlane)) * depthScale - depthBias;
+    return std::clamp(static_cast<std::int32_t>(std::floor(slice)), 0, static_cast<std::int32_t>(SLICES) - 1);
+}
+
+void LightClusterGrid::buildClusterBounds() {
+
+    glm::mat4 inverseProjection = glm::inverse(projection);
+
+    //view space direction through an NDC point, scaled to depth one
+    auto rayAtUnitDepth = [&](float ndcX, float ndcY) {
+        glm::vec4 point = inverseProjection * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+        glm::vec3 position = glm::vec3(point) / point.w;
+        return position / -position.z;
+    };
+
+    for (std::uint32_t y = 0; y < TILES_Y; y++) {
+        for (std::uint32_t x = 0; x < TILES_X; x++) {
+
+            float ndcX0 = -1.0f + 2.0f * x / TILES_X;
+            float ndcX1 = -1.0f + 2.0f * (x + 1) / TILES_X;
+            float ndcY0 = -1.0f + 2.0f * y / TILES_Y;
+            float ndcY1 = -1.0f + 2.0f * (y + 1) / TILES_Y;
+            glm::vec3 rays[4] = {rayAtUnitDepth(ndcX0, ndcY0), rayAtUnitDepth(ndcX1, ndcY0),
+                                 rayAtUnitDepth(ndcX0, ndcY1), rayAtUnitDepth(ndcX1, ndcY1)};
+
+            for (std::uint32_t slice = 0; slice < SLICES; slice++) {
+                float nearDepth = sliceDepths[slice];
+                float farDepth = sliceDepths[slice + 1];
+
+                glm::vec3 boundsMin(INFINITY);
+                glm::vec3 boundsMax(-INFINITY);
+                for (const glm::vec3& ray : rays) {
+                    for (float depth : {nearDepth, farDepth}) {
+                        boundsMin = glm::min(boundsMin, ray * depth);
+                        boundsMax = glm::max(boundsMax, ray * depth);
+                    }
+                }
+
+                std::uint32_t cluster = clusterIndex(x, y, slice);
+                minX[cluster] = boundsMin.x; minY[cluster] = boundsMin.y; minZ[cluster] = boundsMin.z;
+                maxX[cluster] = boundsMax.x; maxY[cluster] = boundsMax.y; maxZ[cluster] = boundsMax.z;
+            }
+        }
+    }
+}
+
+void LightClusterGrid::assign(const PointLight* lights, std::size_t count, const glm::mat4& view) {
+
+    PROFILE_SCOPE("LightClusterGrid::assign");
+
+    stats = LightClusterStats{};
+    stats.lights = count;
+    count = std::min(count, MAX_LIGHTS);
+
+    pairClusters.clear();
+    pairLights.clear();
+
+    // --- 1. Find the froxels each light's sphere touches ---
+    for (std::size_t i = 0; i < count; i++) {
+        const PointLight& light = lights[i];
+        glm::vec3 center = glm::vec3(view * glm::vec4(light.position, 1.0f));
+        float radius = light.range;
+        float depth = -center.z;
+        if (radius <= 0.0f || depth + radius < nearPlane || depth - radius > farPlane) continue;
+
+        std::int32_t firstSlice = sliceForDepth(depth - radius);
+        std::int32_t lastSlice = sliceForDepth(std::min(depth + radius, farPlane));
+
+        std::size_t pairsBefore = pairClusters.size();
+        float radiusSquared = radius * radius;
+
+        for (std::int32_t slice = firstSlice; slice <= lastSlice; slice++) {
+
+            //the part of the sphere inside this slice is no wider than its section closest to the center
+            float sliceNear = std::max(sliceDepths[slice], depth - radius);
+            float sliceFar = std::min(sliceDepths[slice + 1], depth + radius);
+            float offset = depth < sliceNear ? sliceNear - depth : (depth > sliceFar ? depth - sliceFar : 0.0f);
+            float sectionRadius = std::sqrt(std::max(radiusSquared - offset * offset, 0.0f));
+
+            //ndc = p00 * x / depth - p20, so the extremes lie on the slab's near or far face
+            std::int32_t firstX, lastX, firstY, lastY;
+            if (!tileRange(center.x - sectionRadius, center.x + sectionRadius, sliceNear, sliceFar,
+                           projection[0][0], projection[2][0], TILES_X, firstX, lastX) ||
+                !tileRange(center.y - sectionRadius, center.y + sectionRadius, sliceNear, sliceFar,
+                           projection[1][1], projection[2][1], TILES_Y, firstY, lastY)) {
+                continue;
+            }
+
+            for (std::int32_t y = firstY; y <= lastY; y++) {
+                std::uint32_t row = clusterIndex(0, y, slice);
+                std::int32_t x = firstX;
+
+#if CLUSTERS_USE_SSE
+                const __m128 zero = _mm_setzero_ps();
+                const __m128 cx = _mm_set1_ps(center.x);
+                const __m128 cy = _mm_set1_ps(center.y);
+                const __m128 cz = _mm_set1_ps(center.z);
+                const __m128 r2 = _mm_set1_ps(radiusSquared);
+
+                for (; x <= lastX; x += 4) {
+                    std::uint32_t cluster = row + x;
+
+                    //distance from the center to each box per axis, zero inside the slab
+                    __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&minX[cluster]), cx),
+                                                      _mm_sub_ps(cx, _mm_loadu_ps(&maxX[cluster]))), zero);
+                    __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&minY[cluster]), cy),
+                                                      _mm_sub_ps(cy, _mm_loadu_ps(&maxY[cluster]))), zero);
+                    __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&minZ[cluster]), cz),
+                                                      _mm_sub_ps(cz, _mm_loadu_ps(&maxZ[cluster]))), zero);
+                    __m128 distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+                    //lanes past lastX belong to the next row
+                    int mask = _mm_movemask_ps(_mm_cmple_ps(distanceSquared, r2)) & ((1 << std::min(4, lastX - x + 1)) - 1);
+                    for (int lane = 0; lane < 4; lane++) {
+                        if (mask & (1 << lane)) {
+                            pairClusters.push_back(cluster + lane);
+                            pairLights.push_back(static_cast<std::uint16_t>(i));
+                        }
+                    }
+                }
+#endif
+
+                for (; x <= lastX; x++) {
+                    std::uint32_t cluster = row + x;
+                    float dx = std::max({minX[cluster] - center.x, center.x - maxX[cluster], 0.0f});
+                    float dy = std::max({minY[cluster] - center.y, center.y - maxY[cluster], 0.0f});
+                    float dz = std::max({minZ[cluster] - center.z, center.z - maxZ[cluster], 0.0f});
+                    if (dx * dx + dy * dy + dz * dz <= radiusSquared) {
+                        pairClusters.push_back(cluster);
+                        pairLights.push_back(static_cast<std::uint16_t>(i));
+                    }
+                }
+            }
+        }
+
+        if (pairClusters.size() > pairsBefore) stats.assignedLights++;
+    }
+
+    // --- 2. Counting sort into one index list, runs capped at MAX_LIGHTS_PER_CLUSTER ---
+    for (auto& cluster : clusters) cluster = ClusterRange{0, 0};
+    for (std::uint32_t cluster : pairClusters) clusters[cluster].count++;
+
+    std::uint32_t offset = 0;
+    for (auto& cluster : clusters) {
+        stats.maxPerCluster = std::max<std::uint64_t>(stats.maxPerCluster, cluster.count);
+        std::uint32_t kept = std::min(cluster.count, MAX_LIGHTS_PER_CLUSTER);
+        stats.overflow += cluster.count - kept;
+
+        cluster.offset = offset;
+        cluster.count = 0;
+        offset += kept;
+    }
+    lightIndices.resize(offset);
+
+    //pairs arrive in light order, so a full cluster drops its highest light indices
+    for (std::size_t p = 0; p < pairClusters.size(); p++) {
+        std::uint32_t c = pairClusters[p];
+        ClusterRange& cluster = clusters[c];
+        std::uint32_t end = c + 1 < CLUSTER_COUNT ? clusters[c + 1].offset : offset;
+        if (cluster.offset + cluster.count < end) {
+            lightIndices[cluster.offset + cluster.count++] = pairLights[p];
+        }
+    }
+
+    stats.indices = lightIndices.size();
+}
@@ -0,0 +1,41 @@
+#include "MaterialBuffer.hpp"
+#include "GLStateCache.hpp"
+#include <glad/glad.h>
+#include <cstring>
+
+MaterialBuffer::MaterialBuffer() {
+
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    if (alignment <= 0) alignment = 256;
+
+    //round the entry size up so every material starts on a bindable offset
+    std::size_t align = static_cast<std::size_t>(alignment);
+    stride = ((sizeof(GpuMaterial) + align - 1) / align) * align;
+
+    glGenBuffers(1, &UBO);
+}
+
+MaterialBuffer::~MaterialBuffer() {
+    glDeleteBuffers(1, &UBO);
+}
+
+void MaterialBuffer::upload(const std::vector<GpuMaterial>& materials) {
+
+    std::vector<unsigned char> staging(materials.size() * stride, 0);
+    for (std::size_t i = 0; i < materials.size(); i++) {
+        std::memcpy(&staging[i * stride], &materials[i], sizeof(GpuMaterial));
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferData(GL_UNIFORM_BUFFER, staging.size(), staging.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    count = materials.size();
+}
+
+void MaterialBuffer::bind(std::uint32_t materialIndex, GLStateCache& stateCache) const {
+
+    if (materialIndex >= count) materialIndex = 0;
+    stateCache.bindUniformBufferRange(BINDING_POINT, UBO, materialIndex * stride, sizeof(GpuMaterial));
+}
@@ -1,69 +1,134 @@
 #include "Mesh.hpp"
-#include "AssetManager.hpp"
+#include "MeshOptimizer.hpp"
+#include "MeshSimplifier.hpp"
+#include "Profiler.hpp"
 #include <glad/glad.h>
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <glm/gtc/type_ptr.hpp> 
 
-Mesh::Mesh(std::vector<Vertex>&& vertices, std::vector<unsigned int>&& indices, std::vector<SubMesh>&& subMeshes)  {
+namespace {
+
+    std::uint32_t nextMeshID() {
+        static std::uint32_t nextID = 0;
+        return nextID++;
+    }
+}
+
+Mesh::Mesh(std::vector<Vertex>&& vertices, std::vector<unsigned int>&& indices, std::vector<SubMesh>&& subMeshes,
+           std::shared_ptr<GeometryArena> arena, bool keepCPUData, std::vector<MeshLOD>&& lods)  {
     this->vertices = std::move(vertices);
     this->indices = std::move(indices);
     this->subMeshes = std::move(subMeshes);
-    setupMesh();
+    this->arena = std::move(arena);
+    this->lods = std::move(lods);
+    if (this->lods.empty()) this->lods.push_back(MeshLOD{});
+
+    id = nextMeshID();
+
+    for (const auto& vertex : this->vertices) {
+        bounds.expand(vertex.Position);
+    }
+
+    upload();
+    offsetSubMeshes();
+
+    if (!keepCPUData) {
+        std::vector<Vertex>().swap(this->vertices);
+        std::vector<unsigned int>().swap(this->indices);
+    }
+}
+
+Mesh::Mesh(const void* vertices, std::uint32_t vertexCount, const void* indices, std::uint32_t indexCount, IndexType indexType,
+           std::vector<SubMesh>&& subMeshes, std::vector<MeshLOD>&& lods, const AABB& bounds,
+           const glm::mat4& positionTransform, bool quantized, std::shared_ptr<GeometryArena> arena) {
+    this->subMeshes = std::move(subMeshes);
+    this->lods = std::move(lods);
+    if (this->lods.empty()) this->lods.push_back(MeshLOD{});
+    this->arena = std::move(arena);
+    this->bounds = bounds;
+    this->positionTransform = positionTransform;
+    this->quantized = quantized;
+    id = nextMeshID();
+
+    range = this->arena->allocate(vertices, vertexCount, indices, indexCount, indexType);
+    offsetSubMeshes();
 }
 
-void Mesh::setupMesh() {
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
-    glBindVertexArray(0);
+void Mesh::offsetSubMeshes() {
+    for (auto& subMesh : subMeshes) {
+        subMesh.indexOffset += range.firstIndex;
+        subMesh.baseVertex += static_cast<int>(range.baseVertex);
+    }
 }
 
-void Mesh::draw(Shader& shader, AssetManager& assetManager) {
+void Mesh::upload() {
 
-    glBindVertexArray(VAO);
+    std::uint32_t vertexCount = static_cast<std::uint32_t>(vertices.size());
+    std::uint32_t indexCount = static_cast<std::uint32_t>(indices.size());
 
-    for (const auto& subMesh : subMeshes) {
-        auto material = assetManager.getMaterial(subMesh.materialName);
+    // --- 1. Vertices in the arena's format ---
+    const void* vertexData = vertices.data();
+    std::vector<PackedVertex> packedVertices;
+    if (arena->getFormat() == VertexFormat::PACKED) {
+        PositionQuantization quantization = PositionQuantization::fromBounds(bounds);
+        positionTransform = quantization.toMatrix();
+        quantized = true;
 
-        if (material->albedoMap) {
-            glActiveTexture(GL_TEXTURE0); 
-            material->albedoMap->bind();
+        packedVertices.reserve(vertices.size());
+        for (const auto& vertex : vertices) {
+            packedVertices.push_back(VertexPacking::pack(vertex, quantization));
         }
+        vertexData = packedVertices.data();
+    }
 
-        shader.setVec4("albedoFactor", material->albedoFactor);
-        shader.setFloat("metallicFactor", material->metallicFactor);
-        shader.setFloat("roughnessFactor", material->roughnessFactor);
-        shader.setVec3("emissiveFactor", material->emissiveFactor);
-        shader.setBool("doubleSided", material->doubleSided);
-        glDrawElements(GL_TRIANGLES, 
-                       subMesh.indexCount, 
-                       GL_UNSIGNED_INT, 
-                       (void*)(subMesh.indexOffset * sizeof(unsigned int)));
+    // --- 2. Indices, 16-bit whenever every index fits ---
+    //indices are local to their primitive, so the mesh's vertex count bounds every index
+    if (vertexCount <= 0x10000) {
+        std::vector<std::uint16_t> shortIndices(indices.begin(), indices.end());
+        range = arena->allocate(vertexData, vertexCount, shortIndices.data(), indexCount, IndexType::UINT16);
+    } else {
+        range = arena->allocate(vertexData, vertexCount, indices.data(), indexCount, IndexType::UINT32);
     }
-    glBindVertexArray(0);
 }
 
-std::shared_ptr<Mesh> Mesh::CreateFromGLTF(const tinygltf::Model& model, const tinygltf::Mesh& gltfMesh) {
-    std::vector<Vertex> vertices;
-    std::vector<unsigned int> indices;
-    std::vector<SubMesh> subMeshes;
+Mesh::~Mesh() {
+    arena->release(range);
+}
+
+std::shared_ptr<Mesh> Mesh::CreateFromGLTF(const tinygltf::Model& model, const tinygltf::Mesh& gltfMesh,
+                                           MaterialID firstMaterial, std::shared_ptr<GeometryArena> arena,
+                                           const MeshImportOptions& options) {
+    return Create(ProcessGLTF(model, gltfMesh, firstMaterial, options), std::move(arena), options.keepCPUData);
+}
+
+std::shared_ptr<Mesh> Mesh::Create(MeshData&& data, std::shared_ptr<GeometryArena> arena, bool keepCPUData) {
+    return std::make_shared<Mesh>(std::move(data.vertices), std::move(data.indices), std::move(data.subMeshes),
+                                  std::move(arena), keepCPUData, std::move(data.lods));
+}
+
+MeshData Mesh::ProcessGLTF(const tinygltf::Model& model, const tinygltf::Mesh& gltfMesh, MaterialID firstMaterial,
+                           const MeshImportOptions& options) {
+
+    PROFILE_SCOPE("Mesh::ProcessGLTF");
+
+    //per primitive: its optimized vertices and one index list per LOD, all over those vertices
+    struct Primitive {
+        std::vector<Vertex> vertices;
+        std::vector<std::vector<std::uint32_t>> lodIndices;
+        std::vector<float> lodErrors;
+        MaterialID materialID = 0;
+    };
+    std::vector<Primitive> primitives;
+    MeshOptimizationReport meshReport;
+    std::size_t lodCount = 1;
 
-    for (const auto& primitive : gltfMesh.primitives) {
-        SubMesh subMesh;
-        // This is the key fix: we track the starting index for this primitive's vertices
-        unsigned int baseVertex = static_cast<unsigned int>(vertices.size());
-        unsigned int indexOffset = static_cast<unsigned int>(indices.size());
+    for (const auto& gltfPrimitive : gltfMesh.primitives) {
+        Primitive& primitive = primitives.emplace_back();
+        std::vector<Vertex>& primitiveVertices = primitive.vertices;
+        std::vector<std::uint32_t>& primitiveIndices = primitive.lodIndices.emplace_back();
+        primitive.lodErrors.push_back(0.0f);
         
         // --- Process Vertices ---
         const float* positions = nullptr;
@@ -71,19 +136,19 @@ std::shared_ptr<Mesh> Mesh::CreateFromGLTF(const tinygltf::Model& model, const t
         const float* texcoords = nullptr;
         size_t vertexCount = 0;
 
-        if (primitive.attributes.count("POSITION")) {
-            const auto& accessor = model.accessors[primitive.attributes.at("POSITION")];
+        if (gltfPrimitive.attributes.count("POSITION")) {
+            const auto& accessor = model.accessors[gltfPrimitive.attributes.at("POSITION")];
             const auto& view = model.bufferViews[accessor.bufferView];
             positions = reinterpret_cast<const float*>(&(model.buffers[view.buffer].data[accessor.byteOffset + view.byteOffset]));
             vertexCount = accessor.count;
         }
-        if (primitive.attributes.count("NORMAL")) {
-            const auto& accessor = model.accessors[primitive.attributes.at("NORMAL")];
+        if (gltfPrimitive.attributes.count("NORMAL")) {
+            const auto& accessor = model.accessors[gltfPrimitive.attributes.at("NORMAL")];
             const auto& view = model.bufferViews[accessor.bufferView];
             normals = reinterpret_cast<const float*>(&(model.buffers[view.buffer].data[accessor.byteOffset + view.byteOffset]));
         }
-        if (primitive.attributes.count("TEXCOORD_0")) {
-            const auto& accessor = model.accessors[primitive.attributes.at("TEXCOORD_0")];
+        if (gltfPrimitive.attributes.count("TEXCOORD_0")) {
+            const auto& accessor = model.accessors[gltfPrimitive.attributes.at("TEXCOORD_0")];
             const auto& view = model.bufferViews[accessor.bufferView];
             texcoords = reinterpret_cast<const float*>(&(model.buffers[view.buffer].data[accessor.byteOffset + view.byteOffset]));
         }
@@ -93,34 +158,111 @@ std::shared_ptr<Mesh> Mesh::CreateFromGLTF(const tinygltf::Model& model, const t
             vertex.Position = glm::make_vec3(&positions[i * 3]);
             if (normals) vertex.Normal = glm::make_vec3(&normals[i * 3]);
             if (texcoords) vertex.TexCoords = glm::make_vec2(&texcoords[i * 2]);
-            vertices.push_back(vertex);
+            primitiveVertices.push_back(vertex);
         }
         
         // --- Process Indices ---
-        const tinygltf::Accessor& indexAccessor = model.accessors[primitive.indices];
+        const tinygltf::Accessor& indexAccessor = model.accessors[gltfPrimitive.indices];
         const tinygltf::BufferView& indexBufferView = model.bufferViews[indexAccessor.bufferView];
         const tinygltf::Buffer& indexBuffer = model.buffers[indexBufferView.buffer];
         const void* indexData = &indexBuffer.data[indexBufferView.byteOffset + indexAccessor.byteOffset];
         
         for (size_t i = 0; i < indexAccessor.count; i++) {
-            // Add the baseVertex offset to correctly map the index to the combined vertex buffer
             if (indexAccessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT) {
-                indices.push_back(baseVertex + static_cast<const unsigned short*>(indexData)[i]);
+                primitiveIndices.push_back(static_cast<const unsigned short*>(indexData)[i]);
             } else if (indexAccessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT) {
-                indices.push_back(baseVertex + static_cast<const unsigned int*>(indexData)[i]);
+                primitiveIndices.push_back(static_cast<const unsigned int*>(indexData)[i]);
             }
         }
 
-        if (primitive.material >= 0) {
-            subMesh.materialName = model.materials[primitive.material].name;
-        } else {
-            subMesh.materialName = "default";
+        // --- Optimize for the post-transform cache, overdraw and vertex fetch ---
+        MeshOptimizationReport report = MeshOptimizer::optimize(primitiveVertices, primitiveIndices);
+        meshReport.verticesBefore += report.verticesBefore;
+        meshReport.verticesAfter += report.verticesAfter;
+        meshReport.acmrBefore += report.acmrBefore * report.triangles;
+        meshReport.acmrAfter += report.acmrAfter * report.triangles;
+        meshReport.triangles += report.triangles;
+
+        // --- Simplified LODs, each simplified from LOD 0 so errors are measured against it ---
+        if (options.generateLODs) {
+            AABB primitiveBounds;
+            for (const auto& vertex : primitiveVertices) primitiveBounds.expand(vertex.Position);
+            float maxError = glm::length(primitiveBounds.max - primitiveBounds.min) * options.maxLODError;
+
+            const std::vector<std::uint32_t> base = primitive.lodIndices[0];
+            for (std::uint32_t level = 1; level < options.maxLODs; level++) {
+                const std::vector<std::uint32_t>& previous = primitive.lodIndices.back();
+                if (previous.size() / 3 < MIN_LOD_TRIANGLES) break;
+
+                std::size_t target = (base.size() >> level) / 3 * 3;
+                float error = 0.0f;
+                std::vector<std::uint32_t> simplified = MeshSimplifier::simplify(primitiveVertices, base, target, maxError, &error);
+
+                //not worth a level if the error bound stopped it early
+                if (simplified.size() * 5 > previous.size() * 4) break;
+
+                MeshOptimizer::optimizeVertexCache(simplified, primitiveVertices.size());
+                primitive.lodIndices.push_back(std::move(simplified));
+                primitive.lodErrors.push_back(std::max(error, primitive.lodErrors.back()));
+            }
+            lodCount = std::max(lodCount, primitive.lodIndices.size());
+        }
+
+        //resolved once here, a draw never looks materials up by name
+        if (gltfPrimitive.material >= 0) {
+            primitive.materialID = firstMaterial + static_cast<MaterialID>(gltfPrimitive.material);
+        }
+    }
+
+#if SUPERPOSITION_PROFILING
+    if (meshReport.triangles > 0) {
+        std::cout << "Mesh '" << gltfMesh.name << "': " << meshReport.verticesBefore << " -> " << meshReport.verticesAfter
+                  << " vertices, ACMR " << meshReport.acmrBefore / meshReport.triangles
+                  << " -> " << meshReport.acmrAfter / meshReport.triangles << ", " << lodCount << " LODs" << std::endl;
+    }
+#endif
+
+    // --- Flatten into LOD-major submeshes over one vertex and index array ---
+    MeshData data;
+    std::vector<Vertex>& vertices = data.vertices;
+    std::vector<unsigned int>& indices = data.indices;
+    std::vector<SubMesh>& subMeshes = data.subMeshes;
+    std::vector<MeshLOD>& lods = data.lods;
+    lods.resize(lodCount);
+
+    //indices stay local to the primitive, the draw adds its base vertex
+    std::vector<int> baseVertices;
+    for (const auto& primitive : primitives) {
+        baseVertices.push_back(static_cast<int>(vertices.size()));
+        vertices.insert(vertices.end(), primitive.vertices.begin(), primitive.vertices.end());
+    }
+
+    for (std::size_t level = 0; level < lodCount; level++) {
+        lods[level].firstSubMesh = static_cast<std::uint32_t>(subMeshes.size());
+
+        for (std::size_t p = 0; p < primitives.size(); p++) {
+            const Primitive& primitive = primitives[p];
+
+            //primitives with a shorter chain reuse the indices of their last level
+            if (level >= primitive.lodIndices.size()) {
+                SubMesh reused = subMeshes[lods[level - 1].firstSubMesh + p];
+                subMeshes.push_back(reused);
+                lods[level].error = std::max(lods[level].error, primitive.lodErrors.back());
+                continue;
+            }
+
+            const auto& lodIndices = primitive.lodIndices[level];
+            SubMesh subMesh;
+            subMesh.materialID = primitive.materialID;
+            subMesh.indexOffset = static_cast<unsigned int>(indices.size());
+            subMesh.indexCount = static_cast<unsigned int>(lodIndices.size());
+            subMesh.baseVertex = baseVertices[p];
+            subMeshes.push_back(subMesh);
+
+            indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+            lods[level].error = std::max(lods[level].error, primitive.lodErrors[level]);
         }
-        
-        subMesh.indexOffset = indexOffset;
-        subMesh.indexCount = indexAccessor.count;
-        subMeshes.push_back(subMesh);
     }
-    
-    return std::make_shared<Mesh>(std::move(vertices), std::move(indices), std::move(subMeshes));
-}
\ No newline at end of file
+
+    return data;
+}
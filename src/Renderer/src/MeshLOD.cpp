@@ -0,0 +1,26 @@
+#include "MeshLOD.hpp"
+
+std::uint32_t LODSelection::select(const MeshLOD* lods, std::size_t lodCount, std::uint32_t currentLOD,
+                                   float pixelsPerUnit, float thresholdPixels, float hysteresis) {
+
+    if (lodCount <= 1) return 0;
+    if (currentLOD >= lodCount) currentLOD = static_cast<std::uint32_t>(lodCount - 1);
+
+    //errors grow with the LOD index, so the first LOD over the threshold ends the search
+    std::uint32_t desired = 0;
+    for (std::uint32_t lod = 1; lod < lodCount; lod++) {
+        if (lods[lod].error * pixelsPerUnit > thresholdPixels) break;
+        desired = lod;
+    }
+
+    //finer is always allowed, quality never waits on the hysteresis band
+    if (desired <= currentLOD) return desired;
+
+    float coarseThreshold = thresholdPixels * (1.0f - hysteresis);
+    std::uint32_t coarser = currentLOD;
+    for (std::uint32_t lod = currentLOD + 1; lod <= desired; lod++) {
+        if (lods[lod].error * pixelsPerUnit > coarseThreshold) break;
+        coarser = lod;
+    }
+    return coarser;
+}
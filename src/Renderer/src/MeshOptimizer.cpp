@@ -0,0 +1,307 @@
+#include "MeshOptimizer.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace {
+
+    // Forsyth's scoring, see "Linear-Speed Vertex Cache Optimisation"
+    constexpr unsigned int FORSYTH_CACHE_SIZE = 32;
+    constexpr float CACHE_DECAY_POWER = 1.5f;
+    constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+    constexpr float VALENCE_BOOST_SCALE = 2.0f;
+    constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+    float vertexScore(int cachePosition, std::uint32_t remainingTriangles) {
+
+        if (remainingTriangles == 0) return -1.0f;
+
+        float score = 0.0f;
+        if (cachePosition >= 0) {
+            //the three vertices of the last triangle score the same, otherwise the order would
+            //depend on which one was written last
+            if (cachePosition < 3) {
+                score = LAST_TRIANGLE_SCORE;
+            } else {
+                float scale = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+                score = std::pow(1.0f - (cachePosition - 3) * scale, CACHE_DECAY_POWER);
+            }
+        }
+
+        //vertices with few triangles left are finished off first so they leave the working set
+        score += VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingTriangles), -VALENCE_BOOST_POWER);
+        return score;
+    }
+}
+
+std::size_t MeshOptimizer::weldVertices(std::vector<Vertex>& vertices, std::vector<std::uint32_t>& indices) {
+
+    std::unordered_map<Vertex, std::uint32_t> unique;
+    unique.reserve(vertices.size());
+
+    std::vector<std::uint32_t> remap(vertices.size());
+    std::vector<Vertex> welded;
+    welded.reserve(vertices.size());
+
+    for (std::size_t i = 0; i < vertices.size(); i++) {
+        auto inserted = unique.emplace(vertices[i], static_cast<std::uint32_t>(welded.size()));
+        if (inserted.second) welded.push_back(vertices[i]);
+        remap[i] = inserted.first->second;
+    }
+
+    for (auto& index : indices) index = remap[index];
+
+    std::size_t removed = vertices.size() - welded.size();
+    vertices.swap(welded);
+    return removed;
+}
+
+void MeshOptimizer::optimizeVertexCache(std::vector<std::uint32_t>& indices, std::size_t vertexCount) {
+
+    const std::size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || vertexCount == 0) return;
+
+    // --- 1. Vertex to triangle adjacency ---
+    std::vector<std::uint32_t> remaining(vertexCount, 0);
+    for (std::uint32_t index : indices) remaining[index]++;
+
+    std::vector<std::uint32_t> offsets(vertexCount + 1, 0);
+    for (std::size_t v = 0; v < vertexCount; v++) offsets[v + 1] = offsets[v] + remaining[v];
+
+    std::vector<std::uint32_t> adjacency(indices.size());
+    std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (std::size_t t = 0; t < triangleCount; t++) {
+        for (int corner = 0; corner < 3; corner++) {
+            adjacency[fill[indices[t * 3 + corner]]++] = static_cast<std::uint32_t>(t);
+        }
+    }
+
+    // --- 2. Initial scores ---
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> scores(vertexCount);
+    for (std::size_t v = 0; v < vertexCount; v++) scores[v] = vertexScore(-1, remaining[v]);
+
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<std::uint8_t> emitted(triangleCount, 0);
+    for (std::size_t t = 0; t < triangleCount; t++) {
+        triangleScores[t] = scores[indices[t * 3]] + scores[indices[t * 3 + 1]] + scores[indices[t * 3 + 2]];
+    }
+
+    // --- 3. Greedy emission ---
+    std::vector<std::uint32_t> output;
+    output.reserve(indices.size());
+
+    //one slot per cache entry plus room for the three vertices pushed by each triangle
+    std::vector<std::uint32_t> cache;
+    std::vector<std::uint32_t> nextCache;
+    cache.reserve(FORSYTH_CACHE_SIZE + 3);
+    nextCache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+    std::size_t scanStart = 0;
+    std::int64_t best = 0;
+    {
+        float bestScore = -1.0f;
+        for (std::size_t t = 0; t < triangleCount; t++) {
+            if (triangleScores[t] > bestScore) {
+                bestScore = triangleScores[t];
+                best = static_cast<std::int64_t>(t);
+            }
+        }
+    }
+
+    while (best >= 0) {
+        std::size_t triangle = static_cast<std::size_t>(best);
+        emitted[triangle] = 1;
+
+        const std::uint32_t* corners = &indices[triangle * 3];
+        output.insert(output.end(), corners, corners + 3);
+
+        //the emitted triangle's vertices move to the front, the rest keep their order
+        nextCache.assign(corners, corners + 3);
+        for (std::uint32_t vertex : cache) {
+            if (vertex != corners[0] && vertex != corners[1] && vertex != corners[2]) nextCache.push_back(vertex);
+        }
+
+        //the emitted triangle is no longer adjacent to its vertices
+        for (int corner = 0; corner < 3; corner++) {
+            std::uint32_t vertex = corners[corner];
+            std::uint32_t* begin = &adjacency[offsets[vertex]];
+            std::uint32_t* end = begin + remaining[vertex];
+            std::uint32_t* found = std::find(begin, end, static_cast<std::uint32_t>(triangle));
+            if (found != end) {
+                std::swap(*found, *(end - 1));
+                remaining[vertex]--;
+            }
+        }
+
+        //rescore everything that was in the cache, including vertices that just fell out
+        for (std::size_t i = 0; i < nextCache.size(); i++) {
+            std::uint32_t vertex = nextCache[i];
+            cachePosition[vertex] = i < FORSYTH_CACHE_SIZE ? static_cast<int>(i) : -1;
+            float score = vertexScore(cachePosition[vertex], remaining[vertex]);
+            float delta = score - scores[vertex];
+            scores[vertex] = score;
+
+            for (std::uint32_t a = 0; a < remaining[vertex]; a++) {
+                triangleScores[adjacency[offsets[vertex] + a]] += delta;
+            }
+        }
+
+        //the best next triangle is nearly always adjacent to the cache
+        best = -1;
+        float bestScore = -1.0f;
+        std::size_t cached = std::min<std::size_t>(nextCache.size(), FORSYTH_CACHE_SIZE);
+        for (std::size_t i = 0; i < cached; i++) {
+            std::uint32_t vertex = nextCache[i];
+            for (std::uint32_t a = 0; a < remaining[vertex]; a++) {
+                std::uint32_t candidate = adjacency[offsets[vertex] + a];
+                if (triangleScores[candidate] > bestScore) {
+                    bestScore = triangleScores[candidate];
+                    best = candidate;
+                }
+            }
+        }
+
+        nextCache.resize(cached);
+        cache.swap(nextCache);
+
+        //cache exhausted, continue with the next triangle in input order
+        if (best < 0) {
+            while (scanStart < triangleCount && emitted[scanStart]) scanStart++;
+            if (scanStart < triangleCount) best = static_cast<std::int64_t>(scanStart);
+        }
+    }
+
+    indices.swap(output);
+}
+
+void MeshOptimizer::optimizeOverdraw(std::vector<std::uint32_t>& indices, const std::vector<Vertex>& vertices) {
+
+    const std::size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2) return;
+
+    // --- 1. Clusters start wherever a triangle misses the cache on all three vertices ---
+    std::vector<std::size_t> clusterStarts;
+    std::vector<std::uint32_t> timestamps(vertices.size(), 0);
+    std::uint32_t time = CACHE_SIZE + 1;
+
+    for (std::size_t t = 0; t < triangleCount; t++) {
+        int misses = 0;
+        for (int corner = 0; corner < 3; corner++) {
+            std::uint32_t vertex = indices[t * 3 + corner];
+            if (time - timestamps[vertex] > CACHE_SIZE) {
+                timestamps[vertex] = time++;
+                misses++;
+            }
+        }
+        if (misses == 3 || t == 0) clusterStarts.push_back(t);
+    }
+    clusterStarts.push_back(triangleCount);
+
+    std::size_t clusterCount = clusterStarts.size() - 1;
+    if (clusterCount < 2) return;
+
+    // --- 2. Sort key: how far the cluster faces away from the mesh center ---
+    glm::vec3 meshCenter(0.0f);
+    float meshArea = 0.0f;
+    std::vector<glm::vec3> clusterCenters(clusterCount, glm::vec3(0.0f));
+    std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3(0.0f));
+    std::vector<float> clusterAreas(clusterCount, 0.0f);
+
+    for (std::size_t c = 0; c < clusterCount; c++) {
+        for (std::size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++) {
+            const glm::vec3& a = vertices[indices[t * 3]].Position;
+            const glm::vec3& b = vertices[indices[t * 3 + 1]].Position;
+            const glm::vec3& d = vertices[indices[t * 3 + 2]].Position;
+
+            //area weighted, the cross product's length is twice the triangle's area
+            glm::vec3 normal = glm::cross(b - a, d - a);
+            float area = glm::length(normal);
+            glm::vec3 center = (a + b + d) * (area / 3.0f);
+
+            clusterCenters[c] += center;
+            clusterNormals[c] += normal;
+            clusterAreas[c] += area;
+            meshCenter += center;
+            meshArea += area;
+        }
+    }
+    if (meshArea > 0.0f) meshCenter /= meshArea;
+
+    std::vector<float> sortKeys(clusterCount, 0.0f);
+    for (std::size_t c = 0; c < clusterCount; c++) {
+        if (clusterAreas[c] <= 0.0f) continue;
+        glm::vec3 center = clusterCenters[c] / clusterAreas[c];
+        float normalLength = glm::length(clusterNormals[c]);
+        if (normalLength > 0.0f) sortKeys[c] = glm::dot(center - meshCenter, clusterNormals[c] / normalLength);
+    }
+
+    // --- 3. Emit clusters from most outward facing to least ---
+    std::vector<std::size_t> order(clusterCount);
+    for (std::size_t c = 0; c < clusterCount; c++) order[c] = c;
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return sortKeys[a] > sortKeys[b]; });
+
+    std::vector<std::uint32_t> output;
+    output.reserve(indices.size());
+    for (std::size_t c : order) {
+        output.insert(output.end(), indices.begin() + clusterStarts[c] * 3, indices.begin() + clusterStarts[c + 1] * 3);
+    }
+    indices.swap(output);
+}
+
+void MeshOptimizer::optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<std::uint32_t>& indices) {
+
+    constexpr std::uint32_t UNUSED = ~0u;
+    std::vector<std::uint32_t> remap(vertices.size(), UNUSED);
+    std::vector<Vertex> ordered;
+    ordered.reserve(vertices.size());
+
+    for (auto& index : indices) {
+        if (remap[index] == UNUSED) {
+            remap[index] = static_cast<std::uint32_t>(ordered.size());
+            ordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+
+    vertices.swap(ordered);
+}
+
+float MeshOptimizer::computeACMR(const std::vector<std::uint32_t>& indices, std::size_t vertexCount, unsigned int cacheSize) {
+
+    if (indices.size() < 3) return 0.0f;
+
+    //a vertex is cached while fewer than cacheSize misses happened since it was loaded
+    std::vector<std::uint32_t> timestamps(vertexCount, 0);
+    std::uint32_t time = cacheSize + 1;
+    std::size_t misses = 0;
+
+    for (std::uint32_t index : indices) {
+        if (time - timestamps[index] > cacheSize) {
+            timestamps[index] = time++;
+            misses++;
+        }
+    }
+
+    return static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+}
+
+MeshOptimizationReport MeshOptimizer::optimize(std::vector<Vertex>& vertices, std::vector<std::uint32_t>& indices) {
+
+    PROFILE_SCOPE("MeshOptimizer::optimize");
+
+    MeshOptimizationReport report;
+    report.verticesBefore = vertices.size();
+    report.triangles = indices.size() / 3;
+    report.acmrBefore = computeACMR(indices, vertices.size());
+
+    weldVertices(vertices, indices);
+    optimizeVertexCache(indices, vertices.size());
+    optimizeOverdraw(indices, vertices);
+    optimizeVertexFetch(vertices, indices);
+
+    report.verticesAfter = vertices.size();
+    report.acmrAfter = computeACMR(indices, vertices.size());
+    return report;
+}
@@ -0,0 +1,244 @@
+#include "MeshSimplifier.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+    // Sum of squared distances to a set of planes, weighted by triangle area
+    struct Quadric {
+        double a2 = 0, ab = 0, ac = 0, ad = 0;
+        double b2 = 0, bc = 0, bd = 0;
+        double c2 = 0, cd = 0;
+        double d2 = 0;
+        double weight = 0;
+
+        void addPlane(const glm::vec3& normal, float distance, double area) {
+            double a = normal.x, b = normal.y, c = normal.z, d = distance;
+            a2 += area * a * a; ab += area * a * b; ac += area * a * c; ad += area * a * d;
+            b2 += area * b * b; bc += area * b * c; bd += area * b * d;
+            c2 += area * c * c; cd += area * c * d;
+            d2 += area * d * d;
+            weight += area;
+        }
+
+        void add(const Quadric& other) {
+            a2 += other.a2; ab += other.ab; ac += other.ac; ad += other.ad;
+            b2 += other.b2; bc += other.bc; bd += other.bd;
+            c2 += other.c2; cd += other.cd;
+            d2 += other.d2;
+            weight += other.weight;
+        }
+
+        //v^T Q v for v = (x, y, z, 1)
+        double evaluate(const glm::vec3& p) const {
+            double x = p.x, y = p.y, z = p.z;
+            return a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+                 + b2 * y * y + 2 * bc * y * z + 2 * bd * y
+                 + c2 * z * z + 2 * cd * z
+                 + d2;
+        }
+    };
+
+    struct Collapse {
+        std::uint32_t from;
+        std::uint32_t to;
+        //mean squared distance, the error reported is its square root
+        double cost;
+    };
+
+    std::uint64_t edgeKey(std::uint32_t a, std::uint32_t b) {
+        if (a > b) std::swap(a, b);
+        return (static_cast<std::uint64_t>(a) << 32) | b;
+    }
+
+    std::uint32_t resolve(std::vector<std::uint32_t>& remap, std::uint32_t vertex) {
+        while (remap[vertex] != vertex) {
+            remap[vertex] = remap[remap[vertex]];
+            vertex = remap[vertex];
+        }
+        return vertex;
+    }
+
+    glm::vec3 triangleNormal(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+        return glm::cross(b - a, c - a);
+    }
+}
+
+std::vector<std::uint32_t> MeshSimplifier::simplify(const std::vector<Vertex>& vertices,
+                                                    const std::vector<std::uint32_t>& indices,
+                                                    std::size_t targetIndexCount,
+                                                    float maxError,
+                                                    float* resultError) {
+
+    PROFILE_SCOPE("MeshSimplifier::simplify");
+
+    std::vector<std::uint32_t> triangles = indices;
+    const std::size_t vertexCount = vertices.size();
+    double appliedError = 0.0;
+
+    // --- 1. Plane quadrics per vertex ---
+    std::vector<Quadric> quadrics(vertexCount);
+    for (std::size_t t = 0; t + 2 < triangles.size(); t += 3) {
+        const glm::vec3& a = vertices[triangles[t]].Position;
+        const glm::vec3& b = vertices[triangles[t + 1]].Position;
+        const glm::vec3& c = vertices[triangles[t + 2]].Position;
+
+        glm::vec3 normal = triangleNormal(a, b, c);
+        float length = glm::length(normal);
+        if (length <= 0.0f) continue;
+        normal /= length;
+
+        double area = 0.5 * length;
+        for (int corner = 0; corner < 3; corner++) {
+            quadrics[triangles[t + corner]].addPlane(normal, -glm::dot(normal, a), area);
+        }
+    }
+
+    // --- 2. Lock vertices on edges that do not have exactly two triangles ---
+    std::vector<std::uint8_t> locked(vertexCount, 0);
+    {
+        std::vector<std::uint64_t> edges;
+        edges.reserve(triangles.size());
+        for (std::size_t t = 0; t + 2 < triangles.size(); t += 3) {
+            for (int corner = 0; corner < 3; corner++) {
+                edges.push_back(edgeKey(triangles[t + corner], triangles[t + (corner + 1) % 3]));
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+
+        for (std::size_t i = 0; i < edges.size();) {
+            std::size_t j = i;
+            while (j < edges.size() && edges[j] == edges[i]) j++;
+            if (j - i != 2) {
+                locked[static_cast<std::uint32_t>(edges[i] >> 32)] = 1;
+                locked[static_cast<std::uint32_t>(edges[i] & 0xFFFFFFFFu)] = 1;
+            }
+            i = j;
+        }
+    }
+
+    std::vector<std::uint32_t> remap(vertexCount);
+    for (std::size_t v = 0; v < vertexCount; v++) remap[v] = static_cast<std::uint32_t>(v);
+
+    std::vector<std::uint64_t> edges;
+    std::vector<Collapse> collapses;
+    std::vector<std::uint32_t> adjacencyOffsets(vertexCount + 1);
+    std::vector<std::uint32_t> adjacency;
+    std::vector<std::uint8_t> touched(vertexCount);
+    const double maxCost = static_cast<double>(maxError) * maxError;
+
+    // --- 3. Passes of independent collapses, cheapest first ---
+    while (triangles.size() > targetIndexCount) {
+
+        //vertex to triangle adjacency for the flip test
+        std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+        for (std::uint32_t index : triangles) adjacencyOffsets[index + 1]++;
+        for (std::size_t v = 0; v < vertexCount; v++) adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+        adjacency.resize(triangles.size());
+        {
+            std::vector<std::uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (std::size_t i = 0; i < triangles.size(); i++) {
+                adjacency[fill[triangles[i]]++] = static_cast<std::uint32_t>(i / 3);
+            }
+        }
+
+        edges.clear();
+        for (std::size_t t = 0; t < triangles.size(); t += 3) {
+            for (int corner = 0; corner < 3; corner++) {
+                edges.push_back(edgeKey(triangles[t + corner], triangles[t + (corner + 1) % 3]));
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+        collapses.clear();
+        for (std::uint64_t edge : edges) {
+            std::uint32_t a = static_cast<std::uint32_t>(edge >> 32);
+            std::uint32_t b = static_cast<std::uint32_t>(edge & 0xFFFFFFFFu);
+
+            Quadric combined = quadrics[a];
+            combined.add(quadrics[b]);
+            double weight = combined.weight > 0.0 ? combined.weight : 1.0;
+
+            //each direction keeps the surviving vertex where it is
+            Collapse best{0, 0, -1.0};
+            if (!locked[a]) best = Collapse{a, b, std::max(combined.evaluate(vertices[b].Position), 0.0) / weight};
+            if (!locked[b]) {
+                double cost = std::max(combined.evaluate(vertices[a].Position), 0.0) / weight;
+                if (best.cost < 0.0 || cost < best.cost) best = Collapse{b, a, cost};
+            }
+            if (best.cost >= 0.0 && best.cost <= maxCost) collapses.push_back(best);
+        }
+        if (collapses.empty()) break;
+
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+
+        std::fill(touched.begin(), touched.end(), 0);
+        std::size_t trianglesToRemove = (triangles.size() - targetIndexCount + 2) / 3;
+        std::size_t removed = 0;
+        std::size_t applied = 0;
+
+        for (const Collapse& collapse : collapses) {
+            if (removed >= trianglesToRemove) break;
+            if (touched[collapse.from] || touched[collapse.to]) continue;
+
+            //reject collapses that flip or flatten a triangle that stays
+            const glm::vec3& target = vertices[collapse.to].Position;
+            bool valid = true;
+            std::size_t shared = 0;
+            for (std::uint32_t a = adjacencyOffsets[collapse.from]; a < adjacencyOffsets[collapse.from + 1]; a++) {
+                const std::uint32_t* corners = &triangles[adjacency[a] * 3];
+                if (corners[0] == collapse.to || corners[1] == collapse.to || corners[2] == collapse.to) {
+                    shared++;
+                    continue;
+                }
+
+                glm::vec3 p[3];
+                glm::vec3 q[3];
+                for (int c = 0; c < 3; c++) {
+                    p[c] = vertices[corners[c]].Position;
+                    q[c] = corners[c] == collapse.from ? target : p[c];
+                }
+                glm::vec3 before = triangleNormal(p[0], p[1], p[2]);
+                glm::vec3 after = triangleNormal(q[0], q[1], q[2]);
+                if (glm::dot(before, after) <= 0.25f * glm::length(before) * glm::length(after)) {
+                    valid = false;
+                    break;
+                }
+            }
+            if (!valid) continue;
+
+            //neighbours of both ends are frozen for the rest of the pass, their flip tests are stale
+            for (std::uint32_t end : {collapse.from, collapse.to}) {
+                for (std::uint32_t a = adjacencyOffsets[end]; a < adjacencyOffsets[end + 1]; a++) {
+                    const std::uint32_t* corners = &triangles[adjacency[a] * 3];
+                    touched[corners[0]] = touched[corners[1]] = touched[corners[2]] = 1;
+                }
+            }
+
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to].add(quadrics[collapse.from]);
+            appliedError = std::max(appliedError, collapse.cost);
+            removed += shared;
+            applied++;
+        }
+        if (applied == 0) break;
+
+        //apply the collapses and drop triangles that became degenerate
+        std::size_t write = 0;
+        for (std::size_t t = 0; t < triangles.size(); t += 3) {
+            std::uint32_t a = resolve(remap, triangles[t]);
+            std::uint32_t b = resolve(remap, triangles[t + 1]);
+            std::uint32_t c = resolve(remap, triangles[t + 2]);
+            if (a == b || b == c || a == c) continue;
+            triangles[write++] = a;
+            triangles[write++] = b;
+            triangles[write++] = c;
+        }
+        triangles.resize(write);
+    }
+
+    if (resultError) *resultError = static_cast<float>(std::sqrt(appliedError));
+    return triangles;
+}
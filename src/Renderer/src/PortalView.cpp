@@ -0,0 +1,86 @@
+#include "PortalView.hpp"
+#include <algorithm>
+
+glm::mat4 PortalView::throughPortal(const glm::mat4& view, const glm::mat4& sourceModel, const glm::mat4& targetModel) {
+    //target space -> target manifold's frame -> source manifold's frame -> source space -> view
+    return view * sourceModel * glm::inverse(targetModel);
+}
+
+bool PortalView::facesCamera(const glm::mat4& model, const glm::vec3& cameraPosition) {
+    glm::vec3 normal = glm::vec3(model[2]);
+    return glm::dot(cameraPosition - glm::vec3(model[3]), normal) > 0.0f;
+}
+
+glm::vec4 PortalView::clipPlane(const glm::mat4& view, const glm::mat4& targetModel) {
+    glm::vec3 normal = -glm::normalize(glm::vec3(targetModel[2]));
+    glm::vec4 worldPlane(normal, -glm::dot(normal, glm::vec3(targetModel[3])));
+
+    //planes transform by the inverse transpose, which also covers scaled manifolds
+    glm::vec4 plane = glm::transpose(glm::inverse(view)) * worldPlane;
+    return plane / glm::length(glm::vec3(plane));
+}
+
+glm::mat4 PortalView::obliqueProjection(const glm::mat4& projection, const glm::vec4& clipPlane) {
+
+    //the camera sits at the view space origin, whose distance to the plane is w
+    if (clipPlane.w >= 0.0f) return projection;
+
+    //corner of the view frustum opposite the plane, in clip space, pulled back to view space
+    glm::vec4 corner((glm::sign(clipPlane.x) + projection[2][0]) / projection[0][0],
+                     (glm::sign(clipPlane.y) + projection[2][1]) / projection[1][1],
+                     -1.0f,
+                     (1.0f + projection[2][2]) / projection[3][2]);
+
+    //new third row makes the near plane the clip plane while keeping that corner on the far plane
+    glm::vec4 row = clipPlane * (2.0f / glm::dot(clipPlane, corner));
+
+    glm::mat4 oblique = projection;
+    oblique[0][2] = row.x;
+    oblique[1][2] = row.y;
+    oblique[2][2] = row.z + 1.0f;
+    oblique[3][2] = row.w;
+    return oblique;
+}
+
+bool PortalView::screenRect(const glm::mat4& viewProjection, const AABB& bounds, ScreenRect& rect) {
+
+    rect.min = glm::vec2(1.0f);
+    rect.max = glm::vec2(-1.0f);
+
+    bool behind = false;
+    bool inFront = false;
+    for (int corner = 0; corner < 8; corner++) {
+        glm::vec3 point((corner & 1) ? bounds.max.x : bounds.min.x,
+                        (corner & 2) ? bounds.max.y : bounds.min.y,
+                        (corner & 4) ? bounds.max.z : bounds.min.z);
+        glm::vec4 clip = viewProjection * glm::vec4(point, 1.0f);
+
+        //w is the view depth, a corner at or behind the camera has no meaningful projection
+        if (clip.w <= 1e-4f) {
+            behind = true;
+            continue;
+        }
+        inFront = true;
+        glm::vec2 ndc = glm::vec2(clip) / clip.w;
+        rect.min = glm::min(rect.min, ndc);
+        rect.max = glm::max(rect.max, ndc);
+    }
+
+    if (!inFront) return false;
+    if (behind) rect = ScreenRect{};
+
+    rect = ScreenRect::intersect(rect, ScreenRect{});
+    return !rect.isEmpty();
+}
+
+glm::mat4 PortalView::restrictToRect(const glm::mat4& projection, const ScreenRect& rect) {
+
+    //scales and offsets clip x and y so rect lands on [-1, 1]
+    glm::vec2 size = rect.max - rect.min;
+    glm::mat4 remap(1.0f);
+    remap[0][0] = 2.0f / size.x;
+    remap[1][1] = 2.0f / size.y;
+    remap[3][0] = -(rect.max.x + rect.min.x) / size.x;
+    remap[3][1] = -(rect.max.y + rect.min.y) / size.y;
+    return remap * projection;
+}
@@ -0,0 +1,240 @@
+#include "PostProcessGraph.hpp"
+#include "GpuProfiler.hpp"
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace {
+
+    //indexed by PassKind, literals because the profiler reads zone names back a few frames later
+    const char* const ZONE_NAMES[] = {"GPU::bloomDownsample", "GPU::bloomUpsample", "GPU::tonemap", "GPU::fxaa"};
+}
+
+PostProcessSettings PostProcessSettings::forQuality(PostProcessQuality quality) {
+    PostProcessSettings settings;
+    switch (quality) {
+        case PostProcessQuality::LOW:
+            settings.bloom = false;
+            settings.fxaa = false;
+            break;
+        case PostProcessQuality::MEDIUM:
+            settings.bloomLevels = 3;
+            settings.fxaa = true;
+            break;
+        case PostProcessQuality::HIGH:
+            settings.bloomLevels = 5;
+            settings.fxaa = true;
+            break;
+    }
+    return settings;
+}
+
+PostProcessGraph::PostProcessGraph(const PostProcessShaders& shaders, unsigned int quadVAO) {
+    this->shaders = shaders;
+    this->quadVAO = quadVAO;
+
+    glGenFramebuffers(1, &FBO);
+
+    downsampleUniforms.sourceTexture = shaders.bloomDownsample->getUniform<int>("sourceTexture");
+    downsampleUniforms.texelSize = shaders.bloomDownsample->getUniform<glm::vec2>("texelSize");
+    downsampleUniforms.prefilter = shaders.bloomDownsample->getUniform<bool>("prefilter");
+    downsampleUniforms.threshold = shaders.bloomDownsample->getUniform<float>("threshold");
+
+    upsampleUniforms.sourceTexture = shaders.bloomUpsample->getUniform<int>("sourceTexture");
+    upsampleUniforms.texelSize = shaders.bloomUpsample->getUniform<glm::vec2>("texelSize");
+
+    tonemapUniforms.sceneTexture = shaders.tonemap->getUniform<int>("sceneTexture");
+    tonemapUniforms.bloomTexture = shaders.tonemap->getUniform<int>("bloomTexture");
+    tonemapUniforms.exposure = shaders.tonemap->getUniform<float>("exposure");
+    tonemapUniforms.bloomStrength = shaders.tonemap->getUniform<float>("bloomStrength");
+
+    fxaaUniforms.sourceTexture = shaders.fxaa->getUniform<int>("sourceTexture");
+    fxaaUniforms.inverseSize = shaders.fxaa->getUniform<glm::vec2>("inverseSize");
+
+    build();
+}
+
+PostProcessGraph::~PostProcessGraph() {
+    glDeleteFramebuffers(1, &FBO);
+}
+
+void PostProcessGraph::setSettings(const PostProcessSettings& settings) {
+    bool rebuild = settings.bloom != this->settings.bloom ||
+                   settings.bloomLevels != this->settings.bloomLevels ||
+                   settings.fxaa != this->settings.fxaa;
+    this->settings = settings;
+    if (rebuild) build();
+}
+
+// Declares every effect and lets the graph drop what the settings do not use. Bloom is only
+// culled through its consumer: with bloom off, tonemap stops reading the chain
+void PostProcessGraph::build() {
+
+    graph.clear();
+    passKinds.clear();
+    passLevels.clear();
+
+    auto addPass = [&](const std::string& name, const std::vector<RenderGraph::ResourceID>& reads,
+                       RenderGraph::ResourceID write, PassKind kind, std::uint32_t level) {
+        graph.addPass(name, reads, write);
+        passKinds.push_back(kind);
+        passLevels.push_back(level);
+    };
+
+    sceneResource = graph.importResource("scene");
+    backbufferResource = graph.importResource("backbuffer");
+    graph.markOutput(backbufferResource);
+
+    // --- 1. Bloom: downsample into a mip chain, then blend back up it ---
+    std::uint32_t levels = std::max(1u, settings.bloomLevels);
+    std::vector<RenderGraph::ResourceID> bloom;
+    for (std::uint32_t i = 0; i < levels; i++) {
+        float scale = 1.0f / static_cast<float>(2u << i);
+        bloom.push_back(graph.createResource("bloom" + std::to_string(i), GraphResourceDesc{scale, RenderTargetFormat::RGB16F}));
+    }
+    for (std::uint32_t i = 0; i < levels; i++) {
+        RenderGraph::ResourceID source = i == 0 ? sceneResource : bloom[i - 1];
+        addPass("bloomDownsample" + std::to_string(i), {source}, bloom[i], PassKind::BLOOM_DOWNSAMPLE, i);
+    }
+    for (std::uint32_t i = levels - 1; i-- > 0;) {
+        addPass("bloomUpsample" + std::to_string(i), {bloom[i + 1]}, bloom[i], PassKind::BLOOM_UPSAMPLE, i);
+    }
+
+    // --- 2. Tonemap, straight to the window when there is no FXAA after it ---
+    RenderGraph::ResourceID tonemapTarget = backbufferResource;
+    if (settings.fxaa) {
+        tonemapTarget = graph.createResource("ldr", GraphResourceDesc{1.0f, RenderTargetFormat::RGBA8});
+    }
+    std::vector<RenderGraph::ResourceID> tonemapReads = {sceneResource};
+    if (settings.bloom) tonemapReads.push_back(bloom[0]);
+    addPass("tonemap", tonemapReads, tonemapTarget, PassKind::TONEMAP, 0);
+
+    // --- 3. FXAA on the tonemapped image ---
+    if (settings.fxaa) {
+        addPass("fxaa", {tonemapTarget}, backbufferResource, PassKind::FXAA, 0);
+    }
+
+    graph.compile();
+}
+
+unsigned int PostProcessGraph::textureOf(RenderGraph::ResourceID resource) const {
+    if (resource == sceneResource) return sceneTexture;
+    return slotTargets[graph.getSlot(resource)].id;
+}
+
+glm::vec2 PostProcessGraph::sizeOf(RenderGraph::ResourceID resource) const {
+    if (resource == sceneResource) return sceneSize;
+    const RenderTargetDesc& desc = slotTargets[graph.getSlot(resource)].desc;
+    return glm::vec2(static_cast<float>(desc.width), static_cast<float>(desc.height));
+}
+
+void PostProcessGraph::execute(RenderTargetPool& pool, unsigned int sceneColor, int sceneWidth, int sceneHeight,
+                               int windowWidth, int windowHeight, GpuProfiler* profiler) {
+
+    sceneTexture = sceneColor;
+    sceneSize = glm::vec2(static_cast<float>(sceneWidth), static_cast<float>(sceneHeight));
+    slotTargets.assign(graph.getSlotCount(), RenderTarget{});
+
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    glActiveTexture(GL_TEXTURE0);
+    glBindVertexArray(quadVAO);
+
+    const std::vector<RenderGraph::PassID>& passes = graph.getLivePasses();
+    for (std::size_t i = 0; i < passes.size(); i++) {
+
+        //targets come from the pool just before their first use and go back right after their last
+        for (std::uint32_t slot : graph.getAcquires(i)) {
+            const GraphResourceDesc& desc = graph.getSlotDesc(slot);
+            int width = std::max(1, static_cast<int>(std::lround(sceneWidth * desc.scale)));
+            int height = std::max(1, static_cast<int>(std::lround(sceneHeight * desc.scale)));
+            slotTargets[slot] = pool.acquire(RenderTargetDesc{width, height, desc.format});
+        }
+
+        RenderGraph::ResourceID write = graph.getWrite(passes[i]);
+        int targetWidth = windowWidth;
+        int targetHeight = windowHeight;
+        if (write == backbufferResource) {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        } else {
+            const RenderTarget& target = slotTargets[graph.getSlot(write)];
+            glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.id, 0);
+            targetWidth = target.desc.width;
+            targetHeight = target.desc.height;
+        }
+        glViewport(0, 0, targetWidth, targetHeight);
+
+        {
+            GPU_PROFILE_SCOPE(profiler, ZONE_NAMES[static_cast<std::size_t>(passKinds[passes[i]])]);
+            runPass(passes[i]);
+        }
+
+        for (std::uint32_t slot : graph.getReleases(i)) {
+            pool.release(slotTargets[slot]);
+        }
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void PostProcessGraph::runPass(RenderGraph::PassID pass) {
+
+    const std::vector<RenderGraph::ResourceID>& reads = graph.getReads(pass);
+
+    switch (passKinds[pass]) {
+
+        case PassKind::BLOOM_DOWNSAMPLE: {
+            //the first level also pulls out the bright parts of the scene
+            shaders.bloomDownsample->use();
+            shaders.bloomDownsample->set(downsampleUniforms.sourceTexture, 0);
+            shaders.bloomDownsample->set(downsampleUniforms.texelSize, 1.0f / sizeOf(reads[0]));
+            shaders.bloomDownsample->set(downsampleUniforms.prefilter, passLevels[pass] == 0);
+            shaders.bloomDownsample->set(downsampleUniforms.threshold, settings.bloomThreshold);
+            glBindTexture(GL_TEXTURE_2D, textureOf(reads[0]));
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+            break;
+        }
+
+        case PassKind::BLOOM_UPSAMPLE: {
+            //adds the blurred smaller level on top of what the downsample left in this one
+            shaders.bloomUpsample->use();
+            shaders.bloomUpsample->set(upsampleUniforms.sourceTexture, 0);
+            shaders.bloomUpsample->set(upsampleUniforms.texelSize, 1.0f / sizeOf(reads[0]));
+            glBindTexture(GL_TEXTURE_2D, textureOf(reads[0]));
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_ONE, GL_ONE);
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+            glDisable(GL_BLEND);
+            break;
+        }
+
+        case PassKind::TONEMAP: {
+            bool bloom = reads.size() > 1;
+            shaders.tonemap->use();
+            shaders.tonemap->set(tonemapUniforms.sceneTexture, 0);
+            shaders.tonemap->set(tonemapUniforms.bloomTexture, 1);
+            shaders.tonemap->set(tonemapUniforms.exposure, settings.exposure);
+            shaders.tonemap->set(tonemapUniforms.bloomStrength, bloom ? settings.bloomStrength : 0.0f);
+            glBindTexture(GL_TEXTURE_2D, textureOf(reads[0]));
+            if (bloom) {
+                glActiveTexture(GL_TEXTURE1);
+                glBindTexture(GL_TEXTURE_2D, textureOf(reads[1]));
+                glActiveTexture(GL_TEXTURE0);
+            }
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+            break;
+        }
+
+        case PassKind::FXAA: {
+            shaders.fxaa->use();
+            shaders.fxaa->set(fxaaUniforms.sourceTexture, 0);
+            shaders.fxaa->set(fxaaUniforms.inverseSize, 1.0f / sizeOf(reads[0]));
+            glBindTexture(GL_TEXTURE_2D, textureOf(reads[0]));
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+            break;
+        }
+    }
+
+}
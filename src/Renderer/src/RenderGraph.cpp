@@ -0,0 +1,132 @@
+#include "RenderGraph.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+void RenderGraph::clear() {
+    resources.clear();
+    passes.clear();
+    livePasses.clear();
+    slots.clear();
+    acquires.clear();
+    releases.clear();
+}
+
+RenderGraph::ResourceID RenderGraph::importResource(const std::string& name) {
+    Resource resource;
+    resource.name = name;
+    resource.imported = true;
+    resources.push_back(resource);
+    return static_cast<ResourceID>(resources.size() - 1);
+}
+
+RenderGraph::ResourceID RenderGraph::createResource(const std::string& name, const GraphResourceDesc& desc) {
+    Resource resource;
+    resource.name = name;
+    resource.desc = desc;
+    resources.push_back(resource);
+    return static_cast<ResourceID>(resources.size() - 1);
+}
+
+RenderGraph::PassID RenderGraph::addPass(const std::string& name, const std::vector<ResourceID>& reads, ResourceID write) {
+    Pass pass;
+    pass.name = name;
+    pass.reads = reads;
+    pass.write = write;
+    passes.push_back(pass);
+    return static_cast<PassID>(passes.size() - 1);
+}
+
+void RenderGraph::markOutput(ResourceID resource) {
+    resources[resource].output = true;
+}
+
+void RenderGraph::compile() {
+
+    livePasses.clear();
+    slots.clear();
+
+    // --- 1. Dependencies on whichever pass last wrote each resource ---
+    std::vector<std::int64_t> lastWriter(resources.size(), -1);
+    for (PassID p = 0; p < passes.size(); p++) {
+        Pass& pass = passes[p];
+        pass.dependencies.clear();
+        pass.live = false;
+
+        for (ResourceID read : pass.reads) {
+            if (lastWriter[read] >= 0) {
+                pass.dependencies.push_back(static_cast<PassID>(lastWriter[read]));
+            } else if (!resources[read].imported) {
+                throw std::runtime_error("RenderGraph: pass " + pass.name + " reads " + resources[read].name +
+                                         " before anything writes it.");
+            }
+        }
+        if (lastWriter[pass.write] >= 0) {
+            pass.dependencies.push_back(static_cast<PassID>(lastWriter[pass.write]));
+        }
+        lastWriter[pass.write] = p;
+    }
+
+    // --- 2. Cull everything the outputs do not depend on ---
+    std::vector<PassID> stack;
+    for (ResourceID r = 0; r < resources.size(); r++) {
+        if (resources[r].output && lastWriter[r] >= 0) stack.push_back(static_cast<PassID>(lastWriter[r]));
+    }
+    while (!stack.empty()) {
+        PassID p = stack.back();
+        stack.pop_back();
+        if (passes[p].live) continue;
+        passes[p].live = true;
+        for (PassID dependency : passes[p].dependencies) stack.push_back(dependency);
+    }
+    for (PassID p = 0; p < passes.size(); p++) {
+        if (passes[p].live) livePasses.push_back(p);
+    }
+
+    // --- 3. Lifetimes of the transient resources over the live passes ---
+    for (Resource& resource : resources) {
+        resource.used = false;
+        resource.slot = NO_SLOT;
+    }
+    auto touch = [&](ResourceID id, std::size_t liveIndex) {
+        Resource& resource = resources[id];
+        if (!resource.used) resource.firstUse = liveIndex;
+        resource.lastUse = liveIndex;
+        resource.used = true;
+    };
+    for (std::size_t i = 0; i < livePasses.size(); i++) {
+        const Pass& pass = passes[livePasses[i]];
+        for (ResourceID read : pass.reads) touch(read, i);
+        touch(pass.write, i);
+    }
+
+    // --- 4. Slots, reused once the previous resource in them is dead ---
+    std::vector<ResourceID> order;
+    for (ResourceID r = 0; r < resources.size(); r++) {
+        if (resources[r].used && !resources[r].imported) order.push_back(r);
+    }
+    std::sort(order.begin(), order.end(), [&](ResourceID a, ResourceID b) {
+        return resources[a].firstUse < resources[b].firstUse;
+    });
+
+    for (ResourceID id : order) {
+        Resource& resource = resources[id];
+        for (std::uint32_t s = 0; s < slots.size(); s++) {
+            if (slots[s].desc == resource.desc && slots[s].lastUse < resource.firstUse) {
+                resource.slot = s;
+                slots[s].lastUse = resource.lastUse;
+                break;
+            }
+        }
+        if (resource.slot == NO_SLOT) {
+            resource.slot = static_cast<std::uint32_t>(slots.size());
+            slots.push_back(Slot{resource.desc, resource.firstUse, resource.lastUse});
+        }
+    }
+
+    acquires.assign(livePasses.size(), {});
+    releases.assign(livePasses.size(), {});
+    for (std::uint32_t s = 0; s < slots.size(); s++) {
+        acquires[slots[s].firstUse].push_back(s);
+        releases[slots[s].lastUse].push_back(s);
+    }
+}
@@ -0,0 +1,68 @@
+#include "RenderQueue.hpp"
+#include <algorithm>
+#include <cstring>
+
+std::uint32_t RenderKey::depthBucket(float viewDepth) {
+
+    if (!(viewDepth > 0.0f)) return 0;
+
+    //positive IEEE floats sort like their bit patterns, the top 16 bits keep exponent and 7 mantissa bits
+    std::uint32_t bits;
+    std::memcpy(&bits, &viewDepth, sizeof(bits));
+    return bits >> 16;
+}
+
+void RenderQueue::reserve(std::size_t count) {
+    packets.reserve(count);
+    scratch.reserve(count);
+}
+
+void RenderQueue::sort() {
+
+    const std::size_t count = packets.size();
+    if (count < 2) return;
+
+    if (scratch.size() < count) scratch.resize(count);
+
+    // --- 1. Build the histograms of all eight key bytes in one pass ---
+    std::uint32_t histograms[8][256] = {};
+    for (const auto& packet : packets) {
+        std::uint64_t key = packet.key;
+        for (int byte = 0; byte < 8; byte++) {
+            histograms[byte][(key >> (byte * 8)) & 0xFF]++;
+        }
+    }
+
+    // --- 2. Scatter byte by byte, skipping bytes every key shares ---
+    DrawPacket* source = packets.data();
+    DrawPacket* destination = scratch.data();
+    bool swapped = false;
+
+    for (int byte = 0; byte < 8; byte++) {
+        std::uint32_t* histogram = histograms[byte];
+        unsigned int firstDigit = (source[0].key >> (byte * 8)) & 0xFF;
+        if (histogram[firstDigit] == count) continue;
+
+        //exclusive prefix sum turns counts into write offsets
+        std::uint32_t offset = 0;
+        for (int digit = 0; digit < 256; digit++) {
+            std::uint32_t digitCount = histogram[digit];
+            histogram[digit] = offset;
+            offset += digitCount;
+        }
+
+        for (std::size_t i = 0; i < count; i++) {
+            unsigned int digit = (source[i].key >> (byte * 8)) & 0xFF;
+            destination[histogram[digit]++] = source[i];
+        }
+
+        std::swap(source, destination);
+        swapped = !swapped;
+    }
+
+    //the sorted data ended up in the scratch storage, swap buffers instead of copying back
+    if (swapped) {
+        packets.swap(scratch);
+        packets.resize(count);
+    }
+}
@@ -0,0 +1,105 @@
+#include "RenderTargetPool.hpp"
+#include <glad/glad.h>
+
+RenderTargetPool::~RenderTargetPool() {
+    for (const Entry& entry : entries) {
+        destroy(entry.target);
+    }
+}
+
+std::size_t RenderTargetPool::bytesPerPixel(RenderTargetFormat format) {
+    switch (format) {
+        //drivers pad three channel formats to four
+        case RenderTargetFormat::RGB16F: return 8;
+        case RenderTargetFormat::RGBA8: return 4;
+        case RenderTargetFormat::DEPTH24_STENCIL8: return 4;
+    }
+    return 4;
+}
+
+RenderTarget RenderTargetPool::create(const RenderTargetDesc& desc) {
+
+    RenderTarget target;
+    target.desc = desc;
+
+    if (desc.format == RenderTargetFormat::DEPTH24_STENCIL8) {
+        target.renderbuffer = true;
+        glGenRenderbuffers(1, &target.id);
+        glBindRenderbuffer(GL_RENDERBUFFER, target.id);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, desc.width, desc.height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        return target;
+    }
+
+    glGenTextures(1, &target.id);
+    glBindTexture(GL_TEXTURE_2D, target.id);
+    if (desc.format == RenderTargetFormat::RGB16F) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, desc.width, desc.height, 0, GL_RGB, GL_FLOAT, NULL);
+    } else {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, desc.width, desc.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    }
+
+    //linear so a target rendered below native resolution is upscaled smoothly
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return target;
+}
+
+void RenderTargetPool::destroy(const RenderTarget& target) {
+    if (target.renderbuffer) {
+        glDeleteRenderbuffers(1, &target.id);
+    } else {
+        glDeleteTextures(1, &target.id);
+    }
+}
+
+RenderTarget RenderTargetPool::acquire(const RenderTargetDesc& desc) {
+
+    std::size_t bytes = bytesFor(desc);
+    bytesInUse += bytes;
+
+    for (Entry& entry : entries) {
+        if (!entry.inUse && entry.target.desc == desc) {
+            entry.inUse = true;
+            return entry.target;
+        }
+    }
+
+    Entry entry;
+    entry.target = create(desc);
+    entry.inUse = true;
+    entries.push_back(entry);
+    bytesAllocated += bytes;
+    return entry.target;
+}
+
+void RenderTargetPool::release(const RenderTarget& target) {
+    for (Entry& entry : entries) {
+        if (entry.inUse && entry.target.id == target.id && entry.target.renderbuffer == target.renderbuffer) {
+            entry.inUse = false;
+            entry.releasedFrame = frame;
+            bytesInUse -= bytesFor(entry.target.desc);
+            return;
+        }
+    }
+}
+
+void RenderTargetPool::endFrame() {
+
+    frame++;
+
+    for (std::size_t i = 0; i < entries.size();) {
+        Entry& entry = entries[i];
+        if (!entry.inUse && frame - entry.releasedFrame > MAX_IDLE_FRAMES) {
+            bytesAllocated -= bytesFor(entry.target.desc);
+            destroy(entry.target);
+            entries[i] = entries.back();
+            entries.pop_back();
+            continue;
+        }
+        i++;
+    }
+}
@@ -0,0 +1,32 @@
+#include "SampleCounter.hpp"
+#include <glad/glad.h>
+
+SampleCounter::SampleCounter(Type type) {
+    target = type == Type::TIME_ELAPSED ? GL_TIME_ELAPSED : GL_SAMPLES_PASSED;
+    glGenQueries(static_cast<GLsizei>(queries.size()), queries.data());
+}
+
+SampleCounter::~SampleCounter() {
+    glDeleteQueries(static_cast<GLsizei>(queries.size()), queries.data());
+}
+
+void SampleCounter::begin() {
+
+    current = frameCount % FRAME_LATENCY;
+    frameCount++;
+
+    //issued FRAME_LATENCY frames ago, so reading it does not stall in practice
+    if (pending[current]) {
+        GLuint64 result = 0;
+        glGetQueryObjectui64v(queries[current], GL_QUERY_RESULT, &result);
+        samples = result;
+        pending[current] = false;
+    }
+
+    glBeginQuery(target, queries[current]);
+}
+
+void SampleCounter::end() {
+    glEndQuery(target);
+    pending[current] = true;
+}
@@ -2,6 +2,9 @@
 #include "Shader.hpp"
 #include <glad/glad.h>
 #include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -44,30 +47,179 @@ Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath) {
     checkCompileErrors(m_ID, "PROGRAM");
     glDeleteShader(vertex);
     glDeleteShader(fragment);
+
+    reflectUniforms();
+
+    static std::uint32_t nextSortID = 0;
+    sortID = nextSortID++;
 }
 
 void Shader::use() {
     glUseProgram(m_ID);
 }
 
+UniformStats Shader::uniformStats;
+
+void Shader::reflectUniforms() {
+
+    GLint count = 0;
+    GLint maxNameLength = 0;
+    glGetProgramiv(m_ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(m_ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    std::vector<char> nameBuffer(std::max(maxNameLength, 1));
+    uniforms.reserve(count);
+
+    for (GLint i = 0; i < count; i++) {
+        GLint size = 0;
+        GLenum type = 0;
+        GLsizei length = 0;
+        glGetActiveUniform(m_ID, static_cast<GLuint>(i), static_cast<GLsizei>(nameBuffer.size()), &length, &size, &type, nameBuffer.data());
+
+        std::string name(nameBuffer.data(), length);
+        GLint location = glGetUniformLocation(m_ID, name.c_str());
+
+        //uniforms inside blocks have no location and are set through buffers
+        if (location < 0) continue;
+
+        UniformInfo info;
+        info.location = location;
+        info.type = type;
+
+        int slot = static_cast<int>(uniforms.size());
+        uniforms.push_back(info);
+        slotByName[name] = slot;
+
+        //arrays are reported as "name[0]", also register the plain name
+        std::size_t bracket = name.find('[');
+        if (bracket != std::string::npos) {
+            slotByName[name.substr(0, bracket)] = slot;
+        }
+    }
+}
+
+bool Shader::accepts(const glm::mat4*, unsigned int type) { return type == GL_FLOAT_MAT4; }
+bool Shader::accepts(const glm::mat3*, unsigned int type) { return type == GL_FLOAT_MAT3; }
+bool Shader::accepts(const glm::vec2*, unsigned int type) { return type == GL_FLOAT_VEC2; }
+bool Shader::accepts(const glm::vec3*, unsigned int type) { return type == GL_FLOAT_VEC3; }
+bool Shader::accepts(const glm::vec4*, unsigned int type) { return type == GL_FLOAT_VEC4; }
+bool Shader::accepts(const float*, unsigned int type) { return type == GL_FLOAT; }
+
+//glUniform1i sets ints, bools and the texture unit of every sampler type
+bool Shader::accepts(const int*, unsigned int type) {
+    switch (type) {
+        case GL_INT:
+        case GL_BOOL:
+        case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+        case GL_SAMPLER_1D_SHADOW: case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_CUBE_SHADOW:
+        case GL_SAMPLER_1D_ARRAY: case GL_SAMPLER_2D_ARRAY:
+        case GL_SAMPLER_1D_ARRAY_SHADOW: case GL_SAMPLER_2D_ARRAY_SHADOW:
+        case GL_SAMPLER_2D_MULTISAMPLE: case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:
+        case GL_SAMPLER_2D_RECT: case GL_SAMPLER_2D_RECT_SHADOW: case GL_SAMPLER_BUFFER:
+        case GL_INT_SAMPLER_1D: case GL_INT_SAMPLER_2D: case GL_INT_SAMPLER_3D: case GL_INT_SAMPLER_CUBE:
+        case GL_INT_SAMPLER_1D_ARRAY: case GL_INT_SAMPLER_2D_ARRAY: case GL_INT_SAMPLER_2D_RECT:
+        case GL_INT_SAMPLER_BUFFER: case GL_INT_SAMPLER_2D_MULTISAMPLE: case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_1D: case GL_UNSIGNED_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_3D:
+        case GL_UNSIGNED_INT_SAMPLER_CUBE: case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY: case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_2D_RECT: case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+        case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE: case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+            return true;
+        default:
+            return false;
+    }
+}
+
+//bool handles upload through glUniform1i, which a bool or int uniform takes
+bool Shader::accepts(const bool*, unsigned int type) { return type == GL_BOOL || type == GL_INT; }
+
+void Shader::reportTypeMismatch(const std::string& name, unsigned int type) {
+    std::cerr << "ERROR::SHADER::UNIFORM_TYPE_MISMATCH: " << name << " is declared as GL type 0x"
+              << std::hex << type << std::dec << ", the handle is left invalid" << std::endl;
+    assert(false && "uniform handle type does not match the uniform's GLSL type");
+}
+
+bool Shader::updateCache(int slot, const void* data, std::size_t size) const {
+
+    UniformInfo& info = uniforms[slot];
+    if (info.hasValue && std::memcmp(info.value.data(), data, size) == 0) {
+        uniformStats.callsSaved++;
+        return false;
+    }
+
+    std::memcpy(info.value.data(), data, size);
+    info.hasValue = true;
+    uniformStats.callsIssued++;
+    return true;
+}
+
+void Shader::set(UniformHandle<glm::mat4> handle, const glm::mat4& mat) const {
+    if (!handle.isValid() || !updateCache(handle.slot, glm::value_ptr(mat), sizeof(glm::mat4))) return;
+    glUniformMatrix4fv(uniforms[handle.slot].location, 1, GL_FALSE, glm::value_ptr(mat));
+}
+
+void Shader::set(UniformHandle<glm::mat3> handle, const glm::mat3& mat) const {
+    if (!handle.isValid() || !updateCache(handle.slot, glm::value_ptr(mat), sizeof(glm::mat3))) return;
+    glUniformMatrix3fv(uniforms[handle.slot].location, 1, GL_FALSE, glm::value_ptr(mat));
+}
+
+void Shader::set(UniformHandle<glm::vec2> handle, const glm::vec2& value) const {
+    if (!handle.isValid() || !updateCache(handle.slot, &value[0], sizeof(glm::vec2))) return;
+    glUniform2fv(uniforms[handle.slot].location, 1, &value[0]);
+}
+
+void Shader::set(UniformHandle<glm::vec3> handle, const glm::vec3& value) const {
+    if (!handle.isValid() || !updateCache(handle.slot, &value[0], sizeof(glm::vec3))) return;
+    glUniform3fv(uniforms[handle.slot].location, 1, &value[0]);
+}
+
+void Shader::set(UniformHandle<glm::vec4> handle, const glm::vec4& value) const {
+    if (!handle.isValid() || !updateCache(handle.slot, &value[0], sizeof(glm::vec4))) return;
+    glUniform4fv(uniforms[handle.slot].location, 1, &value[0]);
+}
+
+void Shader::set(UniformHandle<float> handle, float value) const {
+    if (!handle.isValid() || !updateCache(handle.slot, &value, sizeof(float))) return;
+    glUniform1f(uniforms[handle.slot].location, value);
+}
+
+void Shader::set(UniformHandle<int> handle, int value) const {
+    if (!handle.isValid() || !updateCache(handle.slot, &value, sizeof(int))) return;
+    glUniform1i(uniforms[handle.slot].location, value);
+}
+
+void Shader::set(UniformHandle<bool> handle, bool value) const {
+    set(UniformHandle<int>{handle.slot}, static_cast<int>(value));
+}
+
 void Shader::setMat4(const std::string& name, const glm::mat4& mat) const {
-    glUniformMatrix4fv(glGetUniformLocation(m_ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+    set(getUniform<glm::mat4>(name), mat);
 }
 
 void Shader::setVec3(const std::string& name, const glm::vec3& value) const {
-    glUniform3fv(glGetUniformLocation(m_ID, name.c_str()), 1, &value[0]);
+    set(getUniform<glm::vec3>(name), value);
 }
 
 void Shader::setVec4(const std::string& name, const glm::vec4& value) const {
-    glUniform4fv(glGetUniformLocation(m_ID, name.c_str()), 1, &value[0]);
+    set(getUniform<glm::vec4>(name), value);
 }
 
 void Shader::setFloat(const std::string& name, float value) const {
-    glUniform1f(glGetUniformLocation(m_ID, name.c_str()), value);
+    set(getUniform<float>(name), value);
 }
 
 void Shader::setBool(const std::string& name, bool value) const {
-    glUniform1i(glGetUniformLocation(m_ID, name.c_str()), (int)value);
+    set(getUniform<bool>(name), value);
+}
+
+void Shader::setInt(const std::string& name, int value) const {
+    set(getUniform<int>(name), value);
+}
+
+void Shader::bindUniformBlock(const std::string& blockName, unsigned int bindingPoint) const {
+    unsigned int blockIndex = glGetUniformBlockIndex(m_ID, blockName.c_str());
+    if (blockIndex != GL_INVALID_INDEX) {
+        glUniformBlockBinding(m_ID, blockIndex, bindingPoint);
+    }
 }
 
 void Shader::checkCompileErrors(unsigned int shader, std::string type) {
@@ -0,0 +1,117 @@
+#include "ShadowLayout.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+    //any up vector works as long as it is not parallel to the light
+    glm::vec3 lightUp(const glm::vec3& direction) {
+        return std::abs(direction.y) > 0.99f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    }
+}
+
+void ShadowLayout::cascadeSplits(float nearPlane, float farPlane, std::size_t count, float lambda, float* splits) {
+    for (std::size_t i = 0; i <= count; i++) {
+        float t = static_cast<float>(i) / static_cast<float>(count);
+        float logarithmic = nearPlane * std::pow(farPlane / nearPlane, t);
+        float linear = nearPlane + (farPlane - nearPlane) * t;
+        splits[i] = lambda * logarithmic + (1.0f - lambda) * linear;
+    }
+    //exact at both ends, whatever the rounding did
+    splits[0] = nearPlane;
+    splits[count] = farPlane;
+}
+
+BoundingSphere ShadowLayout::sliceBounds(const glm::mat4& projection, const glm::mat4& inverseView, float nearDepth, float farDepth) {
+
+    //squared half diagonal of the slice's cross section per unit of depth
+    float tanX = 1.0f / projection[0][0];
+    float tanY = 1.0f / projection[1][1];
+    float k = tanX * tanX + tanY * tanY;
+
+    //on the view axis, equally far from the near and far corners, unless that lies past the far plane
+    float depth = 0.5f * (farDepth + nearDepth) * (1.0f + k);
+    float radius;
+    if (depth >= farDepth) {
+        depth = farDepth;
+        radius = farDepth * std::sqrt(k);
+    } else {
+        radius = std::sqrt((farDepth - depth) * (farDepth - depth) + farDepth * farDepth * k);
+    }
+
+    BoundingSphere sphere;
+    sphere.center = glm::vec3(inverseView * glm::vec4(0.0f, 0.0f, -depth, 1.0f));
+    sphere.radius = radius;
+    return sphere;
+}
+
+bool ShadowLayout::fitCascade(ShadowCascade& cascade, const BoundingSphere& slice, const glm::vec3& lightDirection,
+                              int resolution, float margin, float casterDistance) {
+
+    glm::vec3 direction = glm::normalize(lightDirection);
+    float radius = slice.radius * (1.0f + margin);
+
+    if (cascade.valid &&
+        glm::dot(direction, cascade.lightDirection) > 0.99999f &&
+        std::abs(cascade.radius - radius) <= radius * 1e-4f &&
+        glm::length(slice.center - cascade.center) + slice.radius <= cascade.radius) {
+        return false;
+    }
+
+    // Snap the center to whole texels across the light, so static geometry rasterizes the same after the move
+    glm::vec3 up = lightUp(direction);
+    glm::mat4 rotation = glm::lookAt(glm::vec3(0.0f), direction, up);
+    glm::vec4 center = rotation * glm::vec4(slice.center, 1.0f);
+    float texel = 2.0f * radius / static_cast<float>(resolution);
+    center.x = std::floor(center.x / texel) * texel;
+    center.y = std::floor(center.y / texel) * texel;
+
+    cascade.center = glm::vec3(glm::inverse(rotation) * center);
+    cascade.lightDirection = direction;
+    cascade.radius = radius;
+    cascade.view = glm::lookAt(cascade.center - direction * (radius + casterDistance), cascade.center, up);
+    cascade.projection = glm::ortho(-radius, radius, -radius, radius, 0.0f, 2.0f * radius + casterDistance);
+    cascade.valid = true;
+    return true;
+}
+
+std::uint32_t ShadowLayout::cubeFace(const glm::vec3& direction) {
+    glm::vec3 a = glm::abs(direction);
+    if (a.x >= a.y && a.x >= a.z) return direction.x >= 0.0f ? 0u : 1u;
+    if (a.y >= a.z) return direction.y >= 0.0f ? 2u : 3u;
+    return direction.z >= 0.0f ? 4u : 5u;
+}
+
+glm::mat4 ShadowLayout::cubeFaceView(const glm::vec3& position, std::uint32_t face) {
+    //the GL cube map face orientations
+    static const glm::vec3 directions[6] = {
+        { 1.0f,  0.0f,  0.0f}, {-1.0f,  0.0f,  0.0f},
+        { 0.0f,  1.0f,  0.0f}, { 0.0f, -1.0f,  0.0f},
+        { 0.0f,  0.0f,  1.0f}, { 0.0f,  0.0f, -1.0f}
+    };
+    static const glm::vec3 ups[6] = {
+        {0.0f, -1.0f,  0.0f}, {0.0f, -1.0f,  0.0f},
+        {0.0f,  0.0f,  1.0f}, {0.0f,  0.0f, -1.0f},
+        {0.0f, -1.0f,  0.0f}, {0.0f, -1.0f,  0.0f}
+    };
+    return glm::lookAt(position, position + directions[face], ups[face]);
+}
+
+glm::mat4 ShadowLayout::cubeFaceProjection(float range) {
+    float nearPlane = std::min(0.05f, range * 0.5f);
+    return glm::perspective(glm::radians(90.0f), 1.0f, nearPlane, range);
+}
+
+glm::mat4 ShadowLayout::tileTransform(std::uint32_t tile, std::uint32_t tilesPerRow) {
+    float size = 1.0f / static_cast<float>(tilesPerRow);
+    glm::vec3 offset((static_cast<float>(tile % tilesPerRow) + 0.5f) * size,
+                     (static_cast<float>(tile / tilesPerRow) + 0.5f) * size,
+                     0.5f);
+    glm::mat4 transform = glm::translate(glm::mat4(1.0f), offset);
+    return glm::scale(transform, glm::vec3(0.5f * size, 0.5f * size, 0.5f));
+}
+
+glm::mat4 ShadowLayout::textureTransform() {
+    return tileTransform(0, 1);
+}
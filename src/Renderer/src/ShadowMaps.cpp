@@ -0,0 +1,149 @@
+#include "ShadowMaps.hpp"
+#include <glad/glad.h>
+#include <algorithm>
+
+ShadowMaps::ShadowMaps() {
+
+    cascades = createDepthTexture(GL_TEXTURE_2D_ARRAY, CASCADE_RESOLUTION, CASCADE_COUNT, true);
+    staticCascades = createDepthTexture(GL_TEXTURE_2D_ARRAY, CASCADE_RESOLUTION, CASCADE_COUNT, false);
+    atlas = createDepthTexture(GL_TEXTURE_2D, ATLAS_RESOLUTION, 1, true);
+    staticAtlas = createDepthTexture(GL_TEXTURE_2D, ATLAS_RESOLUTION, 1, false);
+
+    //depth only, both framebuffers get their attachment per pass
+    glGenFramebuffers(1, &drawFBO);
+    glGenFramebuffers(1, &readFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, drawFBO);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    glBindFramebuffer(GL_FRAMEBUFFER, readFBO);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    //a texture buffer needs storage before it can be attached
+    glGenBuffers(1, &matrixBuffer);
+    glGenTextures(1, &matrixTexture);
+    glBindBuffer(GL_TEXTURE_BUFFER, matrixBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, MATRIX_COUNT * sizeof(glm::mat4), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_BUFFER, matrixTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, matrixBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+ShadowMaps::~ShadowMaps() {
+    unsigned int textures[] = {cascades, staticCascades, atlas, staticAtlas, matrixTexture};
+    glDeleteTextures(5, textures);
+    glDeleteFramebuffers(1, &drawFBO);
+    glDeleteFramebuffers(1, &readFBO);
+    glDeleteBuffers(1, &matrixBuffer);
+}
+
+unsigned int ShadowMaps::createDepthTexture(unsigned int target, int size, int layers, bool sampled) {
+
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(target, texture);
+    if (target == GL_TEXTURE_2D_ARRAY) {
+        glTexImage3D(target, 0, GL_DEPTH_COMPONENT24, size, size, layers, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    } else {
+        glTexImage2D(target, 0, GL_DEPTH_COMPONENT24, size, size, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    }
+
+    //sampled maps compare in hardware, LINEAR gives 2x2 PCF for free. The static twins are only ever copied
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, sampled ? GL_LINEAR : GL_NEAREST);
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, sampled ? GL_LINEAR : GL_NEAREST);
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    if (sampled) {
+        glTexParameteri(target, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glTexParameteri(target, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    }
+    glBindTexture(target, 0);
+    return texture;
+}
+
+void ShadowMaps::attach(unsigned int framebuffer, const ShadowTarget& target, bool staticTwin) const {
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    if (target.type == ShadowTarget::Type::CASCADE) {
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticTwin ? staticCascades : cascades,
+                                  0, static_cast<GLint>(target.index));
+    } else {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, staticTwin ? staticAtlas : atlas, 0);
+    }
+}
+
+void ShadowMaps::region(const ShadowTarget& target, int& x, int& y, int& size) const {
+    if (target.type == ShadowTarget::Type::CASCADE) {
+        x = 0;
+        y = 0;
+        size = CASCADE_RESOLUTION;
+        return;
+    }
+    x = static_cast<int>(target.index % TILES_PER_ROW) * TILE_RESOLUTION;
+    y = static_cast<int>(target.index / TILES_PER_ROW) * TILE_RESOLUTION;
+    size = TILE_RESOLUTION;
+}
+
+// Viewport and scissor on the target's square, the scissor keeps clears inside an atlas tile
+void ShadowMaps::setRegion(const ShadowTarget& target) const {
+    int x, y, size;
+    region(target, x, y, size);
+    glViewport(x, y, size, size);
+    glScissor(x, y, size, size);
+}
+
+void ShadowMaps::beginStatic(const ShadowTarget& target) {
+    attach(drawFBO, target, true);
+    setRegion(target);
+    glEnable(GL_SCISSOR_TEST);
+    glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+void ShadowMaps::beginDynamic(const ShadowTarget& target) {
+
+    // --- 1. Copy the static casters' depth, blits also obey the scissor so it is set first ---
+    attach(readFBO, target, true);
+    attach(drawFBO, target, false);
+    setRegion(target);
+    glEnable(GL_SCISSOR_TEST);
+
+    int x, y, size;
+    region(target, x, y, size);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, readFBO);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, drawFBO);
+    glBlitFramebuffer(x, y, x + size, y + size, x, y, x + size, y + size, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+    // --- 2. Moving casters are drawn on top ---
+    glBindFramebuffer(GL_FRAMEBUFFER, drawFBO);
+}
+
+void ShadowMaps::end() {
+    glDisable(GL_SCISSOR_TEST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void ShadowMaps::uploadMatrices(const std::vector<glm::mat4>& matrices) {
+    std::size_t count = std::min<std::size_t>(matrices.size(), MATRIX_COUNT);
+    if (count == 0) return;
+    glBindBuffer(GL_TEXTURE_BUFFER, matrixBuffer);
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, count * sizeof(glm::mat4), matrices.data());
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void ShadowMaps::bind() const {
+    glActiveTexture(GL_TEXTURE0 + FIRST_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, cascades);
+    glActiveTexture(GL_TEXTURE0 + FIRST_TEXTURE_UNIT + 1);
+    glBindTexture(GL_TEXTURE_2D, atlas);
+    glActiveTexture(GL_TEXTURE0 + FIRST_TEXTURE_UNIT + 2);
+    glBindTexture(GL_TEXTURE_BUFFER, matrixTexture);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+std::size_t ShadowMaps::getBytesAllocated() const {
+    //24 bit depth is stored in 4 bytes
+    std::size_t cascadeBytes = std::size_t(CASCADE_RESOLUTION) * CASCADE_RESOLUTION * CASCADE_COUNT * 4;
+    std::size_t atlasBytes = std::size_t(ATLAS_RESOLUTION) * ATLAS_RESOLUTION * 4;
+    return 2 * (cascadeBytes + atlasBytes) + MATRIX_COUNT * sizeof(glm::mat4);
+}
@@ -1,21 +1,101 @@
 #include "Texture.hpp"
+#include "GLExtensions.hpp"
+
+//the S3TC and RGTC enums, in case glad was generated without them
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+    #define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+    #define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RED_RGTC1
+    #define GL_COMPRESSED_RED_RGTC1 0x8DBB
+#endif
+#ifndef GL_COMPRESSED_RG_RGTC2
+    #define GL_COMPRESSED_RG_RGTC2 0x8DBD
+#endif
+
+Texture::Texture(TextureFormat format, int levelCount, bool grey) {
+    this->format = format;
+    levelBytes.assign(levelCount, 0);
 
-Texture::Texture(const unsigned char* data, int width, int height, int nrComponents) {
     glGenTextures(1, &ID);
     glBindTexture(GL_TEXTURE_2D, ID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, levelCount - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+    setSampling();
 
-    GLenum format;
-    if (nrComponents == 1) format = GL_RED;
-    else if (nrComponents == 3) format = GL_RGB;
-    else if (nrComponents == 4) format = GL_RGBA;
-    else {
-        std::cerr << "Unsupported number of texture components: " << nrComponents << std::endl;
-        return;
+    if (grey) {
+        GLint swizzle[4] = {GL_RED, GL_RED, GL_RED, TextureCompression::channelCount(format) == 2 ? GL_GREEN : GL_ONE};
+        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
     }
 
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
+    if ((format == TextureFormat::BC1 || format == TextureFormat::BC3) && !GLExtensions::hasS3TC()) {
+        std::cerr << "S3TC is not supported, uploading a decompressed texture" << std::endl;
+    }
+}
 
+void Texture::uploadLevel(int level, const TextureUpload& upload) {
+    glBindTexture(GL_TEXTURE_2D, ID);
+    //raw rows are tightly packed, a 3 channel level of odd width is not 4-byte aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    std::size_t uploaded = upload.size;
+    if ((format == TextureFormat::BC1 || format == TextureFormat::BC3) && !GLExtensions::hasS3TC()) {
+        TextureLevel compressed;
+        compressed.width = upload.width;
+        compressed.height = upload.height;
+        const std::uint8_t* begin = static_cast<const std::uint8_t*>(upload.data);
+        compressed.data.assign(begin, begin + upload.size);
+        TextureLevel rgba = TextureCompression::decode(compressed, format);
+        glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, upload.width, upload.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data.data());
+        uploaded = rgba.data.size();
+    } else {
+        switch (format) {
+            case TextureFormat::R8:
+                glTexImage2D(GL_TEXTURE_2D, level, GL_RED, upload.width, upload.height, 0, GL_RED, GL_UNSIGNED_BYTE, upload.data);
+                break;
+            case TextureFormat::RG8:
+                glTexImage2D(GL_TEXTURE_2D, level, GL_RG, upload.width, upload.height, 0, GL_RG, GL_UNSIGNED_BYTE, upload.data);
+                break;
+            case TextureFormat::RGB8:
+                glTexImage2D(GL_TEXTURE_2D, level, GL_RGB, upload.width, upload.height, 0, GL_RGB, GL_UNSIGNED_BYTE, upload.data);
+                break;
+            case TextureFormat::RGBA8:
+                glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, upload.width, upload.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, upload.data);
+                break;
+            default: {
+                GLenum internalFormat = format == TextureFormat::BC1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+                                      : format == TextureFormat::BC3 ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+                                      : format == TextureFormat::BC4 ? GL_COMPRESSED_RED_RGTC1
+                                      : GL_COMPRESSED_RG_RGTC2;
+                glCompressedTexImage2D(GL_TEXTURE_2D, level, internalFormat, upload.width, upload.height, 0,
+                                       static_cast<GLsizei>(upload.size), upload.data);
+                break;
+            }
+        }
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    bytes = bytes - levelBytes[level] + uploaded;
+    levelBytes[level] = uploaded;
+}
+
+// Respecifying a level as 0x0 lets the driver free it, it lies below the base level so the
+// texture stays complete
+void Texture::releaseLevel(int level) {
+    glBindTexture(GL_TEXTURE_2D, ID);
+    glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    bytes -= levelBytes[level];
+    levelBytes[level] = 0;
+}
+
+void Texture::setBaseLevel(int level) {
+    glBindTexture(GL_TEXTURE_2D, ID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+}
+
+void Texture::setSampling() const {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
@@ -28,4 +108,4 @@ void Texture::bind() const {
 
 Texture::~Texture() {
     glDeleteTextures(1, &ID);
-}
\ No newline at end of file
+}
@@ -0,0 +1,491 @@
+#include "TextureCompression.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+    constexpr float GAMMA = 2.2f;
+
+    struct Color {
+        float r = 0.0f, g = 0.0f, b = 0.0f;
+    };
+
+    float distanceSquared(const Color& a, const Color& b) {
+        float dr = a.r - b.r, dg = a.g - b.g, db = a.b - b.b;
+        return dr * dr + dg * dg + db * db;
+    }
+
+    std::uint16_t packColor(const Color& color) {
+        auto quantize = [](float value, int max) {
+            return static_cast<std::uint16_t>(std::clamp(static_cast<int>(std::lround(value / 255.0f * max)), 0, max));
+        };
+        return static_cast<std::uint16_t>((quantize(color.r, 31) << 11) | (quantize(color.g, 63) << 5) | quantize(color.b, 31));
+    }
+
+    Color unpackColor(std::uint16_t packed) {
+        int r = (packed >> 11) & 31;
+        int g = (packed >> 5) & 63;
+        int b = packed & 31;
+        return Color{static_cast<float>((r << 3) | (r >> 2)), static_cast<float>((g << 2) | (g >> 4)), static_cast<float>((b << 3) | (b >> 2))};
+    }
+
+    //the four-color palette of a block with color0 > color1
+    void palette(std::uint16_t color0, std::uint16_t color1, Color* colors) {
+        Color a = unpackColor(color0);
+        Color b = unpackColor(color1);
+        colors[0] = a;
+        colors[1] = b;
+        colors[2] = Color{(2.0f * a.r + b.r) / 3.0f, (2.0f * a.g + b.g) / 3.0f, (2.0f * a.b + b.b) / 3.0f};
+        colors[3] = Color{(a.r + 2.0f * b.r) / 3.0f, (a.g + 2.0f * b.g) / 3.0f, (a.b + 2.0f * b.b) / 3.0f};
+    }
+
+    //nearest palette entry for every texel, returns the total squared error
+    float assign(const Color* texels, std::uint16_t color0, std::uint16_t color1, std::uint8_t* indices) {
+        Color colors[4];
+        palette(color0, color1, colors);
+        float error = 0.0f;
+        for (int i = 0; i < 16; i++) {
+            float best = distanceSquared(texels[i], colors[0]);
+            indices[i] = 0;
+            for (std::uint8_t c = 1; c < 4; c++) {
+                float d = distanceSquared(texels[i], colors[c]);
+                if (d < best) { best = d; indices[i] = c; }
+            }
+            error += best;
+        }
+        return error;
+    }
+
+    //endpoints minimizing the error for fixed indices, each texel a known blend of the two
+    bool leastSquares(const Color* texels, const std::uint8_t* indices, Color& endpoint0, Color& endpoint1) {
+        static const float WEIGHTS[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        Color ax, bx;
+        for (int i = 0; i < 16; i++) {
+            float a = WEIGHTS[indices[i]];
+            float b = 1.0f - a;
+            aa += a * a; ab += a * b; bb += b * b;
+            ax.r += a * texels[i].r; ax.g += a * texels[i].g; ax.b += a * texels[i].b;
+            bx.r += b * texels[i].r; bx.g += b * texels[i].g; bx.b += b * texels[i].b;
+        }
+        float determinant = aa * bb - ab * ab;
+        if (std::abs(determinant) < 1e-6f) return false;
+        float inverse = 1.0f / determinant;
+        endpoint0 = Color{(bb * ax.r - ab * bx.r) * inverse, (bb * ax.g - ab * bx.g) * inverse, (bb * ax.b - ab * bx.b) * inverse};
+        endpoint1 = Color{(aa * bx.r - ab * ax.r) * inverse, (aa * bx.g - ab * ax.g) * inverse, (aa * bx.b - ab * ax.b) * inverse};
+        return true;
+    }
+
+    void writeBC1(std::uint16_t color0, std::uint16_t color1, const std::uint8_t* indices, std::uint8_t* block) {
+        std::uint32_t bits = 0;
+        for (int i = 0; i < 16; i++) bits |= static_cast<std::uint32_t>(indices[i]) << (2 * i);
+        block[0] = static_cast<std::uint8_t>(color0 & 0xFF);
+        block[1] = static_cast<std::uint8_t>(color0 >> 8);
+        block[2] = static_cast<std::uint8_t>(color1 & 0xFF);
+        block[3] = static_cast<std::uint8_t>(color1 >> 8);
+        for (int b = 0; b < 4; b++) block[4 + b] = static_cast<std::uint8_t>(bits >> (8 * b));
+    }
+
+    //texel (x, y) of a block, coordinates past the edge repeat the last row or column
+    template <typename Fetch>
+    void gatherBlock(int blockX, int blockY, int width, int height, Fetch fetch) {
+        for (int y = 0; y < 4; y++) {
+            for (int x = 0; x < 4; x++) {
+                int sx = std::min(blockX * 4 + x, width - 1);
+                int sy = std::min(blockY * 4 + y, height - 1);
+                fetch(y * 4 + x, sy * width + sx);
+            }
+        }
+    }
+
+    std::size_t blockBytes(TextureFormat format) {
+        return format == TextureFormat::BC1 || format == TextureFormat::BC4 ? 8 : 16;
+    }
+}
+
+bool TextureCompression::isCompressed(TextureFormat format) {
+    return format == TextureFormat::BC1 || format == TextureFormat::BC3 ||
+           format == TextureFormat::BC4 || format == TextureFormat::BC5;
+}
+
+int TextureCompression::channelCount(TextureFormat format) {
+    switch (format) {
+        case TextureFormat::R8:
+        case TextureFormat::BC4: return 1;
+        case TextureFormat::RG8:
+        case TextureFormat::BC5: return 2;
+        case TextureFormat::RGB8: return 3;
+        default: return 4;
+    }
+}
+
+std::size_t TextureCompression::levelBytes(TextureFormat format, int width, int height) {
+    if (isCompressed(format)) {
+        return std::size_t((width + 3) / 4) * std::size_t((height + 3) / 4) * blockBytes(format);
+    }
+    return std::size_t(width) * std::size_t(height) * std::size_t(channelCount(format));
+}
+
+TextureFormat TextureCompression::rawFormat(int components) {
+    switch (components) {
+        case 1: return TextureFormat::R8;
+        case 2: return TextureFormat::RG8;
+        case 3: return TextureFormat::RGB8;
+        default: return TextureFormat::RGBA8;
+    }
+}
+
+TextureChannels TextureCompression::findChannels(const std::uint8_t* pixels, int width, int height, int components) {
+
+    TextureChannels channels;
+    channels.components = components;
+    if (components < 3) return channels;
+
+    bool opaque = true, grey = true, redOnly = true, noBlue = true;
+    std::size_t texels = std::size_t(width) * std::size_t(height);
+    for (std::size_t i = 0; i < texels; i++) {
+        const std::uint8_t* pixel = &pixels[i * components];
+        if (components == 4 && pixel[3] != 255) opaque = false;
+        if (pixel[0] != pixel[1] || pixel[0] != pixel[2]) grey = false;
+        if (pixel[1] != 0 || pixel[2] != 0) redOnly = false;
+        if (pixel[2] != 0) noBlue = false;
+    }
+
+    //grey first, an all black texture is also red only but reads the same either way
+    channels.grey = grey;
+    if (!opaque) channels.components = grey ? 2 : 4;
+    else channels.components = grey || redOnly ? 1 : noBlue ? 2 : 3;
+    return channels;
+}
+
+TextureLevel TextureCompression::packChannels(const TextureLevel& level, int components, const TextureChannels& channels) {
+
+    TextureLevel result;
+    result.width = level.width;
+    result.height = level.height;
+
+    //grey with alpha keeps red and alpha, everything else a prefix of the channels
+    int source[4] = {0, channels.grey ? 3 : 1, 2, 3};
+    std::size_t texels = std::size_t(level.width) * std::size_t(level.height);
+    result.data.resize(texels * channels.components);
+    for (std::size_t i = 0; i < texels; i++) {
+        for (int c = 0; c < channels.components; c++) {
+            result.data[i * channels.components + c] = level.data[i * components + source[c]];
+        }
+    }
+    return result;
+}
+
+TextureFormat TextureCompression::chooseFormat(const std::uint8_t* pixels, int width, int height, int components) {
+    if (components == 1) return TextureFormat::BC4;
+    if (components == 2) return TextureFormat::BC5;
+    if (components == 3) return TextureFormat::BC1;
+
+    std::size_t texels = std::size_t(width) * std::size_t(height);
+    for (std::size_t i = 0; i < texels; i++) {
+        if (pixels[i * 4 + 3] != 255) return TextureFormat::BC3;
+    }
+    return TextureFormat::BC1;
+}
+
+std::vector<TextureLevel> TextureCompression::buildMipChain(const std::uint8_t* pixels, int width, int height, int components, bool srgb) {
+
+    PROFILE_SCOPE("TextureCompression::buildMipChain");
+
+    float toLinear[256];
+    for (int i = 0; i < 256; i++) toLinear[i] = srgb ? std::pow(i / 255.0f, GAMMA) : i / 255.0f;
+    int colorChannels = srgb ? std::min(components, 3) : 0;
+
+    std::vector<TextureLevel> levels;
+    TextureLevel& base = levels.emplace_back();
+    base.width = width;
+    base.height = height;
+    base.data.assign(pixels, pixels + std::size_t(width) * height * components);
+
+    while (levels.back().width > 1 || levels.back().height > 1) {
+        const TextureLevel& source = levels.back();
+        TextureLevel level;
+        level.width = std::max(1, source.width / 2);
+        level.height = std::max(1, source.height / 2);
+        level.data.resize(std::size_t(level.width) * level.height * components);
+
+        for (int y = 0; y < level.height; y++) {
+            for (int x = 0; x < level.width; x++) {
+                int x0 = std::min(x * 2, source.width - 1), x1 = std::min(x * 2 + 1, source.width - 1);
+                int y0 = std::min(y * 2, source.height - 1), y1 = std::min(y * 2 + 1, source.height - 1);
+                const std::uint8_t* texels[4] = {
+                    &source.data[(std::size_t(y0) * source.width + x0) * components],
+                    &source.data[(std::size_t(y0) * source.width + x1) * components],
+                    &source.data[(std::size_t(y1) * source.width + x0) * components],
+                    &source.data[(std::size_t(y1) * source.width + x1) * components]
+                };
+
+                std::uint8_t* out = &level.data[(std::size_t(y) * level.width + x) * components];
+                for (int c = 0; c < components; c++) {
+                    if (c < colorChannels) {
+                        float sum = toLinear[texels[0][c]] + toLinear[texels[1][c]] + toLinear[texels[2][c]] + toLinear[texels[3][c]];
+                        out[c] = static_cast<std::uint8_t>(std::lround(std::pow(sum * 0.25f, 1.0f / GAMMA) * 255.0f));
+                    } else {
+                        out[c] = static_cast<std::uint8_t>((texels[0][c] + texels[1][c] + texels[2][c] + texels[3][c] + 2) / 4);
+                    }
+                }
+            }
+        }
+        levels.push_back(std::move(level));
+    }
+    return levels;
+}
+
+TextureLevel TextureCompression::encode(const TextureLevel& level, int components, TextureFormat format) {
+
+    TextureLevel result;
+    result.width = level.width;
+    result.height = level.height;
+
+    if (!isCompressed(format)) {
+        if (format != rawFormat(components)) throw std::runtime_error("Raw texture formats cannot change the channel count");
+        result.data = level.data;
+        return result;
+    }
+
+    result.data.resize(levelBytes(format, level.width, level.height));
+    int blocksX = (level.width + 3) / 4;
+    int blocksY = (level.height + 3) / 4;
+    std::uint8_t* out = result.data.data();
+
+    for (int by = 0; by < blocksY; by++) {
+        for (int bx = 0; bx < blocksX; bx++) {
+            std::uint8_t rgba[64];
+            gatherBlock(bx, by, level.width, level.height, [&](int texel, std::size_t source) {
+                const std::uint8_t* pixel = &level.data[source * components];
+                rgba[texel * 4 + 0] = pixel[0];
+                rgba[texel * 4 + 1] = components > 1 ? pixel[1] : pixel[0];
+                rgba[texel * 4 + 2] = components > 2 ? pixel[2] : (components > 1 ? 0 : pixel[0]);
+                rgba[texel * 4 + 3] = components > 3 ? pixel[3] : 255;
+            });
+
+            std::uint8_t channel[16];
+            auto extract = [&](int c) {
+                for (int i = 0; i < 16; i++) channel[i] = rgba[i * 4 + c];
+            };
+
+            switch (format) {
+                case TextureFormat::BC1:
+                    encodeBC1Block(rgba, out);
+                    break;
+                case TextureFormat::BC3:
+                    extract(3);
+                    encodeBC4Block(channel, out);
+                    encodeBC1Block(rgba, out + 8);
+                    break;
+                case TextureFormat::BC4:
+                    extract(0);
+                    encodeBC4Block(channel, out);
+                    break;
+                default:
+                    extract(0);
+                    encodeBC4Block(channel, out);
+                    extract(1);
+                    encodeBC4Block(channel, out + 8);
+                    break;
+            }
+            out += blockBytes(format);
+        }
+    }
+    return result;
+}
+
+TextureLevel TextureCompression::decode(const TextureLevel& level, TextureFormat format) {
+
+    if (!isCompressed(format)) return level;
+
+    int channels = channelCount(format);
+    TextureLevel result;
+    result.width = level.width;
+    result.height = level.height;
+    result.data.resize(std::size_t(level.width) * level.height * channels);
+
+    int blocksX = (level.width + 3) / 4;
+    int blocksY = (level.height + 3) / 4;
+    const std::uint8_t* in = level.data.data();
+
+    for (int by = 0; by < blocksY; by++) {
+        for (int bx = 0; bx < blocksX; bx++) {
+            std::uint8_t rgba[64];
+            std::uint8_t first[16], second[16];
+            switch (format) {
+                case TextureFormat::BC1:
+                    decodeBC1Block(in, rgba);
+                    break;
+                case TextureFormat::BC3:
+                    decodeBC4Block(in, first);
+                    decodeBC1Block(in + 8, rgba);
+                    for (int i = 0; i < 16; i++) rgba[i * 4 + 3] = first[i];
+                    break;
+                case TextureFormat::BC4:
+                    decodeBC4Block(in, first);
+                    for (int i = 0; i < 16; i++) rgba[i * 4] = first[i];
+                    break;
+                default:
+                    decodeBC4Block(in, first);
+                    decodeBC4Block(in + 8, second);
+                    for (int i = 0; i < 16; i++) { rgba[i * 4] = first[i]; rgba[i * 4 + 1] = second[i]; }
+                    break;
+            }
+            in += blockBytes(format);
+
+            //texels past the edge were padding
+            for (int y = 0; y < 4 && by * 4 + y < level.height; y++) {
+                for (int x = 0; x < 4 && bx * 4 + x < level.width; x++) {
+                    std::size_t target = (std::size_t(by * 4 + y) * level.width + bx * 4 + x) * channels;
+                    std::memcpy(&result.data[target], &rgba[(y * 4 + x) * 4], channels);
+                }
+            }
+        }
+    }
+    return result;
+}
+
+// Endpoints from the principal axis of the block's colors, inset a little so the extremes land
+// on palette entries, then refined once by least squares against the chosen indices
+void TextureCompression::encodeBC1Block(const std::uint8_t* rgba, std::uint8_t* block) {
+
+    Color texels[16];
+    Color mean;
+    for (int i = 0; i < 16; i++) {
+        texels[i] = Color{static_cast<float>(rgba[i * 4]), static_cast<float>(rgba[i * 4 + 1]), static_cast<float>(rgba[i * 4 + 2])};
+        mean.r += texels[i].r / 16.0f; mean.g += texels[i].g / 16.0f; mean.b += texels[i].b / 16.0f;
+    }
+
+    // --- 1. Principal axis by power iteration on the covariance ---
+    float cov[3][3] = {};
+    for (const Color& texel : texels) {
+        float d[3] = {texel.r - mean.r, texel.g - mean.g, texel.b - mean.b};
+        for (int row = 0; row < 3; row++) for (int col = 0; col < 3; col++) cov[row][col] += d[row] * d[col];
+    }
+    //start from the row of the widest channel, a fixed start can be orthogonal to the axis
+    int widest = cov[0][0] >= cov[1][1] && cov[0][0] >= cov[2][2] ? 0 : (cov[1][1] >= cov[2][2] ? 1 : 2);
+    float axis[3] = {cov[widest][0], cov[widest][1], cov[widest][2]};
+    if (cov[widest][widest] < 1e-6f) axis[0] = axis[1] = axis[2] = 1.0f;
+    for (int iteration = 0; iteration < 8; iteration++) {
+        float next[3];
+        for (int row = 0; row < 3; row++) next[row] = cov[row][0] * axis[0] + cov[row][1] * axis[1] + cov[row][2] * axis[2];
+        float length = std::max({std::abs(next[0]), std::abs(next[1]), std::abs(next[2])});
+        if (length < 1e-6f) break;
+        for (int c = 0; c < 3; c++) axis[c] = next[c] / length;
+    }
+
+    float minT = 1e30f, maxT = -1e30f;
+    for (const Color& texel : texels) {
+        float t = (texel.r - mean.r) * axis[0] + (texel.g - mean.g) * axis[1] + (texel.b - mean.b) * axis[2];
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+    float axisLengthSquared = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+    float inset = (maxT - minT) / 16.0f;
+    minT = (minT + inset) / axisLengthSquared;
+    maxT = (maxT - inset) / axisLengthSquared;
+    auto along = [&](float t) {
+        return Color{mean.r + axis[0] * t, mean.g + axis[1] * t, mean.b + axis[2] * t};
+    };
+
+    // --- 2. Indices for those endpoints, then one least squares refit ---
+    std::uint16_t color0 = packColor(along(maxT));
+    std::uint16_t color1 = packColor(along(minT));
+    std::uint8_t indices[16];
+    float error = assign(texels, color0, color1, indices);
+
+    Color refit0, refit1;
+    if (leastSquares(texels, indices, refit0, refit1)) {
+        std::uint16_t refitColor0 = packColor(refit0);
+        std::uint16_t refitColor1 = packColor(refit1);
+        std::uint8_t refitIndices[16];
+        float refitError = assign(texels, refitColor0, refitColor1, refitIndices);
+        if (refitError < error) {
+            color0 = refitColor0;
+            color1 = refitColor1;
+            std::memcpy(indices, refitIndices, sizeof(indices));
+        }
+    }
+
+    // --- 3. color0 > color1 selects the four color mode, swapping endpoints swaps the index pairs ---
+    if (color0 < color1) {
+        std::swap(color0, color1);
+        for (std::uint8_t& index : indices) index ^= 1;
+    } else if (color0 == color1) {
+        std::memset(indices, 0, sizeof(indices));
+    }
+    writeBC1(color0, color1, indices, block);
+}
+
+void TextureCompression::encodeBC4Block(const std::uint8_t* values, std::uint8_t* block) {
+
+    std::uint8_t minValue = *std::min_element(values, values + 16);
+    std::uint8_t maxValue = *std::max_element(values, values + 16);
+    std::memset(block, 0, 8);
+    block[0] = maxValue;
+    block[1] = minValue;
+    if (maxValue == minValue) return;
+
+    //eight value mode, max first: index 0 is max, 1 is min and 2..7 step from max to min
+    float palette[8];
+    palette[0] = maxValue;
+    palette[1] = minValue;
+    for (int i = 1; i < 7; i++) palette[i + 1] = ((7 - i) * maxValue + i * minValue) / 7.0f;
+
+    std::uint64_t bits = 0;
+    for (int i = 0; i < 16; i++) {
+        std::uint64_t best = 0;
+        float bestError = std::abs(values[i] - palette[0]);
+        for (std::uint64_t p = 1; p < 8; p++) {
+            float error = std::abs(values[i] - palette[p]);
+            if (error < bestError) { bestError = error; best = p; }
+        }
+        bits |= best << (3 * i);
+    }
+    for (int b = 0; b < 6; b++) block[2 + b] = static_cast<std::uint8_t>(bits >> (8 * b));
+}
+
+void TextureCompression::decodeBC1Block(const std::uint8_t* block, std::uint8_t* rgba) {
+    std::uint16_t color0 = static_cast<std::uint16_t>(block[0] | (block[1] << 8));
+    std::uint16_t color1 = static_cast<std::uint16_t>(block[2] | (block[3] << 8));
+    std::uint32_t bits = block[4] | (block[5] << 8) | (block[6] << 16) | (static_cast<std::uint32_t>(block[7]) << 24);
+
+    Color colors[4];
+    palette(color0, color1, colors);
+    bool threeColor = color0 <= color1;
+    if (threeColor) {
+        colors[2] = Color{(colors[0].r + colors[1].r) / 2.0f, (colors[0].g + colors[1].g) / 2.0f, (colors[0].b + colors[1].b) / 2.0f};
+        colors[3] = Color{};
+    }
+
+    for (int i = 0; i < 16; i++) {
+        int index = (bits >> (2 * i)) & 3;
+        rgba[i * 4 + 0] = static_cast<std::uint8_t>(std::lround(colors[index].r));
+        rgba[i * 4 + 1] = static_cast<std::uint8_t>(std::lround(colors[index].g));
+        rgba[i * 4 + 2] = static_cast<std::uint8_t>(std::lround(colors[index].b));
+        rgba[i * 4 + 3] = threeColor && index == 3 ? 0 : 255;
+    }
+}
+
+void TextureCompression::decodeBC4Block(const std::uint8_t* block, std::uint8_t* values) {
+    float a0 = block[0];
+    float a1 = block[1];
+    float palette[8] = {a0, a1};
+    if (a0 > a1) {
+        for (int i = 1; i < 7; i++) palette[i + 1] = ((7 - i) * a0 + i * a1) / 7.0f;
+    } else {
+        for (int i = 1; i < 5; i++) palette[i + 1] = ((5 - i) * a0 + i * a1) / 5.0f;
+        palette[6] = 0.0f;
+        palette[7] = 255.0f;
+    }
+
+    std::uint64_t bits = 0;
+    for (int b = 0; b < 6; b++) bits |= static_cast<std::uint64_t>(block[2 + b]) << (8 * b);
+    for (int i = 0; i < 16; i++) {
+        values[i] = static_cast<std::uint8_t>(std::lround(palette[(bits >> (3 * i)) & 7]));
+    }
+}
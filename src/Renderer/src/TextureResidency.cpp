@@ -0,0 +1,96 @@
+#include "TextureResidency.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+std::uint32_t TextureResidency::levelFor(int width, int height, std::uint32_t levelCount, float screenPixels) {
+    if (levelCount == 0) return 0;
+    if (screenPixels <= 0.0f) return levelCount - 1;
+    float size = static_cast<float>(std::max(width, height));
+    float level = std::floor(std::log2(std::max(size / screenPixels, 1.0f)));
+    return std::min(static_cast<std::uint32_t>(level), levelCount - 1);
+}
+
+std::uint32_t TextureResidency::tailLevel(int width, int height, std::uint32_t levelCount) {
+    std::uint32_t level = 0;
+    while (level + 1 < levelCount && (std::max(width, height) >> level) > TAIL_SIZE) level++;
+    return level;
+}
+
+std::uint32_t TextureResidency::add(std::vector<std::size_t> levelBytes, std::uint32_t tailLevel) {
+    Entry& entry = textures.emplace_back();
+    entry.levelBytes = std::move(levelBytes);
+    entry.tail = std::min<std::uint32_t>(tailLevel, static_cast<std::uint32_t>(entry.levelBytes.size()) - 1);
+    entry.resident = entry.tail;
+    entry.wanted = entry.tail;
+    for (std::size_t l = entry.tail; l < entry.levelBytes.size(); l++) residentBytes += entry.levelBytes[l];
+    return static_cast<std::uint32_t>(textures.size() - 1);
+}
+
+void TextureResidency::request(std::uint32_t texture, std::uint32_t level) {
+    Entry& entry = textures[texture];
+    if (entry.lastUsed != frame) {
+        entry.lastUsed = frame;
+        entry.wanted = level;
+    } else {
+        entry.wanted = std::min(entry.wanted, level);
+    }
+}
+
+void TextureResidency::plan(std::size_t budgetBytes, std::size_t uploadBytes, std::vector<TextureStreamAction>& actions) {
+
+    actions.clear();
+
+    //smallest next level first, so low mips arrive everywhere before anything gets its finest
+    candidates.clear();
+    for (std::uint32_t t = 0; t < textures.size(); t++) {
+        const Entry& entry = textures[t];
+        if (entry.lastUsed == frame && entry.resident > entry.wanted) candidates.push_back({entry.levelBytes[entry.resident - 1], t});
+    }
+    std::make_heap(candidates.begin(), candidates.end(), std::greater<Candidate>());
+
+    std::size_t uploaded = 0;
+    while (!candidates.empty() && (uploaded == 0 || uploaded < uploadBytes)) {
+        std::pop_heap(candidates.begin(), candidates.end(), std::greater<Candidate>());
+        auto [bytes, t] = candidates.back();
+        candidates.pop_back();
+
+        //every other candidate is at least as large, if this one does not fit none will
+        bool fits = true;
+        while (residentBytes + bytes > budgetBytes) {
+            if (!evictFor(t, actions)) { fits = false; break; }
+        }
+        if (!fits) break;
+
+        Entry& entry = textures[t];
+        entry.resident--;
+        residentBytes += bytes;
+        uploaded += bytes;
+        actions.push_back(TextureStreamAction{TextureStreamAction::Type::UPLOAD, t, entry.resident});
+        if (entry.resident > entry.wanted) {
+            candidates.push_back({entry.levelBytes[entry.resident - 1], t});
+            std::push_heap(candidates.begin(), candidates.end(), std::greater<Candidate>());
+        }
+    }
+
+    frame++;
+}
+
+bool TextureResidency::evictFor(std::uint32_t texture, std::vector<TextureStreamAction>& actions) {
+
+    std::uint32_t victim = static_cast<std::uint32_t>(textures.size());
+    for (std::uint32_t t = 0; t < textures.size(); t++) {
+        const Entry& entry = textures[t];
+        if (t == texture || entry.resident >= entry.tail) continue;
+        //drawn this frame, only levels finer than it asked for can go
+        if (entry.lastUsed == frame && entry.resident >= entry.wanted) continue;
+        if (victim == textures.size() || entry.lastUsed < textures[victim].lastUsed) victim = t;
+    }
+    if (victim == textures.size()) return false;
+
+    Entry& entry = textures[victim];
+    actions.push_back(TextureStreamAction{TextureStreamAction::Type::EVICT, victim, entry.resident});
+    residentBytes -= entry.levelBytes[entry.resident];
+    entry.resident++;
+    return true;
+}
@@ -0,0 +1,70 @@
+#include "TextureStreamer.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+TextureStreamer::TextureStreamer(std::size_t budgetBytes, std::size_t uploadBytesPerFrame) {
+    this->budgetBytes = budgetBytes;
+    this->uploadBytesPerFrame = uploadBytesPerFrame;
+}
+
+std::shared_ptr<Texture> TextureStreamer::add(TextureFormat format, std::vector<TextureUpload> levels, std::shared_ptr<const void> owner,
+                                              bool grey) {
+
+    //the tail is sized from the largest level, and a texture with none has nothing to sample
+    if (levels.empty()) throw std::runtime_error("TextureStreamer: a texture needs at least one level");
+
+    std::uint32_t levelCount = static_cast<std::uint32_t>(levels.size());
+    std::vector<std::size_t> levelBytes;
+    for (const TextureUpload& level : levels) levelBytes.push_back(level.size);
+
+    std::uint32_t tail = TextureResidency::tailLevel(levels[0].width, levels[0].height, levelCount);
+    std::uint32_t slot = residency.add(std::move(levelBytes), tail);
+
+    auto texture = std::make_shared<Texture>(format, static_cast<int>(levelCount), grey);
+    for (std::uint32_t l = levelCount; l-- > tail;) texture->uploadLevel(static_cast<int>(l), levels[l]);
+    texture->setBaseLevel(static_cast<int>(tail));
+
+    slots[texture.get()] = slot;
+    streamed.push_back(Streamed{texture, std::move(levels), std::move(owner)});
+    return texture;
+}
+
+void TextureStreamer::request(const Texture& texture, float screenPixels) {
+    auto it = slots.find(&texture);
+    if (it == slots.end()) return;
+
+    const Streamed& entry = streamed[it->second];
+    residency.request(it->second, TextureResidency::levelFor(entry.levels[0].width, entry.levels[0].height,
+                                                             static_cast<std::uint32_t>(entry.levels.size()), screenPixels));
+}
+
+void TextureStreamer::update() {
+
+    PROFILE_SCOPE("TextureStreamer::update");
+
+    uploadsLastFrame = 0;
+    evictionsLastFrame = 0;
+
+    residency.plan(budgetBytes, uploadBytesPerFrame, actions);
+    changed.clear();
+    for (const TextureStreamAction& action : actions) {
+        Streamed& entry = streamed[action.texture];
+        int level = static_cast<int>(action.level);
+        if (action.type == TextureStreamAction::Type::UPLOAD) {
+            entry.texture->uploadLevel(level, entry.levels[level]);
+            uploadsLastFrame++;
+        } else {
+            entry.texture->releaseLevel(level);
+            evictionsLastFrame++;
+        }
+        changed.push_back(action.texture);
+    }
+
+    //nothing samples between here and the actions, so the base level only moves once per texture
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    for (std::uint32_t slot : changed) {
+        streamed[slot].texture->setBaseLevel(static_cast<int>(residency.getResidentLevel(slot)));
+    }
+}
@@ -0,0 +1,134 @@
+#include "Vertex.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+PositionQuantization PositionQuantization::fromBounds(const AABB& bounds) {
+
+    PositionQuantization quantization;
+    if (!bounds.isValid()) return quantization;
+
+    //flat meshes keep a tiny extent on their flat axis so encoding never divides by zero
+    quantization.offset = bounds.min;
+    quantization.scale = glm::max(bounds.max - bounds.min, glm::vec3(1e-6f));
+    return quantization;
+}
+
+glm::mat4 PositionQuantization::toMatrix() const {
+    glm::mat4 matrix(1.0f);
+    matrix[0][0] = scale.x;
+    matrix[1][1] = scale.y;
+    matrix[2][2] = scale.z;
+    matrix[3] = glm::vec4(offset, 1.0f);
+    return matrix;
+}
+
+// IEEE 754 binary16 with round to nearest even, values past the range become infinity
+std::uint16_t VertexPacking::floatToHalf(float value) {
+
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    std::uint32_t sign = (bits >> 16) & 0x8000u;
+    std::uint32_t magnitude = bits & 0x7FFFFFFFu;
+
+    // --- 1. NaN and infinity ---
+    if (magnitude >= 0x7F800000u) {
+        return static_cast<std::uint16_t>(sign | 0x7C00u | (magnitude > 0x7F800000u ? 0x200u : 0u));
+    }
+
+    // --- 2. Overflow ---
+    if (magnitude >= 0x477FF000u) return static_cast<std::uint16_t>(sign | 0x7C00u);
+
+    // --- 3. Subnormal halves, shift the implicit bit in and round ---
+    if (magnitude < 0x38800000u) {
+        if (magnitude < 0x33000000u) return static_cast<std::uint16_t>(sign);
+        std::uint32_t exponent = magnitude >> 23;
+        std::uint32_t mantissa = (magnitude & 0x7FFFFFu) | 0x800000u;
+        std::uint32_t shift = 126 - exponent;
+        std::uint32_t half = mantissa >> shift;
+        std::uint32_t remainder = mantissa & ((1u << shift) - 1);
+        std::uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half & 1u))) half++;
+        return static_cast<std::uint16_t>(sign | half);
+    }
+
+    // --- 4. Normal halves, rebias the exponent and round the mantissa ---
+    std::uint32_t half = (magnitude - 0x38000000u) >> 13;
+    std::uint32_t remainder = magnitude & 0x1FFFu;
+    if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) half++;
+    return static_cast<std::uint16_t>(sign | half);
+}
+
+float VertexPacking::halfToFloat(std::uint16_t half) {
+
+    std::uint32_t sign = static_cast<std::uint32_t>(half & 0x8000u) << 16;
+    std::uint32_t exponent = (half >> 10) & 0x1Fu;
+    std::uint32_t mantissa = half & 0x3FFu;
+    std::uint32_t bits;
+
+    if (exponent == 0) {
+        //zero or subnormal, exact in single precision
+        float value = std::ldexp(static_cast<float>(mantissa), -24);
+        return sign ? -value : value;
+    }
+    if (exponent == 31) {
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+std::uint32_t VertexPacking::packNormal(const glm::vec3& normal) {
+
+    auto snorm10 = [](float value) {
+        float clamped = std::clamp(value, -1.0f, 1.0f);
+        std::int32_t quantized = static_cast<std::int32_t>(std::lround(clamped * 511.0f));
+        return static_cast<std::uint32_t>(quantized) & 0x3FFu;
+    };
+
+    return snorm10(normal.x) | (snorm10(normal.y) << 10) | (snorm10(normal.z) << 20);
+}
+
+glm::vec3 VertexPacking::unpackNormal(std::uint32_t packed) {
+
+    //sign extend each 10 bit field, -512 decodes to -1 like the GL rule does
+    auto snorm10 = [](std::uint32_t bits) {
+        std::int32_t value = static_cast<std::int32_t>(bits << 22) >> 22;
+        return std::max(static_cast<float>(value) / 511.0f, -1.0f);
+    };
+
+    return glm::vec3(snorm10(packed & 0x3FFu), snorm10((packed >> 10) & 0x3FFu), snorm10((packed >> 20) & 0x3FFu));
+}
+
+std::uint16_t VertexPacking::quantizeUnorm16(float value) {
+    float clamped = std::clamp(value, 0.0f, 1.0f);
+    return static_cast<std::uint16_t>(std::lround(clamped * 65535.0f));
+}
+
+PackedVertex VertexPacking::pack(const Vertex& vertex, const PositionQuantization& quantization) {
+
+    PackedVertex packed{};
+    glm::vec3 normalized = (vertex.Position - quantization.offset) / quantization.scale;
+    packed.position[0] = quantizeUnorm16(normalized.x);
+    packed.position[1] = quantizeUnorm16(normalized.y);
+    packed.position[2] = quantizeUnorm16(normalized.z);
+    packed.normal = packNormal(vertex.Normal);
+    packed.texCoords[0] = floatToHalf(vertex.TexCoords.x);
+    packed.texCoords[1] = floatToHalf(vertex.TexCoords.y);
+    return packed;
+}
+
+Vertex VertexPacking::unpack(const PackedVertex& packed, const PositionQuantization& quantization) {
+
+    Vertex vertex;
+    glm::vec3 normalized(packed.position[0] / 65535.0f, packed.position[1] / 65535.0f, packed.position[2] / 65535.0f);
+    vertex.Position = quantization.offset + normalized * quantization.scale;
+    vertex.Normal = unpackNormal(packed.normal);
+    vertex.TexCoords = glm::vec2(halfToFloat(packed.texCoords[0]), halfToFloat(packed.texCoords[1]));
+    return vertex;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "System.hpp"
+#include "LightClusters.hpp"
+#include "Types.hpp"
+#include <cstdint>
+#include <vector>
+
+class Coordinator;
+
+// The brightest directional LightComponent, shading every pixel of the spaces it is in
+struct DirectionalLight {
+    //towards where the light travels, unit length
+    glm::vec3 direction = glm::vec3(0.0f, -1.0f, 0.0f);
+    //already multiplied by the intensity
+    glm::vec3 color = glm::vec3(0.0f);
+    SpaceMask spaces = 0;
+    bool castShadows = false;
+};
+
+// Collects every LightComponent into the flat list the renderer clusters and uploads
+class LightSystem : public System {
+    private:
+        Coordinator* coordinator = nullptr;
+        std::vector<PointLight> lights;
+        //spaces each light shines in, parallel to lights
+        std::vector<SpaceMask> lightSpaces;
+        //parallel to lights, so the renderer can keep a light's shadow tiles across frames
+        std::vector<Entity> lightEntities;
+        std::vector<std::uint8_t> lightShadows;
+        DirectionalLight directionalLight;
+        bool hasDirectional = false;
+
+    public:
+        void init(Coordinator* coordinator);
+
+        //reads world positions, so it runs after the TransformSystem
+        void update();
+
+        const std::vector<PointLight>& getLights() const { return lights; }
+        const std::vector<SpaceMask>& getLightSpaces() const { return lightSpaces; }
+        const std::vector<Entity>& getLightEntities() const { return lightEntities; }
+        bool castsShadows(std::size_t light) const { return lightShadows[light] != 0; }
+
+        //nullptr when no directional light exists
+        const DirectionalLight* getDirectionalLight() const { return hasDirectional ? &directionalLight : nullptr; }
+
+        void onEntityAdded(Entity entity) override {}
+        void onEntityRemoved(Entity entity) override {}
+};
@@ -9,6 +9,7 @@ class btRigidBody;
 class Coordinator;
 class SpaceManager;
 class Space;
+class TransformSystem;
 
 class PhysicsSystem : public System {
 
@@ -21,6 +22,7 @@ class PhysicsSystem : public System {
 
         Coordinator* coordinator;
         SpaceManager* spaceManager;
+        TransformSystem* transformSystem = nullptr;
         
         std::map<Entity, btRigidBody*> entityToRigidBodyMap;
 
@@ -28,7 +30,8 @@ class PhysicsSystem : public System {
 
         SpaceID getCurrentSpace();
         void setCurrentSpace(SpaceID id);
-        void init(Coordinator* coordinator, SpaceManager* spaceManager);
+        //transformSystem is optional, when set moved bodies mark their world transform dirty
+        void init(Coordinator* coordinator, SpaceManager* spaceManager, TransformSystem* transformSystem = nullptr);
         void update(float deltaTime);
         void updateEntitySignature(Entity entity, Signature newSignature);
         void onEntityAdded(Entity entity) override;
@@ -6,11 +6,13 @@
 
 class Coordinator;
 class InputSystem; 
+class TransformSystem;
 
 class PlayerControlSystem : public System {
     private:
         Coordinator* coordinator;
         InputSystem* inputSystem; 
+        TransformSystem* transformSystem = nullptr;
 
         void processCameraLook(Entity entity);
 
@@ -23,7 +25,7 @@ class PlayerControlSystem : public System {
                                     RigidBodyComponent& rigidBody);
 
     public:
-        void init(Coordinator* coordinator, InputSystem* inputSystem);
+        void init(Coordinator* coordinator, InputSystem* inputSystem, TransformSystem* transformSystem = nullptr);
         void update(float deltaTime);
         void onEntityAdded(Entity entity) override {}
         void onEntityRemoved(Entity entity) override {}
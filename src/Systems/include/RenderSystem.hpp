@@ -1,8 +1,29 @@
 #pragma once
 
 #include "System.hpp"
+#include "DrawCommandBuffer.hpp"
+#include "DynamicBVH.hpp"
+#include "DynamicResolution.hpp"
 #include "Framebuffer.hpp"
+#include "GLStateCache.hpp"
+#include "GpuProfiler.hpp"
+#include "InstanceBuffer.hpp"
+#include "LightBuffer.hpp"
+#include "LightClusters.hpp"
+#include "Mesh.hpp"
+#include "PostProcessGraph.hpp"
+#include "PortalView.hpp"
+#include "RenderQueue.hpp"
+#include "RenderTargetPool.hpp"
+#include "SampleCounter.hpp"
+#include "ShadowLayout.hpp"
+#include "ShadowMaps.hpp"
+#include "Shader.hpp"
+#include <array>
+#include <cstdint>
 #include <memory>
+#include <utility>
+#include <vector>
 #include <glm/glm.hpp>
 
 
@@ -11,23 +32,300 @@ class Coordinator;
 class AssetManager;
 class Shader;
 class Framebuffer;
+class TransformSystem;
+class LightSystem;
 struct CameraComponent;
 struct TransformComponent;
 
+// Per-frame counters, refreshed at the end of every draw()
+struct RenderStats {
+    std::uint64_t instances = 0;
+    std::uint64_t triangles = 0;
+    std::uint64_t drawCalls = 0;
+    std::uint64_t drawCommands = 0;
+    std::uint64_t stateBinds = 0;
+    std::uint64_t redundantBinds = 0;
+    std::uint64_t uniformCallsIssued = 0;
+    std::uint64_t uniformCallsSaved = 0;
+    //summed over every view, an entity seen through a portal counts once more
+    std::uint64_t visible = 0;
+    std::uint64_t culled = 0;
+    //views rendered through manifolds, and manifolds drawn as plain meshes instead because they
+    //faced away, were too small on screen or hit the view limit
+    std::uint64_t portalViews = 0;
+    std::uint64_t portalsSkipped = 0;
+    std::uint64_t lights = 0;
+    std::uint64_t lightIndices = 0;
+    std::uint64_t lightOverflow = 0;
+
+    //samples that passed the depth test in each pass, a few frames old
+    std::uint64_t depthSamples = 0;
+    std::uint64_t shadedSamples = 0;
+    //shaded samples per framebuffer pixel, at most 1 with the depth pre-pass
+    float overdraw = 0.0f;
+
+    //fraction of the window resolution rendered, and the GPU time it was picked from
+    float renderScale = 1.0f;
+    float gpuMilliseconds = 0.0f;
+    std::uint64_t renderTargetBytes = 0;
+
+    //cascades and cube faces drawn again, the casters drawn into them, and the ones reused as they were
+    std::uint64_t shadowPasses = 0;
+    std::uint64_t shadowCasters = 0;
+    std::uint64_t shadowTilesCached = 0;
+};
+
 class RenderSystem : public System {
 
     private:
 
-        Coordinator* coordinator;
-        AssetManager* assetManager;
+        Coordinator* coordinator = nullptr;
+        AssetManager* assetManager = nullptr;
+        TransformSystem* transformSystem = nullptr;
         unsigned int quadVAO;
-            
+
+        //declared before the framebuffer, which hands its targets back on destruction
+        std::unique_ptr<RenderTargetPool> renderTargets;
         std::unique_ptr<Framebuffer> framebuffer;
+        std::unique_ptr<GpuProfiler> gpuProfiler;
+        //"GPU::<material>" per MaterialID, interned the first time the material's batch is timed
+        std::vector<const char*> materialZoneNames;
+        //zones kept free for the passes after a view's batches, its portals and post-processing
+        static constexpr std::size_t GPU_ZONES_AFTER_BATCHES = 16;
+        //bloom, tonemapping and FXAA from the HDR framebuffer to the window
+        std::unique_ptr<PostProcessGraph> postProcess;
+        PostProcessSettings postProcessSettings;
+        std::unique_ptr<InstanceBuffer> instanceBuffer;
+
+        //meshes are resolved when an entity joins the system, indexed by entity
+        std::vector<std::shared_ptr<Mesh>> entityMeshes;
+
+        //LOD drawn last frame per entity, the starting point for hysteresis
+        std::vector<std::uint8_t> entityLODs;
+
+        //pixels across the largest draw of each material this frame, by MaterialID, which its
+        //textures stream towards
+        std::vector<float> materialScreenSizes;
+
+        //the resolution the scene is rendered at, the window's scaled by dynamic resolution
+        float viewportWidth = 1280.0f;
+        float viewportHeight = 720.0f;
+        int windowWidth = 1280;
+        int windowHeight = 720;
+        bool dynamicResolutionEnabled = false;
+        DynamicResolution dynamicResolution;
+        //GPU time of the whole frame, what dynamic resolution reacts to
+        std::unique_ptr<SampleCounter> frameTimer;
+
+        float lodThresholdPixels = 1.0f;
+        static constexpr float LOD_HYSTERESIS = 0.25f;
+
+        //world bounds of every renderable, one tree per space so a view only walks its own space.
+        //Only touched when an entity's transform or spaces change
+        struct RenderSpace {
+            DynamicBVH bvh;
+            //BVH proxy per entity, NULL_NODE while the entity is not in this space
+            std::vector<std::int32_t> proxyIDs = std::vector<std::int32_t>(MAX_ENTITIES, DynamicBVH::NULL_NODE);
+        };
+        //indexed by SpaceID, created the first time an entity enters the space
+        std::vector<std::unique_ptr<RenderSpace>> spaces;
+        //spaces each entity currently has a proxy in
+        std::vector<SpaceMask> entitySpaces;
+        SpaceID viewSpace = DEFAULT_SPACE;
+
+        //entities that joined since the last frame and still need a proxy
+        std::vector<Entity> pendingBounds;
+
+        // The camera's view, or what one manifold shows of its target space. Children are drawn
+        // nested inside their parent, each only where the stencil buffer holds its level
+        struct RenderView {
+            SpaceID space = DEFAULT_SPACE;
+            glm::mat4 view = glm::mat4(1.0f);
+            //oblique for portal views, so nothing between the camera and the target manifold is drawn
+            glm::mat4 projection = glm::mat4(1.0f);
+            glm::vec3 cameraPosition = glm::vec3(0.0f);
+            //narrowed to the portal's screen rectangle and its surface
+            Frustum frustum;
+            ScreenRect rect;
+            std::uint32_t level = 0;
+
+            //the manifold this view is seen through, its index in the parent's visibleEntities
+            //and its instance in the instance buffer
+            Entity portal = NULL_ENTITY;
+            std::uint32_t portalSlot = 0;
+            std::uint32_t portalInstance = 0;
+            //the target manifold, which lies on the view's near plane and is never drawn in it
+            Entity exit = NULL_ENTITY;
+
+            std::vector<std::uint32_t> visibleEntities;
+            //indexed like visibleEntities
+            std::vector<InstanceData> instances;
+            //one packet per visible submesh, packet instances index visibleEntities
+            RenderQueue queue;
+            std::vector<std::uint32_t> children;
+
+            //where this view's data lands in the frame's shared buffers
+            std::uint32_t firstInstance = 0;
+            std::uint32_t firstBatch = 0, batchCount = 0;
+            std::uint32_t firstDepthBatch = 0, depthBatchCount = 0;
+            std::uint32_t firstPortalCommand = 0, portalCommandCount = 0;
+            unsigned int portalVertexArray = 0;
+            IndexType portalIndexType = IndexType::UINT32;
+        };
+        //sized once so views can hold references to each other while the tree is built
+        std::vector<RenderView> views;
+        std::size_t viewCount = 0;
+        std::uint32_t maxPortalDepth = 2;
+        float minPortalScreenArea = 0.001f;
+        static constexpr std::size_t MAX_VIEWS = 16;
+
+        GLStateCache stateCache;
+
+        //consecutive commands sharing a material, VAO and index type, submitted as one multi-draw
+        struct DrawBatch {
+            MaterialID materialID;
+            unsigned int vertexArray;
+            IndexType indexType;
+            std::uint32_t firstCommand;
+            std::uint32_t commandCount;
+        };
+        std::unique_ptr<DrawCommandBuffer> drawCommands;
+        std::vector<DrawBatch> drawBatches;
+
+        //depth-only pass over the same instances in front to back order, packet instances index the view's queue
+        bool depthPrePassEnabled = true;
+        RenderQueue depthQueue;
+        std::unique_ptr<DrawCommandBuffer> depthCommands;
+        std::vector<DrawBatch> depthBatches;
+        std::unique_ptr<SampleCounter> depthSamples;
+        std::unique_ptr<SampleCounter> shadedSamples;
+
+        //manifold surfaces, drawn into the stencil and depth buffers around each portal view
+        std::unique_ptr<DrawCommandBuffer> portalCommands;
+
+        //shadows are rendered for the camera's space only, portal views are lit without them
+        bool shadowsEnabled = true;
+        float shadowDistance = 60.0f;
+        static constexpr float CASCADE_SPLIT_LAMBDA = 0.75f;
+        //extra room around each cascade's slice, the camera moves this far before the cascade follows
+        static constexpr float CASCADE_MARGIN = 0.2f;
+        //casters this far beyond a cascade towards the light still shadow it
+        static constexpr float CASCADE_CASTER_DISTANCE = 50.0f;
+        std::unique_ptr<ShadowMaps> shadowMaps;
+        std::array<ShadowCascade, ShadowMaps::CASCADE_COUNT> cascades;
+        //view depth where each cascade ends, zero without a shadowed directional light
+        glm::vec4 cascadeEnds = glm::vec4(0.0f);
+        std::vector<glm::mat4> shadowMatrices;
+
+        // The casters last drawn into a cascade or cube face. A tile is drawn again only when a
+        // list changes or a caster on it moved, its static twin only when that happens to a static one
+        struct ShadowTile {
+            std::vector<Entity> staticCasters;
+            std::vector<Entity> dynamicCasters;
+            bool staticValid = false;
+        };
+        std::vector<ShadowTile> cascadeTiles;
+        std::vector<ShadowTile> atlasTiles;
+
+        // Six atlas tiles held by a point light while it stays among the nearest shadowed lights
+        struct PointShadowSlot {
+            Entity light = NULL_ENTITY;
+            glm::vec3 position = glm::vec3(0.0f);
+            float range = 0.0f;
+            //index into the LightSystem's lights this frame
+            std::size_t lightIndex = 0;
+        };
+        std::vector<PointShadowSlot> pointShadowSlots;
+        //slot of each of the LightSystem's lights this frame, -1 without shadows
+        std::vector<float> lightShadowSlots;
+
+        // One pass over a tile's casters, into its static twin or into the sampled map
+        struct ShadowDraw {
+            ShadowTarget target;
+            bool staticCasters;
+            glm::mat4 view;
+            glm::mat4 projection;
+            //range of shadowCasters, and of the instances after firstShadowInstance
+            std::uint32_t firstCaster, casterCount;
+            std::uint32_t firstBatch, batchCount;
+        };
+        std::vector<ShadowDraw> shadowDraws;
+        std::vector<Entity> shadowCasters;
+        std::uint32_t firstShadowInstance = 0;
+        std::unique_ptr<DrawCommandBuffer> shadowCommands;
+        std::vector<DrawBatch> shadowBatches;
+
+        //entities with a non-static RigidBodyComponent, the casters drawn over the static twin every time they move
+        std::vector<std::uint8_t> entityDynamic;
+        //frame each entity's bounds last changed
+        std::vector<std::uint64_t> entityMovedFrame;
+        std::uint64_t frameIndex = 0;
+        std::vector<std::uint32_t> shadowCandidates;
+        std::vector<std::uint32_t> faceCandidates;
+        //point lights given a shadow slot this frame, nearest reach first
+        std::vector<std::size_t> shadowLights;
+        std::vector<Entity> staticScratch;
+        std::vector<Entity> dynamicScratch;
+
+        //froxel light lists, rebuilt on the CPU for every view from the lights of its space
+        LightClusterGrid lightClusters;
+        std::unique_ptr<LightBuffer> lightBuffer;
+        std::vector<PointLight> viewLights;
+
         std::shared_ptr<Shader> pbrShader;
-        std::shared_ptr<Shader> postProcessShader;
+        std::shared_ptr<Shader> depthShader;
+
+        // resolved once in init so the per-entity loop never looks uniforms up by name
+        struct PbrUniforms {
+            UniformHandle<glm::mat4> view;
+            UniformHandle<glm::mat4> projection;
+            UniformHandle<glm::vec3> viewPos;
+            UniformHandle<glm::vec4> clusterParams;
+            UniformHandle<int> lightData;
+            UniformHandle<int> lightClusters;
+            UniformHandle<int> lightIndices;
+            UniformHandle<glm::vec3> sunDirection;
+            UniformHandle<glm::vec3> sunColor;
+            UniformHandle<glm::vec4> cascadeEnds;
+            UniformHandle<bool> shadowsEnabled;
+            UniformHandle<int> cascadeShadowMap;
+            UniformHandle<int> pointShadowAtlas;
+            UniformHandle<int> shadowMatrices;
+        } pbrUniforms;
+
+        struct DepthUniforms {
+            UniformHandle<glm::mat4> view;
+            UniformHandle<glm::mat4> projection;
+        } depthUniforms;
+
+        RenderStats stats;
 
         void setupScreenQuad();
-        float exposure = 1.0f;
+        void geometryPass(const CameraComponent& camera,
+                        const TransformComponent& cameraTransform,
+                        const LightSystem& lights);
+        void buildView(std::size_t index, const glm::mat4& projection);
+        bool addPortalView(std::size_t parentIndex, std::uint32_t slot, const glm::mat4& projection);
+        void writeInstances();
+        void recordDepthCommands(RenderView& view);
+        void recordDrawCommands(RenderView& view);
+        void recordPortalCommands(RenderView& view);
+        void buildShadows(const LightSystem& lights, const RenderView& camera);
+        void assignPointShadows(const LightSystem& lights, const RenderView& camera);
+        void updateShadowTile(ShadowTile& tile, const ShadowTarget& target, const glm::mat4& view,
+                              const glm::mat4& projection, const std::vector<std::uint32_t>& candidates);
+        void recordShadowCommands();
+        void shadowPass();
+        void drawView(std::size_t index, const LightSystem& lights);
+        const char* getMaterialZoneName(MaterialID materialID);
+        void drawPortal(const RenderView& parent, std::size_t childIndex, const LightSystem& lights);
+        void drawPortalSurface(const RenderView& child);
+        void postProcessPass();
+        void updateResolution();
+        void applyRenderSize();
+        void resolveMesh(Entity entity);
+        void updateBounds();
+        void updateProxy(Entity entity);
 
     public:
 
@@ -35,16 +333,45 @@ class RenderSystem : public System {
 
         void init(  Coordinator* coordinator, 
                     AssetManager* assetManager, 
+                    TransformSystem* transformSystem,
                     int screenWidth = 1280, 
                     int screenHeight = 720);
 
         void draw(const CameraComponent& camera,
                 const TransformComponent& cameraTransform,
-                const glm::vec3& lightPos,
-                const glm::vec3& lightColor);
+                const LightSystem& lights);
+
+        //window framebuffer size in pixels, the render targets follow at the current scale
+        void resize(int width, int height);
 
-        void onEntityAdded(Entity entity) override {}
-        void onEntityRemoved(Entity entity) override {}
+        void onEntityAdded(Entity entity) override;
+        void onEntityRemoved(Entity entity) override;
 
-        void setExposure(float exposure) {this->exposure = exposure;}
+        void setExposure(float exposure);
+        //effects drop out of the post-process graph when turned off, they are never just skipped in a shader
+        void setPostProcessSettings(const PostProcessSettings& settings);
+        void setPostProcessQuality(PostProcessQuality quality);
+        const PostProcessSettings& getPostProcessSettings() const { return postProcessSettings; }
+        //renders below the window resolution when GPU frame time goes over budget, off by default
+        void setDynamicResolution(bool enabled);
+        void setFrameBudget(float milliseconds) { dynamicResolution.setBudget(milliseconds); }
+        void setResolutionScaleRange(float minScale, float maxScale) { dynamicResolution.setScaleRange(minScale, maxScale); }
+        const RenderTargetPool& getRenderTargetPool() const { return *renderTargets; }
+        //largest on-screen simplification error accepted when picking a LOD, in pixels
+        void setLODThreshold(float pixels) {this->lodThresholdPixels = pixels;}
+        //lays down depth first so the PBR pass shades each pixel at most once, on by default
+        void setDepthPrePass(bool enabled) {this->depthPrePassEnabled = enabled;}
+        //cascaded sun shadows and cube shadows for point lights with castShadows, on by default
+        void setShadows(bool enabled) {this->shadowsEnabled = enabled;}
+        //view depth the sun's cascades reach to
+        void setShadowDistance(float distance) {this->shadowDistance = distance;}
+        //space the camera is in
+        void setViewSpace(SpaceID space) {this->viewSpace = space;}
+        //manifolds seen through this many manifolds are drawn as plain meshes, at most 8 for the stencil
+        void setMaxPortalDepth(std::uint32_t depth) {this->maxPortalDepth = depth < 8 ? depth : 8;}
+        //manifolds covering less of the screen than this fraction are not rendered into
+        void setMinPortalScreenArea(float area) {this->minPortalScreenArea = area;}
+        //an entity's SpatialStateComponent instances changed, its proxies move at the next draw
+        void onSpacesChanged(Entity entity) { pendingBounds.push_back(entity); }
+        const RenderStats& getStats() const { return stats; }
 };
\ No newline at end of file
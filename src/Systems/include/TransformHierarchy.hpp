@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Types.hpp"
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Parent/child links and world matrices for every transform, stored in packed arrays sorted by
+// depth so each parent precedes its children. World matrices are then one forward pass:
+// world[i] = world[parent[i]] * local[i]. Only nodes marked dirty and their descendants are
+// recomputed, and the pass starts at the first dirty node, so an unchanged tree costs nothing.
+class TransformHierarchy {
+
+    public:
+
+        static constexpr std::uint32_t NO_INDEX = ~0u;
+
+        //parent must already be in the hierarchy, otherwise the node starts as a root
+        void add(Entity entity, Entity parent = NULL_ENTITY);
+
+        //children of the removed node are attached to its parent, keeping their local transforms
+        void remove(Entity entity);
+
+        //returns false, changing nothing, when the link would create a cycle
+        bool setParent(Entity entity, Entity parent);
+
+        void setLocal(Entity entity, const glm::mat4& local);
+        void markDirty(Entity entity);
+
+        //sorts if links changed, then recomputes dirty subtrees
+        void update();
+
+        bool contains(Entity entity) const;
+        Entity getParent(Entity entity) const;
+        const glm::mat4& getWorld(Entity entity) const;
+        std::size_t size() const { return entities.size(); }
+
+        //packed order, parents always come before their children
+        const std::vector<Entity>& getOrder() const { return entities; }
+
+        //entities whose world matrix changed in the last update
+        const std::vector<Entity>& getUpdatedEntities() const { return updatedEntities; }
+
+        //children moved to a new parent by the last remove()
+        const std::vector<Entity>& getReattached() const { return reattached; }
+
+    private:
+
+        void sortByDepth();
+        void markIndexDirty(std::uint32_t index);
+        std::uint32_t indexOf(Entity entity) const;
+
+        // packed node data, all indexed by position in the depth order
+        std::vector<Entity> entities;
+        std::vector<Entity> parentEntities;
+        std::vector<std::uint32_t> parents;
+        std::vector<glm::mat4> locals;
+        std::vector<glm::mat4> worlds;
+        std::vector<std::uint8_t> dirty;
+
+        std::vector<std::uint32_t> indexByEntity;
+
+        //links changed since the last sort, parents[] may not precede children
+        bool orderDirty = false;
+        std::uint32_t firstDirty = NO_INDEX;
+
+        std::vector<Entity> updatedEntities;
+        std::vector<std::uint32_t> updatedIndices;
+        std::vector<Entity> reattached;
+
+        // sort scratch
+        std::vector<std::int32_t> depths;
+        std::vector<std::uint32_t> depthOffsets;
+        std::vector<std::uint32_t> order;
+        std::vector<std::uint32_t> walk;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "System.hpp"
+#include "TransformHierarchy.hpp"
+#include "Types.hpp"
+#include <cstdint>
+#include <vector>
+
+class Coordinator;
+
+// Keeps WorldTransformComponent in sync with TransformComponent. TransformComponent is local to
+// its parent; world matrices come from a TransformHierarchy. Only entities passed to markDirty
+// and their descendants are recomputed, so anything that writes a TransformComponent after the
+// entity was created has to mark it. Entities that never move cost nothing per frame.
+class TransformSystem : public System {
+
+    private:
+
+        Coordinator* coordinator = nullptr;
+        TransformHierarchy hierarchy;
+
+        std::vector<Entity> dirtyEntities;
+        std::vector<std::uint8_t> dirtyFlags;
+
+    public:
+
+        void init(Coordinator* coordinator);
+        void update();
+
+        void markDirty(Entity entity);
+
+        //keeps the entity's local transform, so its world transform follows the new parent.
+        //Returns false when the link would create a cycle
+        bool setParent(Entity entity, Entity parent);
+        Entity getParent(Entity entity) const { return hierarchy.getParent(entity); }
+
+        //entities recomputed by the last update, read by systems that cache derived data
+        const std::vector<Entity>& getUpdatedEntities() const { return hierarchy.getUpdatedEntities(); }
+
+        void onEntityAdded(Entity entity) override;
+        void onEntityRemoved(Entity entity) override;
+
+        //T * R * S with the rotation expanded from the quaternion directly
+        static glm::mat4 computeLocalMatrix(const TransformComponent& transform);
+
+        //inverse transpose of the upper 3x3, built from cofactors instead of a general inverse
+        static glm::mat3 computeNormalMatrix(const glm::mat4& model);
+
+        //world transform of an entity without a parent
+        static void computeWorldTransform(const TransformComponent& transform, WorldTransformComponent& world);
+};
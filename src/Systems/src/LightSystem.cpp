@@ -0,0 +1,51 @@
+#include "LightSystem.hpp"
+#include "Coordinator.hpp"
+#include "Profiler.hpp"
+
+void LightSystem::init(Coordinator* coordinator) {
+    this->coordinator = coordinator;
+}
+
+void LightSystem::update() {
+
+    PROFILE_SCOPE("LightSystem::update");
+
+    lights.clear();
+    lightSpaces.clear();
+    lightEntities.clear();
+    lightShadows.clear();
+    lights.reserve(entitySet.size());
+    lightSpaces.reserve(entitySet.size());
+    hasDirectional = false;
+
+    for (Entity const& entity : entitySet) {
+        auto const& light = coordinator->getComponent<LightComponent>(entity);
+        auto const& world = coordinator->getComponent<WorldTransformComponent>(entity);
+
+        SpaceMask spaces = coordinator->hasComponent<SpatialStateComponent>(entity)
+                               ? coordinator->getComponent<SpatialStateComponent>(entity).spaceMask()
+                               : SpaceMask(1) << DEFAULT_SPACE;
+
+        if (light.type == LightType::DIRECTIONAL) {
+            //only one is shaded, the brightest wins
+            glm::vec3 color = light.color * light.intensity;
+            if (hasDirectional && glm::dot(color, color) <= glm::dot(directionalLight.color, directionalLight.color)) continue;
+
+            directionalLight.direction = glm::normalize(-glm::vec3(world.model[2]));
+            directionalLight.color = color;
+            directionalLight.spaces = spaces;
+            directionalLight.castShadows = light.castShadows;
+            hasDirectional = true;
+            continue;
+        }
+
+        PointLight pointLight;
+        pointLight.position = glm::vec3(world.model[3]);
+        pointLight.range = light.range;
+        pointLight.color = light.color * light.intensity;
+        lights.push_back(pointLight);
+        lightSpaces.push_back(spaces);
+        lightEntities.push_back(entity);
+        lightShadows.push_back(light.castShadows ? 1 : 0);
+    }
+}
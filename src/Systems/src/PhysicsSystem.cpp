@@ -1,12 +1,15 @@
 #include "PhysicsSystem.hpp"
 #include "SpaceManager.hpp"
 #include "Coordinator.hpp"
+#include "TransformSystem.hpp"
+#include "Profiler.hpp"
 #include <btBulletDynamicsCommon.h>
 #include <iostream>
 
-void PhysicsSystem::init(Coordinator* coordinator, SpaceManager* spaceManager) {
+void PhysicsSystem::init(Coordinator* coordinator, SpaceManager* spaceManager, TransformSystem* transformSystem) {
     this->coordinator = coordinator;
     this->spaceManager = spaceManager;
+    this->transformSystem = transformSystem;
 }
 
 void PhysicsSystem::update(float deltaTime) {
@@ -28,9 +31,13 @@ void PhysicsSystem::update(float deltaTime) {
     }
 
     // --- 2. Step the simulation ---
-    mainSpace->dynamicsWorld->stepSimulation(deltaTime, 10);
+    {
+        PROFILE_SCOPE("PhysicsSystem::stepSimulation");
+        mainSpace->dynamicsWorld->stepSimulation(deltaTime, 10);
+    }
 
     // --- 3. Sync simulation results back to components ---
+    PROFILE_SCOPE("PhysicsSystem::syncTransforms");
     for (auto const& pair : entityToRigidBodyMap) {
         Entity entity = pair.first;
         btRigidBody* body = pair.second;
@@ -53,10 +60,16 @@ void PhysicsSystem::update(float deltaTime) {
         }
 
         btVector3 pos = btTransform.getOrigin();
-        transform.position = glm::vec3(pos.getX(), pos.getY(), pos.getZ());
-        
         btQuaternion rot = btTransform.getRotation();
-        transform.rotation = glm::quat(rot.getW(), rot.getX(), rot.getY(), rot.getZ());
+        glm::vec3 position(pos.getX(), pos.getY(), pos.getZ());
+        glm::quat rotation(rot.getW(), rot.getX(), rot.getY(), rot.getZ());
+
+        //sleeping and static bodies come back unchanged and keep their cached world matrix
+        if (position == transform.position && rotation == transform.rotation) continue;
+
+        transform.position = position;
+        transform.rotation = rotation;
+        if (transformSystem) transformSystem->markDirty(entity);
     }
 }
 
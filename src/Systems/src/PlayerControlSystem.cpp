@@ -1,9 +1,11 @@
 #include "PlayerControlSystem.hpp"
 #include "Coordinator.hpp"
+#include "TransformSystem.hpp"
 
-void PlayerControlSystem::init(Coordinator* coordinator, InputSystem* inputSystem) {
+void PlayerControlSystem::init(Coordinator* coordinator, InputSystem* inputSystem, TransformSystem* transformSystem) {
     this->coordinator = coordinator;
     this->inputSystem = inputSystem;
+    this->transformSystem = transformSystem;
 }
 
 
@@ -22,7 +24,9 @@ void PlayerControlSystem::update(float deltaTime) {
             processMovementBody(transform, playerControl ,coordinator->getComponent<RigidBodyComponent>(entity));
         }
         else {
+            glm::vec3 previousPosition = transform.position;
             processMovementFlight(transform, playerControl ,deltaTime);            
+            if (transformSystem && transform.position != previousPosition) transformSystem->markDirty(entity);
         }
     }
 }
@@ -1,11 +1,16 @@
 #include "RenderSystem.hpp"
 #include "Coordinator.hpp"
 #include "AssetManager.hpp"
+#include "TransformSystem.hpp"
+#include "LightSystem.hpp"
 #include "Mesh.hpp"
 #include "Framebuffer.hpp"
+#include "Profiler.hpp"
 #include <glad/glad.h>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <cmath>
 
 struct QuadVertex {
     glm::vec2 Position;
@@ -13,17 +18,223 @@ struct QuadVertex {
 };
 
 
-void RenderSystem::init(Coordinator* coordinator, AssetManager* assetManager, int screenWidth, int screenHeight) {
+void RenderSystem::init(Coordinator* coordinator, AssetManager* assetManager, TransformSystem* transformSystem, int screenWidth, int screenHeight) {
 
     this->coordinator = coordinator;
     this->assetManager = assetManager;
+    this->transformSystem = transformSystem;
 
-    framebuffer = std::make_unique<Framebuffer>(screenWidth, screenHeight);
+    renderTargets = std::make_unique<RenderTargetPool>();
+    framebuffer = std::make_unique<Framebuffer>(*renderTargets, screenWidth, screenHeight);
+    frameTimer = std::make_unique<SampleCounter>(SampleCounter::Type::TIME_ELAPSED);
+    resize(screenWidth, screenHeight);
+    instanceBuffer = std::make_unique<InstanceBuffer>();
+    drawCommands = std::make_unique<DrawCommandBuffer>();
+    depthCommands = std::make_unique<DrawCommandBuffer>();
+    lightBuffer = std::make_unique<LightBuffer>();
+    depthSamples = std::make_unique<SampleCounter>();
+    shadedSamples = std::make_unique<SampleCounter>();
+    portalCommands = std::make_unique<DrawCommandBuffer>();
+    shadowCommands = std::make_unique<DrawCommandBuffer>();
+    shadowMaps = std::make_unique<ShadowMaps>();
+    shadowMatrices.assign(ShadowMaps::MATRIX_COUNT, glm::mat4(1.0f));
+    cascadeTiles.resize(ShadowMaps::CASCADE_COUNT);
+    atlasTiles.resize(ShadowMaps::TILE_COUNT);
+    pointShadowSlots.resize(ShadowMaps::MAX_POINT_SHADOWS);
+    views.resize(MAX_VIEWS);
+    spaces.resize(MAX_SPACES);
+
+    //entities spawned before init (scene loading) still need their meshes resolved
+    entityMeshes.resize(MAX_ENTITIES);
+    entityLODs.assign(MAX_ENTITIES, 0);
+    entitySpaces.assign(MAX_ENTITIES, 0);
+    entityDynamic.assign(MAX_ENTITIES, 0);
+    entityMovedFrame.assign(MAX_ENTITIES, 0);
+    for (auto const& entity : entitySet) {
+        resolveMesh(entity);
+        pendingBounds.push_back(entity);
+    }
+
+#if SUPERPOSITION_PROFILING
+    gpuProfiler = std::make_unique<GpuProfiler>();
+#endif
 
     pbrShader = assetManager->getShader("pbr");
-    postProcessShader = assetManager->getShader("post_process");
-    
+    depthShader = assetManager->getShader("depth");
+
+    pbrUniforms.view = pbrShader->getUniform<glm::mat4>("view");
+    pbrUniforms.projection = pbrShader->getUniform<glm::mat4>("projection");
+    pbrUniforms.viewPos = pbrShader->getUniform<glm::vec3>("viewPos");
+    pbrUniforms.clusterParams = pbrShader->getUniform<glm::vec4>("clusterParams");
+    pbrUniforms.lightData = pbrShader->getUniform<int>("lightData");
+    pbrUniforms.lightClusters = pbrShader->getUniform<int>("lightClusters");
+    pbrUniforms.lightIndices = pbrShader->getUniform<int>("lightIndices");
+    pbrUniforms.sunDirection = pbrShader->getUniform<glm::vec3>("sunDirection");
+    pbrUniforms.sunColor = pbrShader->getUniform<glm::vec3>("sunColor");
+    pbrUniforms.cascadeEnds = pbrShader->getUniform<glm::vec4>("cascadeEnds");
+    pbrUniforms.shadowsEnabled = pbrShader->getUniform<bool>("shadowsEnabled");
+    pbrUniforms.cascadeShadowMap = pbrShader->getUniform<int>("cascadeShadowMap");
+    pbrUniforms.pointShadowAtlas = pbrShader->getUniform<int>("pointShadowAtlas");
+    pbrUniforms.shadowMatrices = pbrShader->getUniform<int>("shadowMatrices");
+    pbrShader->bindUniformBlock("MaterialBlock", MaterialBuffer::BINDING_POINT);
+
+    //the light buffers and shadow maps never move off their units
+    pbrShader->use();
+    pbrShader->set(pbrUniforms.lightData, static_cast<int>(LightBuffer::FIRST_TEXTURE_UNIT));
+    pbrShader->set(pbrUniforms.lightClusters, static_cast<int>(LightBuffer::FIRST_TEXTURE_UNIT + 1));
+    pbrShader->set(pbrUniforms.lightIndices, static_cast<int>(LightBuffer::FIRST_TEXTURE_UNIT + 2));
+    pbrShader->set(pbrUniforms.cascadeShadowMap, static_cast<int>(ShadowMaps::FIRST_TEXTURE_UNIT));
+    pbrShader->set(pbrUniforms.pointShadowAtlas, static_cast<int>(ShadowMaps::FIRST_TEXTURE_UNIT + 1));
+    pbrShader->set(pbrUniforms.shadowMatrices, static_cast<int>(ShadowMaps::FIRST_TEXTURE_UNIT + 2));
+
+    depthUniforms.view = depthShader->getUniform<glm::mat4>("view");
+    depthUniforms.projection = depthShader->getUniform<glm::mat4>("projection");
+
     setupScreenQuad();
+
+    PostProcessShaders postProcessShaders;
+    postProcessShaders.bloomDownsample = assetManager->getShader("bloom_downsample");
+    postProcessShaders.bloomUpsample = assetManager->getShader("bloom_upsample");
+    postProcessShaders.tonemap = assetManager->getShader("tonemap");
+    postProcessShaders.fxaa = assetManager->getShader("fxaa");
+    postProcess = std::make_unique<PostProcessGraph>(postProcessShaders, quadVAO);
+    postProcess->setSettings(postProcessSettings);
+}
+
+void RenderSystem::setExposure(float exposure) {
+    postProcessSettings.exposure = exposure;
+    if (postProcess) postProcess->setSettings(postProcessSettings);
+}
+
+void RenderSystem::setPostProcessSettings(const PostProcessSettings& settings) {
+    postProcessSettings = settings;
+    if (postProcess) postProcess->setSettings(postProcessSettings);
+}
+
+void RenderSystem::setPostProcessQuality(PostProcessQuality quality) {
+    PostProcessSettings settings = PostProcessSettings::forQuality(quality);
+    settings.exposure = postProcessSettings.exposure;
+    setPostProcessSettings(settings);
+}
+
+void RenderSystem::resize(int width, int height) {
+    windowWidth = width;
+    windowHeight = height;
+    applyRenderSize();
+}
+
+void RenderSystem::setDynamicResolution(bool enabled) {
+    dynamicResolutionEnabled = enabled;
+    applyRenderSize();
+}
+
+void RenderSystem::applyRenderSize() {
+
+    //before init there is nothing to resize yet
+    if (!framebuffer) return;
+
+    float scale = dynamicResolutionEnabled ? dynamicResolution.getScale() : 1.0f;
+    int width = std::max(1, static_cast<int>(std::lround(windowWidth * scale)));
+    int height = std::max(1, static_cast<int>(std::lround(windowHeight * scale)));
+
+    framebuffer->resize(width, height);
+    viewportWidth = static_cast<float>(width);
+    viewportHeight = static_cast<float>(height);
+    stats.renderScale = scale;
+}
+
+// Feeds the GPU time of a frame a few frames back to the controller, and follows a new scale
+// with the render targets. The pool keeps the previous size around for when it comes back
+void RenderSystem::updateResolution() {
+
+    stats.gpuMilliseconds = static_cast<float>(frameTimer->getSamples()) * 1e-6f;
+
+    if (dynamicResolutionEnabled && dynamicResolution.update(stats.gpuMilliseconds)) {
+        applyRenderSize();
+    }
+
+    renderTargets->endFrame();
+    stats.renderTargetBytes = renderTargets->getBytesAllocated();
+}
+
+void RenderSystem::resolveMesh(Entity entity) {
+    auto const& meshInfo = coordinator->getComponent<MeshComponent>(entity);
+    entityMeshes[entity] = assetManager->getMesh(meshInfo.meshName);
+}
+
+void RenderSystem::onEntityAdded(Entity entity) {
+    if (!assetManager) return;
+    resolveMesh(entity);
+    entityLODs[entity] = 0;
+    pendingBounds.push_back(entity);
+}
+
+void RenderSystem::onEntityRemoved(Entity entity) {
+    if (entity < entityMeshes.size()) entityMeshes[entity].reset();
+
+    if (entity >= entitySpaces.size()) return;
+    for (SpaceID space = 0; space < MAX_SPACES; space++) {
+        if (!(entitySpaces[entity] & (SpaceMask(1) << space))) continue;
+        RenderSpace& renderSpace = *spaces[space];
+        renderSpace.bvh.destroyProxy(renderSpace.proxyIDs[entity]);
+        renderSpace.proxyIDs[entity] = DynamicBVH::NULL_NODE;
+    }
+    entitySpaces[entity] = 0;
+}
+
+// Refits the BVHs for new entities and ones whose world transform was recomputed this frame
+void RenderSystem::updateBounds() {
+
+    PROFILE_SCOPE("RenderSystem::updateBounds");
+
+    for (Entity entity : pendingBounds) {
+        updateProxy(entity);
+    }
+    pendingBounds.clear();
+
+    if (!transformSystem) return;
+    for (Entity entity : transformSystem->getUpdatedEntities()) {
+        updateProxy(entity);
+    }
+}
+
+void RenderSystem::updateProxy(Entity entity) {
+
+    //the transform system also tracks entities that are not rendered, or were removed since
+    if (entity >= entityMeshes.size() || !entityMeshes[entity]) return;
+
+    auto const& world = coordinator->getComponent<WorldTransformComponent>(entity);
+    AABB worldBounds = entityMeshes[entity]->bounds.transformed(world.model);
+
+    //shadow tiles this entity falls into are drawn again, its rigid body decides which twin.
+    //Mass 0 is a static body to the physics system, like the ground, so it stays cached
+    entityMovedFrame[entity] = frameIndex;
+    entityDynamic[entity] = coordinator->hasComponent<RigidBodyComponent>(entity)
+                                && coordinator->getComponent<RigidBodyComponent>(entity).mass != 0.0f ? 1 : 0;
+
+    SpaceMask mask = coordinator->hasComponent<SpatialStateComponent>(entity)
+                         ? coordinator->getComponent<SpatialStateComponent>(entity).spaceMask()
+                         : SpaceMask(1) << DEFAULT_SPACE;
+
+    //instances share the entity's world transform in every space it is in
+    for (SpaceID space = 0; space < MAX_SPACES; space++) {
+        SpaceMask bit = SpaceMask(1) << space;
+        if (!((mask | entitySpaces[entity]) & bit)) continue;
+
+        if (!spaces[space]) spaces[space] = std::make_unique<RenderSpace>();
+        RenderSpace& renderSpace = *spaces[space];
+        std::int32_t& proxyID = renderSpace.proxyIDs[entity];
+
+        if (!(mask & bit)) {
+            renderSpace.bvh.destroyProxy(proxyID);
+            proxyID = DynamicBVH::NULL_NODE;
+        } else if (proxyID != DynamicBVH::NULL_NODE) {
+            renderSpace.bvh.moveProxy(proxyID, worldBounds);
+        } else {
+            proxyID = renderSpace.bvh.createProxy(worldBounds, entity);
+        }
+    }
+    entitySpaces[entity] = mask;
 }
 
 void RenderSystem::setupScreenQuad() {
@@ -56,58 +267,908 @@ void RenderSystem::setupScreenQuad() {
 
 void RenderSystem::draw(const CameraComponent& camera,
                       const TransformComponent& cameraTransform,
-                      const glm::vec3& lightPos,
-                      const glm::vec3& lightColor)
+                      const LightSystem& lights)
 {
+    if (gpuProfiler) gpuProfiler->beginFrame();
+    Shader::resetUniformStats();
+
+    frameTimer->begin();
+    geometryPass(camera, cameraTransform, lights);
+    postProcessPass();
+    frameTimer->end();
+
+    updateResolution();
+
+    UniformStats uniformStats = Shader::getUniformStats();
+    stats.uniformCallsIssued = uniformStats.callsIssued;
+    stats.uniformCallsSaved = uniformStats.callsSaved;
+}
+
+void RenderSystem::geometryPass(const CameraComponent& camera,
+                                const TransformComponent& cameraTransform,
+                                const LightSystem& lights)
+{
+    PROFILE_SCOPE("RenderSystem::geometryPass");
+    GPU_PROFILE_SCOPE(gpuProfiler.get(), "GPU::geometryPass");
+
+    glm::mat4 view = glm::lookAt(cameraTransform.position, cameraTransform.position + cameraTransform.front, glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = camera.projectionMatrix;
+
+    //portal views only change the depth row of the projection, so they share the froxel layout
+    lightClusters.setProjection(projection);
+
+    frameIndex++;
+    updateBounds();
+
+    // The camera's view, then every portal view it can see, each culled against its own space
+    stats.visible = 0;
+    stats.culled = 0;
+    stats.portalsSkipped = 0;
+    stats.triangles = 0;
+    materialScreenSizes.assign(assetManager->getMaterialCount(), 0.0f);
+    {
+        PROFILE_SCOPE("RenderSystem::buildViews");
+
+        viewCount = 1;
+        RenderView& root = views[0];
+        root.space = viewSpace < MAX_SPACES ? viewSpace : DEFAULT_SPACE;
+        root.view = view;
+        root.projection = projection;
+        root.cameraPosition = cameraTransform.position;
+        root.frustum = Frustum::fromMatrix(projection * view);
+        root.rect = ScreenRect{};
+        root.level = 0;
+        root.portal = NULL_ENTITY;
+        root.exit = NULL_ENTITY;
+        buildView(0, projection);
+    }
+    stats.portalViews = viewCount - 1;
+
+    //mip feedback for the texture streamer, applied in the next AssetManager::update
+    assetManager->requestTextures(materialScreenSizes);
+
+    //after the camera's view picked this frame's LODs, which the casters reuse
+    buildShadows(lights, views[0]);
+
+    writeInstances();
+
+    // Every view's commands go into the same buffers, uploaded once
+    {
+        PROFILE_SCOPE("RenderSystem::recordCommands");
+
+        drawCommands->clear();
+        drawBatches.clear();
+        depthCommands->clear();
+        depthBatches.clear();
+        portalCommands->clear();
+        shadowCommands->clear();
+        shadowBatches.clear();
+
+        for (std::size_t i = 0; i < viewCount; i++) {
+            if (depthPrePassEnabled) recordDepthCommands(views[i]);
+            recordDrawCommands(views[i]);
+            recordPortalCommands(views[i]);
+        }
+        recordShadowCommands();
+
+        drawCommands->upload();
+        depthCommands->upload();
+        portalCommands->upload();
+        shadowCommands->upload();
+    }
+
+    //the post process pass and framebuffer binds bypass the cache, start each frame from scratch
+    stateCache.invalidate();
+    stateCache.resetStats();
+
+    shadowPass();
+
     // --- 1. GEOMETRY PASS: Render the scene to the framebuffer ---
     framebuffer->bind();
     glEnable(GL_DEPTH_TEST); // Enable depth testing
-    
-    // Clear the framebuffer's content
+
+    // Clear the framebuffer's content, the stencil holds which view owns each pixel
     glClearColor(0.1f, 0.1f, 0.15f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
-    pbrShader->use();
+    glEnable(GL_STENCIL_TEST);
+    drawView(0, lights);
+    glDisable(GL_STENCIL_TEST);
+    instanceBuffer->endFrame();
+
+    const GLStateStats& stateStats = stateCache.getStats();
+    stats.drawCalls = stateStats.draws;
+    stats.stateBinds = stateStats.binds();
+    stats.redundantBinds = stateStats.redundantBinds;
+    stats.drawCommands = drawCommands->size() + depthCommands->size() + portalCommands->size() + shadowCommands->size();
+    stats.depthSamples = views[0].depthBatchCount > 0 ? depthSamples->getSamples() : 0;
+    stats.shadedSamples = shadedSamples->getSamples();
+    stats.overdraw = static_cast<float>(stats.shadedSamples) / (viewportWidth * viewportHeight);
+}
+
+// Culls the view against its space and builds one packet per visible submesh. Manifolds that open
+// a portal view draw nothing here, their children are built once the view's own queue is sorted
+void RenderSystem::buildView(std::size_t index, const glm::mat4& projection) {
+
+    RenderView& view = views[index];
+    view.visibleEntities.clear();
+    view.queue.clear();
+    view.children.clear();
+    view.batchCount = 0;
+    view.depthBatchCount = 0;
+
+    // --- 1. Only entities of this space whose bounds touch the view's frustum ---
+    if (RenderSpace* space = spaces[view.space].get()) {
+        PROFILE_SCOPE("RenderSystem::cull");
+        space->bvh.query(view.frustum, view.visibleEntities);
+        stats.culled += space->bvh.getProxyCount() - view.visibleEntities.size();
+    }
+    stats.visible += view.visibleEntities.size();
+
+    // --- 2. Packets, sorted by state ---
+    {
+        PROFILE_SCOPE("RenderSystem::buildQueue");
+
+        view.instances.resize(view.visibleEntities.size());
+
+        //pixels covered by one world unit at distance one, projection[1][1] is 1 / tan(fovy / 2)
+        float pixelsPerUnitAtOne = projection[1][1] * viewportHeight * 0.5f;
+
+        for (std::size_t i = 0; i < view.visibleEntities.size(); i++) {
+            Entity entity = view.visibleEntities[i];
+            const Mesh& mesh = *entityMeshes[entity];
+            auto const& world = coordinator->getComponent<WorldTransformComponent>(entity);
+
+            //matrices come straight from the cache, nothing is rebuilt for entities that did not move.
+            //Quantized meshes fold their position decode into the model matrix
+            view.instances[i].model = mesh.quantized ? world.model * mesh.positionTransform : world.model;
+            view.instances[i].normalMatrix = world.normalMatrix;
+
+            //the manifold the view looks out of lies on its near plane
+            if (entity == view.exit) continue;
+            if (view.level < maxPortalDepth && coordinator->hasComponent<SpatialManifoldComponent>(entity) &&
+                addPortalView(index, static_cast<std::uint32_t>(i), projection)) {
+                continue;
+            }
+
+            float viewDepth = -(view.view * world.model[3]).z;
+            std::uint32_t depth = RenderKey::depthBucket(viewDepth);
+
+            //pixels one unit of the mesh covers at the bounds' center
+            glm::vec3 center = glm::vec3(world.model * glm::vec4(mesh.bounds.center(), 1.0f));
+            float distance = std::max(glm::length(center - view.cameraPosition), 0.01f);
+            float scale = std::sqrt(std::max({glm::dot(glm::vec3(world.model[0]), glm::vec3(world.model[0])),
+                                              glm::dot(glm::vec3(world.model[1]), glm::vec3(world.model[1])),
+                                              glm::dot(glm::vec3(world.model[2]), glm::vec3(world.model[2]))}));
+            float pixelsPerUnit = scale * pixelsPerUnitAtOne / distance;
+
+            // LOD from the projected size of the simplification error at the bounds' center
+            std::size_t firstSubMesh = 0;
+            std::size_t lastSubMesh = mesh.subMeshes.size();
+            if (mesh.lods.size() > 1) {
+                std::uint32_t lod = LODSelection::select(mesh.lods.data(), mesh.lods.size(), entityLODs[entity],
+                                                         pixelsPerUnit, lodThresholdPixels, LOD_HYSTERESIS);
+                //hysteresis follows the camera's view, portal views pick from it without moving it
+                if (view.level == 0) entityLODs[entity] = static_cast<std::uint8_t>(lod);
+                firstSubMesh = mesh.lods[lod].firstSubMesh;
+                lastSubMesh = firstSubMesh + mesh.getPrimitiveCount();
+            }
+
+            //textures are assumed to span the mesh once, the bounds' diagonal on screen
+            float screenSize = pixelsPerUnit * 2.0f * glm::length(mesh.bounds.extents());
+
+            for (std::size_t s = firstSubMesh; s < lastSubMesh; s++) {
+                stats.triangles += mesh.subMeshes[s].indexCount / 3;
+                MaterialID materialID = mesh.subMeshes[s].materialID;
+                if (materialID < materialScreenSizes.size()) {
+                    materialScreenSizes[materialID] = std::max(materialScreenSizes[materialID], screenSize);
+                }
+                std::uint64_t key = RenderKey::make(RenderKey::PASS_OPAQUE,
+                                                    pbrShader->sortID,
+                                                    materialID,
+                                                    mesh.id,
+                                                    static_cast<std::uint32_t>(s),
+                                                    depth);
+                view.queue.push(key, static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(s));
+            }
+        }
+
+        view.queue.sort();
+    }
+
+    // --- 3. Portal views, culled against their target space ---
+    for (std::uint32_t child : view.children) {
+        buildView(child, projection);
+    }
+}
+
+// Opens a view through a visible manifold. Returns false when the manifold should be drawn as a
+// plain mesh instead: it faces away, covers too little of the screen or the view limit is reached
+bool RenderSystem::addPortalView(std::size_t parentIndex, std::uint32_t slot, const glm::mat4& projection) {
+
+    RenderView& parent = views[parentIndex];
+    Entity portal = parent.visibleEntities[slot];
+    auto const& manifold = coordinator->getComponent<SpatialManifoldComponent>(portal);
+    const glm::mat4& sourceModel = coordinator->getComponent<WorldTransformComponent>(portal).model;
+
+    if (viewCount >= views.size() || manifold.targetSpace >= MAX_SPACES || manifold.targetManifold == NULL_ENTITY ||
+        !coordinator->hasComponent<WorldTransformComponent>(manifold.targetManifold)) {
+        stats.portalsSkipped++;
+        return false;
+    }
+
+    //what the manifold can show is bounded by its rectangle, nested portals by their parent's too
+    ScreenRect rect;
+    AABB bounds = entityMeshes[portal]->bounds.transformed(sourceModel);
+    if (!PortalView::facesCamera(sourceModel, parent.cameraPosition) ||
+        !PortalView::screenRect(parent.projection * parent.view, bounds, rect)) {
+        stats.portalsSkipped++;
+        return false;
+    }
+    rect = ScreenRect::intersect(rect, parent.rect);
+    if (rect.area() < minPortalScreenArea) {
+        stats.portalsSkipped++;
+        return false;
+    }
+
+    const glm::mat4& targetModel = coordinator->getComponent<WorldTransformComponent>(manifold.targetManifold).model;
+
+    std::size_t childIndex = viewCount++;
+    RenderView& child = views[childIndex];
+    child.space = manifold.targetSpace;
+    child.view = PortalView::throughPortal(parent.view, sourceModel, targetModel);
+    child.projection = PortalView::obliqueProjection(projection, PortalView::clipPlane(child.view, targetModel));
+    child.cameraPosition = glm::vec3(glm::inverse(child.view)[3]);
+    child.rect = rect;
+    child.level = parent.level + 1;
+    child.portal = portal;
+    child.portalSlot = slot;
+    child.exit = manifold.targetManifold;
+
+    //side planes through the rectangle and the target manifold's surface as the near plane
+    child.frustum = Frustum::fromMatrix(PortalView::restrictToRect(projection, rect) * child.view);
+    child.frustum.planes[4] = PortalView::clipPlane(glm::mat4(1.0f), targetModel);
+
+    parent.children.push_back(static_cast<std::uint32_t>(childIndex));
+    return true;
+}
+
+// Instance data of every view in one mapping, each view in its packet order so every batch is a
+// contiguous range, followed by the surfaces of the manifolds it looks through
+void RenderSystem::writeInstances() {
+
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < viewCount; i++) {
+        RenderView& view = views[i];
+        view.firstInstance = static_cast<std::uint32_t>(total);
+        total += view.queue.size();
+        for (std::uint32_t child : view.children) {
+            views[child].portalInstance = static_cast<std::uint32_t>(total++);
+        }
+    }
+    firstShadowInstance = static_cast<std::uint32_t>(total);
+    total += shadowCasters.size();
+    stats.instances = total;
+
+    InstanceData* instances = instanceBuffer->map(total);
+    if (!instances) return;
+
+    for (std::size_t i = 0; i < viewCount; i++) {
+        const RenderView& view = views[i];
+        for (std::size_t p = 0; p < view.queue.size(); p++) {
+            instances[view.firstInstance + p] = view.instances[view.queue[p].instance];
+        }
+        for (std::uint32_t child : view.children) {
+            instances[views[child].portalInstance] = view.instances[views[child].portalSlot];
+        }
+    }
+    for (std::size_t c = 0; c < shadowCasters.size(); c++) {
+        Entity entity = shadowCasters[c];
+        const Mesh& mesh = *entityMeshes[entity];
+        auto const& world = coordinator->getComponent<WorldTransformComponent>(entity);
+        InstanceData& instance = instances[firstShadowInstance + c];
+        instance.model = mesh.quantized ? world.model * mesh.positionTransform : world.model;
+        instance.normalMatrix = world.normalMatrix;
+    }
+    instanceBuffer->unmap();
+}
+
+// Depth only, front to back so later occluders are rejected early. Draws read the instance
+// data written for the main queue, so a command covers consecutive packets of that queue.
+void RenderSystem::recordDepthCommands(RenderView& view) {
+
+    PROFILE_SCOPE("RenderSystem::depthPrePass");
+
+    // --- 1. Re-sort the view's packets by depth ---
+    depthQueue.clear();
+    for (std::size_t i = 0; i < view.queue.size(); i++) {
+        const DrawPacket& packet = view.queue[i];
+        const Mesh& mesh = *entityMeshes[view.visibleEntities[packet.instance]];
+        std::uint64_t key = RenderKey::makeDepthFirst(static_cast<std::uint32_t>(mesh.getIndexType()),
+                                                      static_cast<std::uint32_t>(packet.key & RenderKey::DEPTH_MASK),
+                                                      mesh.id,
+                                                      packet.subMesh);
+        depthQueue.push(key, static_cast<std::uint32_t>(i), packet.subMesh);
+    }
+    depthQueue.sort();
+
+    // --- 2. Record the commands, one multi-draw per VAO and index type ---
+    view.firstDepthBatch = static_cast<std::uint32_t>(depthBatches.size());
+
+    const auto& packets = depthQueue.getPackets();
+    std::size_t begin = 0;
+    while (begin < packets.size()) {
+        const DrawPacket& first = packets[begin];
+        const Mesh& mesh = *entityMeshes[view.visibleEntities[view.queue[first.instance].instance]];
+
+        //the same submesh at neighbouring depths can share a command if its instances are adjacent too
+        std::size_t end = begin + 1;
+        while (end < packets.size() &&
+               packets[end].instance == first.instance + (end - begin) &&
+               packets[end].subMesh == first.subMesh &&
+               entityMeshes[view.visibleEntities[view.queue[packets[end].instance].instance]].get() == &mesh) {
+            end++;
+        }
+
+        const SubMesh& subMesh = mesh.subMeshes[first.subMesh];
+        depthCommands->push(DrawElementsIndirectCommand{subMesh.indexCount,
+                                                       static_cast<std::uint32_t>(end - begin),
+                                                       subMesh.indexOffset,
+                                                       subMesh.baseVertex,
+                                                       view.firstInstance + first.instance});
+
+        if (depthBatches.size() == view.firstDepthBatch ||
+            depthBatches.back().vertexArray != mesh.getDepthVAO() ||
+            depthBatches.back().indexType != mesh.getIndexType()) {
+            depthBatches.push_back(DrawBatch{0, mesh.getDepthVAO(), mesh.getIndexType(),
+                                             static_cast<std::uint32_t>(depthCommands->size() - 1), 0});
+        }
+        depthBatches.back().commandCount++;
+
+        begin = end;
+    }
+
+    view.depthBatchCount = static_cast<std::uint32_t>(depthBatches.size()) - view.firstDepthBatch;
+}
+
+// Packets whose keys match in everything but depth become one indirect command, and the commands
+// of one material are issued together since textures and the material range cannot change inside
+// a multi-draw
+void RenderSystem::recordDrawCommands(RenderView& view) {
+
+    PROFILE_SCOPE("RenderSystem::submitQueue");
+
+    const auto& packets = view.queue.getPackets();
+    view.firstBatch = static_cast<std::uint32_t>(drawBatches.size());
+
+    std::size_t begin = 0;
+    while (begin < packets.size()) {
+        const DrawPacket& first = packets[begin];
+        const Mesh& mesh = *entityMeshes[view.visibleEntities[first.instance]];
+        std::uint64_t batchKey = first.key & RenderKey::BATCH_MASK;
+
+        //mesh and submesh are compared in full in case they alias in the key's truncated fields
+        std::size_t end = begin + 1;
+        while (end < packets.size() &&
+               (packets[end].key & RenderKey::BATCH_MASK) == batchKey &&
+               packets[end].subMesh == first.subMesh &&
+               entityMeshes[view.visibleEntities[packets[end].instance]].get() == &mesh) {
+            end++;
+        }
+
+        const SubMesh& subMesh = mesh.subMeshes[first.subMesh];
+        drawCommands->push(DrawElementsIndirectCommand{subMesh.indexCount,
+                                                      static_cast<std::uint32_t>(end - begin),
+                                                      subMesh.indexOffset,
+                                                      subMesh.baseVertex,
+                                                      view.firstInstance + static_cast<std::uint32_t>(begin)});
+
+        if (drawBatches.size() == view.firstBatch ||
+            drawBatches.back().materialID != subMesh.materialID ||
+            drawBatches.back().vertexArray != mesh.getVAO() ||
+            drawBatches.back().indexType != mesh.getIndexType()) {
+            drawBatches.push_back(DrawBatch{subMesh.materialID, mesh.getVAO(), mesh.getIndexType(),
+                                            static_cast<std::uint32_t>(drawCommands->size() - 1), 0});
+        }
+        drawBatches.back().commandCount++;
+
+        begin = end;
+    }
+
+    view.batchCount = static_cast<std::uint32_t>(drawBatches.size()) - view.firstBatch;
+}
+
+// The surfaces of the manifolds a view looks through, at LOD 0 so every pass covers the same pixels
+void RenderSystem::recordPortalCommands(RenderView& view) {
+
+    for (std::uint32_t childIndex : view.children) {
+        RenderView& child = views[childIndex];
+        const Mesh& mesh = *entityMeshes[child.portal];
+
+        child.firstPortalCommand = static_cast<std::uint32_t>(portalCommands->size());
+        child.portalCommandCount = static_cast<std::uint32_t>(mesh.getPrimitiveCount());
+        child.portalVertexArray = mesh.getDepthVAO();
+        child.portalIndexType = mesh.getIndexType();
+
+        for (std::size_t s = 0; s < mesh.getPrimitiveCount(); s++) {
+            const SubMesh& subMesh = mesh.subMeshes[s];
+            portalCommands->push(DrawElementsIndirectCommand{subMesh.indexCount, 1, subMesh.indexOffset,
+                                                            subMesh.baseVertex, child.portalInstance});
+        }
+    }
+}
+
+// Decides which cascades and cube faces need drawing this frame and collects their casters from
+// the space's BVH. Tiles whose casters neither changed nor moved keep last frame's depth
+void RenderSystem::buildShadows(const LightSystem& lights, const RenderView& camera) {
+
+    PROFILE_SCOPE("RenderSystem::buildShadows");
+
+    shadowDraws.clear();
+    shadowCasters.clear();
+    cascadeEnds = glm::vec4(0.0f);
+    lightShadowSlots.assign(lights.getLights().size(), -1.0f);
+    stats.shadowPasses = 0;
+    stats.shadowCasters = 0;
+    stats.shadowTilesCached = 0;
+    if (!shadowsEnabled) return;
+
+    RenderSpace* space = spaces[camera.space].get();
+
+    // --- 1. Sun cascades around the camera's frustum ---
+    const DirectionalLight* sun = lights.getDirectionalLight();
+    if (sun && sun->castShadows && (sun->spaces & (SpaceMask(1) << camera.space))) {
+
+        float splits[ShadowMaps::CASCADE_COUNT + 1];
+        float farPlane = std::min(shadowDistance, lightClusters.getFarPlane());
+        ShadowLayout::cascadeSplits(lightClusters.getNearPlane(), farPlane, ShadowMaps::CASCADE_COUNT, CASCADE_SPLIT_LAMBDA, splits);
+        glm::mat4 inverseView = glm::inverse(camera.view);
+
+        for (std::uint32_t c = 0; c < ShadowMaps::CASCADE_COUNT; c++) {
+            ShadowCascade& cascade = cascades[c];
+            BoundingSphere slice = ShadowLayout::sliceBounds(camera.projection, inverseView, splits[c], splits[c + 1]);
+            if (ShadowLayout::fitCascade(cascade, slice, sun->direction, ShadowMaps::CASCADE_RESOLUTION,
+                                         CASCADE_MARGIN, CASCADE_CASTER_DISTANCE)) {
+                cascadeTiles[c].staticValid = false;
+            }
+            cascadeEnds[c] = splits[c + 1];
+            shadowMatrices[ShadowMaps::TILE_COUNT + c] = ShadowLayout::textureTransform() * cascade.projection * cascade.view;
+
+            shadowCandidates.clear();
+            if (space) space->bvh.query(Frustum::fromMatrix(cascade.projection * cascade.view), shadowCandidates);
+            updateShadowTile(cascadeTiles[c], ShadowTarget{ShadowTarget::Type::CASCADE, c},
+                             cascade.view, cascade.projection, shadowCandidates);
+        }
+    }
+
+    // --- 2. Cube faces of the nearest shadowed point lights, one BVH query per light ---
+    assignPointShadows(lights, camera);
+    const std::vector<PointLight>& allLights = lights.getLights();
+
+    for (std::uint32_t slot = 0; slot < pointShadowSlots.size(); slot++) {
+        const PointShadowSlot& shadowSlot = pointShadowSlots[slot];
+        if (shadowSlot.light == NULL_ENTITY) continue;
+        const PointLight& light = allLights[shadowSlot.lightIndex];
+
+        shadowCandidates.clear();
+        if (space) {
+            AABB reach{light.position - glm::vec3(light.range), light.position + glm::vec3(light.range)};
+            space->bvh.query(reach, shadowCandidates);
+        }
+
+        glm::mat4 projection = ShadowLayout::cubeFaceProjection(light.range);
+        for (std::uint32_t face = 0; face < 6; face++) {
+            std::uint32_t tile = slot * 6 + face;
+            glm::mat4 view = ShadowLayout::cubeFaceView(light.position, face);
+            shadowMatrices[tile] = ShadowLayout::tileTransform(tile, ShadowMaps::TILES_PER_ROW) * projection * view;
+
+            Frustum frustum = Frustum::fromMatrix(projection * view);
+            faceCandidates.clear();
+            for (std::uint32_t entity : shadowCandidates) {
+                if (frustum.intersects(space->bvh.getFatAABB(space->proxyIDs[entity]))) faceCandidates.push_back(entity);
+            }
+            updateShadowTile(atlasTiles[tile], ShadowTarget{ShadowTarget::Type::ATLAS_TILE, tile}, view, projection, faceCandidates);
+        }
+    }
+}
+
+// Lights keep their slot, and the tiles in it, for as long as they stay among the nearest
+// MAX_POINT_SHADOWS shadowed lights. Tiles are only invalidated when a light moves or changes hands
+void RenderSystem::assignPointShadows(const LightSystem& lights, const RenderView& camera) {
+
+    const std::vector<PointLight>& allLights = lights.getLights();
+    const std::vector<SpaceMask>& lightSpaces = lights.getLightSpaces();
+    const std::vector<Entity>& lightEntities = lights.getLightEntities();
+    SpaceMask spaceBit = SpaceMask(1) << camera.space;
+
+    // --- 1. The lights that get shadows, nearest reach first ---
+    shadowLights.clear();
+    for (std::size_t i = 0; i < allLights.size(); i++) {
+        if (lights.castsShadows(i) && (lightSpaces[i] & spaceBit)) shadowLights.push_back(i);
+    }
+    auto reachDistance = [&](std::size_t i) {
+        return glm::length(allLights[i].position - camera.cameraPosition) - allLights[i].range;
+    };
+    std::sort(shadowLights.begin(), shadowLights.end(), [&](std::size_t a, std::size_t b) { return reachDistance(a) < reachDistance(b); });
+    if (shadowLights.size() > pointShadowSlots.size()) shadowLights.resize(pointShadowSlots.size());
+
+    auto invalidate = [&](std::uint32_t slot) {
+        for (std::uint32_t face = 0; face < 6; face++) atlasTiles[slot * 6 + face].staticValid = false;
+    };
+
+    // --- 2. Free the slots of lights that dropped out ---
+    for (std::uint32_t slot = 0; slot < pointShadowSlots.size(); slot++) {
+        Entity light = pointShadowSlots[slot].light;
+        bool kept = std::any_of(shadowLights.begin(), shadowLights.end(), [&](std::size_t i) { return lightEntities[i] == light; });
+        if (!kept) pointShadowSlots[slot].light = NULL_ENTITY;
+    }
+
+    // --- 3. New lights take free slots, lights that moved redraw theirs ---
+    for (std::size_t i : shadowLights) {
+        std::uint32_t slot = 0;
+        while (slot < pointShadowSlots.size() && pointShadowSlots[slot].light != lightEntities[i]) slot++;
+        if (slot == pointShadowSlots.size()) {
+            slot = 0;
+            while (pointShadowSlots[slot].light != NULL_ENTITY) slot++;
+            pointShadowSlots[slot].light = lightEntities[i];
+            invalidate(slot);
+        }
+
+        PointShadowSlot& shadowSlot = pointShadowSlots[slot];
+        if (shadowSlot.position != allLights[i].position || shadowSlot.range != allLights[i].range) invalidate(slot);
+        shadowSlot.position = allLights[i].position;
+        shadowSlot.range = allLights[i].range;
+        shadowSlot.lightIndex = i;
+        lightShadowSlots[i] = static_cast<float>(slot);
+    }
+}
+
+// Splits a tile's casters into static and moving ones and queues the passes the tile needs:
+// the static twin when its casters changed, the sampled map when anything in it did
+void RenderSystem::updateShadowTile(ShadowTile& tile, const ShadowTarget& target, const glm::mat4& view,
+                                    const glm::mat4& projection, const std::vector<std::uint32_t>& candidates) {
+
+    staticScratch.clear();
+    dynamicScratch.clear();
+    for (std::uint32_t entity : candidates) {
+        (entityDynamic[entity] ? dynamicScratch : staticScratch).push_back(entity);
+    }
+    //BVH order changes as the tree is refit, membership is what matters
+    std::sort(staticScratch.begin(), staticScratch.end());
+    std::sort(dynamicScratch.begin(), dynamicScratch.end());
+
+    auto moved = [&](const std::vector<Entity>& casters) {
+        return std::any_of(casters.begin(), casters.end(), [&](Entity entity) { return entityMovedFrame[entity] == frameIndex; });
+    };
+    bool staticDirty = !tile.staticValid || staticScratch != tile.staticCasters || moved(staticScratch);
+    bool dynamicDirty = staticDirty || dynamicScratch != tile.dynamicCasters || moved(dynamicScratch);
+
+    auto push = [&](bool staticCasters, const std::vector<Entity>& casters) {
+        ShadowDraw draw;
+        draw.target = target;
+        draw.staticCasters = staticCasters;
+        draw.view = view;
+        draw.projection = projection;
+        draw.firstCaster = static_cast<std::uint32_t>(shadowCasters.size());
+        draw.casterCount = static_cast<std::uint32_t>(casters.size());
+        draw.firstBatch = 0;
+        draw.batchCount = 0;
+
+        //grouped by mesh and LOD so each group is one instanced command per submesh
+        shadowCasters.insert(shadowCasters.end(), casters.begin(), casters.end());
+        std::sort(shadowCasters.begin() + draw.firstCaster, shadowCasters.end(), [&](Entity a, Entity b) {
+            const Mesh* meshA = entityMeshes[a].get();
+            const Mesh* meshB = entityMeshes[b].get();
+            if (meshA != meshB) return meshA < meshB;
+            if (entityLODs[a] != entityLODs[b]) return entityLODs[a] < entityLODs[b];
+            return a < b;
+        });
+
+        shadowDraws.push_back(draw);
+        stats.shadowPasses++;
+        stats.shadowCasters += casters.size();
+    };
+
+    if (staticDirty) {
+        tile.staticCasters = staticScratch;
+        tile.staticValid = true;
+        push(true, staticScratch);
+    }
+    if (dynamicDirty) {
+        tile.dynamicCasters = dynamicScratch;
+        push(false, dynamicScratch);
+    } else {
+        stats.shadowTilesCached++;
+    }
+}
+
+// Depth commands over the casters of each shadow pass, at the LOD the camera picked for them
+void RenderSystem::recordShadowCommands() {
+
+    PROFILE_SCOPE("RenderSystem::recordShadowCommands");
+
+    for (ShadowDraw& draw : shadowDraws) {
+        draw.firstBatch = static_cast<std::uint32_t>(shadowBatches.size());
+
+        std::uint32_t end = draw.firstCaster + draw.casterCount;
+        std::uint32_t begin = draw.firstCaster;
+        while (begin < end) {
+            Entity first = shadowCasters[begin];
+            const Mesh& mesh = *entityMeshes[first];
+            std::uint8_t lod = entityLODs[first];
+
+            std::uint32_t runEnd = begin + 1;
+            while (runEnd < end && entityMeshes[shadowCasters[runEnd]].get() == &mesh && entityLODs[shadowCasters[runEnd]] == lod) {
+                runEnd++;
+            }
+
+            std::size_t firstSubMesh = 0;
+            std::size_t lastSubMesh = mesh.subMeshes.size();
+            if (mesh.lods.size() > 1) {
+                firstSubMesh = mesh.lods[lod].firstSubMesh;
+                lastSubMesh = firstSubMesh + mesh.getPrimitiveCount();
+            }
+
+            for (std::size_t s = firstSubMesh; s < lastSubMesh; s++) {
+                const SubMesh& subMesh = mesh.subMeshes[s];
+                shadowCommands->push(DrawElementsIndirectCommand{subMesh.indexCount,
+                                                                runEnd - begin,
+                                                                subMesh.indexOffset,
+                                                                subMesh.baseVertex,
+                                                                firstShadowInstance + begin});
+
+                if (shadowBatches.size() == draw.firstBatch ||
+                    shadowBatches.back().vertexArray != mesh.getDepthVAO() ||
+                    shadowBatches.back().indexType != mesh.getIndexType()) {
+                    shadowBatches.push_back(DrawBatch{0, mesh.getDepthVAO(), mesh.getIndexType(),
+                                                      static_cast<std::uint32_t>(shadowCommands->size() - 1), 0});
+                }
+                shadowBatches.back().commandCount++;
+            }
+
+            begin = runEnd;
+        }
+
+        draw.batchCount = static_cast<std::uint32_t>(shadowBatches.size()) - draw.firstBatch;
+    }
+}
+
+// Static twins first where needed, then the sampled maps from a copy of them with the moving
+// casters on top. Slope scaled depth bias keeps lit surfaces from shadowing themselves
+void RenderSystem::shadowPass() {
+
+    PROFILE_SCOPE("RenderSystem::shadowPass");
+
+    shadowMaps->uploadMatrices(shadowMatrices);
+    if (shadowDraws.empty()) return;
+
+    GPU_PROFILE_SCOPE(gpuProfiler.get(), "GPU::shadows");
+
+    stateCache.useProgram(depthShader->m_ID);
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+    glDepthMask(GL_TRUE);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(2.0f, 4.0f);
+
+    for (const ShadowDraw& draw : shadowDraws) {
+        if (draw.staticCasters) {
+            shadowMaps->beginStatic(draw.target);
+        } else {
+            shadowMaps->beginDynamic(draw.target);
+        }
+
+        depthShader->set(depthUniforms.view, draw.view);
+        depthShader->set(depthUniforms.projection, draw.projection);
+        for (std::uint32_t b = draw.firstBatch; b < draw.firstBatch + draw.batchCount; b++) {
+            const DrawBatch& batch = shadowBatches[b];
+            stateCache.bindVertexArray(batch.vertexArray);
+            shadowCommands->draw(batch.firstCommand, batch.commandCount, batch.indexType, *instanceBuffer, stateCache);
+        }
+    }
+
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    shadowMaps->end();
+}
+
+void RenderSystem::drawView(std::size_t index, const LightSystem& lights) {
+
+    PROFILE_SCOPE("RenderSystem::drawView");
+
+    const RenderView& view = views[index];
+    bool cameraView = index == 0;
+
+    // --- 1. Bin the lights of the view's space into its clusters, pbr.frag only loops over its own cluster's list ---
+    {
+        PROFILE_SCOPE("RenderSystem::assignLights");
+
+        const std::vector<PointLight>& allLights = lights.getLights();
+        const std::vector<SpaceMask>& lightSpaces = lights.getLightSpaces();
+        SpaceMask spaceBit = SpaceMask(1) << view.space;
+
+        viewLights.clear();
+        for (std::size_t i = 0; i < allLights.size(); i++) {
+            if (!(lightSpaces[i] & spaceBit)) continue;
+            viewLights.push_back(allLights[i]);
+            viewLights.back().shadowSlot = cameraView ? lightShadowSlots[i] : -1.0f;
+        }
+
+        lightClusters.assign(viewLights.data(), viewLights.size(), view.view);
+        lightBuffer->upload(viewLights, lightClusters);
+        lightBuffer->bind();
+        shadowMaps->bind();
+
+        //the light buffer and shadow map binds bypass the cache
+        stateCache.invalidate();
+    }
+
+    if (cameraView) {
+        const LightClusterStats& lightStats = lightClusters.getStats();
+        stats.lights = lightStats.lights;
+        stats.lightIndices = lightStats.indices;
+        stats.lightOverflow = lightStats.overflow;
+    }
+
+    //only the pixels this view owns
+    glStencilFunc(GL_EQUAL, static_cast<GLint>(view.level), 0xFF);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+
+    // --- 2. Depth first, with colour writes masked ---
+    bool prePass = view.depthBatchCount > 0;
+    if (prePass) {
+        GPU_PROFILE_SCOPE(gpuProfiler.get(), "GPU::depthPrePass");
+
+        stateCache.useProgram(depthShader->m_ID);
+        depthShader->set(depthUniforms.view, view.view);
+        depthShader->set(depthUniforms.projection, view.projection);
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+
+        if (cameraView) depthSamples->begin();
+        for (std::uint32_t b = view.firstDepthBatch; b < view.firstDepthBatch + view.depthBatchCount; b++) {
+            const DrawBatch& batch = depthBatches[b];
+            stateCache.bindVertexArray(batch.vertexArray);
+            depthCommands->draw(batch.firstCommand, batch.commandCount, batch.indexType, *instanceBuffer, stateCache);
+        }
+        if (cameraView) depthSamples->end();
+
+        //with depth already laid down, only the front-most fragment of each pixel passes GL_EQUAL
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        glDepthFunc(GL_EQUAL);
+        glDepthMask(GL_FALSE);
+    }
+
+    // --- 3. One multi-draw per batch ---
+    stateCache.useProgram(pbrShader->m_ID);
 
     // Set up camera and lighting uniforms (these are the same for all objects)
-    glm::mat4 view = glm::lookAt(cameraTransform.position, cameraTransform.position + cameraTransform.front, glm::vec3(0.0f, 1.0f, 0.0f));
-    glm::mat4 projection = camera.projectionMatrix;
-    pbrShader->setMat4("view", view);
-    pbrShader->setMat4("projection", projection);
-    pbrShader->setVec3("viewPos", cameraTransform.position);
-    pbrShader->setVec3("lightPos", lightPos);
-    pbrShader->setVec3("lightColor", lightColor);
+    pbrShader->set(pbrUniforms.view, view.view);
+    pbrShader->set(pbrUniforms.projection, view.projection);
+    pbrShader->set(pbrUniforms.viewPos, view.cameraPosition);
+    pbrShader->set(pbrUniforms.clusterParams, glm::vec4(LightClusterGrid::TILES_X / viewportWidth,
+                                                        LightClusterGrid::TILES_Y / viewportHeight,
+                                                        lightClusters.getDepthScale(),
+                                                        lightClusters.getDepthBias()));
 
-    // Loop through all renderable entities and draw them
-    for (auto const& entity : entitySet) {
-        auto const& transform = coordinator->getComponent<TransformComponent>(entity);
-        auto const& meshInfo = coordinator->getComponent<MeshComponent>(entity);
+    const DirectionalLight* sun = lights.getDirectionalLight();
+    bool sunInSpace = sun && (sun->spaces & (SpaceMask(1) << view.space));
+    pbrShader->set(pbrUniforms.sunDirection, sun ? sun->direction : glm::vec3(0.0f, -1.0f, 0.0f));
+    pbrShader->set(pbrUniforms.sunColor, sunInSpace ? sun->color : glm::vec3(0.0f));
+    pbrShader->set(pbrUniforms.cascadeEnds, cascadeEnds);
+    pbrShader->set(pbrUniforms.shadowsEnabled, cameraView && shadowsEnabled);
+
+    const MaterialBuffer& materialBuffer = assetManager->getMaterialBuffer();
+
+    if (cameraView) shadedSamples->begin();
+    {
+        //a zone per material batch while the frame's queries last, otherwise one for all of them
+        bool batchZones = gpuProfiler && gpuProfiler->getFreeZones() >= view.batchCount + GPU_ZONES_AFTER_BATCHES;
+        GpuProfileScope batchesZone(batchZones ? nullptr : gpuProfiler.get(), "GPU::opaqueBatches");
+
+        for (std::uint32_t b = view.firstBatch; b < view.firstBatch + view.batchCount; b++) {
+            const DrawBatch& batch = drawBatches[b];
+            const Material& material = assetManager->getMaterial(batch.materialID);
+            GpuProfileScope batchZone(batchZones ? gpuProfiler.get() : nullptr,
+                                      batchZones ? getMaterialZoneName(batch.materialID) : nullptr);
+
+            stateCache.bindVertexArray(batch.vertexArray);
+            if (material.albedoMap) {
+                stateCache.bindTexture2D(0, material.albedoMap->ID);
+            }
+            materialBuffer.bind(batch.materialID, stateCache);
 
-        glm::mat4 model = glm::translate(glm::mat4(1.0f), transform.position) *
-                          glm::mat4_cast(transform.rotation) *
-                          glm::scale(glm::mat4(1.0f), transform.scale);
-        pbrShader->setMat4("model", model);
-        
-        auto mesh = assetManager->getMesh(meshInfo.meshName);
-        mesh->draw(*pbrShader, *assetManager);
+            drawCommands->draw(batch.firstCommand, batch.commandCount, batch.indexType, *instanceBuffer, stateCache);
+        }
+    }
+    if (cameraView) shadedSamples->end();
+
+    //portals and the next frame's clear need depth writes back on
+    if (prePass) {
+        glDepthFunc(GL_LESS);
+        glDepthMask(GL_TRUE);
     }
-    
-    // --- 2. POST-PROCESSING PASS: Render the framebuffer texture to the screen ---
-    framebuffer->unbind(); // Bind back to the default framebuffer
-    glDisable(GL_DEPTH_TEST); // No need for depth testing on a 2D quad
 
-    // Clear the screen
-    glClearColor(1.0f, 1.0f, 1.0f, 1.0f); // Set clear color to white for debugging if needed
-    glClear(GL_COLOR_BUFFER_BIT);
+    // --- 4. What each visible manifold shows, inside the pixels this view left it ---
+    for (std::uint32_t child : view.children) {
+        drawPortal(view, child, lights);
+    }
 
-    postProcessShader->use();
-    postProcessShader->setFloat("exposure", exposure);
+    stateCache.bindVertexArray(0);
+}
 
-    // Bind the texture from our framebuffer
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, framebuffer->textureColorBuffer);
+// Steps the manifold's visible pixels up to the child's stencil level and pushes their depth to the
+// far plane, draws the target space there, then seals the surface with its own depth and hands the
+// pixels back to the parent, so overlapping manifolds and later siblings still depth test correctly
+const char* RenderSystem::getMaterialZoneName(MaterialID materialID) {
+    if (materialID >= materialZoneNames.size()) materialZoneNames.resize(materialID + 1, nullptr);
+    const char*& name = materialZoneNames[materialID];
+    //GPU zones are read back frames later, so the name has to outlive this frame
+    if (!name) name = Profiler::get().intern("GPU::" + assetManager->getMaterial(materialID).name);
+    return name;
+}
 
-    // Draw the quad
-    glBindVertexArray(quadVAO);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+void RenderSystem::drawPortal(const RenderView& parent, std::size_t childIndex, const LightSystem& lights) {
+
+    GPU_PROFILE_SCOPE(gpuProfiler.get(), "GPU::portal");
+
+    const RenderView& child = views[childIndex];
+    GLint parentLevel = static_cast<GLint>(parent.level);
+    GLint childLevel = static_cast<GLint>(child.level);
+
+    stateCache.useProgram(depthShader->m_ID);
+    depthShader->set(depthUniforms.view, parent.view);
+    depthShader->set(depthUniforms.projection, parent.projection);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+
+    // --- 1. Mark the surface where it passes the parent's depth ---
+    glDepthMask(GL_FALSE);
+    glStencilFunc(GL_EQUAL, parentLevel, 0xFF);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_INCR);
+    drawPortalSurface(child);
+
+    // --- 2. Clear the marked depth, a depth range of [1, 1] writes the far plane ---
+    glStencilFunc(GL_EQUAL, childLevel, 0xFF);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+    glDepthMask(GL_TRUE);
+    glDepthFunc(GL_ALWAYS);
+    glDepthRange(1.0, 1.0);
+    drawPortalSurface(child);
+    glDepthRange(0.0, 1.0);
+    glDepthFunc(GL_LESS);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+    // --- 3. The target space, recursing into its own manifolds ---
+    drawView(childIndex, lights);
+
+    // --- 4. Seal the surface and return its pixels to the parent's level ---
+    stateCache.useProgram(depthShader->m_ID);
+    depthShader->set(depthUniforms.view, parent.view);
+    depthShader->set(depthUniforms.projection, parent.projection);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glStencilFunc(GL_EQUAL, childLevel, 0xFF);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_DECR);
+    glDepthFunc(GL_ALWAYS);
+    drawPortalSurface(child);
+
+    glDepthFunc(GL_LESS);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glStencilFunc(GL_EQUAL, parentLevel, 0xFF);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+}
+
+void RenderSystem::drawPortalSurface(const RenderView& child) {
+    stateCache.bindVertexArray(child.portalVertexArray);
+    portalCommands->draw(child.firstPortalCommand, child.portalCommandCount, child.portalIndexType, *instanceBuffer, stateCache);
+}
+
+void RenderSystem::postProcessPass() {
+
+    PROFILE_SCOPE("RenderSystem::postProcessPass");
+    GPU_PROFILE_SCOPE(gpuProfiler.get(), "GPU::postProcessPass");
+
+    // --- 2. POST-PROCESSING PASS: Run the post-process graph from the framebuffer texture to the screen ---
+    framebuffer->unbind(); // Bind back to the default framebuffer
+
+    // The last pass covers the whole window, sampling the scene linearly upscales a reduced resolution
+    postProcess->execute(*renderTargets, framebuffer->textureColorBuffer, framebuffer->getWidth(), framebuffer->getHeight(),
+                         windowWidth, windowHeight, gpuProfiler.get());
 }
\ No newline at end of file
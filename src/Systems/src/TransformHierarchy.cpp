@@ -0,0 +1,207 @@
+#include "TransformHierarchy.hpp"
+#include <algorithm>
+#include <cassert>
+#include <type_traits>
+
+std::uint32_t TransformHierarchy::indexOf(Entity entity) const {
+    return entity < indexByEntity.size() ? indexByEntity[entity] : NO_INDEX;
+}
+
+bool TransformHierarchy::contains(Entity entity) const {
+    return indexOf(entity) != NO_INDEX;
+}
+
+Entity TransformHierarchy::getParent(Entity entity) const {
+    std::uint32_t index = indexOf(entity);
+    return index == NO_INDEX ? NULL_ENTITY : parentEntities[index];
+}
+
+const glm::mat4& TransformHierarchy::getWorld(Entity entity) const {
+    assert(contains(entity) && "Entity is not in the transform hierarchy.");
+    return worlds[indexOf(entity)];
+}
+
+void TransformHierarchy::markIndexDirty(std::uint32_t index) {
+    dirty[index] = 1;
+    firstDirty = std::min(firstDirty, index);
+}
+
+void TransformHierarchy::add(Entity entity, Entity parent) {
+
+    if (entity >= indexByEntity.size()) indexByEntity.resize(entity + 1, NO_INDEX);
+    if (indexByEntity[entity] != NO_INDEX) return;
+
+    if (parent == entity || !contains(parent)) parent = NULL_ENTITY;
+
+    //appending keeps every parent ahead of its children, the sort only restores depth order
+    std::uint32_t index = static_cast<std::uint32_t>(entities.size());
+    entities.push_back(entity);
+    parentEntities.push_back(parent);
+    parents.push_back(parent == NULL_ENTITY ? NO_INDEX : indexOf(parent));
+    locals.push_back(glm::mat4(1.0f));
+    worlds.push_back(glm::mat4(1.0f));
+    dirty.push_back(0);
+
+    indexByEntity[entity] = index;
+    markIndexDirty(index);
+    orderDirty = true;
+}
+
+void TransformHierarchy::remove(Entity entity) {
+
+    reattached.clear();
+
+    std::uint32_t index = indexOf(entity);
+    if (index == NO_INDEX) return;
+
+    // --- 1. Hand the children over to the removed node's parent ---
+    Entity parent = parentEntities[index];
+    for (std::uint32_t i = 0; i < entities.size(); i++) {
+        if (parentEntities[i] != entity) continue;
+        parentEntities[i] = parent;
+        reattached.push_back(entities[i]);
+        markIndexDirty(i);
+    }
+
+    // --- 2. Swap the last node into the hole, the next update re-sorts ---
+    std::uint32_t last = static_cast<std::uint32_t>(entities.size() - 1);
+    if (index != last) {
+        entities[index] = entities[last];
+        parentEntities[index] = parentEntities[last];
+        locals[index] = locals[last];
+        worlds[index] = worlds[last];
+        dirty[index] = dirty[last];
+        indexByEntity[entities[index]] = index;
+        if (dirty[index]) firstDirty = std::min(firstDirty, index);
+    }
+
+    entities.pop_back();
+    parentEntities.pop_back();
+    parents.pop_back();
+    locals.pop_back();
+    worlds.pop_back();
+    dirty.pop_back();
+
+    indexByEntity[entity] = NO_INDEX;
+    orderDirty = true;
+}
+
+bool TransformHierarchy::setParent(Entity entity, Entity parent) {
+
+    std::uint32_t index = indexOf(entity);
+    if (index == NO_INDEX) return false;
+
+    if (parent != NULL_ENTITY) {
+        if (!contains(parent)) return false;
+
+        //walking up from the new parent must not reach the entity itself
+        for (Entity ancestor = parent; ancestor != NULL_ENTITY; ancestor = parentEntities[indexOf(ancestor)]) {
+            if (ancestor == entity) return false;
+        }
+    }
+
+    if (parentEntities[index] == parent) return true;
+
+    parentEntities[index] = parent;
+    markIndexDirty(index);
+    orderDirty = true;
+    return true;
+}
+
+void TransformHierarchy::setLocal(Entity entity, const glm::mat4& local) {
+    std::uint32_t index = indexOf(entity);
+    if (index == NO_INDEX) return;
+    locals[index] = local;
+    markIndexDirty(index);
+}
+
+void TransformHierarchy::markDirty(Entity entity) {
+    std::uint32_t index = indexOf(entity);
+    if (index != NO_INDEX) markIndexDirty(index);
+}
+
+// Stable counting sort on depth, so parents land ahead of children and siblings stay together
+void TransformHierarchy::sortByDepth() {
+
+    const std::uint32_t count = static_cast<std::uint32_t>(entities.size());
+
+    // --- 1. Depth of every node, each ancestor chain is walked once ---
+    depths.assign(count, -1);
+    std::int32_t maxDepth = -1;
+
+    for (std::uint32_t i = 0; i < count; i++) {
+        walk.clear();
+        std::uint32_t node = i;
+        while (node != NO_INDEX && depths[node] < 0) {
+            walk.push_back(node);
+            Entity parent = parentEntities[node];
+            node = parent == NULL_ENTITY ? NO_INDEX : indexOf(parent);
+        }
+
+        std::int32_t depth = node == NO_INDEX ? -1 : depths[node];
+        for (auto it = walk.rbegin(); it != walk.rend(); ++it) {
+            depths[*it] = ++depth;
+        }
+        maxDepth = std::max(maxDepth, depth);
+    }
+
+    // --- 2. Counting sort into the new order ---
+    depthOffsets.assign(static_cast<std::size_t>(maxDepth) + 2, 0);
+    for (std::uint32_t i = 0; i < count; i++) depthOffsets[depths[i] + 1]++;
+    for (std::size_t d = 1; d < depthOffsets.size(); d++) depthOffsets[d] += depthOffsets[d - 1];
+
+    order.resize(count);
+    for (std::uint32_t i = 0; i < count; i++) order[depthOffsets[depths[i]]++] = i;
+
+    // --- 3. Permute the packed arrays and rebuild the index links ---
+    auto permute = [this, count](auto& values) {
+        std::remove_reference_t<decltype(values)> sorted(count);
+        for (std::uint32_t i = 0; i < count; i++) sorted[i] = values[order[i]];
+        values.swap(sorted);
+    };
+    permute(entities);
+    permute(parentEntities);
+    permute(locals);
+    permute(worlds);
+    permute(dirty);
+
+    firstDirty = NO_INDEX;
+    for (std::uint32_t i = 0; i < count; i++) {
+        indexByEntity[entities[i]] = i;
+        if (dirty[i] && firstDirty == NO_INDEX) firstDirty = i;
+    }
+    for (std::uint32_t i = 0; i < count; i++) {
+        parents[i] = parentEntities[i] == NULL_ENTITY ? NO_INDEX : indexByEntity[parentEntities[i]];
+    }
+
+    orderDirty = false;
+}
+
+void TransformHierarchy::update() {
+
+    if (orderDirty) sortByDepth();
+
+    updatedEntities.clear();
+    updatedIndices.clear();
+    if (firstDirty == NO_INDEX) return;
+
+    //dirty flags stay set until the pass ends, so a child sees its parent changed
+    const std::uint32_t count = static_cast<std::uint32_t>(entities.size());
+    for (std::uint32_t i = firstDirty; i < count; i++) {
+        std::uint32_t parent = parents[i];
+
+        if (!dirty[i]) {
+            if (parent == NO_INDEX || !dirty[parent]) continue;
+            dirty[i] = 1;
+        }
+
+        worlds[i] = parent == NO_INDEX ? locals[i] : worlds[parent] * locals[i];
+        updatedIndices.push_back(i);
+    }
+
+    for (std::uint32_t index : updatedIndices) {
+        dirty[index] = 0;
+        updatedEntities.push_back(entities[index]);
+    }
+    firstDirty = NO_INDEX;
+}
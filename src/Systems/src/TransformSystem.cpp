@@ -0,0 +1,120 @@
+#include "TransformSystem.hpp"
+#include "Coordinator.hpp"
+#include "Profiler.hpp"
+#include <cmath>
+
+void TransformSystem::init(Coordinator* coordinator) {
+    this->coordinator = coordinator;
+    dirtyFlags.assign(MAX_ENTITIES, 0);
+
+    //entities that joined before init still need their first world matrix. Links are made
+    //after every node exists because the set has no parent-first order
+    for (auto const& entity : entitySet) {
+        hierarchy.add(entity);
+        markDirty(entity);
+    }
+    for (auto const& entity : entitySet) {
+        hierarchy.setParent(entity, coordinator->getComponent<TransformComponent>(entity).parent);
+    }
+}
+
+void TransformSystem::markDirty(Entity entity) {
+
+    if (entity >= dirtyFlags.size() || dirtyFlags[entity]) return;
+    if (entitySet.find(entity) == entitySet.end()) return;
+
+    dirtyFlags[entity] = 1;
+    dirtyEntities.push_back(entity);
+}
+
+bool TransformSystem::setParent(Entity entity, Entity parent) {
+
+    if (!hierarchy.setParent(entity, parent)) return false;
+    coordinator->getComponent<TransformComponent>(entity).parent = parent;
+    return true;
+}
+
+void TransformSystem::onEntityAdded(Entity entity) {
+    if (!coordinator) return;
+    hierarchy.add(entity, coordinator->getComponent<TransformComponent>(entity).parent);
+    markDirty(entity);
+}
+
+void TransformSystem::onEntityRemoved(Entity entity) {
+
+    //left in dirtyEntities, update skips it because the flag is cleared
+    if (entity < dirtyFlags.size()) dirtyFlags[entity] = 0;
+
+    hierarchy.remove(entity);
+    for (Entity child : hierarchy.getReattached()) {
+        coordinator->getComponent<TransformComponent>(child).parent = hierarchy.getParent(child);
+    }
+}
+
+void TransformSystem::update() {
+
+    PROFILE_SCOPE("TransformSystem::update");
+
+    // --- 1. Rebuild local matrices of the transforms that were written ---
+    for (Entity entity : dirtyEntities) {
+        if (!dirtyFlags[entity]) continue;
+        dirtyFlags[entity] = 0;
+
+        auto const& transform = coordinator->getComponent<TransformComponent>(entity);
+        hierarchy.setLocal(entity, computeLocalMatrix(transform));
+    }
+    dirtyEntities.clear();
+
+    // --- 2. Propagate through the changed subtrees ---
+    hierarchy.update();
+
+    // --- 3. Publish the new world matrices ---
+    for (Entity entity : hierarchy.getUpdatedEntities()) {
+        auto& world = coordinator->getComponent<WorldTransformComponent>(entity);
+        world.model = hierarchy.getWorld(entity);
+        world.normalMatrix = computeNormalMatrix(world.model);
+    }
+}
+
+glm::mat4 TransformSystem::computeLocalMatrix(const TransformComponent& transform) {
+
+    const glm::quat& q = transform.rotation;
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+    glm::vec3 axisX(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy));
+    glm::vec3 axisY(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx));
+    glm::vec3 axisZ(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy));
+
+    const glm::vec3& s = transform.scale;
+    glm::mat4 local;
+    local[0] = glm::vec4(axisX * s.x, 0.0f);
+    local[1] = glm::vec4(axisY * s.y, 0.0f);
+    local[2] = glm::vec4(axisZ * s.z, 0.0f);
+    local[3] = glm::vec4(transform.position, 1.0f);
+    return local;
+}
+
+glm::mat3 TransformSystem::computeNormalMatrix(const glm::mat4& model) {
+
+    glm::vec3 c0(model[0]);
+    glm::vec3 c1(model[1]);
+    glm::vec3 c2(model[2]);
+
+    //the inverse transpose of [c0 c1 c2] has the cross products of the other two columns as columns
+    glm::vec3 n0 = glm::cross(c1, c2);
+    glm::vec3 n1 = glm::cross(c2, c0);
+    glm::vec3 n2 = glm::cross(c0, c1);
+
+    //a degenerate (zero scale) matrix keeps the unscaled cofactors instead of dividing by zero
+    float determinant = glm::dot(c0, n0);
+    float inverseDeterminant = std::fabs(determinant) > 1e-12f ? 1.0f / determinant : 1.0f;
+
+    return glm::mat3(n0 * inverseDeterminant, n1 * inverseDeterminant, n2 * inverseDeterminant);
+}
+
+void TransformSystem::computeWorldTransform(const TransformComponent& transform, WorldTransformComponent& world) {
+    world.model = computeLocalMatrix(transform);
+    world.normalMatrix = computeNormalMatrix(world.model);
+}
@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+#include "AssetPack.hpp"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <glm/gtc/type_ptr.hpp>
+#include <stdexcept>
+
+namespace {
+
+    //two triangles as two submeshes, LOD 1 starting at the second
+    void addQuad(AssetPackWriter& writer) {
+        std::vector<Vertex> vertices = {
+            {{0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f}},
+            {{2.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {1.0f, 0.0f}},
+            {{2.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {1.0f, 1.0f}},
+            {{0.0f, 1.0f, -4.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 1.0f}},
+        };
+        std::vector<std::uint32_t> indices = {0, 1, 2, 0, 2, 3};
+        std::vector<AssetPack::SubMeshRecord> subMeshes = {{0, 3, 0, 0}, {AssetPack::NONE, 3, 3, 0}};
+        std::vector<MeshLOD> lods = {{0, 0.0f}, {1, 0.25f}};
+        writer.addMesh("Quad", vertices, indices, subMeshes, lods);
+    }
+
+    std::string tempPath(const char* name) {
+        return (std::string(::testing::TempDir()) + name);
+    }
+}
+
+TEST(AssetPackTest, RoundTripsAPackedScene) {
+    // ARRANGE
+    AssetPackWriter writer(VertexFormat::PACKED);
+    addQuad(writer);
+    std::uint8_t pixels[2 * 2 * 4] = {255, 0, 0, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 0, 0, 255};
+    writer.addTexture("checker", pixels, 2, 2, 4, true, true);
+    AssetPack::MaterialRecord material;
+    material.albedoTexture = 0;
+    material.metallicFactor = 0.25f;
+    writer.addMaterial("painted", material);
+    AssetPack::NodeRecord root;
+    root.mesh = 0;
+    root.position[1] = 3.0f;
+    std::uint32_t rootIndex = writer.addNode("Root", root);
+    AssetPack::NodeRecord child;
+    child.parent = rootIndex;
+    writer.addNode("Child", child);
+
+    std::string path = tempPath("round_trip.pack");
+
+    // ACT
+    ASSERT_TRUE(writer.write(path));
+    AssetPackReader pack(path);
+
+    // ASSERT
+    const AssetPack::Header& header = pack.getHeader();
+    ASSERT_EQ(header.meshCount, 1);
+    ASSERT_EQ(header.textureCount, 1);
+    ASSERT_EQ(header.materialCount, 1);
+    ASSERT_EQ(header.nodeCount, 2);
+    ASSERT_EQ(pack.getVertexFormat(), VertexFormat::PACKED);
+
+    const AssetPack::MeshRecord& mesh = pack.getMesh(0);
+    ASSERT_EQ(pack.getString(mesh.name), "Quad");
+    ASSERT_EQ(mesh.indexType, static_cast<std::uint32_t>(IndexType::UINT16));
+    ASSERT_EQ(mesh.quantized, 1);
+    //everything the arena uploads is aligned in the mapping
+    ASSERT_EQ(mesh.vertices % 16, 0);
+    ASSERT_EQ(mesh.indices % 16, 0);
+
+    //unorm positions, as the vertex fetch normalizes them, decode through the stored transform
+    const PackedVertex* vertices = static_cast<const PackedVertex*>(pack.getVertices(mesh));
+    glm::mat4 positionTransform = glm::make_mat4(mesh.positionTransform);
+    glm::vec3 stored = glm::vec3(vertices[3].position[0], vertices[3].position[1], vertices[3].position[2]) / 65535.0f;
+    glm::vec4 corner = positionTransform * glm::vec4(stored, 1.0f);
+    ASSERT_NEAR(corner.x, 0.0f, 1e-3f);
+    ASSERT_NEAR(corner.y, 1.0f, 1e-3f);
+    ASSERT_NEAR(corner.z, -4.0f, 1e-3f);
+
+    const std::uint16_t* indices = static_cast<const std::uint16_t*>(pack.getIndices(mesh));
+    ASSERT_EQ(indices[5], 3);
+    ASSERT_EQ(pack.getSubMeshes(mesh)[1].material, AssetPack::NONE);
+    ASSERT_EQ(pack.getSubMeshes(mesh)[1].indexOffset, 3);
+    ASSERT_FLOAT_EQ(pack.getLODs(mesh)[1].error, 0.25f);
+
+    const AssetPack::TextureRecord& texture = pack.getTexture(0);
+    ASSERT_EQ(pack.getString(texture.name), "checker");
+    ASSERT_EQ(texture.format, static_cast<std::uint32_t>(TextureFormat::BC1));
+    ASSERT_EQ(texture.levelCount, 2);
+    const AssetPack::LevelRecord* levels = pack.getLevels(texture);
+    ASSERT_EQ(levels[1].width, 1);
+    ASSERT_EQ(levels[1].size, 8);
+    ASSERT_EQ(levels[0].data % 16, 0);
+    TextureLevel compressed{2, 2, std::vector<std::uint8_t>(pack.getLevelData(levels[0]), pack.getLevelData(levels[0]) + levels[0].size)};
+    TextureLevel decoded = TextureCompression::decode(compressed, TextureFormat::BC1);
+    ASSERT_NEAR(decoded.data[4 + 1], 255, 8);
+    ASSERT_NEAR(decoded.data[1], 0, 8);
+
+    ASSERT_EQ(pack.getString(pack.getMaterial(0).name), "painted");
+    ASSERT_FLOAT_EQ(pack.getMaterial(0).metallicFactor, 0.25f);
+    ASSERT_EQ(pack.getNode(1).parent, 0);
+    ASSERT_EQ(pack.getString(pack.getNode(1).name), "Child");
+    ASSERT_FLOAT_EQ(pack.getNode(0).position[1], 3.0f);
+
+    std::remove(path.c_str());
+}
+
+TEST(AssetPackTest, RejectsOtherVersionsAndTruncatedFiles) {
+    // ARRANGE
+    AssetPackWriter writer(VertexFormat::FULL);
+    addQuad(writer);
+    std::string path = tempPath("rejected.pack");
+    ASSERT_TRUE(writer.write(path));
+
+    std::ifstream in(path, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+
+    // ACT
+    std::vector<char> oldVersion = bytes;
+    reinterpret_cast<AssetPack::Header*>(oldVersion.data())->version = AssetPack::VERSION + 1;
+    std::string oldPath = tempPath("old_version.pack");
+    std::ofstream(oldPath, std::ios::binary).write(oldVersion.data(), static_cast<std::streamsize>(oldVersion.size()));
+
+    std::string truncatedPath = tempPath("truncated.pack");
+    std::ofstream(truncatedPath, std::ios::binary).write(bytes.data(), static_cast<std::streamsize>(bytes.size() / 2));
+
+    // ASSERT
+    ASSERT_NO_THROW(AssetPackReader{path});
+    ASSERT_THROW(AssetPackReader{oldPath}, std::runtime_error);
+    ASSERT_THROW(AssetPackReader{truncatedPath}, std::runtime_error);
+    ASSERT_THROW(AssetPackReader{tempPath("missing.pack")}, std::runtime_error);
+
+    std::remove(path.c_str());
+    std::remove(oldPath.c_str());
+    std::remove(truncatedPath.c_str());
+}
+
+TEST(AssetPackTest, RejectsSubMeshAndLODRangesOutsideTheMesh) {
+    // ARRANGE
+    std::vector<Vertex> vertices(3);
+    std::vector<std::uint32_t> indices = {0, 1, 2};
+    AssetPackWriter pastIndices(VertexFormat::FULL);
+    pastIndices.addMesh("PastIndices", vertices, indices, {{0, 3, 3, 0}}, {});
+    AssetPackWriter pastSubMeshes(VertexFormat::FULL);
+    pastSubMeshes.addMesh("PastSubMeshes", vertices, indices, {{0, 3, 0, 0}}, {{1, 0.0f}});
+
+    std::string indicesPath = tempPath("past_indices.pack");
+    std::string subMeshesPath = tempPath("past_submeshes.pack");
+
+    // ACT
+    ASSERT_TRUE(pastIndices.write(indicesPath));
+    ASSERT_TRUE(pastSubMeshes.write(subMeshesPath));
+
+    // ASSERT
+    ASSERT_THROW(AssetPackReader{indicesPath}, std::runtime_error);
+    ASSERT_THROW(AssetPackReader{subMeshesPath}, std::runtime_error);
+
+    std::remove(indicesPath.c_str());
+    std::remove(subMeshesPath.c_str());
+}
+
+TEST(AssetPackTest, RejectsTexturesWithoutLevels) {
+    // ARRANGE
+    AssetPackWriter writer(VertexFormat::FULL);
+    std::uint8_t pixels[4] = {255, 255, 255, 255};
+    writer.addTexture("white", pixels, 1, 1, 4, false, false);
+    std::string path = tempPath("no_levels.pack");
+    ASSERT_TRUE(writer.write(path));
+
+    std::ifstream in(path, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+
+    // ACT
+    const AssetPack::Header* header = reinterpret_cast<const AssetPack::Header*>(bytes.data());
+    reinterpret_cast<AssetPack::TextureRecord*>(bytes.data() + header->textures)->levelCount = 0;
+    std::string noLevelsPath = tempPath("no_levels_zeroed.pack");
+    std::ofstream(noLevelsPath, std::ios::binary).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+
+    // ASSERT
+    ASSERT_NO_THROW(AssetPackReader{path});
+    ASSERT_THROW(AssetPackReader{noLevelsPath}, std::runtime_error);
+
+    std::remove(path.c_str());
+    std::remove(noLevelsPath.c_str());
+}
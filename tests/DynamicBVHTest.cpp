@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+#include "Bounds.hpp"
+#include "DynamicBVH.hpp"
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace {
+
+    AABB makeBox(const glm::vec3& center, float halfSize) {
+        AABB box;
+        box.min = center - glm::vec3(halfSize);
+        box.max = center + glm::vec3(halfSize);
+        return box;
+    }
+
+    Frustum makeCameraFrustum() {
+        glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+        glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        return Frustum::fromMatrix(projection * view);
+    }
+
+    std::vector<AABB> randomBoxes(std::size_t count, std::mt19937& rng) {
+        std::uniform_real_distribution<float> position(-150.0f, 150.0f);
+        std::uniform_real_distribution<float> size(0.1f, 3.0f);
+
+        std::vector<AABB> boxes;
+        for (std::size_t i = 0; i < count; ++i) {
+            boxes.push_back(makeBox({position(rng), position(rng), position(rng)}, size(rng)));
+        }
+        return boxes;
+    }
+
+    AABB fatten(const AABB& box, float margin) {
+        AABB result = box;
+        result.min -= glm::vec3(margin);
+        result.max += glm::vec3(margin);
+        return result;
+    }
+}
+
+TEST(FrustumCullingTest, ClassifiesBoxesAgainstCameraFrustum) {
+    Frustum frustum = makeCameraFrustum();
+
+    ASSERT_EQ(frustum.test(makeBox({0.0f, 0.0f, -10.0f}, 1.0f)), FrustumTest::INSIDE);
+    ASSERT_EQ(frustum.test(makeBox({0.0f, 0.0f, 10.0f}, 1.0f)), FrustumTest::OUTSIDE);
+    ASSERT_EQ(frustum.test(makeBox({0.0f, 0.0f, -200.0f}, 1.0f)), FrustumTest::OUTSIDE);
+    ASSERT_EQ(frustum.test(makeBox({0.0f, 0.0f, -100.0f}, 1.0f)), FrustumTest::INTERSECTS);
+}
+
+TEST(FrustumCullingTest, BatchMatchesScalarTest) {
+    std::mt19937 rng(42);
+    Frustum frustum = makeCameraFrustum();
+
+    //odd count so both the SIMD path and the scalar tail are exercised
+    std::vector<AABB> boxes = randomBoxes(1003, rng);
+    std::vector<std::uint8_t> visible(boxes.size());
+    frustum.testBatch(boxes.data(), boxes.size(), visible.data());
+
+    for (std::size_t i = 0; i < boxes.size(); ++i) {
+        ASSERT_EQ(visible[i] != 0, frustum.intersects(boxes[i])) << "box " << i;
+    }
+}
+
+TEST(AABBTest, TransformedBoundsContainTransformedCorners) {
+    AABB box = makeBox({1.0f, 2.0f, 3.0f}, 0.5f);
+    glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(4.0f, -2.0f, 1.0f)) *
+                      glm::rotate(glm::mat4(1.0f), glm::radians(37.0f), glm::normalize(glm::vec3(1.0f, 2.0f, 0.5f))) *
+                      glm::scale(glm::mat4(1.0f), glm::vec3(2.0f, 1.0f, 3.0f));
+
+    AABB result = box.transformed(model);
+
+    for (int corner = 0; corner < 8; ++corner) {
+        glm::vec3 local((corner & 1) ? box.max.x : box.min.x,
+                        (corner & 2) ? box.max.y : box.min.y,
+                        (corner & 4) ? box.max.z : box.min.z);
+        glm::vec3 world = glm::vec3(model * glm::vec4(local, 1.0f));
+
+        for (int axis = 0; axis < 3; ++axis) {
+            ASSERT_GE(world[axis], result.min[axis] - 1e-4f);
+            ASSERT_LE(world[axis], result.max[axis] + 1e-4f);
+        }
+    }
+}
+
+TEST(DynamicBVHTest, FrustumQueryMatchesBruteForce) {
+    // ARRANGE
+    std::mt19937 rng(7);
+    const float margin = 0.1f;
+    DynamicBVH bvh(margin);
+    Frustum frustum = makeCameraFrustum();
+
+    std::vector<AABB> boxes = randomBoxes(2000, rng);
+    for (std::size_t i = 0; i < boxes.size(); ++i) {
+        bvh.createProxy(boxes[i], static_cast<std::uint32_t>(i));
+    }
+
+    // ACT
+    std::vector<std::uint32_t> results;
+    bvh.query(frustum, results);
+
+    // ASSERT - the tree tests fat boxes, so compare against fattened brute force
+    std::vector<std::uint32_t> expected;
+    for (std::size_t i = 0; i < boxes.size(); ++i) {
+        if (frustum.intersects(fatten(boxes[i], margin))) expected.push_back(static_cast<std::uint32_t>(i));
+    }
+
+    std::sort(results.begin(), results.end());
+    ASSERT_EQ(results, expected);
+    ASSERT_EQ(bvh.getProxyCount(), boxes.size());
+}
+
+TEST(DynamicBVHTest, MovedAndDestroyedProxiesStayConsistent) {
+    // ARRANGE
+    std::mt19937 rng(99);
+    std::uniform_real_distribution<float> jitter(-0.05f, 0.05f);
+    std::uniform_real_distribution<float> jump(-150.0f, 150.0f);
+    DynamicBVH bvh(0.1f);
+
+    std::vector<AABB> boxes = randomBoxes(1000, rng);
+    std::vector<std::int32_t> proxies;
+    for (std::size_t i = 0; i < boxes.size(); ++i) {
+        proxies.push_back(bvh.createProxy(boxes[i], static_cast<std::uint32_t>(i)));
+    }
+
+    // ACT - small moves stay in the fat box, large ones force reinsertion
+    bool smallMoveReinserted = false;
+    for (std::size_t i = 0; i < boxes.size(); ++i) {
+        if (i % 2 == 0) {
+            glm::vec3 offset(jitter(rng), jitter(rng), jitter(rng));
+            boxes[i].min += offset;
+            boxes[i].max += offset;
+            smallMoveReinserted |= bvh.moveProxy(proxies[i], boxes[i]);
+        } else {
+            glm::vec3 center(jump(rng), jump(rng), jump(rng));
+            boxes[i] = makeBox(center, 1.0f);
+            bvh.moveProxy(proxies[i], boxes[i]);
+        }
+    }
+
+    std::vector<bool> alive(boxes.size(), true);
+    for (std::size_t i = 0; i < boxes.size(); i += 3) {
+        bvh.destroyProxy(proxies[i]);
+        alive[i] = false;
+    }
+
+    // ASSERT
+    ASSERT_FALSE(smallMoveReinserted);
+
+    AABB region = makeBox(glm::vec3(0.0f), 60.0f);
+    std::vector<std::uint32_t> results;
+    bvh.query(region, results);
+    std::sort(results.begin(), results.end());
+
+    std::vector<std::uint32_t> expected;
+    for (std::size_t i = 0; i < boxes.size(); ++i) {
+        if (alive[i] && bvh.getFatAABB(proxies[i]).overlaps(region)) expected.push_back(static_cast<std::uint32_t>(i));
+        if (alive[i]) ASSERT_TRUE(bvh.getFatAABB(proxies[i]).contains(boxes[i]));
+    }
+    ASSERT_EQ(results, expected);
+
+    //AVL balancing keeps the tree logarithmic even after churn
+    ASSERT_LT(bvh.getHeight(), 32);
+}
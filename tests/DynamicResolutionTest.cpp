@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include "DynamicResolution.hpp"
+#include <cmath>
+
+namespace {
+
+    // GPU time of a frame whose cost scales with its pixel count
+    float frameTime(float fullResolutionMilliseconds, float scale) {
+        return fullResolutionMilliseconds * scale * scale;
+    }
+
+    // Runs frames until the scale has not moved for a while, returns how many changes happened
+    int settle(DynamicResolution& resolution, float fullResolutionMilliseconds, int frames) {
+        int changes = 0;
+        for (int i = 0; i < frames; ++i) {
+            if (resolution.update(frameTime(fullResolutionMilliseconds, resolution.getScale()))) changes++;
+        }
+        return changes;
+    }
+}
+
+TEST(DynamicResolutionTest, StaysAtFullResolutionWithinBudget) {
+    // ARRANGE
+    DynamicResolution resolution(16.0f);
+
+    // ACT
+    int changes = settle(resolution, 12.0f, 500);
+
+    // ASSERT
+    ASSERT_EQ(changes, 0);
+    ASSERT_FLOAT_EQ(resolution.getScale(), 1.0f);
+}
+
+TEST(DynamicResolutionTest, DropsToAStepThatFitsTheBudget) {
+    // ARRANGE
+    DynamicResolution resolution(16.0f);
+
+    // ACT
+    settle(resolution, 30.0f, 300);
+
+    // ASSERT
+    float scale = resolution.getScale();
+    ASSERT_LT(scale, 1.0f);
+    ASSERT_LE(frameTime(30.0f, scale), 16.0f);
+    //quantized so the render target pool only sees a few sizes
+    float steps = scale / DynamicResolution::SCALE_STEP;
+    ASSERT_FLOAT_EQ(steps, std::round(steps));
+    //and not lower than needed, one step up would be over budget
+    ASSERT_GT(frameTime(30.0f, scale + DynamicResolution::SCALE_STEP), 16.0f * 0.9f);
+}
+
+TEST(DynamicResolutionTest, RecoversAfterTheSpikeEndsWithoutOscillating) {
+    // ARRANGE
+    DynamicResolution resolution(16.0f);
+    settle(resolution, 40.0f, 200);
+    ASSERT_LT(resolution.getScale(), 1.0f);
+
+    // ACT
+    settle(resolution, 8.0f, 2000);
+    int laterChanges = settle(resolution, 8.0f, 1000);
+
+    // ASSERT
+    ASSERT_FLOAT_EQ(resolution.getScale(), 1.0f);
+    ASSERT_EQ(laterChanges, 0);
+}
+
+TEST(DynamicResolutionTest, NeverLeavesTheScaleRange) {
+    // ARRANGE
+    DynamicResolution resolution(16.0f);
+    resolution.setScaleRange(0.75f, 1.0f);
+
+    // ACT
+    settle(resolution, 200.0f, 500);
+
+    // ASSERT
+    ASSERT_FLOAT_EQ(resolution.getScale(), 0.75f);
+
+    //missing measurements leave everything alone
+    ASSERT_FALSE(resolution.update(0.0f));
+}
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include "FreeListAllocator.hpp"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+TEST(FreeListAllocatorTest, AllocatesUntilFullAndReusesReleasedBlocks) {
+    // ARRANGE
+    FreeListAllocator allocator(100);
+
+    // ACT
+    std::uint32_t a = allocator.allocate(40);
+    std::uint32_t b = allocator.allocate(40);
+    std::uint32_t full = allocator.allocate(30);
+    allocator.release(a);
+    std::uint32_t reused = allocator.allocate(30);
+
+    // ASSERT
+    ASSERT_EQ(a, 0);
+    ASSERT_EQ(b, 40);
+    ASSERT_EQ(full, FreeListAllocator::INVALID_OFFSET);
+    ASSERT_EQ(reused, 0);
+    ASSERT_EQ(allocator.getUsed(), 70);
+    ASSERT_EQ(allocator.allocate(0), FreeListAllocator::INVALID_OFFSET);
+}
+
+TEST(FreeListAllocatorTest, ReleaseCoalescesNeighbours) {
+    // ARRANGE
+    FreeListAllocator allocator(90);
+    std::uint32_t a = allocator.allocate(30);
+    std::uint32_t b = allocator.allocate(30);
+    std::uint32_t c = allocator.allocate(30);
+
+    // ACT
+    allocator.release(a);
+    allocator.release(c);
+    ASSERT_EQ(allocator.getFreeBlockCount(), 2);
+    allocator.release(b);
+
+    // ASSERT
+    ASSERT_EQ(allocator.getFreeBlockCount(), 1);
+    ASSERT_EQ(allocator.getLargestFreeBlock(), 90);
+    ASSERT_EQ(allocator.allocate(90), 0);
+}
+
+TEST(FreeListAllocatorTest, BestFitAndGrowKeepOffsets) {
+    // ARRANGE
+    // free blocks of 20 at 0 and 10 at 50, 30 used in between and 20 used at the end
+    FreeListAllocator allocator(80);
+    std::uint32_t large = allocator.allocate(20);
+    allocator.allocate(30);
+    std::uint32_t small = allocator.allocate(10);
+    std::uint32_t last = allocator.allocate(20);
+    allocator.release(large);
+    allocator.release(small);
+
+    // ACT
+    std::uint32_t fit = allocator.allocate(8);
+    allocator.release(last);
+    allocator.grow(200);
+
+    // ASSERT
+    ASSERT_EQ(fit, 50);
+    ASSERT_EQ(allocator.getCapacity(), 200);
+    //the remainder at 58, the released tail and the new space form one block
+    ASSERT_EQ(allocator.getLargestFreeBlock(), 142);
+    ASSERT_EQ(allocator.allocate(142), 58);
+}
+
+TEST(FreeListAllocatorTest, RandomWorkloadNeverOverlaps) {
+    // ARRANGE
+    std::mt19937 rng(99);
+    FreeListAllocator allocator(4096);
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> live;
+
+    // ACT
+    for (int step = 0; step < 5000; ++step) {
+        if (!live.empty() && rng() % 3 == 0) {
+            std::size_t victim = rng() % live.size();
+            allocator.release(live[victim].first);
+            live[victim] = live.back();
+            live.pop_back();
+            continue;
+        }
+        std::uint32_t size = 1 + rng() % 64;
+        std::uint32_t offset = allocator.allocate(size);
+        if (offset != FreeListAllocator::INVALID_OFFSET) live.emplace_back(offset, size);
+    }
+
+    // ASSERT
+    std::sort(live.begin(), live.end());
+    std::uint32_t used = 0;
+    for (std::size_t i = 0; i < live.size(); ++i) {
+        used += live[i].second;
+        ASSERT_LE(live[i].first + live[i].second, allocator.getCapacity());
+        if (i > 0) ASSERT_LE(live[i - 1].first + live[i - 1].second, live[i].first);
+    }
+    ASSERT_EQ(allocator.getUsed(), used);
+
+    for (auto const& allocation : live) allocator.release(allocation.first);
+    ASSERT_EQ(allocator.getFreeBlockCount(), 1);
+    ASSERT_EQ(allocator.getLargestFreeBlock(), 4096);
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include "JobSystem.hpp"
+#include <atomic>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+TEST(JobSystemTest, FuturesReturnEachJobsResult) {
+    // ARRANGE
+    JobSystem jobs(4);
+    std::vector<std::future<int>> results;
+
+    // ACT
+    for (int i = 0; i < 100; i++) {
+        results.push_back(jobs.submit([i]() { return i * i; }));
+    }
+
+    // ASSERT
+    ASSERT_EQ(jobs.getThreadCount(), 4);
+    for (int i = 0; i < 100; i++) {
+        ASSERT_EQ(results[i].get(), i * i);
+    }
+}
+
+TEST(JobSystemTest, JobsRunOffTheSubmittingThread) {
+    // ARRANGE
+    JobSystem jobs(2);
+    std::atomic<int> ran{0};
+    std::vector<std::future<std::thread::id>> threads;
+
+    // ACT
+    for (int i = 0; i < 16; i++) {
+        threads.push_back(jobs.submit([&ran]() {
+            ran++;
+            return std::this_thread::get_id();
+        }));
+    }
+
+    // ASSERT
+    std::set<std::thread::id> seen;
+    for (auto& thread : threads) seen.insert(thread.get());
+    ASSERT_EQ(ran.load(), 16);
+    ASSERT_EQ(seen.count(std::this_thread::get_id()), 0);
+    ASSERT_LE(seen.size(), 2);
+}
+
+TEST(JobSystemTest, ExceptionsReachTheFuture) {
+    // ARRANGE
+    JobSystem jobs(1);
+
+    // ACT
+    std::future<int> failed = jobs.submit([]() -> int { throw std::runtime_error("bad asset"); });
+    std::future<int> next = jobs.submit([]() { return 7; });
+
+    // ASSERT
+    ASSERT_THROW(failed.get(), std::runtime_error);
+    //the worker survives a throwing job
+    ASSERT_EQ(next.get(), 7);
+}
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include "LightClusters.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace {
+
+    glm::mat4 makeProjection() {
+        return glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+    }
+
+    glm::mat4 makeView() {
+        return glm::lookAt(glm::vec3(0.0f, 2.0f, 5.0f), glm::vec3(0.0f, 2.0f, -5.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    }
+
+    PointLight makeLight(const glm::vec3& position, float range) {
+        PointLight light;
+        light.position = position;
+        light.range = range;
+        light.color = glm::vec3(1.0f);
+        return light;
+    }
+
+    // The cluster pbr.frag would read for a world space point, or -1 when the point is off screen
+    std::int32_t clusterOf(const LightClusterGrid& grid, const glm::vec3& point, const glm::mat4& view, const glm::mat4& projection) {
+        glm::vec4 viewPoint = view * glm::vec4(point, 1.0f);
+        glm::vec4 clip = projection * viewPoint;
+        glm::vec2 ndc = glm::vec2(clip) / clip.w;
+        if (clip.w <= 0.0f || std::fabs(ndc.x) >= 1.0f || std::fabs(ndc.y) >= 1.0f) return -1;
+
+        std::uint32_t x = std::min(static_cast<std::uint32_t>((ndc.x * 0.5f + 0.5f) * LightClusterGrid::TILES_X), LightClusterGrid::TILES_X - 1);
+        std::uint32_t y = std::min(static_cast<std::uint32_t>((ndc.y * 0.5f + 0.5f) * LightClusterGrid::TILES_Y), LightClusterGrid::TILES_Y - 1);
+        return static_cast<std::int32_t>(LightClusterGrid::clusterIndex(x, y, grid.sliceForDepth(-viewPoint.z)));
+    }
+
+    bool clusterLists(const LightClusterGrid& grid, std::int32_t cluster, std::uint16_t light) {
+        const ClusterRange& range = grid.getClusters()[cluster];
+        const auto& indices = grid.getLightIndices();
+        return std::find(indices.begin() + range.offset, indices.begin() + range.offset + range.count, light) !=
+               indices.begin() + range.offset + range.count;
+    }
+}
+
+TEST(LightClustersTest, DepthSlicesSpanNearToFar) {
+    // ARRANGE
+    LightClusterGrid grid;
+
+    // ACT
+    grid.setProjection(makeProjection());
+
+    // ASSERT
+    ASSERT_NEAR(grid.getNearPlane(), 0.1f, 1e-4f);
+    ASSERT_NEAR(grid.getFarPlane(), 100.0f, 1e-2f);
+    ASSERT_EQ(grid.sliceForDepth(0.1f), 0);
+    ASSERT_EQ(grid.sliceForDepth(0.01f), 0);
+    ASSERT_EQ(grid.sliceForDepth(99.0f), static_cast<std::int32_t>(LightClusterGrid::SLICES) - 1);
+    ASSERT_EQ(grid.sliceForDepth(1000.0f), static_cast<std::int32_t>(LightClusterGrid::SLICES) - 1);
+
+    std::int32_t previous = 0;
+    for (float depth = 0.1f; depth < 100.0f; depth *= 1.1f) {
+        std::int32_t slice = grid.sliceForDepth(depth);
+        ASSERT_GE(slice, previous);
+        previous = slice;
+    }
+}
+
+TEST(LightClustersTest, EveryLitPointFindsItsLightInItsCluster) {
+    // ARRANGE
+    glm::mat4 projection = makeProjection();
+    glm::mat4 view = makeView();
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> position(-20.0f, 20.0f);
+    std::uniform_real_distribution<float> range(0.5f, 6.0f);
+
+    std::vector<PointLight> lights;
+    for (int i = 0; i < 300; ++i) {
+        lights.push_back(makeLight({position(rng), position(rng) * 0.25f, position(rng) - 15.0f}, range(rng)));
+    }
+
+    LightClusterGrid grid;
+    grid.setProjection(projection);
+
+    // ACT
+    grid.assign(lights.data(), lights.size(), view);
+
+    // ASSERT
+    ASSERT_EQ(grid.getStats().overflow, 0u);
+    ASSERT_GT(grid.getStats().assignedLights, 0u);
+    ASSERT_LT(grid.getStats().assignedLights, lights.size());
+
+    //sample points inside each light's range, a light can never be missing from a lit point's cluster
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::size_t checked = 0;
+    for (std::uint16_t i = 0; i < lights.size(); ++i) {
+        for (int sample = 0; sample < 20; ++sample) {
+            glm::vec3 offset(unit(rng), unit(rng), unit(rng));
+            if (glm::length(offset) > 1.0f) continue;
+            glm::vec3 point = lights[i].position + offset * lights[i].range * 0.999f;
+
+            std::int32_t cluster = clusterOf(grid, point, view, projection);
+            if (cluster < 0) continue;
+            ASSERT_TRUE(clusterLists(grid, cluster, i)) << "light " << i << " missing from cluster " << cluster;
+            checked++;
+        }
+    }
+    ASSERT_GT(checked, 500u);
+}
+
+TEST(LightClustersTest, LightsOutsideTheFrustumAreSkipped) {
+    // ARRANGE
+    LightClusterGrid grid;
+    grid.setProjection(makeProjection());
+    std::vector<PointLight> lights = {
+        makeLight({0.0f, 2.0f, 20.0f}, 5.0f),     //behind the camera
+        makeLight({0.0f, 2.0f, -200.0f}, 5.0f),   //past the far plane
+        makeLight({100.0f, 2.0f, -5.0f}, 5.0f),   //far off to the side
+        makeLight({0.0f, 2.0f, -5.0f}, 1.0f)      //straight ahead
+    };
+
+    // ACT
+    grid.assign(lights.data(), lights.size(), makeView());
+
+    // ASSERT
+    ASSERT_EQ(grid.getStats().lights, 4u);
+    ASSERT_EQ(grid.getStats().assignedLights, 1u);
+    for (std::uint16_t index : grid.getLightIndices()) {
+        ASSERT_EQ(index, 3);
+    }
+    ASSERT_GT(grid.getLightIndices().size(), 0u);
+}
+
+TEST(LightClustersTest, FullClustersKeepTheirFirstLights) {
+    // ARRANGE
+    LightClusterGrid grid;
+    grid.setProjection(makeProjection());
+    std::vector<PointLight> lights(LightClusterGrid::MAX_LIGHTS_PER_CLUSTER + 50, makeLight({0.0f, 2.0f, -5.0f}, 0.5f));
+
+    // ACT
+    grid.assign(lights.data(), lights.size(), makeView());
+
+    // ASSERT
+    const LightClusterStats& stats = grid.getStats();
+    ASSERT_EQ(stats.maxPerCluster, lights.size());
+    ASSERT_GT(stats.overflow, 0u);
+
+    for (const ClusterRange& cluster : grid.getClusters()) {
+        ASSERT_LE(cluster.count, LightClusterGrid::MAX_LIGHTS_PER_CLUSTER);
+        for (std::uint32_t i = 0; i < cluster.count; ++i) {
+            ASSERT_EQ(grid.getLightIndices()[cluster.offset + i], i);
+        }
+    }
+}
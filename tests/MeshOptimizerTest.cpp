@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include "MeshOptimizer.hpp"
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+namespace {
+
+    // Flat grid of size x size quads with one vertex per corner, triangles in random order
+    void shuffledGrid(int size, std::vector<Vertex>& vertices, std::vector<std::uint32_t>& indices) {
+        for (int y = 0; y <= size; ++y) {
+            for (int x = 0; x <= size; ++x) {
+                Vertex vertex{};
+                vertex.Position = glm::vec3(static_cast<float>(x), static_cast<float>(y), 0.0f);
+                vertex.Normal = glm::vec3(0.0f, 0.0f, 1.0f);
+                vertices.push_back(vertex);
+            }
+        }
+
+        std::vector<std::array<std::uint32_t, 3>> triangles;
+        auto corner = [size](int x, int y) { return static_cast<std::uint32_t>(y * (size + 1) + x); };
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                triangles.push_back({corner(x, y), corner(x + 1, y), corner(x + 1, y + 1)});
+                triangles.push_back({corner(x, y), corner(x + 1, y + 1), corner(x, y + 1)});
+            }
+        }
+
+        std::mt19937 rng(5);
+        std::shuffle(triangles.begin(), triangles.end(), rng);
+        for (auto const& triangle : triangles) indices.insert(indices.end(), triangle.begin(), triangle.end());
+    }
+
+    // Triangles as position triples, rotated so the smallest corner comes first to keep winding
+    std::vector<std::array<float, 9>> triangleSet(const std::vector<Vertex>& vertices, const std::vector<std::uint32_t>& indices) {
+        std::vector<std::array<float, 9>> triangles;
+        for (std::size_t t = 0; t < indices.size() / 3; ++t) {
+            std::array<std::array<float, 3>, 3> corners;
+            for (int c = 0; c < 3; ++c) {
+                const glm::vec3& p = vertices[indices[t * 3 + c]].Position;
+                corners[c] = {p.x, p.y, p.z};
+            }
+            auto first = std::min_element(corners.begin(), corners.end());
+            std::rotate(corners.begin(), first, corners.end());
+
+            std::array<float, 9> flat;
+            for (int c = 0; c < 3; ++c) std::copy(corners[c].begin(), corners[c].end(), flat.begin() + c * 3);
+            triangles.push_back(flat);
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+}
+
+TEST(MeshOptimizerTest, WeldMergesIdenticalVertices) {
+    // ARRANGE
+    // two triangles sharing an edge, stored unindexed like many exporters write them
+    std::vector<Vertex> vertices(6);
+    const glm::vec3 positions[] = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 0, 0}, {1, 1, 0}, {0, 1, 0}};
+    for (int i = 0; i < 6; ++i) vertices[i].Position = positions[i];
+    std::vector<std::uint32_t> indices = {0, 1, 2, 3, 4, 5};
+
+    // ACT
+    std::size_t removed = MeshOptimizer::weldVertices(vertices, indices);
+
+    // ASSERT
+    ASSERT_EQ(removed, 2);
+    ASSERT_EQ(vertices.size(), 4);
+    ASSERT_EQ(indices[3], indices[0]);
+    ASSERT_EQ(indices[4], indices[2]);
+}
+
+TEST(MeshOptimizerTest, VertexCacheOrderLowersACMR) {
+    // ARRANGE
+    std::vector<Vertex> vertices;
+    std::vector<std::uint32_t> indices;
+    shuffledGrid(32, vertices, indices);
+    auto expected = triangleSet(vertices, indices);
+    float before = MeshOptimizer::computeACMR(indices, vertices.size());
+
+    // ACT
+    MeshOptimizer::optimizeVertexCache(indices, vertices.size());
+    float after = MeshOptimizer::computeACMR(indices, vertices.size());
+
+    // ASSERT
+    //a shuffled grid misses on nearly every corner, a good order approaches one miss per triangle
+    EXPECT_GT(before, 2.5f);
+    EXPECT_LT(after, 0.9f);
+    ASSERT_EQ(triangleSet(vertices, indices), expected);
+}
+
+TEST(MeshOptimizerTest, FullPipelineKeepsTrianglesAndOrdersFetches) {
+    // ARRANGE
+    std::vector<Vertex> vertices;
+    std::vector<std::uint32_t> indices;
+    shuffledGrid(24, vertices, indices);
+
+    //duplicate the whole vertex array, half the triangles point at the copies
+    std::size_t original = vertices.size();
+    vertices.insert(vertices.end(), vertices.begin(), vertices.end());
+    for (std::size_t i = 0; i < indices.size(); i += 6) {
+        for (std::size_t c = 0; c < 3; ++c) indices[i + c] += static_cast<std::uint32_t>(original);
+    }
+    auto expected = triangleSet(vertices, indices);
+
+    // ACT
+    MeshOptimizationReport report = MeshOptimizer::optimize(vertices, indices);
+
+    // ASSERT
+    ASSERT_EQ(report.verticesBefore, original * 2);
+    ASSERT_EQ(report.verticesAfter, original);
+    ASSERT_LT(report.acmrAfter, report.acmrBefore);
+    ASSERT_EQ(triangleSet(vertices, indices), expected);
+
+    //every vertex is first referenced in order, so fetches walk the buffer forwards
+    std::uint32_t next = 0;
+    for (std::uint32_t index : indices) {
+        ASSERT_LE(index, next);
+        if (index == next) next++;
+    }
+    ASSERT_EQ(next, vertices.size());
+}
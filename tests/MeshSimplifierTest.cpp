@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include "MeshLOD.hpp"
+#include "MeshOptimizer.hpp"
+#include "MeshSimplifier.hpp"
+#include <cmath>
+#include <vector>
+
+namespace {
+
+    // Unit sphere from latitude and longitude bands, welded so only the longitude seam remains
+    void uvSphere(int segments, std::vector<Vertex>& vertices, std::vector<std::uint32_t>& indices) {
+        const float pi = 3.14159265f;
+        int rings = segments / 2;
+        for (int r = 0; r <= rings; ++r) {
+            for (int s = 0; s <= segments; ++s) {
+                float theta = pi * r / rings;
+                float phi = 2.0f * pi * s / segments;
+                Vertex vertex{};
+                vertex.Position = glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+                //exact poles so every pole copy welds into one vertex
+                if (r == 0 || r == rings) vertex.Position = glm::vec3(0.0f, r == 0 ? 1.0f : -1.0f, 0.0f);
+                vertex.Normal = vertex.Position;
+                vertices.push_back(vertex);
+            }
+        }
+        for (int r = 0; r < rings; ++r) {
+            for (int s = 0; s < segments; ++s) {
+                std::uint32_t a = r * (segments + 1) + s;
+                std::uint32_t b = a + segments + 1;
+                indices.insert(indices.end(), {a, a + 1, b, a + 1, b + 1, b});
+            }
+        }
+        MeshOptimizer::weldVertices(vertices, indices);
+    }
+
+    std::vector<MeshLOD> lodChain() {
+        std::vector<MeshLOD> lods(3);
+        lods[1].error = 0.01f;
+        lods[2].error = 0.1f;
+        return lods;
+    }
+}
+
+TEST(MeshSimplifierTest, SphereReachesTargetWithBoundedError) {
+    // ARRANGE
+    std::vector<Vertex> vertices;
+    std::vector<std::uint32_t> indices;
+    uvSphere(64, vertices, indices);
+    std::size_t target = indices.size() / 4 / 3 * 3;
+
+    // ACT
+    float error = 0.0f;
+    std::vector<std::uint32_t> simplified = MeshSimplifier::simplify(vertices, indices, target, 0.2f, &error);
+
+    // ASSERT
+    ASSERT_LE(simplified.size(), target);
+    ASSERT_GT(simplified.size(), target / 2);
+    ASSERT_GT(error, 0.0f);
+    ASSERT_LT(error, 0.05f);
+
+    //every remaining triangle still faces outwards and lies close to the surface
+    for (std::size_t t = 0; t < simplified.size(); t += 3) {
+        const glm::vec3& a = vertices[simplified[t]].Position;
+        const glm::vec3& b = vertices[simplified[t + 1]].Position;
+        const glm::vec3& c = vertices[simplified[t + 2]].Position;
+        glm::vec3 center = (a + b + c) / 3.0f;
+        ASSERT_GT(glm::dot(glm::cross(b - a, c - a), center), 0.0f) << "triangle " << t / 3;
+        ASSERT_GT(glm::length(center), 0.9f);
+    }
+}
+
+TEST(MeshSimplifierTest, FlatGridCollapsesButKeepsItsBorder) {
+    // ARRANGE
+    const int size = 16;
+    std::vector<Vertex> vertices;
+    std::vector<std::uint32_t> indices;
+    for (int y = 0; y <= size; ++y) {
+        for (int x = 0; x <= size; ++x) {
+            Vertex vertex{};
+            vertex.Position = glm::vec3(static_cast<float>(x), static_cast<float>(y), 0.0f);
+            vertices.push_back(vertex);
+        }
+    }
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            std::uint32_t a = y * (size + 1) + x;
+            std::uint32_t b = a + size + 1;
+            indices.insert(indices.end(), {a, a + 1, b + 1, a, b + 1, b});
+        }
+    }
+
+    // ACT
+    float error = 1.0f;
+    std::vector<std::uint32_t> simplified = MeshSimplifier::simplify(vertices, indices, 0, 0.001f, &error);
+
+    // ASSERT
+    //a plane costs nothing to simplify, only the locked border vertices limit it
+    ASSERT_FLOAT_EQ(error, 0.0f);
+    ASSERT_LT(simplified.size(), indices.size() / 4);
+
+    float area = 0.0f;
+    for (std::size_t t = 0; t < simplified.size(); t += 3) {
+        const glm::vec3& a = vertices[simplified[t]].Position;
+        const glm::vec3& b = vertices[simplified[t + 1]].Position;
+        const glm::vec3& c = vertices[simplified[t + 2]].Position;
+        area += 0.5f * glm::cross(b - a, c - a).z;
+    }
+    ASSERT_NEAR(area, static_cast<float>(size * size), 1e-3f);
+}
+
+TEST(MeshSimplifierTest, LODSelectionPicksCoarsestWithinThreshold) {
+    // ARRANGE
+    std::vector<MeshLOD> lods = lodChain();
+
+    // ACT / ASSERT
+    //LOD 1 projects to 0.5 pixels and LOD 2 to 5
+    ASSERT_EQ(LODSelection::select(lods.data(), lods.size(), 0, 50.0f, 1.0f, 0.25f), 1);
+    //far enough for every level
+    ASSERT_EQ(LODSelection::select(lods.data(), lods.size(), 0, 5.0f, 1.0f, 0.25f), 2);
+    //close up the full mesh comes back immediately
+    ASSERT_EQ(LODSelection::select(lods.data(), lods.size(), 2, 500.0f, 1.0f, 0.25f), 0);
+    ASSERT_EQ(LODSelection::select(lods.data(), 1, 0, 0.0f, 1.0f, 0.25f), 0);
+}
+
+TEST(MeshSimplifierTest, LODSelectionHysteresis) {
+    // ARRANGE
+    std::vector<MeshLOD> lods = lodChain();
+
+    // ACT
+    //LOD 2 projects to 0.9 pixels, under the threshold but inside the hysteresis band
+    std::uint32_t fromFine = LODSelection::select(lods.data(), lods.size(), 1, 9.0f, 1.0f, 0.25f);
+    std::uint32_t fromCoarse = LODSelection::select(lods.data(), lods.size(), 2, 9.0f, 1.0f, 0.25f);
+    std::uint32_t pastBand = LODSelection::select(lods.data(), lods.size(), 1, 7.0f, 1.0f, 0.25f);
+
+    // ASSERT
+    ASSERT_EQ(fromFine, 1);
+    ASSERT_EQ(fromCoarse, 2);
+    ASSERT_EQ(pastBand, 2);
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include "PortalView.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace {
+
+    glm::mat4 makeProjection() {
+        return glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+    }
+
+    glm::vec3 toNDC(const glm::mat4& viewProjection, const glm::vec3& point) {
+        glm::vec4 clip = viewProjection * glm::vec4(point, 1.0f);
+        return glm::vec3(clip) / clip.w;
+    }
+}
+
+TEST(PortalViewTest, TargetSpaceAppearsBehindTheSourceManifold) {
+    // ARRANGE
+    glm::mat4 view = glm::lookAt(glm::vec3(1.0f, 0.5f, 5.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = makeProjection();
+    glm::mat4 source = glm::mat4(1.0f);
+    glm::mat4 target = glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(100.0f, 3.0f, -40.0f)),
+                                   glm::radians(70.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::vec3 local(0.3f, -0.2f, -3.0f);
+
+    // ACT
+    glm::mat4 portalView = PortalView::throughPortal(view, source, target);
+
+    // ASSERT
+    glm::vec3 seen = toNDC(projection * portalView, glm::vec3(target * glm::vec4(local, 1.0f)));
+    glm::vec3 expected = toNDC(projection * view, glm::vec3(source * glm::vec4(local, 1.0f)));
+    ASSERT_NEAR(seen.x, expected.x, 1e-4f);
+    ASSERT_NEAR(seen.y, expected.y, 1e-4f);
+    ASSERT_NEAR(seen.z, expected.z, 1e-4f);
+
+    ASSERT_TRUE(PortalView::facesCamera(source, glm::vec3(1.0f, 0.5f, 5.0f)));
+    ASSERT_FALSE(PortalView::facesCamera(source, glm::vec3(1.0f, 0.5f, -5.0f)));
+}
+
+TEST(PortalViewTest, ObliqueNearPlaneClipsInFrontOfTheTargetManifold) {
+    // ARRANGE
+    glm::mat4 target = glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -4.0f)),
+                                   glm::radians(20.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 2.0f), glm::vec3(0.0f, 0.0f, -10.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = makeProjection();
+
+    // ACT
+    glm::vec4 plane = PortalView::clipPlane(view, target);
+    glm::mat4 oblique = PortalView::obliqueProjection(projection, plane);
+
+    // ASSERT
+    glm::vec3 normal = glm::vec3(target[2]);
+    glm::vec3 onPlane = glm::vec3(target[3]);
+    glm::vec3 behind = onPlane - normal * 2.0f;
+    glm::vec3 between = onPlane + normal * 1.0f;
+
+    //x and y are untouched, only depth is remapped
+    glm::vec3 regular = toNDC(projection * view, behind);
+    glm::vec3 remapped = toNDC(oblique * view, behind);
+    ASSERT_NEAR(remapped.x, regular.x, 1e-4f);
+    ASSERT_NEAR(remapped.y, regular.y, 1e-4f);
+    ASSERT_GT(remapped.z, -1.0f);
+    ASSERT_LT(remapped.z, 1.0f);
+
+    ASSERT_NEAR(toNDC(oblique * view, onPlane).z, -1.0f, 1e-3f);
+    ASSERT_LT(toNDC(oblique * view, between).z, -1.0f);
+
+    //a plane with the camera on its positive side would flip the frustum, it is refused
+    ASSERT_EQ(PortalView::obliqueProjection(projection, -plane), projection);
+}
+
+TEST(PortalViewTest, ScreenRectShrinksWithDistance) {
+    // ARRANGE
+    glm::mat4 viewProjection = makeProjection() * glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    AABB close{glm::vec3(-0.5f, -0.5f, -1.1f), glm::vec3(0.5f, 0.5f, -1.0f)};
+    AABB far{glm::vec3(-0.5f, -0.5f, -80.1f), glm::vec3(0.5f, 0.5f, -80.0f)};
+    AABB aside{glm::vec3(50.0f, -0.5f, -2.0f), glm::vec3(51.0f, 0.5f, -1.0f)};
+    AABB behind{glm::vec3(-0.5f, -0.5f, 1.0f), glm::vec3(0.5f, 0.5f, 2.0f)};
+    AABB straddling{glm::vec3(-0.5f, -0.5f, -1.0f), glm::vec3(0.5f, 0.5f, 1.0f)};
+
+    // ACT
+    ScreenRect closeRect, farRect, asideRect, behindRect, straddlingRect;
+    bool closeVisible = PortalView::screenRect(viewProjection, close, closeRect);
+    bool farVisible = PortalView::screenRect(viewProjection, far, farRect);
+    bool asideVisible = PortalView::screenRect(viewProjection, aside, asideRect);
+    bool behindVisible = PortalView::screenRect(viewProjection, behind, behindRect);
+    bool straddlingVisible = PortalView::screenRect(viewProjection, straddling, straddlingRect);
+
+    // ASSERT
+    ASSERT_TRUE(closeVisible);
+    ASSERT_TRUE(farVisible);
+    ASSERT_GT(closeRect.area(), 0.05f);
+    ASSERT_LT(farRect.area(), 1e-3f);
+    ASSERT_GT(farRect.area(), 0.0f);
+    ASSERT_FALSE(asideVisible);
+    ASSERT_FALSE(behindVisible);
+    ASSERT_TRUE(straddlingVisible);
+    ASSERT_FLOAT_EQ(straddlingRect.area(), 1.0f);
+}
+
+TEST(PortalViewTest, RestrictedProjectionCullsOutsideTheRect) {
+    // ARRANGE
+    glm::mat4 projection = makeProjection();
+    ScreenRect rect{glm::vec2(0.0f, -0.5f), glm::vec2(0.5f, 0.5f)};
+
+    // ACT
+    Frustum frustum = Frustum::fromMatrix(PortalView::restrictToRect(projection, rect));
+
+    // ASSERT
+    //boxes straight ahead at depth 10, placed by where their centers land in NDC
+    auto boxAt = [&](float ndcX, float ndcY) {
+        glm::vec4 point = glm::inverse(projection) * glm::vec4(ndcX, ndcY, 0.0f, 1.0f);
+        glm::vec3 position = glm::vec3(point) / point.w;
+        position *= 10.0f / -position.z;
+        return AABB{position - glm::vec3(0.01f), position + glm::vec3(0.01f)};
+    };
+    ASSERT_TRUE(frustum.intersects(boxAt(0.25f, 0.0f)));
+    ASSERT_FALSE(frustum.intersects(boxAt(-0.25f, 0.0f)));
+    ASSERT_FALSE(frustum.intersects(boxAt(0.75f, 0.0f)));
+    ASSERT_FALSE(frustum.intersects(boxAt(0.25f, 0.75f)));
+}
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+TEST(ProfilerTest, SummaryPercentiles) {
+    // ARRANGE
+    Profiler& profiler = Profiler::get();
+    profiler.reset();
+
+    // Record 100 samples of 1..100 ms for a single zone
+    for (std::uint64_t i = 1; i <= 100; ++i) {
+        profiler.record("TestZone", 0, i * 1000000, 0);
+    }
+
+    // ACT
+    profiler.endFrame();
+    auto summary = profiler.getSummary();
+
+    // ASSERT
+    auto it = std::find_if(summary.begin(), summary.end(), [](const ZoneSummary& zone) {
+        return zone.name == "TestZone";
+    });
+    ASSERT_NE(it, summary.end());
+    ASSERT_EQ(it->sampleCount, 100);
+    ASSERT_NEAR(it->p50Ms, 51.0, 1.0);
+    ASSERT_NEAR(it->p95Ms, 95.0, 1.0);
+    ASSERT_NEAR(it->p99Ms, 99.0, 1.0);
+    ASSERT_DOUBLE_EQ(it->maxMs, 100.0);
+}
+
+TEST(ProfilerTest, RollingWindowKeepsLatestSamples) {
+    Profiler& profiler = Profiler::get();
+    profiler.reset();
+
+    // Fill the window with slow samples, then overwrite it entirely with fast ones
+    for (std::size_t i = 0; i < Profiler::SUMMARY_WINDOW; ++i) {
+        profiler.record("WindowZone", 0, 50000000, 0);
+    }
+    profiler.endFrame();
+    for (std::size_t i = 0; i < Profiler::SUMMARY_WINDOW; ++i) {
+        profiler.record("WindowZone", 0, 1000000, 0);
+    }
+    profiler.endFrame();
+
+    auto summary = profiler.getSummary();
+    auto it = std::find_if(summary.begin(), summary.end(), [](const ZoneSummary& zone) {
+        return zone.name == "WindowZone";
+    });
+    ASSERT_NE(it, summary.end());
+    ASSERT_EQ(it->sampleCount, Profiler::SUMMARY_WINDOW);
+    ASSERT_DOUBLE_EQ(it->maxMs, 1.0);
+}
+
+TEST(ProfilerTest, InternedNamesAreSharedAndOutliveReset) {
+    Profiler& profiler = Profiler::get();
+    profiler.reset();
+
+    const char* name = profiler.intern("GPU::" + std::string("InternedZone"));
+    profiler.recordGpu(name, 0, 1000000, 0);
+    profiler.reset();
+
+    ASSERT_EQ(profiler.intern("GPU::InternedZone"), name);
+    ASSERT_STREQ(name, "GPU::InternedZone");
+}
+
+TEST(ProfilerTest, ScopesFromWorkerThreadsAreCollected) {
+    Profiler& profiler = Profiler::get();
+    profiler.reset();
+
+    std::thread worker([]() {
+        ProfileScope outer("WorkerOuter");
+        ProfileScope inner("WorkerInner");
+    });
+    worker.join();
+    profiler.endFrame();
+
+    int found = 0;
+    for (auto const& zone : profiler.getSummary()) {
+        if (zone.name == "WorkerOuter" || zone.name == "WorkerInner") found++;
+    }
+    ASSERT_EQ(found, 2);
+}
+
+TEST(ProfilerTest, ExportChromeTrace) {
+    Profiler& profiler = Profiler::get();
+    profiler.reset();
+
+    {
+        ProfileScope scope("TraceZone");
+    }
+
+    const std::string path = "profiler_test_trace.json";
+    ASSERT_TRUE(profiler.exportChromeTrace(path));
+
+    std::ifstream file(path);
+    std::stringstream contents;
+    contents << file.rdbuf();
+
+    ASSERT_NE(contents.str().find("\"traceEvents\""), std::string::npos);
+    ASSERT_NE(contents.str().find("\"name\":\"TraceZone\""), std::string::npos);
+    ASSERT_NE(contents.str().find("\"ph\":\"X\""), std::string::npos);
+    std::remove(path.c_str());
+}
+
+TEST(ProfilerTest, GpuZonesShareTheReportingSurface) {
+    Profiler& profiler = Profiler::get();
+    profiler.reset();
+
+    // GpuProfiler forwards resolved timestamps through recordGpu
+    profiler.recordGpu("GPU::TestPass", 1000000, 3000000, 0);
+    profiler.endFrame();
+
+    bool found = false;
+    for (auto const& zone : profiler.getSummary()) {
+        if (zone.name != "GPU::TestPass") continue;
+        found = true;
+        ASSERT_DOUBLE_EQ(zone.p50Ms, 2.0);
+    }
+    ASSERT_TRUE(found);
+
+    const std::string path = "profiler_test_gpu_trace.json";
+    ASSERT_TRUE(profiler.exportChromeTrace(path));
+
+    std::ifstream file(path);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    ASSERT_NE(contents.str().find("\"args\":{\"name\":\"GPU\"}"), std::string::npos);
+    std::remove(path.c_str());
+}
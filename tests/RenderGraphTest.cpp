@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include "RenderGraph.hpp"
+#include <stdexcept>
+
+namespace {
+
+    const GraphResourceDesc HALF_HDR{0.5f, RenderTargetFormat::RGB16F};
+    const GraphResourceDesc FULL_LDR{1.0f, RenderTargetFormat::RGBA8};
+}
+
+TEST(RenderGraphTest, PassesNobodyReadsAreCulled) {
+    // ARRANGE
+    RenderGraph graph;
+    auto scene = graph.importResource("scene");
+    auto backbuffer = graph.importResource("backbuffer");
+    auto bloom = graph.createResource("bloom", HALF_HDR);
+    auto debug = graph.createResource("debug", FULL_LDR);
+    graph.markOutput(backbuffer);
+
+    auto bloomPass = graph.addPass("bloom", {scene}, bloom);
+    auto debugPass = graph.addPass("debug", {scene}, debug);
+    auto tonemap = graph.addPass("tonemap", {scene}, backbuffer);
+
+    // ACT
+    graph.compile();
+
+    // ASSERT
+    ASSERT_FALSE(graph.isLive(bloomPass));
+    ASSERT_FALSE(graph.isLive(debugPass));
+    ASSERT_TRUE(graph.isLive(tonemap));
+    ASSERT_EQ(graph.getLivePasses().size(), 1u);
+    ASSERT_EQ(graph.getSlotCount(), 0u);
+}
+
+TEST(RenderGraphTest, ReadModifyWriteKeepsEarlierWritersAlive) {
+    // ARRANGE
+    RenderGraph graph;
+    auto scene = graph.importResource("scene");
+    auto backbuffer = graph.importResource("backbuffer");
+    auto half = graph.createResource("half", HALF_HDR);
+    auto quarter = graph.createResource("quarter", GraphResourceDesc{0.25f, RenderTargetFormat::RGB16F});
+    graph.markOutput(backbuffer);
+
+    auto downHalf = graph.addPass("downHalf", {scene}, half);
+    auto downQuarter = graph.addPass("downQuarter", {half}, quarter);
+    //blends the quarter level onto the half level, which needs the half level's contents
+    auto upHalf = graph.addPass("upHalf", {quarter}, half);
+    auto tonemap = graph.addPass("tonemap", {scene, half}, backbuffer);
+
+    // ACT
+    graph.compile();
+
+    // ASSERT
+    std::vector<RenderGraph::PassID> expected = {downHalf, downQuarter, upHalf, tonemap};
+    ASSERT_EQ(graph.getLivePasses(), expected);
+
+    //both levels are alive at once, so they get their own slots, acquired and released around their uses
+    ASSERT_NE(graph.getSlot(half), graph.getSlot(quarter));
+    ASSERT_EQ(graph.getAcquires(0).size(), 1u);
+    ASSERT_EQ(graph.getReleases(2).size(), 1u);
+    ASSERT_EQ(graph.getReleases(2)[0], graph.getSlot(quarter));
+    ASSERT_EQ(graph.getReleases(3)[0], graph.getSlot(half));
+}
+
+TEST(RenderGraphTest, DisjointLifetimesShareASlot) {
+    // ARRANGE
+    RenderGraph graph;
+    auto scene = graph.importResource("scene");
+    auto backbuffer = graph.importResource("backbuffer");
+    auto first = graph.createResource("first", FULL_LDR);
+    auto second = graph.createResource("second", FULL_LDR);
+    auto third = graph.createResource("third", FULL_LDR);
+    auto otherFormat = graph.createResource("otherFormat", HALF_HDR);
+    graph.markOutput(backbuffer);
+
+    graph.addPass("a", {scene}, first);
+    graph.addPass("b", {first}, second);
+    graph.addPass("c", {second}, third);
+    graph.addPass("d", {third}, otherFormat);
+    graph.addPass("e", {otherFormat}, backbuffer);
+
+    // ACT
+    graph.compile();
+
+    // ASSERT
+    //first dies at b, where second is born, so they overlap; third starts after first is done
+    ASSERT_NE(graph.getSlot(first), graph.getSlot(second));
+    ASSERT_EQ(graph.getSlot(first), graph.getSlot(third));
+    ASSERT_NE(graph.getSlot(otherFormat), graph.getSlot(first));
+    ASSERT_EQ(graph.getSlotCount(), 3u);
+    ASSERT_EQ(graph.getSlot(scene), RenderGraph::NO_SLOT);
+}
+
+TEST(RenderGraphTest, ReadingAnUnwrittenTargetThrows) {
+    // ARRANGE
+    RenderGraph graph;
+    auto backbuffer = graph.importResource("backbuffer");
+    auto never = graph.createResource("never", FULL_LDR);
+    graph.markOutput(backbuffer);
+    graph.addPass("tonemap", {never}, backbuffer);
+
+    // ACT & ASSERT
+    ASSERT_THROW(graph.compile(), std::runtime_error);
+}
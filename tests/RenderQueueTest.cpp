@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include "RenderQueue.hpp"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+TEST(RenderQueueTest, SortMatchesStableSort) {
+    // ARRANGE
+    std::mt19937_64 rng(5);
+    RenderQueue queue;
+    std::vector<DrawPacket> expected;
+
+    //few distinct states and many depths, so equal batch keys and skipped radix bytes both occur
+    for (std::uint32_t i = 0; i < 5000; ++i) {
+        std::uint64_t key = RenderKey::make(RenderKey::PASS_OPAQUE, rng() % 2, rng() % 7, rng() % 50, rng() % 3, rng() % 4);
+        queue.push(key, i, 0);
+        expected.push_back({key, i, 0});
+    }
+
+    // ACT
+    queue.sort();
+
+    // ASSERT
+    std::stable_sort(expected.begin(), expected.end(), [](const DrawPacket& a, const DrawPacket& b) {
+        return a.key < b.key;
+    });
+
+    ASSERT_EQ(queue.size(), expected.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_EQ(queue[i].key, expected[i].key) << "packet " << i;
+        ASSERT_EQ(queue[i].instance, expected[i].instance) << "packet " << i;
+    }
+}
+
+TEST(RenderQueueTest, SortDoesNotAllocateOnceWarm) {
+    RenderQueue queue;
+    std::mt19937_64 rng(11);
+
+    auto fillAndSort = [&]() {
+        queue.clear();
+        for (std::uint32_t i = 0; i < 1000; ++i) {
+            queue.push(rng(), i, 0);
+        }
+        queue.sort();
+    };
+
+    //two frames let both internal buffers reach full capacity
+    fillAndSort();
+    fillAndSort();
+    const DrawPacket* storage = queue.getPackets().data();
+    fillAndSort();
+    fillAndSort();
+
+    //sorted data alternates between the two buffers, an even number of frames lands on the same one
+    ASSERT_EQ(queue.getPackets().data(), storage);
+    ASSERT_TRUE(std::is_sorted(queue.getPackets().begin(), queue.getPackets().end(),
+        [](const DrawPacket& a, const DrawPacket& b) { return a.key < b.key; }));
+}
+
+TEST(RenderQueueTest, KeyOrdersStateBeforeDepth) {
+    std::uint64_t nearMaterialB = RenderKey::make(RenderKey::PASS_OPAQUE, 0, 2, 0, 0, RenderKey::depthBucket(1.0f));
+    std::uint64_t farMaterialA = RenderKey::make(RenderKey::PASS_OPAQUE, 0, 1, 0, 0, RenderKey::depthBucket(100.0f));
+    std::uint64_t nearMaterialA = RenderKey::make(RenderKey::PASS_OPAQUE, 0, 1, 0, 0, RenderKey::depthBucket(1.0f));
+
+    ASSERT_LT(farMaterialA, nearMaterialB);
+    ASSERT_LT(nearMaterialA, farMaterialA);
+    ASSERT_EQ(nearMaterialA & RenderKey::BATCH_MASK, farMaterialA & RenderKey::BATCH_MASK);
+
+    ASSERT_EQ(RenderKey::depthBucket(-3.0f), 0u);
+    ASSERT_LT(RenderKey::depthBucket(0.5f), RenderKey::depthBucket(0.6f));
+}
+
+TEST(RenderQueueTest, DepthFirstKeyOrdersDepthBeforeMesh) {
+    std::uint64_t nearMeshB = RenderKey::makeDepthFirst(0, RenderKey::depthBucket(1.0f), 2, 0);
+    std::uint64_t farMeshA = RenderKey::makeDepthFirst(0, RenderKey::depthBucket(100.0f), 1, 0);
+    std::uint64_t nearMeshA = RenderKey::makeDepthFirst(0, RenderKey::depthBucket(1.0f), 1, 0);
+    std::uint64_t near32Bit = RenderKey::makeDepthFirst(1, RenderKey::depthBucket(0.5f), 0, 0);
+
+    ASSERT_LT(nearMeshB, farMeshA);
+    ASSERT_LT(nearMeshA, nearMeshB);
+
+    //index types never interleave, each one is a front to back run of its own
+    ASSERT_LT(farMeshA, near32Bit);
+}
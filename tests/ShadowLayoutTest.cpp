@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include "ShadowLayout.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace {
+
+    const glm::mat4 PROJECTION = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+
+    // Corners of the camera frustum slice between two view depths, in world space
+    void sliceCorners(const glm::mat4& inverseView, float nearDepth, float farDepth, glm::vec3* corners) {
+        float tanX = 1.0f / PROJECTION[0][0];
+        float tanY = 1.0f / PROJECTION[1][1];
+        int c = 0;
+        for (float depth : {nearDepth, farDepth}) {
+            for (float x : {-1.0f, 1.0f}) {
+                for (float y : {-1.0f, 1.0f}) {
+                    corners[c++] = glm::vec3(inverseView * glm::vec4(x * tanX * depth, y * tanY * depth, -depth, 1.0f));
+                }
+            }
+        }
+    }
+
+    glm::vec3 project(const glm::mat4& matrix, const glm::vec3& point) {
+        glm::vec4 clip = matrix * glm::vec4(point, 1.0f);
+        return glm::vec3(clip) / clip.w;
+    }
+}
+
+TEST(ShadowLayoutTest, SplitsCoverTheRangeInOrder) {
+    // ARRANGE
+    float splits[5];
+    float linear[5];
+
+    // ACT
+    ShadowLayout::cascadeSplits(0.1f, 100.0f, 4, 0.75f, splits);
+    ShadowLayout::cascadeSplits(0.1f, 100.0f, 4, 0.0f, linear);
+
+    // ASSERT
+    ASSERT_FLOAT_EQ(splits[0], 0.1f);
+    ASSERT_FLOAT_EQ(splits[4], 100.0f);
+    for (int i = 1; i < 5; i++) {
+        ASSERT_GT(splits[i], splits[i - 1]);
+        //the near cascades get more of the resolution than an even split would give them
+        if (i < 4) ASSERT_LT(splits[i], linear[i]);
+    }
+    ASSERT_NEAR(linear[2], 50.05f, 1e-3f);
+}
+
+TEST(ShadowLayoutTest, SliceBoundsHoldTheSliceWhereverTheCameraLooks) {
+    // ARRANGE
+    glm::mat4 forward = glm::inverse(glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+    glm::mat4 turned = glm::inverse(glm::lookAt(glm::vec3(3.0f, 1.0f, -2.0f), glm::vec3(4.0f, 0.5f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+
+    // ACT
+    BoundingSphere a = ShadowLayout::sliceBounds(PROJECTION, forward, 5.0f, 20.0f);
+    BoundingSphere b = ShadowLayout::sliceBounds(PROJECTION, turned, 5.0f, 20.0f);
+
+    // ASSERT
+    ASSERT_NEAR(a.radius, b.radius, 1e-4f);
+    glm::vec3 corners[8];
+    sliceCorners(turned, 5.0f, 20.0f, corners);
+    for (const glm::vec3& corner : corners) {
+        ASSERT_LE(glm::length(corner - b.center), b.radius + 1e-3f);
+    }
+}
+
+TEST(ShadowLayoutTest, CascadeOnlyMovesOnceTheSliceLeavesItsMargin) {
+    // ARRANGE
+    glm::vec3 light = glm::normalize(glm::vec3(-0.3f, -1.0f, -0.2f));
+    BoundingSphere slice{glm::vec3(0.0f, 0.0f, -10.0f), 8.0f};
+    ShadowCascade cascade;
+    ASSERT_TRUE(ShadowLayout::fitCascade(cascade, slice, light, 1024, 0.25f, 50.0f));
+
+    // ACT
+    slice.center.x += 0.5f;
+    bool smallMove = ShadowLayout::fitCascade(cascade, slice, light, 1024, 0.25f, 50.0f);
+    slice.center.x += 5.0f;
+    bool largeMove = ShadowLayout::fitCascade(cascade, slice, light, 1024, 0.25f, 50.0f);
+    bool turnedLight = ShadowLayout::fitCascade(cascade, slice, glm::vec3(0.0f, -1.0f, 0.0f), 1024, 0.25f, 50.0f);
+
+    // ASSERT
+    ASSERT_FALSE(smallMove);
+    ASSERT_TRUE(largeMove);
+    ASSERT_TRUE(turnedLight);
+
+    //the refitted cascade still holds the whole slice inside its texture and depth range
+    glm::mat4 shadow = ShadowLayout::textureTransform() * cascade.projection * cascade.view;
+    for (glm::vec3 offset : {glm::vec3(1, 0, 0), glm::vec3(-1, 0, 0), glm::vec3(0, 1, 0),
+                             glm::vec3(0, -1, 0), glm::vec3(0, 0, 1), glm::vec3(0, 0, -1)}) {
+        glm::vec3 uv = project(shadow, slice.center + offset * slice.radius);
+        for (int axis = 0; axis < 3; axis++) {
+            ASSERT_GE(uv[axis], 0.0f);
+            ASSERT_LE(uv[axis], 1.0f);
+        }
+    }
+}
+
+TEST(ShadowLayoutTest, CubeFacesLandInsideTheirAtlasTile) {
+    // ARRANGE
+    glm::vec3 light(2.0f, 3.0f, -1.0f);
+    float range = 10.0f;
+    const std::uint32_t tilesPerRow = 8;
+    const std::uint32_t firstTile = 12;
+    glm::vec3 directions[] = {{1.0f, 0.2f, -0.3f}, {-0.5f, 0.9f, 0.1f}, {0.3f, -0.4f, -0.9f},
+                              {-0.7f, -0.1f, 0.69f}, {0.0f, -1.0f, 0.0f}, {0.6f, 0.6f, 0.59f}};
+
+    for (const glm::vec3& direction : directions) {
+        // ACT
+        std::uint32_t face = ShadowLayout::cubeFace(direction);
+        std::uint32_t tile = firstTile + face;
+        glm::mat4 shadow = ShadowLayout::tileTransform(tile, tilesPerRow) *
+                           ShadowLayout::cubeFaceProjection(range) *
+                           ShadowLayout::cubeFaceView(light, face);
+        glm::vec3 uv = project(shadow, light + glm::normalize(direction) * 4.0f);
+
+        // ASSERT
+        float size = 1.0f / tilesPerRow;
+        float minU = (tile % tilesPerRow) * size;
+        float minV = (tile / tilesPerRow) * size;
+        ASSERT_GE(uv.x, minU);
+        ASSERT_LE(uv.x, minU + size);
+        ASSERT_GE(uv.y, minV);
+        ASSERT_LE(uv.y, minV + size);
+        ASSERT_GT(uv.z, 0.0f);
+        ASSERT_LT(uv.z, 1.0f);
+    }
+}
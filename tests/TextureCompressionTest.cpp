@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include "TextureCompression.hpp"
+#include <cstdlib>
+
+TEST(TextureCompressionTest, BC1KeepsASolidBlockExact) {
+    // ARRANGE
+    //a color 565 represents exactly
+    std::uint8_t rgba[64];
+    for (int i = 0; i < 16; i++) { rgba[i * 4] = 255; rgba[i * 4 + 1] = 130; rgba[i * 4 + 2] = 0; rgba[i * 4 + 3] = 255; }
+
+    // ACT
+    std::uint8_t block[8];
+    TextureCompression::encodeBC1Block(rgba, block);
+    std::uint8_t decoded[64];
+    TextureCompression::decodeBC1Block(block, decoded);
+
+    // ASSERT
+    for (int i = 0; i < 16; i++) {
+        ASSERT_EQ(decoded[i * 4], 255);
+        ASSERT_EQ(decoded[i * 4 + 1], 130);
+        ASSERT_EQ(decoded[i * 4 + 2], 0);
+        ASSERT_EQ(decoded[i * 4 + 3], 255);
+    }
+}
+
+TEST(TextureCompressionTest, BC1FollowsAGradient) {
+    // ARRANGE
+    std::uint8_t rgba[64];
+    for (int i = 0; i < 16; i++) {
+        rgba[i * 4] = static_cast<std::uint8_t>(i * 16);
+        rgba[i * 4 + 1] = static_cast<std::uint8_t>(255 - i * 16);
+        rgba[i * 4 + 2] = 64;
+        rgba[i * 4 + 3] = 255;
+    }
+
+    // ACT
+    std::uint8_t block[8];
+    TextureCompression::encodeBC1Block(rgba, block);
+    std::uint8_t decoded[64];
+    TextureCompression::decodeBC1Block(block, decoded);
+
+    // ASSERT
+    //four palette entries over a 240 wide ramp leave at most half a step, plus 565 rounding
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 3; c++) {
+            ASSERT_LE(std::abs(decoded[i * 4 + c] - rgba[i * 4 + c]), 48) << "texel " << i << " channel " << c;
+        }
+        ASSERT_EQ(decoded[i * 4 + 3], 255);
+    }
+    //the four color mode, so no texel came out transparent
+    std::uint16_t color0 = static_cast<std::uint16_t>(block[0] | (block[1] << 8));
+    std::uint16_t color1 = static_cast<std::uint16_t>(block[2] | (block[3] << 8));
+    ASSERT_GT(color0, color1);
+}
+
+TEST(TextureCompressionTest, BC4RampHitsItsEndpoints) {
+    // ARRANGE
+    std::uint8_t values[16];
+    for (int i = 0; i < 16; i++) values[i] = static_cast<std::uint8_t>(40 + i * 10);
+
+    // ACT
+    std::uint8_t block[8];
+    TextureCompression::encodeBC4Block(values, block);
+    std::uint8_t decoded[16];
+    TextureCompression::decodeBC4Block(block, decoded);
+
+    // ASSERT
+    ASSERT_EQ(decoded[0], 40);
+    ASSERT_EQ(decoded[15], 190);
+    //eight levels over 150 are 21.4 apart
+    for (int i = 0; i < 16; i++) ASSERT_LE(std::abs(decoded[i] - values[i]), 11);
+}
+
+TEST(TextureCompressionTest, ChoosesFormatByChannelUsage) {
+    // ARRANGE
+    std::uint8_t opaque[4 * 4] = {};
+    std::uint8_t translucent[4 * 4] = {};
+    for (int i = 0; i < 4; i++) { opaque[i * 4 + 3] = 255; translucent[i * 4 + 3] = 255; }
+    translucent[2 * 4 + 3] = 128;
+
+    // ACT & ASSERT
+    ASSERT_EQ(TextureCompression::chooseFormat(opaque, 2, 2, 1), TextureFormat::BC4);
+    ASSERT_EQ(TextureCompression::chooseFormat(opaque, 2, 2, 2), TextureFormat::BC5);
+    ASSERT_EQ(TextureCompression::chooseFormat(opaque, 2, 2, 3), TextureFormat::BC1);
+    ASSERT_EQ(TextureCompression::chooseFormat(opaque, 2, 2, 4), TextureFormat::BC1);
+    ASSERT_EQ(TextureCompression::chooseFormat(translucent, 2, 2, 4), TextureFormat::BC3);
+}
+
+TEST(TextureCompressionTest, FindsTheChannelsTexelsUse) {
+    // ARRANGE
+    //RGBA texels, two of them
+    std::uint8_t grey[8] = {10, 10, 10, 255, 200, 200, 200, 255};
+    std::uint8_t greyAlpha[8] = {10, 10, 10, 128, 200, 200, 200, 255};
+    std::uint8_t mask[8] = {10, 0, 0, 255, 200, 0, 0, 255};
+    std::uint8_t normal[8] = {10, 20, 0, 255, 200, 30, 0, 255};
+    std::uint8_t color[8] = {10, 20, 30, 255, 200, 30, 40, 255};
+    std::uint8_t translucent[8] = {10, 20, 30, 255, 200, 30, 40, 0};
+
+    // ACT
+    TextureChannels greyChannels = TextureCompression::findChannels(grey, 2, 1, 4);
+    TextureChannels greyAlphaChannels = TextureCompression::findChannels(greyAlpha, 2, 1, 4);
+    TextureLevel level;
+    level.width = 2;
+    level.height = 1;
+    level.data.assign(greyAlpha, greyAlpha + 8);
+    TextureLevel packed = TextureCompression::packChannels(level, 4, greyAlphaChannels);
+
+    // ASSERT
+    ASSERT_EQ(greyChannels.components, 1);
+    ASSERT_TRUE(greyChannels.grey);
+    ASSERT_EQ(greyAlphaChannels.components, 2);
+    ASSERT_TRUE(greyAlphaChannels.grey);
+    ASSERT_EQ(packed.data, (std::vector<std::uint8_t>{10, 128, 200, 255}));
+
+    ASSERT_EQ(TextureCompression::findChannels(mask, 2, 1, 4).components, 1);
+    ASSERT_FALSE(TextureCompression::findChannels(mask, 2, 1, 4).grey);
+    ASSERT_EQ(TextureCompression::findChannels(normal, 2, 1, 4).components, 2);
+    ASSERT_EQ(TextureCompression::findChannels(color, 2, 1, 4).components, 3);
+    ASSERT_EQ(TextureCompression::findChannels(translucent, 2, 1, 4).components, 4);
+}
+
+TEST(TextureCompressionTest, MipChainBoxFiltersDownToOneTexel) {
+    // ARRANGE
+    //5x3, one channel, texel value is its x
+    std::uint8_t pixels[5 * 3];
+    for (int y = 0; y < 3; y++) for (int x = 0; x < 5; x++) pixels[y * 5 + x] = static_cast<std::uint8_t>(x * 40);
+
+    // ACT
+    std::vector<TextureLevel> levels = TextureCompression::buildMipChain(pixels, 5, 3, 1, false);
+
+    // ASSERT
+    ASSERT_EQ(levels.size(), 3);
+    ASSERT_EQ(levels[1].width, 2);
+    ASSERT_EQ(levels[1].height, 1);
+    ASSERT_EQ(levels[2].width, 1);
+    ASSERT_EQ(levels[2].height, 1);
+    ASSERT_EQ(levels[1].data[0], 20);
+    ASSERT_EQ(levels[1].data[1], 100);
+    ASSERT_EQ(levels[2].data[0], 60);
+}
+
+TEST(TextureCompressionTest, SrgbMipsAverageInLinearSpace) {
+    // ARRANGE
+    //black and white columns, an RGB average would be 128
+    std::uint8_t pixels[2 * 1 * 3] = {0, 0, 0, 255, 255, 255};
+
+    // ACT
+    std::vector<TextureLevel> linear = TextureCompression::buildMipChain(pixels, 2, 1, 3, false);
+    std::vector<TextureLevel> srgb = TextureCompression::buildMipChain(pixels, 2, 1, 3, true);
+
+    // ASSERT
+    ASSERT_EQ(linear[1].data[0], 128);
+    //0.5 ^ (1 / 2.2) * 255
+    ASSERT_EQ(srgb[1].data[0], 186);
+}
+
+TEST(TextureCompressionTest, EncodedLevelsHaveTheBlockSizes) {
+    // ARRANGE
+    TextureLevel level;
+    level.width = 6;
+    level.height = 5;
+    level.data.assign(6 * 5 * 4, 200);
+
+    // ACT
+    TextureLevel bc1 = TextureCompression::encode(level, 4, TextureFormat::BC1);
+    TextureLevel bc3 = TextureCompression::encode(level, 4, TextureFormat::BC3);
+    TextureLevel decoded = TextureCompression::decode(bc3, TextureFormat::BC3);
+
+    // ASSERT
+    //2x2 blocks, the partial ones padded
+    ASSERT_EQ(bc1.data.size(), 4 * 8);
+    ASSERT_EQ(bc3.data.size(), 4 * 16);
+    ASSERT_EQ(TextureCompression::levelBytes(TextureFormat::BC5, 1, 1), 16);
+    ASSERT_EQ(TextureCompression::levelBytes(TextureFormat::RGB8, 3, 3), 27);
+    ASSERT_EQ(decoded.data.size(), level.data.size());
+    ASSERT_NEAR(decoded.data[(4 * 6 + 5) * 4], 200, 4);
+    ASSERT_EQ(decoded.data[(4 * 6 + 5) * 4 + 3], 200);
+}
@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include "TextureResidency.hpp"
+
+namespace {
+
+    //a 512x512 chain at one byte per texel: 512, 256, 128 and the 64..1 tail
+    std::vector<std::size_t> chainBytes() {
+        std::vector<std::size_t> bytes;
+        for (int size = 512; size >= 1; size /= 2) bytes.push_back(static_cast<std::size_t>(size) * size);
+        return bytes;
+    }
+
+    std::size_t tailBytes() {
+        std::size_t bytes = 0;
+        for (int size = 64; size >= 1; size /= 2) bytes += static_cast<std::size_t>(size) * size;
+        return bytes;
+    }
+
+    int count(const std::vector<TextureStreamAction>& actions, TextureStreamAction::Type type) {
+        int n = 0;
+        for (const auto& action : actions) if (action.type == type) n++;
+        return n;
+    }
+}
+
+TEST(TextureResidencyTest, LevelForMatchesScreenSize) {
+    // ACT & ASSERT
+    ASSERT_EQ(TextureResidency::levelFor(512, 512, 10, 600.0f), 0);
+    ASSERT_EQ(TextureResidency::levelFor(512, 512, 10, 512.0f), 0);
+    //the level still at least as large as the screen
+    ASSERT_EQ(TextureResidency::levelFor(512, 512, 10, 200.0f), 1);
+    ASSERT_EQ(TextureResidency::levelFor(512, 256, 10, 8.0f), 6);
+    ASSERT_EQ(TextureResidency::levelFor(512, 512, 10, 0.0f), 9);
+    ASSERT_EQ(TextureResidency::tailLevel(512, 512, 10), 3);
+    ASSERT_EQ(TextureResidency::tailLevel(32, 32, 6), 0);
+}
+
+TEST(TextureResidencyTest, StartsWithTheTailAndStreamsSmallLevelsFirst) {
+    // ARRANGE
+    TextureResidency residency;
+    std::uint32_t a = residency.add(chainBytes(), 3);
+    std::uint32_t b = residency.add(chainBytes(), 3);
+
+    // ACT
+    residency.request(a, 0);
+    residency.request(b, 0);
+    //room for both 128 levels and one 256 level this frame
+    std::vector<TextureStreamAction> first;
+    residency.plan(1 << 24, 128 * 128 * 2 + 1, first);
+
+    // ASSERT
+    ASSERT_EQ(residency.getResidentBytes(), 2 * tailBytes() + 2 * 128 * 128 + 256 * 256);
+    ASSERT_EQ(first.size(), 3);
+    ASSERT_EQ(first[0].level, 2);
+    ASSERT_EQ(first[1].level, 2);
+    ASSERT_EQ(first[2].level, 1);
+
+    //nothing more until the textures are drawn again, the vector is cleared before planning
+    residency.plan(1 << 24, 1 << 24, first);
+    ASSERT_TRUE(first.empty());
+}
+
+TEST(TextureResidencyTest, EvictsLeastRecentlyUsedUnderBudget) {
+    // ARRANGE
+    TextureResidency residency;
+    std::uint32_t old = residency.add(chainBytes(), 3);
+    std::uint32_t recent = residency.add(chainBytes(), 3);
+    std::uint32_t current = residency.add(chainBytes(), 3);
+    //every texture fully resident except the current one's 512 level
+    std::size_t budget = 3 * tailBytes() + 3 * (128 * 128 + 256 * 256) + 512 * 512;
+    residency.request(old, 0);
+    residency.request(recent, 0);
+    residency.request(current, 1);
+    std::vector<TextureStreamAction> actions;
+    residency.plan(budget, 1 << 24, actions);
+    residency.request(recent, 1);
+    residency.request(current, 1);
+    residency.plan(budget, 1 << 24, actions);
+    ASSERT_EQ(residency.getResidentLevel(old), 0);
+
+    // ACT
+    residency.request(current, 0);
+    residency.plan(budget, 1 << 24, actions);
+
+    // ASSERT
+    ASSERT_EQ(count(actions, TextureStreamAction::Type::UPLOAD), 1);
+    ASSERT_EQ(residency.getResidentLevel(current), 0);
+    //the texture not drawn for longest gave up its level, the other kept what it wants
+    ASSERT_EQ(residency.getResidentLevel(old), 1);
+    ASSERT_EQ(residency.getResidentLevel(recent), 1);
+    ASSERT_LE(residency.getResidentBytes(), budget);
+}
+
+TEST(TextureResidencyTest, NeverEvictsWhatIsDrawnNorTheTail) {
+    // ARRANGE
+    TextureResidency residency;
+    std::uint32_t a = residency.add(chainBytes(), 3);
+    std::uint32_t b = residency.add(chainBytes(), 3);
+    std::size_t budget = 2 * tailBytes() + 128 * 128;
+
+    // ACT
+    residency.request(a, 0);
+    residency.request(b, 0);
+    std::vector<TextureStreamAction> first;
+    residency.plan(budget, 1 << 24, first);
+    residency.request(a, 0);
+    residency.request(b, 0);
+    std::vector<TextureStreamAction> second;
+    residency.plan(budget, 1 << 24, second);
+
+    // ASSERT
+    //one 128 level fits, after that both are drawn and want more than the budget holds
+    ASSERT_EQ(first.size(), 1);
+    ASSERT_TRUE(second.empty());
+    ASSERT_EQ(residency.getResidentBytes(), budget);
+
+    //a budget smaller than the tails only stops streaming
+    TextureResidency tight;
+    std::uint32_t c = tight.add(chainBytes(), 3);
+    tight.request(c, 0);
+    tight.plan(0, 1 << 24, second);
+    ASSERT_TRUE(second.empty());
+    ASSERT_EQ(tight.getResidentLevel(c), 3);
+}
@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+#include "Coordinator.hpp"
+#include "TransformHierarchy.hpp"
+#include "TransformSystem.hpp"
+#include "Types.hpp"
+#include <algorithm>
+#include <random>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace {
+
+    glm::mat4 randomLocal(std::mt19937& rng) {
+        std::uniform_real_distribution<float> offset(-5.0f, 5.0f);
+        std::uniform_real_distribution<float> angle(-3.0f, 3.0f);
+        std::uniform_real_distribution<float> scale(0.5f, 1.5f);
+
+        glm::mat4 local = glm::translate(glm::mat4(1.0f), glm::vec3(offset(rng), offset(rng), offset(rng)));
+        local = glm::rotate(local, angle(rng), glm::normalize(glm::vec3(offset(rng), offset(rng), 1.0f)));
+        return glm::scale(local, glm::vec3(scale(rng)));
+    }
+
+    //reference world matrix, walks the parent chain every time
+    glm::mat4 naiveWorld(Entity entity, const std::vector<Entity>& parents, const std::vector<glm::mat4>& locals) {
+        glm::mat4 world = locals[entity];
+        for (Entity parent = parents[entity]; parent != NULL_ENTITY; parent = parents[parent]) {
+            world = locals[parent] * world;
+        }
+        return world;
+    }
+
+    void expectMatrixNear(const glm::mat4& actual, const glm::mat4& expected) {
+        for (int c = 0; c < 4; ++c) {
+            for (int r = 0; r < 4; ++r) {
+                EXPECT_NEAR(actual[c][r], expected[c][r], 1e-3f) << "column " << c << " row " << r;
+            }
+        }
+    }
+
+    bool contains(const std::vector<Entity>& values, Entity value) {
+        return std::find(values.begin(), values.end(), value) != values.end();
+    }
+}
+
+TEST(TransformHierarchyTest, MatchesNaiveRecursionOnRandomTree) {
+    // ARRANGE
+    std::mt19937 rng(7);
+    const Entity count = 500;
+    std::vector<Entity> parents(count, NULL_ENTITY);
+    std::vector<glm::mat4> locals(count);
+
+    TransformHierarchy hierarchy;
+    for (Entity entity = 0; entity < count; ++entity) {
+        if (entity > 0 && rng() % 8 != 0) parents[entity] = rng() % entity;
+        locals[entity] = randomLocal(rng);
+        hierarchy.add(entity, parents[entity]);
+        hierarchy.setLocal(entity, locals[entity]);
+    }
+
+    // ACT
+    hierarchy.update();
+
+    // ASSERT
+    ASSERT_EQ(hierarchy.getUpdatedEntities().size(), count);
+    for (Entity entity = 0; entity < count; ++entity) {
+        expectMatrixNear(hierarchy.getWorld(entity), naiveWorld(entity, parents, locals));
+    }
+}
+
+TEST(TransformHierarchyTest, OnlyDirtySubtreeIsRecomputed) {
+    // ARRANGE
+    // 0 -> 1 -> 2, 0 -> 3, 4 is a separate root
+    TransformHierarchy hierarchy;
+    hierarchy.add(0);
+    hierarchy.add(1, 0);
+    hierarchy.add(2, 1);
+    hierarchy.add(3, 0);
+    hierarchy.add(4);
+    hierarchy.update();
+
+    hierarchy.update();
+    ASSERT_TRUE(hierarchy.getUpdatedEntities().empty());
+
+    // ACT
+    hierarchy.setLocal(1, glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 2.0f, 0.0f)));
+    hierarchy.setLocal(0, glm::translate(glm::mat4(1.0f), glm::vec3(1.0f, 0.0f, 0.0f)));
+    hierarchy.update();
+
+    // ASSERT
+    const auto& updated = hierarchy.getUpdatedEntities();
+    ASSERT_EQ(updated.size(), 4);
+    ASSERT_FALSE(contains(updated, 4));
+
+    ASSERT_FLOAT_EQ(hierarchy.getWorld(2)[3].x, 1.0f);
+    ASSERT_FLOAT_EQ(hierarchy.getWorld(2)[3].y, 2.0f);
+    ASSERT_FLOAT_EQ(hierarchy.getWorld(3)[3].y, 0.0f);
+
+    // A leaf change touches only the leaf
+    hierarchy.setLocal(3, glm::mat4(1.0f));
+    hierarchy.update();
+    ASSERT_EQ(hierarchy.getUpdatedEntities().size(), 1);
+    ASSERT_EQ(hierarchy.getUpdatedEntities()[0], 3);
+}
+
+TEST(TransformHierarchyTest, ReparentingKeepsDepthOrderAndRejectsCycles) {
+    // ARRANGE
+    TransformHierarchy hierarchy;
+    hierarchy.add(0);
+    hierarchy.add(1, 0);
+    hierarchy.add(2, 1);
+    hierarchy.add(3);
+    hierarchy.setLocal(3, glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, 5.0f)));
+    hierarchy.update();
+
+    // ACT
+    bool cycle = hierarchy.setParent(0, 2);
+    bool moved = hierarchy.setParent(0, 3);
+    hierarchy.update();
+
+    // ASSERT
+    ASSERT_FALSE(cycle);
+    ASSERT_TRUE(moved);
+    ASSERT_EQ(hierarchy.getParent(0), 3);
+    ASSERT_FLOAT_EQ(hierarchy.getWorld(2)[3].z, 5.0f);
+
+    const auto& order = hierarchy.getOrder();
+    for (Entity entity : order) {
+        Entity parent = hierarchy.getParent(entity);
+        if (parent == NULL_ENTITY) continue;
+        auto parentPosition = std::find(order.begin(), order.end(), parent);
+        auto position = std::find(order.begin(), order.end(), entity);
+        ASSERT_LT(parentPosition, position) << "entity " << entity;
+    }
+}
+
+TEST(TransformHierarchyTest, RemovingNodeReattachesChildren) {
+    // ARRANGE
+    TransformHierarchy hierarchy;
+    hierarchy.add(0);
+    hierarchy.add(1, 0);
+    hierarchy.add(2, 1);
+    hierarchy.add(3, 1);
+    hierarchy.setLocal(0, glm::translate(glm::mat4(1.0f), glm::vec3(3.0f, 0.0f, 0.0f)));
+    hierarchy.setLocal(1, glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 4.0f, 0.0f)));
+    hierarchy.update();
+
+    // ACT
+    hierarchy.remove(1);
+    hierarchy.update();
+
+    // ASSERT
+    ASSERT_FALSE(hierarchy.contains(1));
+    ASSERT_EQ(hierarchy.size(), 3);
+    ASSERT_EQ(hierarchy.getReattached().size(), 2);
+    ASSERT_EQ(hierarchy.getParent(2), 0);
+    ASSERT_EQ(hierarchy.getParent(3), 0);
+    ASSERT_FLOAT_EQ(hierarchy.getWorld(2)[3].x, 3.0f);
+    ASSERT_FLOAT_EQ(hierarchy.getWorld(2)[3].y, 0.0f);
+}
+
+TEST(TransformHierarchyTest, TransformSystemFollowsParents) {
+    // ARRANGE
+    auto coordinator = std::make_unique<Coordinator>();
+    coordinator->registerComponent<TransformComponent>();
+    coordinator->registerComponent<WorldTransformComponent>();
+
+    Signature signature;
+    signature.set(coordinator->getComponentTypeID<TransformComponent>());
+    signature.set(coordinator->getComponentTypeID<WorldTransformComponent>());
+    coordinator->registerSystem<TransformSystem>(signature);
+    auto transformSystem = coordinator->getSystem<TransformSystem>();
+    transformSystem->init(coordinator.get());
+
+    auto spawn = [&](const TransformComponent& transform) {
+        Entity entity = coordinator->createEntity();
+        coordinator->addComponent(entity, transform);
+        coordinator->addComponent(entity, WorldTransformComponent{});
+        return entity;
+    };
+
+    Entity root = spawn(TransformComponent{.position = {1.0f, 0.0f, 0.0f}, .scale = {2.0f, 2.0f, 2.0f}});
+    Entity child = spawn(TransformComponent{.position = {0.0f, 1.0f, 0.0f}, .parent = root});
+    transformSystem->update();
+
+    // ACT
+    coordinator->getComponent<TransformComponent>(root).position.x = 5.0f;
+    transformSystem->markDirty(root);
+    transformSystem->update();
+
+    // ASSERT
+    const auto& world = coordinator->getComponent<WorldTransformComponent>(child);
+    ASSERT_EQ(transformSystem->getUpdatedEntities().size(), 2);
+    ASSERT_FLOAT_EQ(world.model[3].x, 5.0f);
+    ASSERT_FLOAT_EQ(world.model[3].y, 2.0f);
+    ASSERT_NEAR(world.normalMatrix[1][1], 0.5f, 1e-5f);
+
+    // Removing the parent hands the child to the root level
+    coordinator->removeComponent<WorldTransformComponent>(root);
+    ASSERT_EQ(coordinator->getComponent<TransformComponent>(child).parent, NULL_ENTITY);
+}
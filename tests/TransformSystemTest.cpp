@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include "Coordinator.hpp"
+#include "TransformSystem.hpp"
+#include "Types.hpp"
+#include <algorithm>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace {
+
+    struct TransformFixture {
+        std::unique_ptr<Coordinator> coordinator = std::make_unique<Coordinator>();
+        std::shared_ptr<TransformSystem> transformSystem;
+
+        TransformFixture() {
+            coordinator->registerComponent<TransformComponent>();
+            coordinator->registerComponent<WorldTransformComponent>();
+
+            Signature signature;
+            signature.set(coordinator->getComponentTypeID<TransformComponent>());
+            signature.set(coordinator->getComponentTypeID<WorldTransformComponent>());
+            coordinator->registerSystem<TransformSystem>(signature);
+
+            transformSystem = coordinator->getSystem<TransformSystem>();
+            transformSystem->init(coordinator.get());
+        }
+
+        Entity spawn(const TransformComponent& transform) {
+            Entity entity = coordinator->createEntity();
+            coordinator->addComponent(entity, transform);
+            coordinator->addComponent(entity, WorldTransformComponent{});
+            return entity;
+        }
+    };
+
+    void expectMatrixNear(const float* actual, const float* expected, int size) {
+        for (int i = 0; i < size; ++i) {
+            EXPECT_NEAR(actual[i], expected[i], 1e-4f) << "element " << i;
+        }
+    }
+}
+
+TEST(TransformSystemTest, ClosedFormMatchesMatrixProducts) {
+    // ARRANGE
+    TransformComponent transform;
+    transform.position = {3.0f, -1.0f, 7.5f};
+    transform.rotation = glm::angleAxis(glm::radians(63.0f), glm::normalize(glm::vec3(0.3f, 1.0f, -0.4f)));
+    transform.scale = {2.0f, 0.5f, 3.0f};
+
+    // ACT
+    WorldTransformComponent world;
+    TransformSystem::computeWorldTransform(transform, world);
+
+    // ASSERT
+    glm::mat4 model = glm::translate(glm::mat4(1.0f), transform.position) *
+                      glm::mat4_cast(transform.rotation) *
+                      glm::scale(glm::mat4(1.0f), transform.scale);
+    glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+
+    expectMatrixNear(&world.model[0][0], &model[0][0], 16);
+    expectMatrixNear(&world.normalMatrix[0][0], &normalMatrix[0][0], 9);
+}
+
+TEST(TransformSystemTest, OnlyDirtyEntitiesAreRecomputed) {
+    // ARRANGE
+    TransformFixture fixture;
+    Entity moving = fixture.spawn(TransformComponent{.position = {1.0f, 2.0f, 3.0f}});
+    Entity still = fixture.spawn(TransformComponent{.position = {-4.0f, 0.0f, 0.0f}});
+
+    // New entities get their first world matrix on the next update
+    fixture.transformSystem->update();
+    ASSERT_EQ(fixture.transformSystem->getUpdatedEntities().size(), 2);
+    ASSERT_FLOAT_EQ(fixture.coordinator->getComponent<WorldTransformComponent>(still).model[3].x, -4.0f);
+
+    // A frame without changes touches nothing
+    fixture.transformSystem->update();
+    ASSERT_TRUE(fixture.transformSystem->getUpdatedEntities().empty());
+
+    // ACT
+    fixture.coordinator->getComponent<TransformComponent>(moving).position.x = 10.0f;
+    fixture.transformSystem->markDirty(moving);
+    fixture.transformSystem->markDirty(moving);
+    fixture.transformSystem->update();
+
+    // ASSERT
+    const auto& updated = fixture.transformSystem->getUpdatedEntities();
+    ASSERT_EQ(updated.size(), 1);
+    ASSERT_EQ(updated[0], moving);
+    ASSERT_FLOAT_EQ(fixture.coordinator->getComponent<WorldTransformComponent>(moving).model[3].x, 10.0f);
+}
+
+TEST(TransformSystemTest, RemovedEntitiesAreSkipped) {
+    TransformFixture fixture;
+    Entity entity = fixture.spawn(TransformComponent{});
+    fixture.transformSystem->update();
+
+    fixture.transformSystem->markDirty(entity);
+    fixture.coordinator->removeComponent<WorldTransformComponent>(entity);
+    fixture.transformSystem->update();
+
+    ASSERT_TRUE(fixture.transformSystem->getUpdatedEntities().empty());
+}
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+#include "UploadQueue.hpp"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+TEST(UploadQueueTest, TasksRunInOrderWithinTheBudget) {
+    // ARRANGE
+    UploadQueue queue;
+    std::vector<int> order;
+    for (int i = 0; i < 5; i++) queue.push([&order, i]() { order.push_back(i); });
+
+    // ACT
+    std::size_t ran = queue.process(1000.0);
+
+    // ASSERT
+    ASSERT_EQ(ran, 5);
+    ASSERT_TRUE(queue.empty());
+    ASSERT_EQ(order, (std::vector<int>{0, 1, 2, 3, 4}));
+}
+
+TEST(UploadQueueTest, SpentBudgetLeavesTheRestForLaterFrames) {
+    // ARRANGE
+    UploadQueue queue;
+    int ran = 0;
+    for (int i = 0; i < 3; i++) {
+        queue.push([&ran]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            ran++;
+        });
+    }
+
+    // ACT
+    std::size_t first = queue.process(1.0);
+    std::size_t second = queue.process(0.0);
+
+    // ASSERT
+    //a task over budget still runs, so the queue always makes progress
+    ASSERT_EQ(first, 1);
+    ASSERT_EQ(second, 1);
+    ASSERT_EQ(ran, 2);
+    ASSERT_EQ(queue.size(), 1);
+}
+
+TEST(UploadQueueTest, TasksQueuedWhileProcessingWaitForTheNextCall) {
+    // ARRANGE
+    UploadQueue queue;
+    bool followUpRan = false;
+    queue.push([&]() { queue.push([&]() { followUpRan = true; }); });
+
+    // ACT
+    std::size_t first = queue.process(1000.0);
+    bool afterFirst = followUpRan;
+    std::size_t second = queue.process(1000.0);
+
+    // ASSERT
+    ASSERT_EQ(first, 1);
+    ASSERT_FALSE(afterFirst);
+    ASSERT_EQ(second, 1);
+    ASSERT_TRUE(followUpRan);
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include "Vertex.hpp"
+#include <cmath>
+#include <limits>
+#include <random>
+
+TEST(VertexPackingTest, HalfFloatRoundTrip) {
+    // ARRANGE
+    const float exact[] = {0.0f, 1.0f, -2.5f, 0.5f, 65504.0f, 6.103515625e-05f, 5.9604644775390625e-08f};
+
+    // ACT / ASSERT
+    for (float value : exact) {
+        EXPECT_EQ(VertexPacking::halfToFloat(VertexPacking::floatToHalf(value)), value) << value;
+    }
+
+    //texture coordinates in a few repeats keep at least 11 bits of precision
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> uv(-4.0f, 4.0f);
+    for (int i = 0; i < 1000; ++i) {
+        float value = uv(rng);
+        float decoded = VertexPacking::halfToFloat(VertexPacking::floatToHalf(value));
+        EXPECT_LE(std::fabs(decoded - value), std::fabs(value) * (1.0f / 2048.0f) + 1e-7f) << value;
+    }
+
+    EXPECT_EQ(VertexPacking::floatToHalf(1e6f), 0x7C00);
+    EXPECT_EQ(VertexPacking::floatToHalf(-std::numeric_limits<float>::infinity()), 0xFC00);
+    EXPECT_TRUE(std::isnan(VertexPacking::halfToFloat(VertexPacking::floatToHalf(std::nanf("")))));
+    //1 + 2^-11 is halfway between two halves and rounds to the even one
+    EXPECT_EQ(VertexPacking::floatToHalf(1.00048828125f), 0x3C00);
+}
+
+TEST(VertexPackingTest, NormalsSurvive1010102) {
+    // ARRANGE
+    std::mt19937 rng(11);
+    std::normal_distribution<float> component(0.0f, 1.0f);
+
+    for (int i = 0; i < 1000; ++i) {
+        glm::vec3 normal = glm::normalize(glm::vec3(component(rng), component(rng), component(rng)));
+
+        // ACT
+        glm::vec3 decoded = VertexPacking::unpackNormal(VertexPacking::packNormal(normal));
+
+        // ASSERT
+        //one snorm10 step is 1/511, the angular error stays well under half a degree
+        EXPECT_GT(glm::dot(glm::normalize(decoded), normal), 0.99996f);
+    }
+
+    glm::vec3 axis = VertexPacking::unpackNormal(VertexPacking::packNormal(glm::vec3(0.0f, -1.0f, 0.0f)));
+    EXPECT_FLOAT_EQ(axis.y, -1.0f);
+    EXPECT_FLOAT_EQ(axis.x, 0.0f);
+}
+
+TEST(VertexPackingTest, QuantizedPositionsDecodeThroughMatrix) {
+    // ARRANGE
+    AABB bounds;
+    bounds.min = glm::vec3(-10.0f, 0.0f, 2.0f);
+    bounds.max = glm::vec3(30.0f, 0.0f, 4.0f);
+    PositionQuantization quantization = PositionQuantization::fromBounds(bounds);
+
+    Vertex vertex;
+    vertex.Position = glm::vec3(7.5f, 0.0f, 3.25f);
+    vertex.Normal = glm::vec3(0.0f, 1.0f, 0.0f);
+    vertex.TexCoords = glm::vec2(0.25f, 0.75f);
+
+    // ACT
+    PackedVertex packed = VertexPacking::pack(vertex, quantization);
+    glm::vec3 normalized(packed.position[0] / 65535.0f, packed.position[1] / 65535.0f, packed.position[2] / 65535.0f);
+    glm::vec4 decoded = quantization.toMatrix() * glm::vec4(normalized, 1.0f);
+    Vertex unpacked = VertexPacking::unpack(packed, quantization);
+
+    // ASSERT
+    //a 16-bit step over 40 units is 0.6mm
+    EXPECT_NEAR(decoded.x, vertex.Position.x, 40.0f / 65535.0f);
+    EXPECT_NEAR(decoded.y, vertex.Position.y, 1e-6f);
+    EXPECT_NEAR(decoded.z, vertex.Position.z, 2.0f / 65535.0f);
+    EXPECT_NEAR(unpacked.Position.x, decoded.x, 1e-4f);
+    EXPECT_EQ(unpacked.TexCoords, vertex.TexCoords);
+    EXPECT_FLOAT_EQ(unpacked.Normal.y, 1.0f);
+}
@@ -0,0 +1,183 @@
+// Bakes a glTF scene into an asset pack: parsing, image decoding, mesh optimization, LOD
+// generation and vertex packing all happen here once instead of on every launch.
+//
+//   AssetBaker <input.gltf|.glb> <output.pack> [--full] [--no-lods] [--raw-textures]
+//
+// --full keeps float vertices, the pack only loads into a FULL geometry arena then.
+// --raw-textures stores the mip chains uncompressed instead of BC1/BC3/BC4/BC5.
+#include "AssetPack.hpp"
+#include "Mesh.hpp"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <set>
+#include <vector>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtx/matrix_decompose.hpp>
+
+#define TINYGLTF_IMPLEMENTATION
+#define STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <tiny_gltf.h>
+
+namespace {
+
+    //the decoded image at 8 bits per channel, 16-bit images come as native endian shorts. Empty
+    //when there are no pixels the pack can take
+    std::vector<std::uint8_t> eightBitPixels(const tinygltf::Image& image) {
+
+        std::vector<std::uint8_t> pixels;
+        if (image.width <= 0 || image.height <= 0 || image.component < 1 || image.component > 4) return pixels;
+
+        std::size_t values = std::size_t(image.width) * std::size_t(image.height) * std::size_t(image.component);
+        if (image.bits == 8 && image.image.size() == values) {
+            pixels = image.image;
+        } else if (image.bits == 16 && image.image.size() == values * 2) {
+            pixels.resize(values);
+            for (std::size_t i = 0; i < values; i++) {
+                std::uint16_t value;
+                std::memcpy(&value, &image.image[i * 2], sizeof(value));
+                pixels[i] = static_cast<std::uint8_t>((value + 128) / 257);
+            }
+        }
+        return pixels;
+    }
+
+    //pre-order, so every parent is written before its children
+    void addNode(const tinygltf::Model& model, int nodeIndex, std::uint32_t parent, AssetPackWriter& writer) {
+
+        const tinygltf::Node& node = model.nodes[nodeIndex];
+
+        glm::vec3 position(0.0f);
+        glm::quat rotation(1.0f, 0.0f, 0.0f, 0.0f);
+        glm::vec3 scale(1.0f);
+        if (node.matrix.size() == 16) {
+            glm::vec3 skew;
+            glm::vec4 perspective;
+            glm::decompose(glm::make_mat4(node.matrix.data()), scale, rotation, position, skew, perspective);
+        }
+        if (!node.translation.empty()) position = glm::vec3(node.translation[0], node.translation[1], node.translation[2]);
+        if (!node.rotation.empty()) rotation = glm::quat(node.rotation[3], node.rotation[0], node.rotation[1], node.rotation[2]);
+        if (!node.scale.empty()) scale = glm::vec3(node.scale[0], node.scale[1], node.scale[2]);
+
+        AssetPack::NodeRecord record;
+        record.parent = parent;
+        record.mesh = node.mesh >= 0 ? static_cast<std::uint32_t>(node.mesh) : AssetPack::NONE;
+        std::memcpy(record.position, &position[0], sizeof(record.position));
+        float quaternion[4] = {rotation.x, rotation.y, rotation.z, rotation.w};
+        std::memcpy(record.rotation, quaternion, sizeof(record.rotation));
+        std::memcpy(record.scale, &scale[0], sizeof(record.scale));
+
+        std::uint32_t index = writer.addNode(node.name, record);
+        for (int childIndex : node.children) addNode(model, childIndex, index, writer);
+    }
+}
+
+int main(int argc, char** argv) {
+
+    if (argc < 3) {
+        std::cerr << "usage: AssetBaker <input.gltf|.glb> <output.pack> [--full] [--no-lods] [--raw-textures]" << std::endl;
+        return 1;
+    }
+
+    std::string input = argv[1];
+    std::string output = argv[2];
+    VertexFormat vertexFormat = VertexFormat::PACKED;
+    MeshImportOptions options;
+    bool compressTextures = true;
+    for (int i = 3; i < argc; i++) {
+        if (std::strcmp(argv[i], "--full") == 0) vertexFormat = VertexFormat::FULL;
+        else if (std::strcmp(argv[i], "--no-lods") == 0) options.generateLODs = false;
+        else if (std::strcmp(argv[i], "--raw-textures") == 0) compressTextures = false;
+        else { std::cerr << "Unknown option " << argv[i] << std::endl; return 1; }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    // --- 1. Parse, which also decodes every image ---
+    tinygltf::Model model;
+    tinygltf::TinyGLTF loader;
+    std::string err;
+    std::string warn;
+    bool ret = input.substr(input.find_last_of(".") + 1) == "glb"
+        ? loader.LoadBinaryFromFile(&model, &err, &warn, input)
+        : loader.LoadASCIIFromFile(&model, &err, &warn, input);
+    if (!warn.empty()) { std::cout << "glTF WARN: " << warn << std::endl; }
+    if (!ret) { std::cerr << "glTF ERR: " << err << std::endl; return 1; }
+
+    AssetPackWriter writer(vertexFormat);
+
+    // --- 2. Textures, then materials which keep their glTF indices ---
+    //base colors are gamma encoded, their mips are averaged in linear space
+    std::set<int> colorTextures;
+    for (const auto& material : model.materials) {
+        colorTextures.insert(material.pbrMetallicRoughness.baseColorTexture.index);
+        colorTextures.insert(material.emissiveTexture.index);
+    }
+
+    //textures without a usable image are left out, so glTF texture i is packTextures[i] or NONE
+    std::vector<std::uint32_t> packTextures(model.textures.size(), AssetPack::NONE);
+    for (int i = 0; i < static_cast<int>(model.textures.size()); i++) {
+        int source = model.textures[i].source;
+        if (source < 0 || source >= static_cast<int>(model.images.size())) {
+            std::cout << "Skipping texture " << i << ", it has no image" << std::endl;
+            continue;
+        }
+        const auto& image = model.images[source];
+        std::vector<std::uint8_t> pixels = eightBitPixels(image);
+        if (pixels.empty()) {
+            std::cout << "Skipping texture " << i << ", image " << image.name << " is " << image.bits
+                      << "-bit or was not decoded" << std::endl;
+            continue;
+        }
+        packTextures[i] = writer.addTexture(image.name, pixels.data(), static_cast<std::uint32_t>(image.width),
+                                            static_cast<std::uint32_t>(image.height), static_cast<std::uint32_t>(image.component),
+                                            colorTextures.count(i) > 0, compressTextures);
+    }
+
+    for (const auto& material : model.materials) {
+        AssetPack::MaterialRecord record;
+        const auto& pbr = material.pbrMetallicRoughness;
+        if (pbr.baseColorTexture.index >= 0 && pbr.baseColorTexture.index < static_cast<int>(packTextures.size())) {
+            record.albedoTexture = packTextures[pbr.baseColorTexture.index];
+        }
+        for (int c = 0; c < 4; c++) record.albedoFactor[c] = static_cast<float>(pbr.baseColorFactor[c]);
+        if (material.emissiveFactor.size() == 3) {
+            for (int c = 0; c < 3; c++) record.emissiveFactor[c] = static_cast<float>(material.emissiveFactor[c]);
+        }
+        record.metallicFactor = static_cast<float>(pbr.metallicFactor);
+        record.roughnessFactor = static_cast<float>(pbr.roughnessFactor);
+        record.doubleSided = material.doubleSided ? 1 : 0;
+        writer.addMaterial(material.name, record);
+    }
+
+    // --- 3. Meshes, processed exactly as the runtime importer does ---
+    //MaterialID 0 is the default material, so glTF material i comes out as i + 1
+    for (const auto& gltfMesh : model.meshes) {
+        MeshData data = Mesh::ProcessGLTF(model, gltfMesh, 1, options);
+
+        std::vector<AssetPack::SubMeshRecord> subMeshes;
+        for (const SubMesh& subMesh : data.subMeshes) {
+            subMeshes.push_back(AssetPack::SubMeshRecord{subMesh.materialID == 0 ? AssetPack::NONE : subMesh.materialID - 1,
+                                                         subMesh.indexCount, subMesh.indexOffset, subMesh.baseVertex});
+        }
+        std::vector<std::uint32_t> indices(data.indices.begin(), data.indices.end());
+        writer.addMesh(gltfMesh.name, data.vertices, indices, subMeshes, data.lods);
+    }
+
+    // --- 4. The default scene's node tree ---
+    if (!model.scenes.empty()) {
+        int sceneIndex = model.defaultScene > -1 ? model.defaultScene : 0;
+        for (int nodeIndex : model.scenes[sceneIndex].nodes) addNode(model, nodeIndex, AssetPack::NONE, writer);
+    }
+
+    if (!writer.write(output)) {
+        std::cerr << "Failed to write " << output << std::endl;
+        return 1;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Baked " << input << " -> " << output << " (" << model.meshes.size() << " meshes, "
+              << model.textures.size() << " textures, " << model.nodes.size() << " nodes) in " << seconds << " s" << std::endl;
+    return 0;
+}